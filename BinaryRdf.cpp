@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <vector>
+#include "BinaryRdf.h"
+#include "MappedFile.h"
+
+namespace {
+
+constexpr char MAGIC[8] = {'R', 'D', 'F', 'P', 'B', 'I', 'N', 1};
+constexpr size_t HEADER_SIZE = 48;
+// 文件头标志位：三元组部分之后附有来源标记
+constexpr uint32_t HAS_FLAGS = 1;
+
+void putUint32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+void putUint64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+// LEB128 变长整数：每字节 7 位，最高位表示后面还有字节
+void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+uint64_t getUint(const char* data, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+// 按顺序读取一段数据，越界或变长整数过长时置 failed，之后读到的都是 0
+class Reader {
+public:
+    Reader(const char* begin, size_t size) : cursor(begin), end(begin + size) {}
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (cursor == end) {
+                break;
+            }
+            auto byte = static_cast<unsigned char>(*cursor++);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (byte < 0x80) {
+                return value;
+            }
+        }
+        failed = true;
+        cursor = end;
+        return 0;
+    }
+
+    const char* bytes(size_t count) {
+        if (static_cast<size_t>(end - cursor) < count) {
+            failed = true;
+            cursor = end;
+            return nullptr;
+        }
+        const char* result = cursor;
+        cursor += count;
+        return result;
+    }
+
+    bool atEnd() const { return cursor == end; }
+
+    bool failed = false;
+
+private:
+    const char* cursor;
+    const char* end;
+};
+
+struct EncodedTriple {
+    uint32_t subject;
+    uint32_t predicate;
+    uint32_t object;
+    uint8_t flags;
+
+    bool operator<(const EncodedTriple& other) const {
+        if (subject != other.subject) return subject < other.subject;
+        if (predicate != other.predicate) return predicate < other.predicate;
+        return object < other.object;
+    }
+};
+
+}
+
+bool writeBinaryRdf(const TripleStore& store, const std::string& filename, std::string& error, BinaryRdfInfo* info) {
+    const StringPool& pool = store.getStringPool();
+    const auto& tripleIds = store.getAllTripleIds();
+
+    // 只收录三元组用到的项
+    uint32_t maxId = 0;
+    for (const auto& ids : tripleIds) {
+        maxId = std::max({maxId, ids.subject_id, ids.predicate_id, ids.object_id});
+    }
+    std::vector<uint32_t> poolToFile(tripleIds.empty() ? 0 : static_cast<size_t>(maxId) + 1, UINT32_MAX);
+    std::vector<std::pair<std::string_view, uint32_t>> terms;
+    auto collect = [&](uint32_t id) {
+        if (poolToFile[id] == UINT32_MAX) {
+            poolToFile[id] = 0;
+            terms.emplace_back(pool.getString(id), id);
+        }
+    };
+    for (const auto& ids : tripleIds) {
+        collect(ids.subject_id);
+        collect(ids.predicate_id);
+        collect(ids.object_id);
+    }
+    std::sort(terms.begin(), terms.end());
+
+    std::string out(HEADER_SIZE, '\0');
+    std::string_view previous;
+    for (size_t i = 0; i < terms.size(); ++i) {
+        std::string_view term = terms[i].first;
+        poolToFile[terms[i].second] = static_cast<uint32_t>(i);
+        size_t shared = 0;
+        size_t limit = std::min(previous.size(), term.size());
+        while (shared < limit && previous[shared] == term[shared]) {
+            ++shared;
+        }
+        putVarint(out, shared);
+        putVarint(out, term.size() - shared);
+        out.append(term.data() + shared, term.size() - shared);
+        previous = term;
+    }
+    const size_t dictionaryBytes = out.size() - HEADER_SIZE;
+
+    std::vector<EncodedTriple> triples;
+    triples.reserve(tripleIds.size());
+    bool hasFlags = false;
+    for (size_t i = 0; i < tripleIds.size(); ++i) {
+        const auto& ids = tripleIds[i];
+        uint8_t flags = store.getTripleFlags(static_cast<uint32_t>(i));
+        hasFlags |= flags != BASE_FACT;
+        triples.push_back({poolToFile[ids.subject_id], poolToFile[ids.predicate_id], poolToFile[ids.object_id], flags});
+    }
+    std::sort(triples.begin(), triples.end());
+
+    uint32_t previousSubject = 0;
+    for (size_t i = 0; i < triples.size();) {
+        const uint32_t subject = triples[i].subject;
+        size_t subjectEnd = i;
+        size_t predicates = 0;
+        while (subjectEnd < triples.size() && triples[subjectEnd].subject == subject) {
+            if (subjectEnd == i || triples[subjectEnd].predicate != triples[subjectEnd - 1].predicate) {
+                ++predicates;
+            }
+            ++subjectEnd;
+        }
+        putVarint(out, subject - previousSubject);
+        putVarint(out, predicates);
+        previousSubject = subject;
+
+        uint32_t previousPredicate = 0;
+        while (i < subjectEnd) {
+            const uint32_t predicate = triples[i].predicate;
+            size_t predicateEnd = i;
+            while (predicateEnd < subjectEnd && triples[predicateEnd].predicate == predicate) {
+                ++predicateEnd;
+            }
+            putVarint(out, predicate - previousPredicate);
+            putVarint(out, predicateEnd - i);
+            previousPredicate = predicate;
+
+            uint32_t previousObject = 0;
+            for (; i < predicateEnd; ++i) {
+                putVarint(out, triples[i].object - previousObject);
+                previousObject = triples[i].object;
+            }
+        }
+    }
+    const size_t triplesBytes = out.size() - HEADER_SIZE - dictionaryBytes;
+    if (hasFlags) {
+        for (const auto& triple : triples) {
+            out.push_back(static_cast<char>(triple.flags));
+        }
+    }
+
+    std::string header(MAGIC, sizeof(MAGIC));
+    putUint32(header, hasFlags ? HAS_FLAGS : 0);
+    putUint32(header, 0);
+    putUint64(header, terms.size());
+    putUint64(header, triples.size());
+    putUint64(header, dictionaryBytes);
+    putUint64(header, triplesBytes);
+    out.replace(0, HEADER_SIZE, header);
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(out.data(), static_cast<std::streamsize>(out.size())) || !file.flush()) {
+        error = "cannot write " + filename;
+        return false;
+    }
+    if (info) {
+        *info = {terms.size(), triples.size(), dictionaryBytes, triplesBytes};
+    }
+    return true;
+}
+
+bool loadBinaryRdf(TripleStore& store, const std::string& filename, std::string& error, BinaryRdfInfo* info) {
+    MappedFile file(filename);
+    if (!file.isOpen()) {
+        error = "cannot open " + filename;
+        return false;
+    }
+    if (file.size() < HEADER_SIZE || std::memcmp(file.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        error = filename + " is not an RDFPanda binary file";
+        return false;
+    }
+    const char* data = file.data();
+    const uint32_t headerFlags = static_cast<uint32_t>(getUint(data + 8, 4));
+    const uint64_t termCount = getUint(data + 16, 8);
+    const uint64_t tripleCount = getUint(data + 24, 8);
+    const uint64_t dictionaryBytes = getUint(data + 32, 8);
+    const uint64_t triplesBytes = getUint(data + 40, 8);
+    const uint64_t flagBytes = (headerFlags & HAS_FLAGS) ? tripleCount : 0;
+    const uint64_t body = file.size() - HEADER_SIZE;
+    if (termCount > UINT32_MAX || dictionaryBytes > body || triplesBytes > body - dictionaryBytes ||
+        flagBytes != body - dictionaryBytes - triplesBytes) {
+        error = filename + ": section sizes do not match the file size (truncated?)";
+        return false;
+    }
+    // 每个词项至少两个字节（共享前缀长度与后缀长度两个变长整数），每个三元组至少一个字节（宾语差值）；
+    // 先按段大小检查头部的计数，损坏的头部不会导致按计数分配过大的内存
+    if (termCount > dictionaryBytes / 2 || tripleCount > triplesBytes) {
+        error = filename + ": term or triple count exceeds its section size (corrupt header)";
+        return false;
+    }
+
+    StringPool& pool = store.getStringPool();
+    std::vector<uint32_t> fileToPool(termCount);
+    Reader dictionary(data + HEADER_SIZE, dictionaryBytes);
+    std::string term;
+    for (uint64_t i = 0; i < termCount; ++i) {
+        uint64_t shared = dictionary.varint();
+        uint64_t length = dictionary.varint();
+        const char* suffix = dictionary.bytes(length);
+        if (dictionary.failed || shared > term.size()) {
+            error = filename + ": corrupt dictionary at term " + std::to_string(i);
+            return false;
+        }
+        term.resize(shared);
+        term.append(suffix, length);
+        fileToPool[i] = pool.getId(term);
+    }
+    if (!dictionary.atEnd()) {
+        error = filename + ": corrupt dictionary (trailing bytes)";
+        return false;
+    }
+
+    // 来源标记至少含一个已定义的位，且不含其他位；在加入任何三元组之前检查
+    const uint8_t* flags = reinterpret_cast<const uint8_t*>(data + HEADER_SIZE + dictionaryBytes + triplesBytes);
+    for (uint64_t i = 0; i < flagBytes; ++i) {
+        if (flags[i] == 0 || (flags[i] & ~(BASE_FACT | DERIVED_FACT)) != 0) {
+            error = filename + ": invalid fact flags " + std::to_string(flags[i]) + " for triple " + std::to_string(i);
+            return false;
+        }
+    }
+    Reader encoded(data + HEADER_SIZE + dictionaryBytes, triplesBytes);
+    uint64_t decoded = 0;
+    uint64_t subject = 0;
+    auto corrupt = [&]() {
+        error = filename + ": corrupt triples section after " + std::to_string(decoded) + " triples";
+        return false;
+    };
+    while (!encoded.atEnd()) {
+        subject += encoded.varint();
+        uint64_t predicates = encoded.varint();
+        uint64_t predicate = 0;
+        for (uint64_t p = 0; p < predicates && !encoded.failed; ++p) {
+            predicate += encoded.varint();
+            uint64_t objects = encoded.varint();
+            uint64_t object = 0;
+            for (uint64_t o = 0; o < objects && !encoded.failed; ++o) {
+                object += encoded.varint();
+                if (subject >= termCount || predicate >= termCount || object >= termCount || decoded >= tripleCount) {
+                    return corrupt();
+                }
+                Triple triple(fileToPool[subject], fileToPool[predicate], fileToPool[object]);
+                store.addTriple(triple, flagBytes ? flags[decoded] : static_cast<uint8_t>(BASE_FACT));
+                ++decoded;
+            }
+        }
+        if (encoded.failed) {
+            return corrupt();
+        }
+    }
+    if (decoded != tripleCount) {
+        return corrupt();
+    }
+    if (info) {
+        *info = {termCount, tripleCount, dictionaryBytes, triplesBytes};
+    }
+    return true;
+}
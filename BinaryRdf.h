@@ -0,0 +1,35 @@
+#ifndef RDFPANDA_STORAGE_BINARYRDF_H
+#define RDFPANDA_STORAGE_BINARYRDF_H
+
+#include <cstdint>
+#include <string>
+
+#include "TripleStore.h"
+
+// 紧凑的二进制 RDF 交换格式（参照 HDT 的字典 + ID 三元组结构），用于反复加载同一数据集时代替 N-Triples/Turtle 文本
+// 文件由三部分组成，整数均为小端：
+// - 文件头：魔数 "RDFPBIN" + 版本号、标志位、项数、三元组数、字典与三元组两部分的字节数
+// - 字典：三元组用到的所有项按字节序排序后前缀编码（每项记与前一项相同的前缀长度、其余部分的长度和内容），
+//   项在字典中的序号即文件内的ID
+// - 三元组：按文件内ID的 (主语, 谓语, 宾语) 排序后逐层分组，主语记与上一个主语的差，每个主语下记谓语数及各谓语
+//   与前一谓语的差，每个谓语下记宾语数及各宾语与前一宾语的差，均为变长整数；
+//   存在非基础事实时其后按同样的顺序附上每个三元组的来源标记（TripleFlag）
+// 项的写法与字符串池一致（即 parseNTriples/parseTurtle 写入的形式），读入时不做任何词法分析
+struct BinaryRdfInfo {
+    uint64_t terms = 0;
+    uint64_t triples = 0;
+    uint64_t dictionaryBytes = 0;
+    uint64_t triplesBytes = 0;
+};
+
+// 把事实库中的全部三元组写入 filename；失败时返回 false 并填写 error
+bool writeBinaryRdf(const TripleStore& store, const std::string& filename, std::string& error,
+                    BinaryRdfInfo* info = nullptr);
+
+// 把 filename 中的三元组加入事实库：文件映射到内存，字典项直接写入字符串池，三元组按ID解码后逐个 addTriple，
+// 文件中没有来源标记时均为基础事实。格式错误或文件被截断时返回 false 并填写 error，此前已加入的三元组保留
+bool loadBinaryRdf(TripleStore& store, const std::string& filename, std::string& error,
+                   BinaryRdfInfo* info = nullptr);
+
+
+#endif //RDFPANDA_STORAGE_BINARYRDF_H
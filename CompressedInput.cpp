@@ -0,0 +1,376 @@
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "CompressedInput.h"
+#include "MappedFile.h"
+
+#ifdef RDFPANDA_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef RDFPANDA_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+// 每次解压输出的块大小
+constexpr size_t BLOCK_SIZE = 1 << 20;
+
+// 顺序解压器：每次向 out 写入至多 capacity 字节，返回 0 表示数据结束，出错时抛出 std::runtime_error
+class Decoder {
+public:
+    virtual ~Decoder() = default;
+    virtual size_t read(char* out, size_t capacity) = 0;
+};
+
+#ifdef RDFPANDA_HAS_ZLIB
+class GzipDecoder : public Decoder {
+public:
+    GzipDecoder(const char* data, size_t size) {
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream.avail_in = 0;
+        remaining = size;
+        // 15 + 32：自动识别 gzip 与 zlib 头
+        if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+            throw std::runtime_error("inflateInit2 failed");
+        }
+    }
+
+    ~GzipDecoder() override {
+        inflateEnd(&stream);
+    }
+
+    size_t read(char* out, size_t capacity) override {
+        stream.next_out = reinterpret_cast<Bytef*>(out);
+        stream.avail_out = static_cast<uInt>(capacity);
+        while (stream.avail_out == capacity && !finished) {
+            feed();
+            int status = inflate(&stream, Z_NO_FLUSH);
+            if (status == Z_STREAM_END) {
+                // 后面还有数据时是下一个 gzip 成员
+                if (stream.avail_in == 0 && remaining == 0) {
+                    finished = true;
+                } else {
+                    inflateReset(&stream);
+                }
+            } else if (status == Z_BUF_ERROR || (status == Z_OK && stream.avail_in == 0 && remaining == 0 &&
+                                                 stream.avail_out == capacity)) {
+                throw std::runtime_error("gzip: unexpected end of data");
+            } else if (status != Z_OK) {
+                throw std::runtime_error(std::string("gzip: ") + (stream.msg ? stream.msg : "corrupt data"));
+            }
+        }
+        return capacity - stream.avail_out;
+    }
+
+private:
+    z_stream stream{};
+    size_t remaining = 0;
+    bool finished = false;
+
+    // avail_in 是 32 位的，大文件分段交给 zlib
+    void feed() {
+        if (stream.avail_in == 0 && remaining > 0) {
+            uInt chunk = static_cast<uInt>(std::min<size_t>(remaining, 1u << 30));
+            stream.avail_in = chunk;
+            remaining -= chunk;
+        }
+    }
+};
+#endif
+
+#ifdef RDFPANDA_HAS_ZSTD
+class ZstdDecoder : public Decoder {
+public:
+    ZstdDecoder(const char* data, size_t size) : input{data, size, 0} {
+        stream = ZSTD_createDStream();
+        ZSTD_initDStream(stream);
+    }
+
+    ~ZstdDecoder() override {
+        ZSTD_freeDStream(stream);
+    }
+
+    size_t read(char* out, size_t capacity) override {
+        ZSTD_outBuffer output{out, capacity, 0};
+        while (output.pos == 0 && input.pos < input.size) {
+            size_t status = ZSTD_decompressStream(stream, &output, &input);
+            if (ZSTD_isError(status)) {
+                throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(status));
+            }
+            frameOpen = status != 0;
+        }
+        // 输入已读完但帧还没结束：可能还有缓存在解压器内部的数据，或数据被截断
+        if (output.pos == 0 && frameOpen) {
+            size_t status = ZSTD_decompressStream(stream, &output, &input);
+            if (ZSTD_isError(status)) {
+                throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(status));
+            }
+            frameOpen = status != 0;
+            if (output.pos == 0) {
+                throw std::runtime_error("zstd: unexpected end of data");
+            }
+        }
+        return output.pos;
+    }
+
+private:
+    ZSTD_DStream* stream;
+    ZSTD_inBuffer input;
+    bool frameOpen = false;
+};
+
+// 解压一个完整的 zstd 帧
+std::string decompressFrame(ZSTD_DCtx* context, const char* data, size_t size) {
+    std::string content;
+    unsigned long long contentSize = ZSTD_getFrameContentSize(data, size);
+    if (contentSize != ZSTD_CONTENTSIZE_UNKNOWN && contentSize != ZSTD_CONTENTSIZE_ERROR) {
+        content.resize(static_cast<size_t>(contentSize));
+        size_t written = ZSTD_decompressDCtx(context, &content[0], content.size(), data, size);
+        if (ZSTD_isError(written)) {
+            throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(written));
+        }
+        content.resize(written);
+        return content;
+    }
+    ZstdDecoder decoder(data, size);
+    std::vector<char> block(BLOCK_SIZE);
+    size_t produced;
+    while ((produced = decoder.read(block.data(), block.size())) > 0) {
+        content.append(block.data(), produced);
+    }
+    return content;
+}
+
+// 多帧 zstd：工作线程按序号领取帧并解压，最多领先已交付的帧 window 个，结果按帧序在调用线程中交付
+void decompressFramesParallel(const char* data, const std::vector<std::pair<size_t, size_t>>& frames,
+                              size_t numThreads, const BlockCallback& onBlock) {
+    const size_t window = numThreads * 2;
+    std::vector<std::string> results(frames.size());
+    std::vector<char> ready(frames.size(), 0);
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t next = 0;
+    size_t delivered = 0;
+    bool failed = false;
+    std::string failure;
+
+    auto worker = [&]() {
+        ZSTD_DCtx* context = ZSTD_createDCtx();
+        while (true) {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return failed || next >= frames.size() || next < delivered + window; });
+                if (failed || next >= frames.size()) {
+                    break;
+                }
+                index = next++;
+            }
+            try {
+                std::string content = decompressFrame(context, data + frames[index].first, frames[index].second);
+                std::lock_guard<std::mutex> lock(mutex);
+                results[index] = std::move(content);
+                ready[index] = 1;
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(mutex);
+                failed = true;
+                failure = e.what();
+            }
+            changed.notify_all();
+        }
+        ZSTD_freeDCtx(context);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (size_t i = 0; i < frames.size(); ++i) {
+        std::string content;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return failed || ready[i]; });
+            if (failed) {
+                break;
+            }
+            content = std::move(results[i]);
+            delivered++;
+        }
+        changed.notify_all();
+        onBlock(content.data(), content.size());
+    }
+    {
+        // 交付中途失败时让工作线程退出
+        std::lock_guard<std::mutex> lock(mutex);
+        if (delivered < frames.size()) {
+            failed = true;
+        }
+    }
+    changed.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (!failure.empty()) {
+        throw std::runtime_error(failure);
+    }
+}
+#endif
+
+std::unique_ptr<Decoder> createDecoder(const char* data, size_t size, Compression compression) {
+    // 两个库都未启用时不使用数据
+    (void)data;
+    (void)size;
+    switch (compression) {
+        case Compression::Gzip:
+#ifdef RDFPANDA_HAS_ZLIB
+            return std::unique_ptr<Decoder>(new GzipDecoder(data, size));
+#else
+            throw std::runtime_error("gzip input requires building with zlib (RDFPANDA_WITH_ZLIB)");
+#endif
+        case Compression::Zstd:
+#ifdef RDFPANDA_HAS_ZSTD
+            return std::unique_ptr<Decoder>(new ZstdDecoder(data, size));
+#else
+            throw std::runtime_error("zstd input requires building with libzstd (RDFPANDA_WITH_ZSTD)");
+#endif
+        default:
+            throw std::runtime_error("input is not compressed");
+    }
+}
+
+}
+
+Compression detectCompression(const char* data, size_t size) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    if (size >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b) {
+        return Compression::Gzip;
+    }
+    if (size >= 4 && bytes[0] == 0x28 && bytes[1] == 0xb5 && bytes[2] == 0x2f && bytes[3] == 0xfd) {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+const char* compressionName(Compression compression) {
+    switch (compression) {
+        case Compression::Gzip:
+            return "gzip";
+        case Compression::Zstd:
+            return "zstd";
+        default:
+            return "none";
+    }
+}
+
+bool decompressBlocks(const char* data, size_t size, Compression compression, size_t numThreads,
+                      const BlockCallback& onBlock, std::string& error) {
+    try {
+#ifdef RDFPANDA_HAS_ZSTD
+        if (compression == Compression::Zstd && numThreads > 1) {
+            std::vector<std::pair<size_t, size_t>> frames;
+            for (size_t offset = 0; offset < size;) {
+                size_t frameSize = ZSTD_findFrameCompressedSize(data + offset, size - offset);
+                if (ZSTD_isError(frameSize)) {
+                    throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(frameSize));
+                }
+                frames.emplace_back(offset, frameSize);
+                offset += frameSize;
+            }
+            if (frames.size() > 1) {
+                decompressFramesParallel(data, frames, numThreads, onBlock);
+                return true;
+            }
+        }
+#else
+        (void)numThreads;  // 只用于 zstd 多帧并行解压
+#endif
+        std::unique_ptr<Decoder> decoder = createDecoder(data, size, compression);
+        std::vector<char> block(BLOCK_SIZE);
+        size_t produced;
+        while ((produced = decoder->read(block.data(), block.size())) > 0) {
+            onBlock(block.data(), produced);
+        }
+        return true;
+    } catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+}
+
+class DecompressedStream::Buffer : public std::streambuf {
+public:
+    explicit Buffer(const std::string& filename) : file(filename) {
+        if (!file.isOpen()) {
+            return;
+        }
+        compression = detectCompression(file.data(), file.size());
+        if (compression == Compression::None) {
+            // 未压缩：直接把映射作为读缓冲区
+            char* begin = const_cast<char*>(file.data());
+            setg(begin, begin, begin + file.size());
+            return;
+        }
+        try {
+            decoder = createDecoder(file.data(), file.size(), compression);
+            block.resize(BLOCK_SIZE);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+    }
+
+    MappedFile file;
+    Compression compression = Compression::None;
+    std::string error;
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        if (!decoder) {
+            return traits_type::eof();
+        }
+        size_t produced = 0;
+        try {
+            produced = decoder->read(block.data(), block.size());
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        if (produced == 0) {
+            decoder.reset();
+            return traits_type::eof();
+        }
+        setg(block.data(), block.data(), block.data() + produced);
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    std::unique_ptr<Decoder> decoder;
+    std::vector<char> block;
+};
+
+DecompressedStream::DecompressedStream(const std::string& filename)
+        : std::istream(nullptr), buffer(new Buffer(filename)) {
+    rdbuf(buffer.get());
+    if (!buffer->file.isOpen()) {
+        setstate(std::ios::failbit);
+    }
+}
+
+DecompressedStream::~DecompressedStream() = default;
+
+bool DecompressedStream::isOpen() const {
+    return buffer->file.isOpen();
+}
+
+Compression DecompressedStream::getCompression() const {
+    return buffer->compression;
+}
+
+const std::string& DecompressedStream::getError() const {
+    return buffer->error;
+}
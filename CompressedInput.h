@@ -0,0 +1,47 @@
+#ifndef RDFPANDA_STORAGE_COMPRESSEDINPUT_H
+#define RDFPANDA_STORAGE_COMPRESSEDINPUT_H
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+
+enum class Compression {
+    None,
+    Gzip,
+    Zstd
+};
+
+// 按文件头的魔数识别压缩格式：gzip 为 1f 8b，zstd 为 28 b5 2f fd，其余视为未压缩
+Compression detectCompression(const char* data, size_t size);
+const char* compressionName(Compression compression);
+
+// 把一段完整的压缩数据按顺序解压，每得到一块解压数据在调用线程中回调一次 onBlock(数据, 长度)
+// - zstd 数据由多个帧组成（如 pzstd 的输出）且 numThreads > 1 时，各帧由 numThreads 个线程并行解压，仍按帧的顺序回调；
+//   同时解压的帧不超过线程数的两倍
+// - gzip 只能顺序解压；多个 gzip 成员首尾相接的文件（pigz、cat 拼接）依次解压
+// 数据损坏或编译时未启用对应的库（RDFPANDA_HAS_ZLIB / RDFPANDA_HAS_ZSTD）时返回 false 并填写 error
+using BlockCallback = std::function<void(const char*, size_t)>;
+bool decompressBlocks(const char* data, size_t size, Compression compression, size_t numThreads,
+                      const BlockCallback& onBlock, std::string& error);
+
+// DecompressedStream：以 std::istream 按块读取可能压缩的文件，供 Turtle 等流式解析器使用
+// 文件映射到内存，按魔数选择解压方式，每次补充缓冲区时解压一块；未压缩的文件直接读映射，不复制
+class DecompressedStream : public std::istream {
+public:
+    explicit DecompressedStream(const std::string& filename);
+    ~DecompressedStream() override;
+
+    bool isOpen() const;
+    Compression getCompression() const;
+    // 解压出错时的原因，此前读到的数据截止于出错处
+    const std::string& getError() const;
+
+private:
+    class Buffer;
+    std::unique_ptr<Buffer> buffer;
+};
+
+
+#endif //RDFPANDA_STORAGE_COMPRESSEDINPUT_H
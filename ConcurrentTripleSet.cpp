@@ -0,0 +1,224 @@
+#include <thread>
+#include "ConcurrentTripleSet.h"
+
+namespace {
+
+// 空槽位标记：主语与宾语ID都为 UINT32_MAX 的三元组不会出现（UINT32_MAX 是字符串池的“不存在”标记）
+const uint64_t EMPTY_KEY = UINT64_MAX;
+// 已删除槽位的 tag，谓语ID + 1 不会取到该值
+const uint32_t TOMBSTONE_TAG = UINT32_MAX;
+
+}
+
+ConcurrentTripleSet::Table::Table(size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {
+    for (size_t i = 0; i < capacity; ++i) {
+        slots[i].key.store(EMPTY_KEY, std::memory_order_relaxed);
+        slots[i].tag.store(0, std::memory_order_relaxed);
+    }
+}
+
+ConcurrentTripleSet::ConcurrentTripleSet(size_t expectedCount) : table(new Table(capacityFor(expectedCount))) {}
+
+ConcurrentTripleSet::~ConcurrentTripleSet() {
+    delete table.load();
+    for (Table* t : retired) {
+        delete t;
+    }
+}
+
+size_t ConcurrentTripleSet::capacityFor(size_t expectedCount) {
+    // 保持装载因子不超过 1/2
+    size_t capacity = 1024;
+    while (capacity < expectedCount * 2) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+uint64_t ConcurrentTripleSet::hash(uint32_t subject, uint32_t predicate, uint32_t object) {
+    // splitmix64 混合三个ID
+    uint64_t x = (static_cast<uint64_t>(subject) << 32 | object) ^ (static_cast<uint64_t>(predicate) * 0x9E3779B97F4A7C15ULL);
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+ConcurrentTripleSet::ProbeResult ConcurrentTripleSet::probeInsert(Table* t, uint64_t key, uint32_t tag, uint64_t h) {
+    // 线性探测
+    for (size_t i = 0; i <= t->mask; ++i) {
+        Slot& slot = t->slots[(h + i) & t->mask];
+        uint64_t current = slot.key.load(std::memory_order_acquire);
+        if (current == EMPTY_KEY) {
+            if (slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                slot.tag.store(tag, std::memory_order_release);
+                return ProbeResult::Inserted;
+            }
+            // CAS 失败时 current 为抢先写入的键，继续按占用槽位处理
+        }
+        if (current == key) {
+            // 主宾相同，等待抢先者发布谓语后再比较
+            uint32_t existing;
+            while ((existing = slot.tag.load(std::memory_order_acquire)) == 0) {
+                std::this_thread::yield();
+            }
+            if (existing == tag) {
+                return ProbeResult::Exists;
+            }
+        }
+    }
+    return ProbeResult::Full;
+}
+
+bool ConcurrentTripleSet::insert(uint32_t subject, uint32_t predicate, uint32_t object) {
+    const uint64_t key = static_cast<uint64_t>(subject) << 32 | object;
+    const uint32_t tag = predicate + 1;
+    const uint64_t h = hash(subject, predicate, object);
+
+    while (true) {
+        Table* t = table.load(std::memory_order_acquire);
+        // 先登记再检查 sealed，与 grow() 中先置 sealed 再检查 users 配对，保证扩容时没有遗漏的插入
+        t->users.fetch_add(1);
+        if (t->sealed.load()) {
+            t->users.fetch_sub(1);
+            std::lock_guard<std::mutex> wait(resizeMutex);  // 等待扩容完成
+            continue;
+        }
+
+        ProbeResult result = probeInsert(t, key, tag, h);
+        size_t count = result == ProbeResult::Inserted ? t->count.fetch_add(1, std::memory_order_relaxed) + 1 : 0;
+        t->users.fetch_sub(1, std::memory_order_release);
+
+        if (result == ProbeResult::Full) {
+            grow(t);
+            continue;
+        }
+        if (result == ProbeResult::Exists) {
+            duplicateCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        insertCount.fetch_add(1, std::memory_order_relaxed);
+        if (count * 2 > t->mask + 1) {
+            grow(t);
+        }
+        return true;
+    }
+}
+
+bool ConcurrentTripleSet::contains(uint32_t subject, uint32_t predicate, uint32_t object) const {
+    const uint64_t key = static_cast<uint64_t>(subject) << 32 | object;
+    const uint32_t tag = predicate + 1;
+    const uint64_t h = hash(subject, predicate, object);
+
+    const Table* t = table.load(std::memory_order_acquire);
+    for (size_t i = 0; i <= t->mask; ++i) {
+        const Slot& slot = t->slots[(h + i) & t->mask];
+        uint64_t current = slot.key.load(std::memory_order_acquire);
+        if (current == EMPTY_KEY) {
+            return false;
+        }
+        if (current == key && slot.tag.load(std::memory_order_acquire) == tag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ConcurrentTripleSet::erase(uint32_t subject, uint32_t predicate, uint32_t object) {
+    const uint64_t key = static_cast<uint64_t>(subject) << 32 | object;
+    const uint32_t tag = predicate + 1;
+    const uint64_t h = hash(subject, predicate, object);
+
+    Table* t = table.load(std::memory_order_acquire);
+    for (size_t i = 0; i <= t->mask; ++i) {
+        Slot& slot = t->slots[(h + i) & t->mask];
+        uint64_t current = slot.key.load(std::memory_order_acquire);
+        if (current == EMPTY_KEY) {
+            return false;
+        }
+        if (current == key && slot.tag.load(std::memory_order_acquire) == tag) {
+            slot.tag.store(TOMBSTONE_TAG, std::memory_order_release);
+            t->tombstones.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ConcurrentTripleSet::grow(Table* full) {
+    std::lock_guard<std::mutex> lock(resizeMutex);
+    if (table.load(std::memory_order_acquire) != full) {
+        return;  // 其他线程已完成扩容
+    }
+
+    full->sealed.store(true);
+    while (full->users.load() != 0) {
+        std::this_thread::yield();
+    }
+
+    // 此时旧表不再变化，单线程迁移到两倍容量的新表
+    Table* bigger = new Table((full->mask + 1) * 2);
+    size_t migrated = 0;
+    for (size_t i = 0; i <= full->mask; ++i) {
+        uint64_t key = full->slots[i].key.load(std::memory_order_relaxed);
+        if (key == EMPTY_KEY) {
+            continue;
+        }
+        uint32_t tag = full->slots[i].tag.load(std::memory_order_relaxed);
+        if (tag == TOMBSTONE_TAG) {
+            continue;
+        }
+        uint64_t h = hash(static_cast<uint32_t>(key >> 32), tag - 1, static_cast<uint32_t>(key));
+        for (size_t j = 0; ; ++j) {
+            Slot& slot = bigger->slots[(h + j) & bigger->mask];
+            if (slot.key.load(std::memory_order_relaxed) == EMPTY_KEY) {
+                slot.key.store(key, std::memory_order_relaxed);
+                slot.tag.store(tag, std::memory_order_relaxed);
+                break;
+            }
+        }
+        migrated++;
+    }
+    bigger->count.store(migrated, std::memory_order_relaxed);
+
+    table.store(bigger, std::memory_order_release);
+    retired.push_back(full);
+    resizeCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ConcurrentTripleSet::reset(size_t expectedCount) {
+    std::lock_guard<std::mutex> lock(resizeMutex);
+    delete table.load();
+    for (Table* t : retired) {
+        delete t;
+    }
+    retired.clear();
+    table.store(new Table(capacityFor(expectedCount)));
+}
+
+size_t ConcurrentTripleSet::size() const {
+    const Table* t = table.load(std::memory_order_acquire);
+    return t->count.load(std::memory_order_relaxed) - t->tombstones.load(std::memory_order_relaxed);
+}
+
+size_t ConcurrentTripleSet::capacity() const {
+    return table.load(std::memory_order_acquire)->mask + 1;
+}
+
+ConcurrentTripleSet::Stats ConcurrentTripleSet::getStats() const {
+    return {
+        insertCount.load(std::memory_order_relaxed),
+        duplicateCount.load(std::memory_order_relaxed),
+        resizeCount.load(std::memory_order_relaxed),
+        size(),
+        capacity()
+    };
+}
+
+void ConcurrentTripleSet::resetCounters() {
+    insertCount.store(0);
+    duplicateCount.store(0);
+    resizeCount.store(0);
+}
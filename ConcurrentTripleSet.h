@@ -0,0 +1,80 @@
+#ifndef RDFPANDA_STORAGE_CONCURRENTTRIPLESET_H
+#define RDFPANDA_STORAGE_CONCURRENTTRIPLESET_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// 并发去重集合：以三元组ID为键的开放寻址哈希表，插入即判重（insert-if-absent）
+// 每个槽位由两个原子字组成：key 存放 (主语ID << 32 | 宾语ID)，tag 存放 谓语ID + 1（0 表示尚未发布）
+// 插入只使用 CAS，不加锁；装载因子超过 1/2 时在线扩容，只有扩容期间的插入需要短暂等待
+// 删除把 tag 置为墓碑，槽位仍占用以保持探测链，扩容时丢弃
+class ConcurrentTripleSet {
+public:
+    explicit ConcurrentTripleSet(size_t expectedCount = 0);
+    ~ConcurrentTripleSet();
+
+    ConcurrentTripleSet(const ConcurrentTripleSet&) = delete;
+    ConcurrentTripleSet& operator=(const ConcurrentTripleSet&) = delete;
+
+    // 三元组不存在时插入并返回 true，已存在返回 false；可并发调用
+    bool insert(uint32_t subject, uint32_t predicate, uint32_t object);
+    bool contains(uint32_t subject, uint32_t predicate, uint32_t object) const;
+    // 删除三元组，返回是否存在；不可与 insert 并发
+    bool erase(uint32_t subject, uint32_t predicate, uint32_t object);
+
+    // 清空并按预计元素数重新分配，不可与其他操作并发
+    void reset(size_t expectedCount);
+
+    size_t size() const;
+    size_t capacity() const;
+
+    // 统计信息
+    struct Stats {
+        uint64_t inserts;     // 成功插入次数
+        uint64_t duplicates;  // 因已存在被拒绝的次数
+        uint64_t resizes;     // 扩容次数
+        size_t size;
+        size_t capacity;
+    };
+
+    Stats getStats() const;
+    void resetCounters();
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> key;
+        std::atomic<uint32_t> tag;
+    };
+
+    struct Table {
+        size_t mask;
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<size_t> count{0};       // 已占用的槽位数（含墓碑），决定何时扩容
+        std::atomic<size_t> tombstones{0};
+        std::atomic<int> users{0};        // 正在该表上插入的线程数
+        std::atomic<bool> sealed{false};  // 扩容开始后不再接受插入
+
+        explicit Table(size_t capacity);
+    };
+
+    enum class ProbeResult { Inserted, Exists, Full };
+
+    std::atomic<Table*> table;
+    std::vector<Table*> retired;  // 扩容后被替换的旧表，可能仍有线程持有其指针，析构时统一释放
+    std::mutex resizeMutex;
+
+    std::atomic<uint64_t> insertCount{0};
+    std::atomic<uint64_t> duplicateCount{0};
+    std::atomic<uint64_t> resizeCount{0};
+
+    static size_t capacityFor(size_t expectedCount);
+    static uint64_t hash(uint32_t subject, uint32_t predicate, uint32_t object);
+    static ProbeResult probeInsert(Table* t, uint64_t key, uint32_t tag, uint64_t h);
+    void grow(Table* full);
+};
+
+
+#endif //RDFPANDA_STORAGE_CONCURRENTTRIPLESET_H
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <cstring>
+#include "CsvScanner.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define RDFPANDA_CSV_SSE2
+#endif
+
+namespace {
+
+// [from, end) 中第一个双引号的位置，没有时返回 end
+const char* findQuote(const char* from, const char* end) {
+    const void* quote = std::memchr(from, '"', end - from);
+    return quote ? static_cast<const char*>(quote) : end;
+}
+
+}
+
+bool CsvScanner::next(std::vector<std::string_view>& fields) {
+    while (pos < end) {
+        spans.clear();
+        scratch.clear();
+        recordLine = line;
+        if (!readRecord()) {
+            // 跳过出错记录所在行的剩余部分
+            const char* newline = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+            pos = newline ? newline + 1 : end;
+            if (newline) {
+                ++line;
+                lineStart = pos;
+            }
+            continue;
+        }
+        // 只有一个空字段的记录是空行
+        if (spans.size() == 1 && spans[0].size == 0) {
+            continue;
+        }
+        fields.clear();
+        for (const Span& span : spans) {
+            fields.emplace_back(span.data ? span.data : scratch.data() + span.offset, span.size);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool CsvScanner::readRecord() {
+    while (true) {
+        if (pos < end && *pos == '"') {
+            if (!readQuoted()) {
+                return false;
+            }
+        } else {
+            const char* stop = findStructural(pos);
+            // 单独的 \r 作为普通字符
+            while (stop < end && *stop == '\r' && stop + 1 < end && stop[1] != '\n') {
+                stop = findStructural(stop + 1);
+            }
+            if (stop < end && *stop == '"') {
+                pos = stop;
+                return fail("quote inside unquoted field");
+            }
+            spans.push_back({pos, 0, static_cast<size_t>(stop - pos)});
+            pos = stop;
+        }
+
+        if (pos == end) {
+            return true;
+        }
+        if (*pos == delimiter) {
+            ++pos;
+            continue;
+        }
+        if (*pos == '\r') {
+            ++pos;
+        }
+        if (pos < end) {
+            ++pos;
+            ++line;
+            lineStart = pos;
+        }
+        return true;
+    }
+}
+
+bool CsvScanner::readQuoted() {
+    const ParseError unterminated{line, static_cast<size_t>(pos - lineStart) + 1, "unterminated quoted field"};
+    const char* begin = ++pos;
+    const size_t scratchStart = scratch.size();
+    bool escaped = false;
+    while (true) {
+        const char* quote = findQuote(pos, end);
+        countLines(pos, quote);
+        if (quote == end) {
+            errors.push_back(unterminated);
+            pos = end;
+            return false;
+        }
+        // "" 表示一个引号：此前的内容连同一个引号复制到 scratch
+        if (quote + 1 < end && quote[1] == '"') {
+            scratch.append(pos, quote + 1);
+            pos = quote + 2;
+            escaped = true;
+            continue;
+        }
+        if (escaped) {
+            scratch.append(pos, quote);
+            spans.push_back({nullptr, scratchStart, scratch.size() - scratchStart});
+        } else {
+            spans.push_back({begin, 0, static_cast<size_t>(quote - begin)});
+        }
+        pos = quote + 1;
+        break;
+    }
+    if (pos < end && *pos != delimiter && *pos != '\n' && !(*pos == '\r' && (pos + 1 == end || pos[1] == '\n'))) {
+        return fail("expected delimiter or end of line after closing quote");
+    }
+    return true;
+}
+
+const char* CsvScanner::findStructural(const char* from) const {
+#ifdef RDFPANDA_CSV_SSE2
+    const __m128i delimiters = _mm_set1_epi8(delimiter);
+    const __m128i quotes = _mm_set1_epi8('"');
+    const __m128i newlines = _mm_set1_epi8('\n');
+    const __m128i returns = _mm_set1_epi8('\r');
+    while (end - from >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, delimiters), _mm_cmpeq_epi8(block, quotes)),
+                                    _mm_or_si128(_mm_cmpeq_epi8(block, newlines), _mm_cmpeq_epi8(block, returns)));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return from + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+        from += 16;
+    }
+#endif
+    while (from < end && *from != delimiter && *from != '"' && *from != '\n' && *from != '\r') {
+        ++from;
+    }
+    return from;
+}
+
+void CsvScanner::countLines(const char* from, const char* to) {
+    for (const char* p = from; (p = static_cast<const char*>(std::memchr(p, '\n', to - p))) != nullptr; ++p) {
+        ++line;
+        lineStart = p + 1;
+    }
+}
+
+bool CsvScanner::fail(const std::string& message) {
+    errors.push_back({line, static_cast<size_t>(pos - lineStart) + 1, message});
+    return false;
+}
+
+size_t CsvScanner::countQuotes(const char* data, size_t size) {
+    const char* p = data;
+    const char* end = data + size;
+    size_t count = 0;
+#ifdef RDFPANDA_CSV_SSE2
+    const __m128i quotes = _mm_set1_epi8('"');
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        count += __builtin_popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, quotes))));
+        p += 16;
+    }
+#endif
+    return count + std::count(p, end, '"');
+}
+
+size_t CsvScanner::findRecordStart(const char* data, size_t size, bool inQuotes) {
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] == '"') {
+            inQuotes = !inQuotes;
+        } else if (data[i] == '\n' && !inQuotes) {
+            return i + 1;
+        }
+    }
+    return size;
+}
@@ -0,0 +1,72 @@
+#ifndef RDFPANDA_STORAGE_CSVSCANNER_H
+#define RDFPANDA_STORAGE_CSVSCANNER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "NTriplesTokenizer.h"
+
+// CSV 导入时列到三元组的映射，列号从 0 开始
+struct CsvOptions {
+    char delimiter = ',';
+    bool header = false;        // 第一条记录为表头，跳过
+    int subjectColumn = 0;
+    int predicateColumn = 1;    // 为 -1 时所有三元组的谓语都是 predicate
+    int objectColumn = 2;
+    std::string predicate;
+};
+
+// CsvScanner：RFC 4180 CSV 的单遍扫描器，直接在内存缓冲区上工作
+// 字段可用双引号括起，其中可含分隔符、换行，"" 表示一个双引号；行尾可为 \n 或 \r\n，空行被跳过
+// 未加引号的字段原样返回（零拷贝）；加引号的字段去掉引号，只有含 "" 时才复制到内部缓冲区
+// 在 x86 上用 SSE2 每次比较 16 字节查找分隔符、引号与换行，其余平台逐字节查找
+// 引号未闭合、闭合引号后不是分隔符或行尾、未加引号的字段中出现引号时记录错误，跳过该记录所在行的剩余部分
+class CsvScanner {
+public:
+    // firstLine 为缓冲区首行的行号（分块解析时使用）
+    CsvScanner(const char* data, size_t size, char delimiter = ',', size_t firstLine = 1)
+            : pos(data), end(data + size), delimiter(delimiter), line(firstLine), lineStart(data) {}
+
+    // 读取下一条记录的全部字段，缓冲区结束时返回 false；字段在下次调用前有效
+    bool next(std::vector<std::string_view>& fields);
+
+    const std::vector<ParseError>& getErrors() const { return errors; }
+    size_t getLine() const { return line; }
+    // 最近一次 next() 返回的记录的起始行号
+    size_t getRecordLine() const { return recordLine; }
+
+    // [data, data + size) 中双引号的个数；分块时据此得知每块开头是否位于引号内
+    static size_t countQuotes(const char* data, size_t size);
+    // 从引号状态已知（inQuotes）的 data 开始，返回第一个引号外的换行符之后的偏移，没有时返回 size
+    static size_t findRecordStart(const char* data, size_t size, bool inQuotes);
+
+private:
+    struct Span {
+        const char* data;   // 为 nullptr 时字段在 scratch 中，从 offset 开始
+        size_t offset;
+        size_t size;
+    };
+
+    const char* pos;
+    const char* end;
+    char delimiter;
+    size_t line;
+    size_t recordLine = 0;
+    const char* lineStart;
+    std::vector<Span> spans;
+    std::string scratch;
+    std::vector<ParseError> errors;
+
+    bool readRecord();
+    bool readQuoted();
+    // 第一个分隔符、引号、\r 或 \n 的位置，没有时返回 end
+    const char* findStructural(const char* from) const;
+    // 统计已跳过的 [from, to) 中的换行
+    void countLines(const char* from, const char* to);
+    bool fail(const std::string& message);
+};
+
+
+#endif //RDFPANDA_STORAGE_CSVSCANNER_H
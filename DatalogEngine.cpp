@@ -12,30 +12,111 @@
 
 void DatalogEngine::initiateRulesMap() {
     // 建立规则关于规则体中各模式三元组的谓语ID的索引，方便迭代中用三元组触发规则的应用
-    for (const auto& rule : rules) {
-        for (const auto& triple : rule.body) {
-            if (isVariable(triple.predicate())) {
-                // 变量不作为索引
+    for (size_t r = 0; r < compiledRules.size(); ++r) {
+        const auto& body = compiledRules[r].body;
+        for (size_t i = 0; i < body.size(); ++i) {
+            const JoinTerm& predicate = body[i].terms[1];
+            if (predicate.isVar) {
+                // 谓语为变量的模式可被任意谓语的事实触发
+                wildcardRules.emplace_back(r, i);
                 continue;
             }
-            uint32_t predicateId = triple.getPredicateId();
+            // 向map中谓语ID对应的规则下标列表中添加当前规则的下标以及该谓语在规则体中的下标
+            rulesMap[predicate.value].emplace_back(r, i);
+        }
+    }
+}
 
-            if (rulesMap.find(predicateId) == rulesMap.end()) {
-                // 如果当前谓语ID不在map中，则添加
-                rulesMap[predicateId] = std::vector<std::pair<size_t, size_t>>();  // 规则下标，规则体中谓语下标
-                // rulesMap[predicateId] = std::vector<size_t>();  // 规则下标
+void DatalogEngine::compileRules() {
+    // 将规则编译为连接模式：变量按首次出现顺序分配槽位，常量解析为字符串池ID
+    // 变量名只在编译期间使用，不进入字符串池
+    StringPool& pool = store.getStringPool();
+    compiledRules.clear();
+    compiledRules.reserve(rules.size());
+    for (const auto& rule : rules) {
+        CompiledRule compiled;
+        std::unordered_map<std::string, uint32_t> slots;  // 变量名 -> 槽位
+        auto compileTerm = [&](const std::string& term) {
+            if (!isVariable(term)) {
+                return JoinTerm::constant(pool.getId(term));
             }
+            auto it = slots.find(term);
+            if (it == slots.end()) {
+                it = slots.emplace(term, static_cast<uint32_t>(slots.size())).first;
+            }
+            return JoinTerm::variable(it->second);
+        };
+        auto compileAtom = [&](const Atom& atom) {
+            JoinAtom compiledAtom;
+            compiledAtom.terms[0] = compileTerm(atom.subject);
+            compiledAtom.terms[1] = compileTerm(atom.predicate);
+            compiledAtom.terms[2] = compileTerm(atom.object);
+            return compiledAtom;
+        };
+
+        for (const auto& atom : rule.body) {
+            compiled.body.push_back(compileAtom(atom));
+        }
+        size_t bodyVarCount = slots.size();
+        compiled.head = compileAtom(rule.head);
+        compiled.varCount = slots.size();
+        // 规则头中出现规则体中没有的变量，无法实例化
+        compiled.valid = compiled.varCount == bodyVarCount;
+        compiled.varNames.resize(slots.size());
+        for (const auto& slot : slots) {
+            compiled.varNames[slot.second] = slot.first;
+        }
+        compiledRules.push_back(std::move(compiled));
+    }
+}
 
-            // 由于按照下标遍历，故每个vector中最后一个元素最大，只需检测是否小于当前规则下标即可防止重复
-            // if (!rulesMap[predicateId].empty() && rulesMap[predicateId].back() >= &rule - &rules[0]) {
-            //     continue;  // 已存在当前规则下标
-            // }
-
-            // 向map中谓语ID对应的规则下标列表中添加当前规则的下标以及该谓语在规则体中的下标
-            rulesMap[predicateId].emplace_back(&rule - &rules[0], &triple - &rule.body[0]);
-            // // 向map中谓语ID对应的规则下标列表中添加当前规则的下标
-            // rulesMap[predicateId].emplace_back(&rule - &rules[0]);
+void DatalogEngine::buildPlans() {
+    // 谓语为变量的模式可能先确定主宾再确定谓语，需要谓语在后的索引
+    if (!wildcardRules.empty()) {
+        store.enableTrieOrder(TrieOrder::SOP);
+        store.enableTrieOrder(TrieOrder::OSP);
+    }
 
+    // 每次推理前根据事实库当前的统计信息生成连接计划
+    fullPlans.clear();
+    triggerPlans.clear();
+    rederivePlans.clear();
+    for (size_t r = 0; r < compiledRules.size(); ++r) {
+        CompiledRule& rule = compiledRules[r];
+        const JoinTerm& headPredicate = rule.head.terms[1];
+        rule.virtualHead = !headPredicate.isVar && store.getVirtualPredicate(headPredicate.value) != nullptr;
+        // 只有规则头中的变量需要枚举，其余变量找到一个见证即可
+        std::vector<bool> headVars(rule.varCount, false);
+        for (const auto& term : rule.head.terms) {
+            if (term.isVar) {
+                headVars[term.value] = true;
+            }
+        }
+        std::vector<bool> prebound(rule.varCount, false);
+        fullPlans.push_back(planJoin(store, rule.body, rule.varCount, prebound, -1, headVars));
+
+        std::vector<JoinPlan> plans;
+        for (size_t i = 0; i < rule.body.size(); ++i) {
+            std::vector<bool> triggerBound(rule.varCount, false);
+            for (const auto& term : rule.body[i].terms) {
+                if (term.isVar) {
+                    triggerBound[term.value] = true;
+                }
+            }
+            plans.push_back(planJoin(store, rule.body, rule.varCount, triggerBound, static_cast<int>(i), headVars));
+        }
+        triggerPlans.push_back(std::move(plans));
+
+        // 重新推导（DRed）：规则头变量预绑定，其余变量都只需一个见证
+        std::vector<bool> noOutput(rule.varCount, false);
+        rederivePlans.push_back(planJoin(store, rule.body, rule.varCount, headVars, -1, noOutput));
+
+        if (!rule.valid) {
+            std::cerr << "Rule " << r << " skipped: head variable not bound by body" << std::endl;
+        } else if (rule.virtualHead) {
+            std::cerr << "Rule " << r << " skipped: head predicate is answered by a virtual index" << std::endl;
+        } else if (!fullPlans[r].valid) {
+            std::cerr << "Rule " << r << " skipped: " << fullPlans[r].error << std::endl;
         }
     }
 }
@@ -51,42 +132,81 @@ void DatalogEngine::reason() {
 
     // 创建线程池
     std::vector<std::future<std::vector<Triple>>> futures;
-    std::mutex storeMutex;
 
     std::atomic<int> reasonCount(0);
 
+    buildPlans();
+
+    // 按事实库规模（预留推理增长）分配去重集合，并装入已有三元组
+    knownTriples.reset(store.getTripleCount() * 2);
+    for (const auto& ids : store.getAllTripleIds()) {
+        knownTriples.insert(ids.subject_id, ids.predicate_id, ids.object_id);
+    }
+    knownTriples.resetCounters();
+    scratchAllocations = 0;
+    joinRuns = 0;
+
+    // 重置剖析计数，未命名的规则以下标和规则头谓语标识
+    profiles.assign(rules.size(), RuleProfile());
+    for (size_t r = 0; r < rules.size(); ++r) {
+        profiles[r].name = !rules[r].name.empty() ? rules[r].name
+                : "#" + std::to_string(r) + " " + rules[r].head.predicate;
+        profiles[r].atoms.resize(compiledRules[r].body.size());
+    }
+
     // 先进行第一轮推理，初始时没有新事实，遍历规则逐条应用
     // int ruleId = 0;
     for (const auto& rule : rules) {
         // std::cout << "Applying rule: " << ruleId++ << std::endl;
         // 使用 std::async 异步执行规则
         reasonCount++;
-        futures.push_back(std::async(std::launch::async, [&]() {
-            std::vector<Triple> newFacts;
-            std::map<std::string, std::string> bindings;
-            leapfrogTriejoin(store.getTriePSORoot(), store.getTriePOSRoot(), rule, newFacts, bindings);
-            return newFacts;
+        size_t ruleIdx = &rule - &rules[0];
+        futures.push_back(std::async(std::launch::async, [&, ruleIdx]() {
+            JoinScratch scratch(compiledRules);
+            scratch.resetBindings(compiledRules[ruleIdx].varCount);
+            leapfrogTriejoin(ruleIdx, -1, scratch);
+            scratchAllocations += scratch.getAllocationCount();
+            mergeProfile(scratch);
+            return std::move(scratch.inferred);
         }));
     }
 
     // 收集线程结果并立即存储，确保推理依赖的正确性
-    for (auto& future : futures) {
-        std::vector<Triple> newFacts = future.get();
+    for (size_t ruleIdx = 0; ruleIdx < futures.size(); ++ruleIdx) {
+        std::vector<Triple> newFacts = futures[ruleIdx].get();
         
         // 立即存储所有新事实，确保后续推理能够找到依赖
+        uint64_t inserted = 0;
         for (const auto& triple : newFacts) {
-            std::lock_guard<std::mutex> lock(getShardMutex(triple.predicate()));
-            if (!tripleExists(triple)) {
-                // 立即存储到数据库
-                store.addTriple(triple);
-                
+            if (insertIfNew(triple)) {
                 // 添加到推理队列
                 newFactQueue.push(triple);
+                inserted++;
             }
         }
+        std::lock_guard<std::mutex> lock(profileMutex);
+        profiles[ruleIdx].inserted += inserted;
+        profiles[ruleIdx].duplicates += newFacts.size() - inserted;
     }
 
+    propagate(newFactQueue, reasonCount);
+    materialized = true;
+
+    // 输出推理完成后的事实库大小
+    std::cout << "Total triples in store:           " << store.getTripleCount() << std::endl;
+    // 输出总共推理的次数
+    std::cout << "Total reasoning count:            " << reasonCount.load() << std::endl;
+    // 输出去重统计
+    ConcurrentTripleSet::Stats dedup = knownTriples.getStats();
+    std::cout << "Derived facts inserted:           " << dedup.inserts << std::endl;
+    std::cout << "Duplicate facts rejected:         " << dedup.duplicates << std::endl;
+    // 输出连接工作区的扩容次数，稳定后应远小于连接次数
+    std::cout << "Join scratch allocations:         " << scratchAllocations.load()
+              << " (" << joinRuns.load() << " joins)" << std::endl;
+}
 
+// 半朴素传播：工作线程逐个取出新事实，用它触发相关规则，新得到的事实写入事实库并入队，直到队列为空
+void DatalogEngine::propagate(std::queue<Triple>& newFactQueue, std::atomic<int>& reasonCount) {
     std::atomic<int> activeTaskCount(0); // 活动任务计数器
     std::mutex queueMutex; // 保护队列的互斥锁
 
@@ -97,9 +217,11 @@ void DatalogEngine::reason() {
 
     // 工作线程
     auto worker = [&]() {
+        // 本线程的连接工作区，所有触发共用
+        JoinScratch scratch(compiledRules);
         while (true) {
             reasonCount++;
-            Triple currentTriple("", "", "");
+            Triple currentTriple(UNBOUND_ID, UNBOUND_ID, UNBOUND_ID);
             {
                 std::unique_lock<std::mutex> lock(queueMutex);
                 cv.wait(lock, [&] { return !newFactQueue.empty() || done; });
@@ -131,72 +253,51 @@ void DatalogEngine::reason() {
             // }
 
             // 处理 currentTriple，推理新事实并加锁入队
-            // 增量优化：检查该三元组是否已经处理过
-            uint64_t tripleHash = static_cast<uint64_t>(currentTriple.getSubjectId()) << 32 | 
-                                 static_cast<uint64_t>(currentTriple.getPredicateId()) << 16 | 
-                                 static_cast<uint64_t>(currentTriple.getObjectId());
-            
-            {
-                std::lock_guard<std::mutex> lock(processedMutex);
-                if (processedTriples.find(tripleHash) != processedTriples.end()) {
-                    activeTaskCount--;
-                    continue;  // 已处理过，跳过
-                }
-                processedTriples.insert(tripleHash);
-            }
+            // 每个事实只在首次插入 knownTriples 时入队一次，无需再记录是否处理过
             // 根据rulesMap找到规则
-            auto it = rulesMap.find(currentTriple.getPredicateId());
-            if (it != rulesMap.end()) {
-                for (const auto& rulePair : it->second) {
-                    size_t ruleIdx = rulePair.first;
-                    size_t patternIdx = rulePair.second;
-                    const Rule& rule = rules[ruleIdx];
-                    const Triple& pattern = rule.body[patternIdx];
-
-                    // 绑定变量
-                    std::map<std::string, std::string> bindings;
-                    if (isVariable(pattern.subject())) {
-                        bindings[pattern.subject()] = currentTriple.subject();
-                    }
-                    if (isVariable(pattern.object())) {
-                        bindings[pattern.object()] = currentTriple.object();
-                    }
+            forEachTrigger(currentTriple.getPredicateId(), [&](size_t ruleIdx, size_t patternIdx) {
+                const CompiledRule& rule = compiledRules[ruleIdx];
 
-                    // 调用leapfrogTriejoin推理新事实
-                    std::vector<Triple> inferredFacts;
-                    std::map<std::string, std::string> bindingsPtr = bindings;
-                    leapfrogTriejoin(store.getTriePSORoot(), store.getTriePOSRoot(), rule, inferredFacts, bindingsPtr);
-                    // reasonCount++;
-
-                    // 先存储新事实，再加入队列
-                    std::vector<Triple> newValidFacts;
-                    
-                    // 第一步：存储新事实  
-                    for (const auto& fact : inferredFacts) {
-                        std::lock_guard<std::mutex> storeLock(getShardMutex(fact.predicate()));
-                        if (!tripleExists(fact)) {
-                            // 立即存储到数据库
-                            store.addTriple(fact);
-                            
-                            // 标记为当前迭代的新事实
-                            markTripleAsNewInCurrentIteration(fact);
-                            newValidFacts.push_back(fact);
-                        }
+                // 用当前三元组绑定触发模式中的变量
+                scratch.resetBindings(rule.varCount);
+                if (!bindTrigger(rule.body[patternIdx], currentTriple, scratch.bindings)) {
+                    return;
+                }
+
+                // 调用leapfrogTriejoin推理新事实
+                scratch.inferred.clear();
+                leapfrogTriejoin(ruleIdx, static_cast<int>(patternIdx), scratch);
+                // reasonCount++;
+
+                // 先存储新事实，再加入队列
+                scratch.fresh.clear();
+                
+                // 第一步：存储新事实  
+                for (const auto& fact : scratch.inferred) {
+                    if (insertIfNew(fact)) {
+                        scratch.push(scratch.fresh, fact);
                     }
-                    
-                    // 第二步：加入推理队列
-                    if (!newValidFacts.empty()) {
-                        std::lock_guard<std::mutex> queueLock(queueMutex);
-                        for (const auto& fact : newValidFacts) {
-                            newFactQueue.push(fact);
-                        }
+                }
+                RuleProfile& profile = scratch.profiles[ruleIdx];
+                profile.inserted += scratch.fresh.size();
+                profile.duplicates += scratch.inferred.size() - scratch.fresh.size();
+                profile.atoms[patternIdx].inserted += scratch.fresh.size();
+                profile.atoms[patternIdx].duplicates += scratch.inferred.size() - scratch.fresh.size();
+                
+                // 第二步：加入推理队列
+                if (!scratch.fresh.empty()) {
+                    std::lock_guard<std::mutex> queueLock(queueMutex);
+                    for (const auto& fact : scratch.fresh) {
+                        newFactQueue.push(fact);
                     }
                 }
-            }
+            });
 
             // 任务完成，减少活动任务计数
             activeTaskCount--;
         }
+        scratchAllocations += scratch.getAllocationCount();
+        mergeProfile(scratch);
     };
 
     // 启动线程池
@@ -221,448 +322,284 @@ void DatalogEngine::reason() {
     done = true;
     cv.notify_all();
     for (auto& t : workers) t.join();
-
-
-    // 输出推理完成后的事实库大小
-    std::cout << "Total triples in store:           " << store.getTripleCount() << std::endl;
-    // 输出总共推理的次数
-    std::cout << "Total reasoning count:            " << reasonCount.load() << std::endl;
-}
-
-bool DatalogEngine::isVariable(const std::string& term) {
-    // 判断是否为变量，变量以?开头，如"?x"
-    return !term.empty() && term[0] == '?';
 }
 
-void DatalogEngine::leapfrogTriejoin(
-    TrieNode* psoRoot, TrieNode* posRoot,
-    const Rule& rule,
-    std::vector<Triple>& newFacts,
-    std::map<std::string, std::string>& bindings
-) {
-
-    // std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
-
-    std::set<std::string> variables;
-    std::map<std::string, std::vector<std::pair<int, int>>> varPositions; // 变量 -> [(triple_idx, position)]
-    // todo: 能不能根据varPositions来筛选代入新三元组对应变量后可能产生冲突的三元组模式？需要找出主语和宾语变量都包含在新三元组对应模式中的三元组模式
-    // todo: 例如新三元组对应模式为A(?x,?y)，则需要找其他(?x,?y)、(?y,?x)、(?x,?x)、(?y,?y)的模式，并查询代入新值后的三元组是否存在于事实库中
-    // todo: 相当于对于两个[(idx, pos)]数组，找出所有idx，使(idx, 0)和(idx, 2)都存在
-    // update: 已实现
-
-    for (int i = 0; i < rule.body.size(); i++) {
-        const Triple& triple = rule.body[i];
-        if (isVariable(triple.subject())) {
-            variables.insert(triple.subject());
-            varPositions[triple.subject()].emplace_back(i, 0); // 0 表示主语位置
-        }
-        if (isVariable(triple.predicate())) {
-            variables.insert(triple.predicate());
-            varPositions[triple.predicate()].emplace_back(i, 1); // 1 表示谓语位置
-            // 实际基本不考虑谓语为变量的情况，但以防万一还是加上
-        }
-        if (isVariable(triple.object())) {
-            variables.insert(triple.object());
-            varPositions[triple.object()].emplace_back(i, 2); // 2 表示宾语位置
+void DatalogEngine::insertBase(const std::vector<Triple>& triples) {
+    maintenance = MaintenanceStats();
+    if (!materialized) {
+        for (const auto& triple : triples) {
+            if (store.addTriple(triple, BASE_FACT)) {
+                maintenance.baseChanged++;
+            }
         }
-    }
-
-    if (!checkConflictingTriples(bindings, varPositions, rule)) {
+        reason();
         return;
     }
 
-    // std::map<std::string, std::string> bindings;
-    // 对每个变量进行leapfrog join，使用优化的变量顺序
-    join_by_variable(psoRoot, posRoot, rule, variables, varPositions, bindings, 0, newFacts);
+    // 已存在的事实（包括推导事实）只补上基础事实标记，真正的新事实才需要传播
+    std::queue<Triple> newFactQueue;
+    for (const auto& triple : triples) {
+        if (knownTriples.insert(triple.getSubjectId(), triple.getPredicateId(), triple.getObjectId())) {
+            newFactQueue.push(triple);
+            maintenance.baseChanged++;
+        }
+        store.addTriple(triple, BASE_FACT);
+    }
+    const uint64_t before = knownTriples.getStats().inserts;
+    std::atomic<int> reasonCount(0);
+    propagate(newFactQueue, reasonCount);
+    maintenance.derived = knownTriples.getStats().inserts - before;
 
-    // std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
-    // std::chrono::duration<double> elapsed = end - start;
-    // std::cout << elapsed.count() << std::endl;
+    std::cout << "Base facts inserted:              " << maintenance.baseChanged << std::endl;
+    std::cout << "Derived facts inserted:           " << maintenance.derived << std::endl;
 }
 
-void DatalogEngine::join_by_variable(
-    TrieNode* psoRoot, TrieNode* posRoot,
-    const Rule& rule,  // 当前规则
-    const std::set<std::string>& variables,  // 当前规则的变量全集
-    const std::map<std::string, std::vector<std::pair<int, int>>>& varPositions,  // 变量 -> [(变量所在三元组模式在规则体中的下标, 主0/谓1/宾2)]
-    std::map<std::string, std::string>& bindings,  // 变量 -> 变量当前的绑定值（常量，未绑定则为空）
-    int varIdx,
-    std::vector<Triple>& newFacts
-) {
-    // 当所有变量都已绑定时，生成新的事实
-    if (varIdx >= variables.size()) {
-        std::string newSubject = substituteVariable(rule.head.subject(), bindings);
-        std::string newPredicate = substituteVariable(rule.head.predicate(), bindings);
-        std::string newObject = substituteVariable(rule.head.object(), bindings);
-
-        newFacts.emplace_back(newSubject, newPredicate, newObject);
+void DatalogEngine::deleteBase(const std::vector<Triple>& triples) {
+    maintenance = MaintenanceStats();
+
+    // 只处理确为基础事实的三元组；去掉基础标记后，它和推导事实一样可能被重新推导
+    std::vector<Triple> overDeleted;
+    for (const auto& triple : triples) {
+        uint32_t index = store.findTriple(triple);
+        if (index == UINT32_MAX || !(store.getTripleFlags(index) & BASE_FACT)) {
+            continue;
+        }
+        store.setTripleFlags(index, store.getTripleFlags(index) & ~BASE_FACT);
+        overDeleted.push_back(triple);
+        maintenance.baseChanged++;
+    }
+    if (!materialized) {
+        for (const auto& triple : overDeleted) {
+            store.removeTriple(triple);
+        }
         return;
     }
 
-    // 优化：在每次递归调用时重新计算变量选择性
-    auto selectivities = computeVariableSelectivity(rule, variables, varPositions, bindings);
-    
-    // 如果没有未绑定的变量，结束递归
-    if (selectivities.empty()) {
-        std::string newSubject = substituteVariable(rule.head.subject(), bindings);
-        std::string newPredicate = substituteVariable(rule.head.predicate(), bindings);
-        std::string newObject = substituteVariable(rule.head.object(), bindings);
-        newFacts.emplace_back(newSubject, newPredicate, newObject);
-        return;
+    JoinScratch scratch(compiledRules);
+
+    // 第一步：过度删除。在删除前的事实库上，从被删除的事实出发沿规则找出所有可能依赖它们的推导事实
+    // 仍带基础标记的事实不受影响，不再向下追踪
+    ConcurrentTripleSet pending(overDeleted.size() * 2);
+    for (const auto& triple : overDeleted) {
+        pending.insert(triple.getSubjectId(), triple.getPredicateId(), triple.getObjectId());
     }
-    
-    // 选择选择性最高的变量（候选值最少）
-    std::string currentVar = selectivities[0].variable;
-
-    // 对当前变量创建迭代器
-    std::vector<TrieIterator*> iterators;
-    for (const auto& pos : varPositions.at(currentVar)) {
-        int tripleIdx = pos.first;
-        int position = pos.second;
-        const Triple& triple = rule.body[tripleIdx];
-
-        TrieIterator* it = nullptr;
-
-        // 根据变量位置选择适当的Trie
-        if (position == 0) { // 主语位置
-            // 如果宾语已绑定，就从posTrie中对应宾语的子节点中查找
-            if (!isVariable(triple.object()) || bindings.find(triple.object()) != bindings.end()) {
-                it = new TrieIterator(posRoot);
-                // 对谓语进行seek (使用ID)
-                uint32_t predId = substituteVariableToId(triple.predicate(), bindings);
-                it->seek(predId);
-                if (!it->atEnd() && it->key() == predId) {
-                    // 对已确定的宾语进行seek (使用ID)
-                    TrieIterator objIt = it->open();
-                    uint32_t objId = substituteVariableToId(triple.object(), bindings);
-                    objIt.seek(objId);
-                    if (!objIt.atEnd() && objIt.key() == objId) {
-                        iterators.push_back(new TrieIterator(objIt.open()));
-                    }
-                }
+    for (size_t i = 0; i < overDeleted.size(); ++i) {
+        const Triple current = overDeleted[i];
+        forEachTrigger(current.getPredicateId(), [&](size_t ruleIdx, size_t patternIdx) {
+            scratch.resetBindings(compiledRules[ruleIdx].varCount);
+            if (!bindTrigger(compiledRules[ruleIdx].body[patternIdx], current, scratch.bindings)) {
+                return;
             }
-            // 否则，从psoTrie中查找
-            else {
-                it = new TrieIterator(psoRoot);
-                // 对谓语进行seek (使用ID)
-                uint32_t predId = substituteVariableToId(triple.predicate(), bindings);
-                it->seek(predId);
-                if (!it->atEnd() && it->key() == predId) {
-                    TrieIterator subIt = it->open();
-                    iterators.push_back(new TrieIterator(subIt));
+            scratch.inferred.clear();
+            leapfrogTriejoin(ruleIdx, static_cast<int>(patternIdx), scratch);
+            for (const auto& fact : scratch.inferred) {
+                uint32_t index = store.findTriple(fact);
+                if (index == UINT32_MAX || (store.getTripleFlags(index) & BASE_FACT)) {
+                    continue;
                 }
-            }
-        }
-        // 这里暂时不考虑谓语为变量，即position == 1的情况
-        else if (position == 2) { // 宾语位置
-            // 如果主语已绑定，就从psoTrie中对应主语的子节点中查找
-            if (!isVariable(triple.subject()) || bindings.find(triple.subject()) != bindings.end()) {
-                it = new TrieIterator(psoRoot);
-                // 对谓语进行seek (使用ID)
-                uint32_t predId = substituteVariableToId(triple.predicate(), bindings);
-                it->seek(predId);
-                if (!it->atEnd() && it->key() == predId) {
-                    // 对已确定的主语进行seek (使用ID)
-                    TrieIterator subjIt = it->open();
-                    uint32_t subjId = substituteVariableToId(triple.subject(), bindings);
-                    subjIt.seek(subjId);
-                    if (!subjIt.atEnd() && subjIt.key() == subjId) {
-                        iterators.push_back(new TrieIterator(subjIt.open()));
-                    }
+                if (pending.insert(fact.getSubjectId(), fact.getPredicateId(), fact.getObjectId())) {
+                    overDeleted.push_back(fact);
                 }
             }
-            // 否则，从posTrie中查找
-            else {
-                it = new TrieIterator(posRoot);
-                // 对谓语进行seek (使用ID)
-                uint32_t predId = substituteVariableToId(triple.predicate(), bindings);
-                it->seek(predId);
-                if (!it->atEnd() && it->key() == predId) {
-                    TrieIterator objIt = it->open();
-                    iterators.push_back(new TrieIterator(objIt));
-                }
-            }
-        }
+        });
+    }
+    maintenance.overDeleted = overDeleted.size();
 
-        if (it && iterators.empty()) {
-            delete it;
-        }
+    // 第二步：从事实库和去重集合中删除
+    for (const auto& triple : overDeleted) {
+        store.removeTriple(triple);
+        knownTriples.erase(triple.getSubjectId(), triple.getPredicateId(), triple.getObjectId());
     }
 
-    // 对当前变量执行leapfrog join
-    if (!iterators.empty()) {
-        LeapfrogJoin lf(iterators);
-        while (!lf.atEnd()) {
-            uint32_t keyId = lf.key();
-            // 将ID转换为字符串进行绑定
-            std::string key = store.getStringPool().getString(keyId);
-            bindings[currentVar] = key;
+    // 第三步：重新推导。仍能由剩余事实一步推出的事实先恢复，再由它们半朴素地传播恢复其余的
+    const uint64_t before = knownTriples.getStats().inserts;
+    std::queue<Triple> newFactQueue;
+    for (const auto& triple : overDeleted) {
+        if (derivable(triple, scratch) && insertIfNew(triple)) {
+            newFactQueue.push(triple);
+        }
+    }
+    scratchAllocations += scratch.getAllocationCount();
+    mergeProfile(scratch);
+    std::atomic<int> reasonCount(0);
+    propagate(newFactQueue, reasonCount);
+    maintenance.rederived = knownTriples.getStats().inserts - before;
 
-            // 递归处理下一个变量（不需要varIdx+1，因为我们动态选择变量）
-            join_by_variable(psoRoot, posRoot, rule, variables, varPositions, bindings, 0, newFacts);
+    std::cout << "Base facts deleted:               " << maintenance.baseChanged << std::endl;
+    std::cout << "Facts over-deleted:               " << maintenance.overDeleted << std::endl;
+    std::cout << "Facts rederived:                  " << maintenance.rederived << std::endl;
+}
 
-            lf.next();
+bool DatalogEngine::derivable(const Triple& triple, JoinScratch& scratch) {
+    for (size_t r = 0; r < compiledRules.size(); ++r) {
+        const CompiledRule& rule = compiledRules[r];
+        if (!rule.valid || rule.virtualHead || !rederivePlans[r].valid) {
+            continue;
         }
-
-        // 清理迭代器
-        for (auto it : iterators) {
-            delete it;
+        // 用事实绑定规则头，规则体有一组满足的绑定即可
+        scratch.resetBindings(rule.varCount);
+        if (!bindTrigger(rule.head, triple, scratch.bindings)) {
+            continue;
+        }
+        bool found = false;
+        TrieJoin join(rederivePlans[r], scratch.stack);
+        join.run(scratch.bindings, [&](const std::vector<uint32_t>&) {
+            found = true;
+            join.stop();
+        });
+        joinRuns++;
+        if (found) {
+            return true;
         }
     }
+    return false;
+}
 
-    // 删除当前变量的绑定
-    bindings.erase(currentVar);
+bool DatalogEngine::isVariable(const std::string& term) {
+    // 判断是否为变量，变量以?开头，如"?x"
+    return !term.empty() && term[0] == '?';
 }
 
-// 辅助函数：若绑定中存在变量则替换其绑定的值，否则返回原字符串（此时为常量）
-std::string DatalogEngine::substituteVariable(const std::string& term, const std::map<std::string, std::string>& bindings) {
-    if (isVariable(term) && bindings.find(term) != bindings.end()) {
-        return bindings.at(term);
+void DatalogEngine::leapfrogTriejoin(size_t ruleIdx, int triggerAtom, JoinScratch& scratch) {
+    const CompiledRule& rule = compiledRules[ruleIdx];
+    if (!rule.valid || rule.virtualHead) {
+        return;
     }
-    return term;
-}
+    const JoinPlan& plan = triggerAtom < 0 ? fullPlans[ruleIdx] : triggerPlans[ruleIdx][triggerAtom];
 
-// 计算变量的选择性，用于优化join顺序
-std::vector<DatalogEngine::VariableSelectivity> DatalogEngine::computeVariableSelectivity(
-    const Rule& rule,
-    const std::set<std::string>& variables,
-    const std::map<std::string, std::vector<std::pair<int, int>>>& varPositions,
-    const std::map<std::string, std::string>& bindings
-) const {
-    std::vector<VariableSelectivity> selectivities;
-    
-    for (const std::string& var : variables) {
-        if (bindings.find(var) != bindings.end()) {
-            continue;  // 已绑定的变量跳过
-        }
-        
-        VariableSelectivity vs;
-        vs.variable = var;
-        vs.candidateCount = 0;
-        
-        // 估算候选值数量
-        const auto& positions = varPositions.at(var);
-        size_t minCandidates = SIZE_MAX;
-        
-        for (const auto& pos : positions) {
-            int tripleIdx = pos.first;
-            int position = pos.second;
-            const Triple& triple = rule.body[tripleIdx];
-            
-            size_t candidates = 0;
-            
-            if (position == 0) {  // 主语位置
-                // 估算：根据谓语获取主语候选数
-                uint32_t predId = substituteVariableToId(triple.predicate(), bindings);
-                candidates = store.queryTripleIdsByPredicateId(predId).size();
-            } else if (position == 2) {  // 宾语位置  
-                // 估算：根据谓语获取宾语候选数
-                uint32_t predId = substituteVariableToId(triple.predicate(), bindings);
-                candidates = store.queryTripleIdsByPredicateId(predId).size();
-            }
-            
-            if (candidates > 0 && candidates < minCandidates) {
-                minCandidates = candidates;
-            }
-        }
-        
-        vs.candidateCount = (minCandidates == SIZE_MAX) ? 1000000 : minCandidates;
-        vs.selectivity = 1.0 / (vs.candidateCount + 1);  // 避免除零
-        
-        selectivities.push_back(vs);
+    uint64_t wallStart = 0;
+    uint64_t cpuStart = 0;
+    if (timingEnabled) {
+        wallStart = wallClockNanos();
+        cpuStart = threadCpuNanos();
     }
-    
-    // 按选择性排序，选择性高的变量优先
-    std::sort(selectivities.begin(), selectivities.end());
-    
-    return selectivities;
-}
-uint32_t DatalogEngine::getIdFromString(const std::string& str) const {
-    {
-        std::lock_guard<std::mutex> lock(cacheAccessMutex);
-        auto it = stringToIdCache.find(str);
-        if (it != stringToIdCache.end()) {
-            return it->second;
-        }
+    const size_t emittedBefore = scratch.inferred.size();
+
+    // 规则头各位置直接取常量ID或变量绑定，不经过字符串
+    const JoinTerm* head = rule.head.terms;
+    joinRuns.fetch_add(1, std::memory_order_relaxed);
+    TrieJoin join(plan, scratch.stack);
+    join.run(scratch.bindings, [&](const std::vector<uint32_t>& b) {
+        scratch.push(scratch.inferred, Triple(
+            head[0].isVar ? b[head[0].value] : head[0].value,
+            head[1].isVar ? b[head[1].value] : head[1].value,
+            head[2].isVar ? b[head[2].value] : head[2].value
+        ));
+    });
+
+    // 记入本线程的剖析计数
+    RuleProfile& profile = scratch.profiles[ruleIdx];
+    const uint64_t emitted = scratch.inferred.size() - emittedBefore;
+    profile.invocations++;
+    profile.candidates += scratch.stack.getCandidateCount();
+    profile.emitted += emitted;
+    for (size_t a = 0; a < plan.atoms.size(); ++a) {
+        uint64_t seeks = scratch.stack.getSeekCount(a);
+        profile.seeks += seeks;
+        profile.atoms[plan.atoms[a].atomIdx].seeks += seeks;
+    }
+    if (triggerAtom >= 0) {
+        profile.atoms[triggerAtom].triggers++;
+        profile.atoms[triggerAtom].emitted += emitted;
     }
-    
-    uint32_t id = store.getStringPool().getId(str);
-    
-    {
-        std::lock_guard<std::mutex> lock(cacheAccessMutex);
-        // 限制缓存大小，避免内存无限增长
-        if (stringToIdCache.size() < 100000) {
-            stringToIdCache[str] = id;
+    if (timingEnabled) {
+        const uint64_t wall = wallClockNanos() - wallStart;
+        const uint64_t cpu = threadCpuNanos() - cpuStart;
+        profile.wallNanos += wall;
+        profile.cpuNanos += cpu;
+        if (triggerAtom >= 0) {
+            profile.atoms[triggerAtom].wallNanos += wall;
+            profile.atoms[triggerAtom].cpuNanos += cpu;
         }
     }
-    
-    return id;
 }
 
-// Semi-Naive评估相关方法实现
-bool DatalogEngine::isTripleNewInCurrentIteration(const Triple& triple) const {
-    uint64_t tripleHash = static_cast<uint64_t>(triple.getSubjectId()) << 32 | 
-                         static_cast<uint64_t>(triple.getPredicateId()) << 16 | 
-                         static_cast<uint64_t>(triple.getObjectId());
-    
-    std::lock_guard<std::mutex> lock(newFactsMutex);
-    return newFactsInPreviousIteration.find(tripleHash) != newFactsInPreviousIteration.end();
-}
-
-void DatalogEngine::markTripleAsNewInCurrentIteration(const Triple& triple) {
-    uint64_t tripleHash = static_cast<uint64_t>(triple.getSubjectId()) << 32 | 
-                         static_cast<uint64_t>(triple.getPredicateId()) << 16 | 
-                         static_cast<uint64_t>(triple.getObjectId());
-    
-    std::lock_guard<std::mutex> lock(newFactsMutex);
-    newFactsInCurrentIteration.insert(tripleHash);
+void DatalogEngine::mergeProfile(const JoinScratch& scratch) {
+    std::lock_guard<std::mutex> lock(profileMutex);
+    for (size_t r = 0; r < profiles.size() && r < scratch.profiles.size(); ++r) {
+        profiles[r].merge(scratch.profiles[r]);
+    }
 }
 
-void DatalogEngine::switchToNextIteration() {
-    std::lock_guard<std::mutex> lock(newFactsMutex);
-    newFactsInPreviousIteration = std::move(newFactsInCurrentIteration);
-    newFactsInCurrentIteration.clear();
+void DatalogEngine::printProfile(std::ostream& os, ReportFormat format) const {
+    ::printProfile(os, profiles, format);
 }
 
-// 新增：替换变量并返回ID
-uint32_t DatalogEngine::substituteVariableToId(const std::string& term, const std::map<std::string, std::string>& bindings) const {
-    std::string value = substituteVariable(term, bindings);
-    return getIdFromString(value);
+std::string DatalogEngine::termName(const CompiledRule& rule, const JoinTerm& term) const {
+    if (term.isVar) {
+        return term.value < rule.varNames.size() ? rule.varNames[term.value] : "?" + std::to_string(term.value);
+    }
+    return store.getStringPool().getString(term.value);
 }
 
-bool DatalogEngine::checkConflictingTriples(
-    const std::map<std::string, std::string>& bindings,
-    const std::map<std::string, std::vector<std::pair<int, int>>>& varPositions,
-    const Rule& rule
-) const {
-    // 遍历bindings中的变量
-    for (const auto& [var, value] : bindings) {
-        if (varPositions.find(var) == varPositions.end()) {
-            continue; // 如果变量不在varPositions中，跳过
+void DatalogEngine::explain(std::ostream& os, ReportFormat format) {
+    if (fullPlans.size() != compiledRules.size()) {
+        buildPlans();
+    }
+    const bool json = format == ReportFormat::Json;
+    if (json) {
+        os << "[";
+    }
+    for (size_t r = 0; r < compiledRules.size(); ++r) {
+        const CompiledRule& rule = compiledRules[r];
+        auto name = [&](const JoinTerm& term) { return termName(rule, term); };
+        std::string title = !rules[r].name.empty() ? rules[r].name : "#" + std::to_string(r);
+        if (json) {
+            os << (r ? "," : "") << "\n  {\"rule\": \"" << jsonEscape(title) << "\", \"full\": ";
+            ::printPlan(os, fullPlans[r], name, format);
+            os << ", \"triggers\": [";
+            for (size_t i = 0; i < triggerPlans[r].size(); ++i) {
+                os << (i ? ", " : "");
+                ::printPlan(os, triggerPlans[r][i], name, format);
+            }
+            os << "]}";
+            continue;
         }
-
-        const auto& positions = varPositions.at(var);
-        std::map<int, std::set<int>> idxToPos;
-
-        // 构建idx到pos的映射
-        for (const auto& [idx, pos] : positions) {
-            idxToPos[idx].insert(pos);
+        os << "rule " << title << ": (" << rules[r].head.subject << ' ' << rules[r].head.predicate << ' '
+           << rules[r].head.object << ") :-";
+        for (const auto& atom : rules[r].body) {
+            os << " (" << atom.subject << ' ' << atom.predicate << ' ' << atom.object << ")";
         }
-
-        // 检查是否同时存在(idx, 0)和(idx, 2)
-        for (const auto& [idx, posSet] : idxToPos) {
-            if (posSet.count(0) && posSet.count(2)) {
-                // 构造实际的三元组
-                const Triple& pattern = rule.body[idx];
-                std::string subject = substituteVariable(pattern.subject(), bindings);
-                std::string predicate = substituteVariable(pattern.predicate(), bindings);
-                std::string object = substituteVariable(pattern.object(), bindings);
-
-                Triple actualTriple(subject, predicate, object);
-
-                // 检查三元组是否存在于事实库中
-                if (store.getNodeByTriple(actualTriple) != nullptr) {
-                    return false;
-                }
-            }
+        os << "\n  full\n";
+        ::printPlan(os, fullPlans[r], name, format);
+        for (size_t i = 0; i < triggerPlans[r].size(); ++i) {
+            os << "  trigger body[" << i << "]\n";
+            ::printPlan(os, triggerPlans[r][i], name, format);
         }
     }
+    if (json) {
+        os << "\n]\n";
+    }
+}
 
-    // 检查规则体中是否有只含常量不含变量的三元组模式
-    for (const auto& triple : rule.body) {
-        if (!isVariable(triple.subject()) && !isVariable(triple.predicate()) && !isVariable(triple.object())) {
-            // 构造实际的三元组
-            Triple actualTriple(triple.subject(), triple.predicate(), triple.object());
-
-            // 检查三元组是否存在于事实库中
-            if (store.getNodeByTriple(actualTriple) != nullptr) {
+bool DatalogEngine::bindTrigger(const JoinAtom& pattern, const Triple& triple, std::vector<uint32_t>& bindings) {
+    const uint32_t ids[3] = { triple.getSubjectId(), triple.getPredicateId(), triple.getObjectId() };
+    for (int pos = 0; pos < 3; ++pos) {
+        const JoinTerm& term = pattern.terms[pos];
+        if (!term.isVar) {
+            if (term.value != ids[pos]) {
                 return false;
             }
+        } else if (bindings[term.value] == UNBOUND_ID) {
+            bindings[term.value] = ids[pos];
+        } else if (bindings[term.value] != ids[pos]) {
+            return false;  // 同一变量出现多次，如 ?x p ?x
         }
     }
-
     return true;
 }
 
-// 优化的存在性检查方法，使用Triple ID哈希缓存
-bool DatalogEngine::tripleExists(const Triple& triple) {
-    // 计算Triple ID的哈希值作为缓存key
-    uint64_t key = static_cast<uint64_t>(triple.getSubjectId()) << 32 | 
-                   static_cast<uint64_t>(triple.getPredicateId()) << 16 | 
-                   static_cast<uint64_t>(triple.getObjectId());
-    
-    bool exists;
-    if (tripleExistenceCache.get(key, exists)) {
-        return exists;
-    }
-    
-    // 直接查询数据库
-    exists = (store.getNodeByTriple(triple) != nullptr);
-    tripleExistenceCache.put(key, exists);
-    
-    return exists;
+// 去重集合判定为新事实后才写入事实库，重复事实不获取任何锁
+bool DatalogEngine::insertIfNew(const Triple& triple) {
+    if (!knownTriples.insert(triple.getSubjectId(), triple.getPredicateId(), triple.getObjectId())) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(storeMutex);
+    store.addTriple(triple, DERIVED_FACT);
+    return true;
 }
 
 // 批处理方法（已移除以确保推理正确性）
 // void DatalogEngine::processBatch(std::vector<Triple>& batch) {
 //     ... 已移除
 // }
-
-
-// 分片锁相关方法
-size_t DatalogEngine::getShardIndex(const std::string& predicate) const {
-    std::hash<std::string> hasher;
-    return hasher(predicate) % SHARD_COUNT;
-}
-
-std::mutex& DatalogEngine::getShardMutex(const std::string& predicate) {
-    size_t index = getShardIndex(predicate);
-    return shardMutexes[index];
-}
-
-// 对象池相关方法
-std::vector<Triple>* DatalogEngine::getTripleVector() {
-    std::lock_guard<std::mutex> lock(poolMutex);
-    if (!tripleVectorPool.empty()) {
-        std::vector<Triple>* vec = tripleVectorPool.back();
-        tripleVectorPool.pop_back();
-        vec->clear();
-        return vec;
-    }
-    return new std::vector<Triple>();
-}
-
-void DatalogEngine::returnTripleVector(std::vector<Triple>* vec) {
-    if (vec) {
-        std::lock_guard<std::mutex> lock(poolMutex);
-        if (tripleVectorPool.size() < 50) {
-            vec->clear();
-            tripleVectorPool.push_back(vec);
-        } else {
-            delete vec;
-        }
-    }
-}
-
-std::map<std::string, std::string>* DatalogEngine::getBindingMap() {
-    std::lock_guard<std::mutex> lock(poolMutex);
-    if (!bindingMapPool.empty()) {
-        std::map<std::string, std::string>* map = bindingMapPool.back();
-        bindingMapPool.pop_back();
-        map->clear();
-        return map;
-    }
-    return new std::map<std::string, std::string>();
-}
-
-void DatalogEngine::returnBindingMap(std::map<std::string, std::string>* map) {
-    if (map) {
-        std::lock_guard<std::mutex> lock(poolMutex);
-        if (bindingMapPool.size() < 50) {
-            map->clear();
-            bindingMapPool.push_back(map);
-        } else {
-            delete map;
-        }
-    }
-}
@@ -7,130 +7,141 @@
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
-#include <list>
-#include <array>
 #include <mutex>
+#include <queue>
+#include <atomic>
 
 #include "TripleStore.h"
-#include "BloomFilter.h"
-
-// 线程安全的LRU缓存实现
-template<typename Key, typename Value>
-class LRUCache {
-private:
-    size_t capacity;
-    std::unordered_map<Key, std::pair<Value, typename std::list<Key>::iterator>> cache;
-    std::list<Key> lru_list;
-    mutable std::mutex cache_mutex;
-    
-public:
-    LRUCache(size_t cap) : capacity(cap) {}
-    
-    bool get(const Key& key, Value& value) {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = cache.find(key);
-        if (it != cache.end()) {
-            // 移动到列表前端
-            lru_list.erase(it->second.second);
-            lru_list.push_front(key);
-            it->second.second = lru_list.begin();
-            value = it->second.first;
-            return true;
-        }
-        return false;
-    }
-    
-    void put(const Key& key, const Value& value) {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = cache.find(key);
-        if (it != cache.end()) {
-            // 更新现有条目
-            it->second.first = value;
-            lru_list.erase(it->second.second);
-            lru_list.push_front(key);
-            it->second.second = lru_list.begin();
-        } else {
-            // 添加新条目
-            if (cache.size() >= capacity) {
-                // 删除最老的条目
-                Key oldest = lru_list.back();
-                lru_list.pop_back();
-                cache.erase(oldest);
-            }
-            lru_list.push_front(key);
-            cache[key] = {value, lru_list.begin()};
-        }
-    }
-    
-    // 添加获取缓存统计信息的方法
-    size_t size() const {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        return cache.size();
-    }
-    
-    void clear() {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        cache.clear();
-        lru_list.clear();
-    }
-};
+#include "TrieJoin.h"
+#include "ConcurrentTripleSet.h"
+#include "ReasonProfile.h"
 
 class DatalogEngine {
 private:
     TripleStore& store;
     std::vector<Rule> rules;
     std::map<uint32_t, std::vector<std::pair<size_t, size_t>>> rulesMap; // 谓语ID -> [规则下标, 规则体中谓语下标]
+    std::vector<std::pair<size_t, size_t>> wildcardRules;                // 谓语为变量的模式：[规则下标, 规则体下标]
+
+    // 规则的编译形式（规则IR）：常量在编译时解析为字符串池ID，变量映射为槽位
+    // 推理过程中只操作ID，规则头实例化即按槽位取三个ID
+    struct CompiledRule {
+        std::vector<JoinAtom> body;
+        JoinAtom head;
+        size_t varCount = 0;
+        bool valid = true;  // 规则头中的变量是否都出现在规则体中
+        bool virtualHead = false;  // 规则头谓语为虚谓语，其事实由注册的索引回答，规则不执行
+        std::vector<std::string> varNames;  // 槽位 -> 变量名，仅用于输出计划
+    };
+    std::vector<CompiledRule> compiledRules;
+
+    // 连接计划，依赖事实库的统计信息，在每次推理开始时生成
+    std::vector<JoinPlan> fullPlans;                  // 规则下标 -> 无触发三元组的全量计划
+    std::vector<std::vector<JoinPlan>> triggerPlans;  // 规则下标 -> 规则体下标 -> 以该模式为触发的计划
+    std::vector<JoinPlan> rederivePlans;              // 规则下标 -> 规则头变量预绑定、只检查存在性的计划
     
-    // 优化的存在性缓存：使用Triple ID的哈希作为key
-    LRUCache<uint64_t, bool> tripleExistenceCache;
-    
-    // 字符串到ID的缓存，避免频繁查询字符串池
-    mutable std::unordered_map<std::string, uint32_t> stringToIdCache;
-    mutable std::mutex cacheAccessMutex;
-    
-    // 增量推理相关
-    std::unordered_set<uint64_t> processedTriples;  // 已处理的三元组哈希值
-    std::mutex processedMutex;
-    
-    // Semi-Naive评估相关
-    std::unordered_set<uint64_t> newFactsInCurrentIteration;  // 当前迭代的新事实
-    std::unordered_set<uint64_t> newFactsInPreviousIteration; // 上一迭代的新事实  
-    mutable std::mutex newFactsMutex;
+    // 已知三元组集合：推理开始时装入事实库中的三元组，新事实只有插入成功才写入事实库并入队
+    // 取代原先的 LRU 存在性缓存、已处理三元组集合和 Trie 查找
+    ConcurrentTripleSet knownTriples;
+
+    // 事实库写入锁：只有确认为新的事实才需要获取
+    std::mutex storeMutex;
     
     // 批处理相关（已移除批处理逻辑以确保推理正确性）
     // static const size_t BATCH_SIZE = 100;
     // std::vector<Triple> batchBuffer;
     
-    // 分片锁相关
-    static const size_t SHARD_COUNT = 24;
-    std::array<std::mutex, SHARD_COUNT> shardMutexes;
-    
-    // 对象池相关
-    std::vector<std::vector<Triple>*> tripleVectorPool;
-    std::vector<std::map<std::string, std::string>*> bindingMapPool;
-    std::mutex poolMutex;
+    // 每个推理线程的工作区：连接迭代器栈、绑定数组和事实缓冲，每次连接前清空复用而不释放
+    // 取代原先按次申请的绑定数组与结果向量，稳定后连接内循环不再分配堆内存
+    struct JoinScratch {
+        JoinStack stack;
+        std::vector<uint32_t> bindings;
+        std::vector<Triple> inferred;   // 连接产生的规则头实例
+        std::vector<Triple> fresh;      // 其中通过去重、需要入队的新事实
+        size_t allocations = 0;         // bindings/inferred/fresh 的扩容次数
+        std::vector<RuleProfile> profiles;  // 本线程的剖析计数，线程结束时合并
+
+        explicit JoinScratch(const std::vector<CompiledRule>& rules) : profiles(rules.size()) {
+            for (size_t r = 0; r < rules.size(); ++r) {
+                profiles[r].atoms.resize(rules[r].body.size());
+            }
+        }
+
+        void resetBindings(size_t varCount) {
+            if (bindings.capacity() < varCount) {
+                allocations++;
+            }
+            bindings.assign(varCount, UNBOUND_ID);
+        }
+
+        template<typename T>
+        void push(std::vector<T>& buffer, const T& value) {
+            if (buffer.size() == buffer.capacity()) {
+                allocations++;
+            }
+            buffer.push_back(value);
+        }
+
+        size_t getAllocationCount() const { return allocations + stack.getAllocationCount(); }
+    };
+
+    // 所有线程工作区的扩容次数与连接次数，用于确认内循环没有堆分配
+    std::atomic<uint64_t> scratchAllocations{0};
+    std::atomic<uint64_t> joinRuns{0};
+
+    // 剖析结果：各线程的计数在线程结束时合并到这里
+    std::vector<RuleProfile> profiles;
+    std::mutex profileMutex;
+    bool timingEnabled = true;  // 是否为每次连接计时
+
+    // reason() 完成后为 true，此后事实库保持物化状态，可以增量维护
+    bool materialized = false;
 
+public:
+    // 增量维护的统计
+    struct MaintenanceStats {
+        size_t baseChanged = 0;   // 实际插入或删除的基础事实数
+        size_t derived = 0;       // 插入时新推导出的事实数
+        size_t overDeleted = 0;   // 删除时过度删除的事实数（含被删除的基础事实）
+        size_t rederived = 0;     // 过度删除后由其余事实重新推导恢复的事实数
+    };
+
+private:
+    MaintenanceStats maintenance;
 
 public:
-    DatalogEngine(TripleStore& store, const std::vector<Rule>& rules) : store(store), rules(rules), tripleExistenceCache(100000) {
+    DatalogEngine(TripleStore& store, const std::vector<Rule>& rules) : store(store), rules(rules) {
+        compileRules();
         initiateRulesMap();
-        
-        // 预分配对象池
-        tripleVectorPool.reserve(50);
-        bindingMapPool.reserve(50);
-        for (int i = 0; i < 20; ++i) {
-            tripleVectorPool.push_back(new std::vector<Triple>());
-            bindingMapPool.push_back(new std::map<std::string, std::string>());
-        }
-    }
-    
-    ~DatalogEngine() {
-        // 清理对象池
-        for (auto* vec : tripleVectorPool) delete vec;
-        for (auto* map : bindingMapPool) delete map;
     }
+
     void reason();
 
+    // 增量维护：在 reason() 物化后的事实库上批量插入/删除基础事实，开销与受影响的事实数成正比
+    // 插入：新事实半朴素地传播；删除：Delete-and-Rederive（先过度删除依赖被删事实的推导事实，再恢复仍可推导的）
+    // 尚未物化时，插入后做一次完整推理，删除只移除基础事实
+    void insertBase(const std::vector<Triple>& triples);
+    void deleteBase(const std::vector<Triple>& triples);
+    MaintenanceStats getMaintenanceStats() const { return maintenance; }
+
+    // 去重统计：inserts 为写入事实库的新事实数，duplicates 为被拒绝的重复事实数
+    ConcurrentTripleSet::Stats getDedupStats() const { return knownTriples.getStats(); }
+
+    // 上一次推理中连接工作区的扩容次数与连接次数
+    uint64_t getScratchAllocationCount() const { return scratchAllocations.load(); }
+    uint64_t getJoinRunCount() const { return joinRuns.load(); }
+
+    // 上一次推理的分规则剖析结果，规则顺序与构造时一致
+    const std::vector<RuleProfile>& getProfile() const { return profiles; }
+    void printProfile(std::ostream& os, ReportFormat format = ReportFormat::Table) const;
+
+    // 关闭后不再读取时钟，wall/cpu 时间记为 0，其余计数不受影响
+    void setTimingEnabled(bool enabled) { timingEnabled = enabled; }
+
+    // 输出每条规则的连接计划（EXPLAIN）：全量计划与各触发模式的计划
+    // 计划依赖事实库统计，推理前调用时按当前事实库生成
+    void explain(std::ostream& os, ReportFormat format = ReportFormat::Table);
+
 private:
     // std::vector<Triple> applyRule(const Rule& rule);
     // bool matchTriple(const Triple& triple, const Triple& pattern, std::map<std::string, std::string>& variableBindings);
@@ -139,66 +150,48 @@ private:
     // std::string getElem(const Triple& triple, int i);
 
     void initiateRulesMap();
+    void compileRules();
+    void buildPlans();
 
-    void leapfrogTriejoin(TrieNode *psoRoot, TrieNode *posRoot, const Rule &rule,
-                            std::vector<Triple> &newFacts,
-                            std::map<std::string, std::string> &bindings);
+    // 执行规则的连接，每组完整绑定实例化一次规则头，追加到 scratch.inferred
+    // triggerAtom 为 -1 时使用全量计划，否则使用以该模式为触发的计划，scratch.bindings 中预绑定变量需已赋值
+    void leapfrogTriejoin(size_t ruleIdx, int triggerAtom, JoinScratch& scratch);
 
-    void join_by_variable(TrieNode *psoRoot, TrieNode *posRoot, const Rule &rule,
-                          const std::set<std::string> &variables,
-                          const std::map<std::string, std::vector<std::pair<int, int>>> &varPositions,
-                          std::map<std::string, std::string> &bindings, int varIdx, std::vector<Triple> &newFacts);
+    // 从队列中的新事实出发用工作线程推理，直到不再产生新事实
+    void propagate(std::queue<Triple>& newFactQueue, std::atomic<int>& reasonCount);
 
-    static std::string substituteVariable(const std::string &term, const std::map<std::string, std::string> &bindings);
-    
-    // 新增：Join顺序优化相关
-    struct VariableSelectivity {
-        std::string variable;
-        size_t candidateCount;
-        double selectivity;
-        
-        bool operator<(const VariableSelectivity& other) const {
-            return selectivity < other.selectivity;  // 选择性高的变量优先
+    // 事实能否由某条规则从当前事实库推出（DRed 的重新推导）
+    bool derivable(const Triple& triple, JoinScratch& scratch);
+
+    // 把线程的剖析计数合并到 profiles
+    void mergeProfile(const JoinScratch& scratch);
+
+    // 计划中项的可读名称：变量取规则中的变量名，常量取字符串池中的字符串
+    std::string termName(const CompiledRule& rule, const JoinTerm& term) const;
+
+    // 对谓语为 predicate 的新事实可以触发的每个模式调用 f(规则下标, 规则体下标)，含谓语为变量的模式
+    template<typename F>
+    void forEachTrigger(uint32_t predicate, F&& f) const {
+        auto it = rulesMap.find(predicate);
+        if (it != rulesMap.end()) {
+            for (const auto& rulePair : it->second) {
+                f(rulePair.first, rulePair.second);
+            }
         }
-    };
-    
-    // 计算变量的选择性
-    std::vector<VariableSelectivity> computeVariableSelectivity(
-        const Rule& rule,
-        const std::set<std::string>& variables,
-        const std::map<std::string, std::vector<std::pair<int, int>>>& varPositions,
-        const std::map<std::string, std::string>& bindings
-    ) const;
-    
-    // 新增：获取ID的辅助函数
-    uint32_t getIdFromString(const std::string& str) const;
-    uint32_t substituteVariableToId(const std::string& term, const std::map<std::string, std::string>& bindings) const;
-    
-    // Semi-Naive评估相关方法
-    bool isTripleNewInCurrentIteration(const Triple& triple) const;
-    void markTripleAsNewInCurrentIteration(const Triple& triple);
-    void switchToNextIteration();
-
-    bool checkConflictingTriples(const std::map<std::string, std::string>& bindings,
-                                    const std::map<std::string, std::vector<std::pair<int, int>>>& varPositions,
-                                    const Rule& rule) const;
+        for (const auto& rulePair : wildcardRules) {
+            f(rulePair.first, rulePair.second);
+        }
+    }
+
+    // 用触发三元组绑定模式中的变量，常量或重复变量不一致时返回false
+    static bool bindTrigger(const JoinAtom& pattern, const Triple& triple, std::vector<uint32_t>& bindings);
     
-    // 优化的存在性检查方法
-    bool tripleExists(const Triple& triple);
+    // 事实不存在时写入事实库并返回true，可并发调用
+    bool insertIfNew(const Triple& triple);
     
     // 批处理方法（已移除）
     // void processBatch(std::vector<Triple>& batch);
     
-    // 分片锁相关方法
-    size_t getShardIndex(const std::string& predicate) const;
-    std::mutex& getShardMutex(const std::string& predicate);
-    
-    // 对象池相关方法
-    std::vector<Triple>* getTripleVector();
-    void returnTripleVector(std::vector<Triple>* vec);
-    std::map<std::string, std::string>* getBindingMap();
-    void returnBindingMap(std::map<std::string, std::string>* map);
-
 
     /*
     void leapfrogTriejoin(TrieNode* trieRoot, const Rule& rule, std::vector<Triple>& newFacts);
@@ -0,0 +1,244 @@
+#include <iostream>
+#include <unordered_set>
+#include "EqualityReasoner.h"
+#include "SchemaReasoner.h"
+
+namespace {
+
+const std::string OWL_SAME_AS = "http://www.w3.org/2002/07/owl#sameAs";
+
+bool isVariable(const std::string& term) {
+    return !term.empty() && term[0] == '?';
+}
+
+// 等价规则的标准写法
+std::vector<Rule> equalityRulePatterns() {
+    return {
+        Rule("", {{"?x", OWL_SAME_AS, "?y"}}, {"?y", OWL_SAME_AS, "?x"}),                             // eq-sym
+        Rule("", {{"?x", OWL_SAME_AS, "?y"}, {"?y", OWL_SAME_AS, "?z"}}, {"?x", OWL_SAME_AS, "?z"}),  // eq-trans
+        Rule("", {{"?s", OWL_SAME_AS, "?s2"}, {"?s", "?p", "?o"}}, {"?s2", "?p", "?o"}),             // eq-rep-s
+        Rule("", {{"?p", OWL_SAME_AS, "?p2"}, {"?s", "?p", "?o"}}, {"?s", "?p2", "?o"}),             // eq-rep-p
+        Rule("", {{"?o", OWL_SAME_AS, "?o2"}, {"?s", "?p", "?o"}}, {"?s", "?p", "?o2"}),             // eq-rep-o
+    };
+}
+
+}
+
+bool EquivalenceClasses::unite(uint32_t a, uint32_t b, std::vector<uint32_t>& demoted) {
+    uint32_t ra = find(a);
+    uint32_t rb = find(b);
+    if (ra == rb) {
+        return false;
+    }
+    // 单元素类在第一次合并时才建立成员表，代表元总在成员表首位
+    for (uint32_t rep : {ra, rb}) {
+        if (classes.find(rep) == classes.end()) {
+            classes[rep] = {rep};
+            representative[rep] = rep;
+        }
+    }
+    std::vector<uint32_t>& ca = classes[ra];
+    std::vector<uint32_t>& cb = classes[rb];
+    // 较大的类保留代表元（同样大时取较小的ID），每个实体改指代表元的次数不超过 log n
+    bool keepA = ca.size() > cb.size() || (ca.size() == cb.size() && ra < rb);
+    uint32_t keep = keepA ? ra : rb;
+    uint32_t drop = keepA ? rb : ra;
+    std::vector<uint32_t>& kept = keepA ? ca : cb;
+    for (uint32_t member : classes[drop]) {
+        representative[member] = keep;
+        kept.push_back(member);
+    }
+    classes.erase(drop);
+    demoted.push_back(drop);
+    return true;
+}
+
+EqualityReasoner::EqualityReasoner(TripleStore& store) : store(store), engine(store) {}
+
+size_t EqualityReasoner::canonicalize() {
+    const uint32_t sameAs = store.getStringPool().getIdIfExists(OWL_SAME_AS);
+    if (sameAs == UINT32_MAX) {
+        return 0;
+    }
+    auto it = store.getTriePSORoot()->children.find(sameAs);
+    if (it == store.getTriePSORoot()->children.end()) {
+        return 0;
+    }
+    // 规范化后的 sameAs 事实主宾相同，只有新写入的事实会引起合并；先收集再修改事实库
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    for (const auto& subject : it->second->children) {
+        for (const auto& object : subject.second->children) {
+            if (subject.first != object.first) {
+                edges.emplace_back(subject.first, object.first);
+            }
+        }
+    }
+    std::vector<uint32_t> demoted;
+    size_t merges = 0;
+    for (const auto& edge : edges) {
+        merges += classes.unite(edge.first, edge.second, demoted);
+    }
+    if (demoted.empty()) {
+        return 0;
+    }
+
+    // 之前被合并的实体已不在事实库中，只有本轮失去代表元身份的实体需要改写
+    std::unordered_set<uint32_t> indices;
+    for (uint32_t id : demoted) {
+        for (const auto& list : {store.queryTripleIdsBySubjectId(id), store.queryTripleIdsByPredicateId(id),
+                                 store.queryTripleIdsByObjectId(id)}) {
+            indices.insert(list.begin(), list.end());
+        }
+    }
+    std::vector<std::pair<Triple, uint8_t>> affected;
+    affected.reserve(indices.size());
+    for (uint32_t index : indices) {
+        affected.emplace_back(store.getTripleById(index), store.getTripleFlags(index));
+    }
+    for (const auto& entry : affected) {
+        const Triple& triple = entry.first;
+        store.removeTriple(triple);
+        store.addTriple(Triple(classes.find(triple.getSubjectId()), classes.find(triple.getPredicateId()),
+                               classes.find(triple.getObjectId())), entry.second);
+    }
+    stats.merges += merges;
+    stats.rewritten += affected.size();
+    return merges;
+}
+
+std::string EqualityReasoner::canonicalTerm(const std::string& term) const {
+    if (isVariable(term)) {
+        return term;
+    }
+    const StringPool& pool = store.getStringPool();
+    uint32_t id = pool.getIdIfExists(term);
+    if (id == UINT32_MAX || classes.find(id) == id) {
+        return term;
+    }
+    return pool.getString(classes.find(id));
+}
+
+std::vector<Rule> EqualityReasoner::canonicalRules(const std::vector<Rule>& rules) const {
+    std::vector<Rule> result;
+    result.reserve(rules.size());
+    auto canonicalAtom = [this](const Atom& atom) {
+        return Atom{canonicalTerm(atom.subject), canonicalTerm(atom.predicate), canonicalTerm(atom.object)};
+    };
+    for (const auto& rule : rules) {
+        std::vector<Atom> body;
+        for (const auto& atom : rule.body) {
+            body.push_back(canonicalAtom(atom));
+        }
+        result.emplace_back(rule.name, body, canonicalAtom(rule.head));
+    }
+    return result;
+}
+
+void EqualityReasoner::reason(const std::vector<Rule>& rules) {
+    std::vector<Rule> remaining;
+    size_t builtin = recognizeEqualityRules(rules, remaining);
+    std::cout << "Built-in equality rules:          " << builtin << " of " << rules.size() << std::endl;
+
+    canonicalize();
+    // 推理可能推导出新的 sameAs（如函数属性），合并后改写的事实可能触发新的推导
+    while (!remaining.empty()) {
+        stats.rounds++;
+        reasonWithSchema(store, canonicalRules(remaining));
+        size_t merged = canonicalize();
+        std::cout << "Equality classes merged:          " << merged << std::endl;
+        if (merged == 0) {
+            break;
+        }
+    }
+    std::cout << "Equality classes:                 " << classes.getClassCount() << " ("
+              << classes.getMemberCount() << " entities)" << std::endl;
+}
+
+QueryResult EqualityReasoner::query(const BGPQuery& query, const RowCallback& onRow) {
+    BGPQuery canonical;
+    for (const auto& pattern : query.patterns) {
+        canonical.patterns.push_back({canonicalTerm(pattern.subject), canonicalTerm(pattern.predicate),
+                                      canonicalTerm(pattern.object)});
+    }
+    canonical.select = query.select;
+    canonical.distinct = query.distinct;
+    canonical.limit = query.limit == 0 ? 0 : SIZE_MAX;  // 展开后行数增多，LIMIT 在展开时判断
+    // 不去重时每组绑定都是一行，未输出的变量也要展开以保留重复行，附加在输出列之后
+    if (!query.distinct && !query.select.empty()) {
+        std::unordered_set<std::string> listed(query.select.begin(), query.select.end());
+        for (const auto& pattern : query.patterns) {
+            for (const std::string* term : {&pattern.subject, &pattern.predicate, &pattern.object}) {
+                if (isVariable(*term) && listed.insert(*term).second) {
+                    canonical.select.push_back(*term);
+                }
+            }
+        }
+    }
+
+    size_t rows = 0;
+    size_t width = query.select.size();
+    std::vector<const std::vector<uint32_t>*> choices;
+    std::vector<size_t> position;
+    std::vector<uint32_t> expanded;
+    std::vector<uint32_t> output;
+    QueryResult result = engine.execute(canonical, [&](const std::vector<uint32_t>& row) {
+        const size_t columns = row.size();
+        const size_t outputWidth = width == 0 ? columns : width;
+        choices.resize(columns);
+        position.assign(columns, 0);
+        for (size_t i = 0; i < columns; ++i) {
+            choices[i] = classes.members(row[i]);
+        }
+        expanded = row;  // 每个代表元位于其成员表首位，初始组合即原结果行
+        while (true) {
+            output.assign(expanded.begin(), expanded.begin() + outputWidth);
+            rows++;
+            if (!onRow(output) || rows >= query.limit) {
+                return false;
+            }
+            // 按里程表顺序枚举各列成员的组合，全部回到首位即枚举完毕
+            bool advanced = false;
+            for (size_t i = columns; i-- > 0 && !advanced;) {
+                if (choices[i] == nullptr) {
+                    continue;
+                }
+                if (++position[i] < choices[i]->size()) {
+                    advanced = true;
+                } else {
+                    position[i] = 0;
+                }
+                expanded[i] = (*choices[i])[position[i]];
+            }
+            if (!advanced) {
+                return true;
+            }
+        }
+    });
+    if (result.ok) {
+        if (width > 0) {
+            result.columns.resize(width);
+        }
+        result.rows = rows;
+    }
+    return result;
+}
+
+size_t recognizeEqualityRules(const std::vector<Rule>& rules, std::vector<Rule>& remaining) {
+    const auto patterns = equalityRulePatterns();
+    size_t recognized = 0;
+    for (const auto& rule : rules) {
+        bool builtin = false;
+        for (const auto& pattern : patterns) {
+            if (sameRule(rule, pattern)) {
+                builtin = true;
+                break;
+            }
+        }
+        if (builtin) {
+            recognized++;
+        } else {
+            remaining.push_back(rule);
+        }
+    }
+    return recognized;
+}
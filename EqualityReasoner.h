@@ -0,0 +1,87 @@
+#ifndef RDFPANDA_STORAGE_EQUALITYREASONER_H
+#define RDFPANDA_STORAGE_EQUALITYREASONER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Trie.h"
+#include "TripleStore.h"
+#include "QueryEngine.h"
+
+// owl:sameAs 的等价类：带成员表的并查集
+// 合并时把较小类的成员并入较大类并直接改指代表元，find 为 O(1)，总代价 O(n log n)
+// 只记录出现在 sameAs 中的实体，其余实体自成一类，不占空间
+class EquivalenceClasses {
+public:
+    uint32_t find(uint32_t id) const {
+        auto it = representative.find(id);
+        return it != representative.end() ? it->second : id;
+    }
+
+    // 合并两个实体所在的类，返回是否原本不在同一类；被并入一侧的原代表元追加到 demoted
+    bool unite(uint32_t a, uint32_t b, std::vector<uint32_t>& demoted);
+
+    // 代表元所在类的全部成员，单元素类返回空
+    const std::vector<uint32_t>* members(uint32_t rep) const {
+        auto it = classes.find(rep);
+        return it != classes.end() ? &it->second : nullptr;
+    }
+
+    size_t getClassCount() const { return classes.size(); }     // 多于一个成员的类
+    size_t getMemberCount() const { return representative.size(); }  // 这些类的成员总数
+
+private:
+    std::unordered_map<uint32_t, uint32_t> representative;         // 实体 -> 代表元
+    std::unordered_map<uint32_t, std::vector<uint32_t>> classes;  // 代表元 -> 成员（含自身）
+};
+
+// 等价模式：owl:sameAs 按 OWL-RL 的等价语义（eq-sym / eq-trans / eq-rep-s / eq-rep-p / eq-rep-o）处理，
+// 但不物化这些规则的结果
+// - 事实库只保存规范化的事实：每个实体替换为其等价类的代表元，sameAs 事实改写为 代表元 sameAs 代表元
+// - 推理时规则中的常量同样替换为代表元；推理产生新的 sameAs 时合并等价类、改写受影响的事实，再推理到不动点
+// - 查询时把结果中的每个代表元展开为类中的全部成员，结果与用等价规则全量物化后查询一致
+// 规范化的事实库中事实数与等价类数成正比；直接在其上用 QueryEngine 查询只得到代表元
+// 推理会删除、改写事实库中的事实，不支持 DatalogEngine 的增量维护
+class EqualityReasoner {
+public:
+    struct Stats {
+        size_t rounds = 0;     // 推理的轮数
+        size_t merges = 0;     // 合并等价类的次数
+        size_t rewritten = 0;  // 因实体被合并而改写的事实数
+    };
+
+    explicit EqualityReasoner(TripleStore& store);
+
+    // 读取事实库中的 sameAs 事实合并等价类，并把涉及被合并实体的事实改写为代表元形式，返回新合并的次数
+    size_t canonicalize();
+
+    // 推理入口：去掉规则集中的等价规则，其余规则（含内置 RDFS/OWL 规则，见 reasonWithSchema）在规范化的事实库上推理，
+    // 每轮结束后重新规范化，直到不再合并
+    void reason(const std::vector<Rule>& rules);
+
+    // 在规范化的事实库上执行查询，模式中的常量先替换为代表元，结果行按等价类展开
+    // 未输出变量的等价类同样计入重复行（DISTINCT 除外），与全量物化后的查询结果一致
+    QueryResult query(const BGPQuery& query, const RowCallback& onRow);
+
+    // 规则中的常量替换为代表元
+    std::vector<Rule> canonicalRules(const std::vector<Rule>& rules) const;
+
+    const EquivalenceClasses& getClasses() const { return classes; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    TripleStore& store;
+    EquivalenceClasses classes;
+    Stats stats;
+    QueryEngine engine;
+
+    std::string canonicalTerm(const std::string& term) const;
+};
+
+// 在规则集中识别等价规则（eq-sym / eq-trans / eq-rep-s / eq-rep-p / eq-rep-o），返回识别出的条数，其余规则追加到 remaining
+size_t recognizeEqualityRules(const std::vector<Rule>& rules, std::vector<Rule>& remaining);
+
+
+#endif //RDFPANDA_STORAGE_EQUALITYREASONER_H
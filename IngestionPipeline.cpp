@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "IngestionPipeline.h"
+#include "BoundedQueue.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double rate(size_t count, double seconds) {
+    return seconds > 0 ? count / seconds : 0.0;
+}
+
+}
+
+void IngestionStats::print(std::ostream& out) const {
+    out << "Triples parsed:                   " << parsed << " (" << stored << " new, " << batches << " batches)"
+        << std::endl;
+    out << "Parse stage:                      " << parseSeconds << " s, " << rate(parsed, parseSeconds)
+        << " triples/s, " << parserThreads << " threads, blocked " << blockedSeconds << " s" << std::endl;
+    out << "Index stage:                      " << indexSeconds << " s busy, " << rate(parsed, indexSeconds)
+        << " triples/s, idle " << idleSeconds << " s" << std::endl;
+    out << "Total:                            " << wallSeconds << " s, " << rate(parsed, wallSeconds)
+        << " triples/s" << std::endl;
+}
+
+IngestionPipeline::IngestionPipeline(TripleStore& store, size_t queueCapacity, size_t batchSize)
+        : store(store), queueCapacity(queueCapacity), batchSize(batchSize) {
+    parser.setStringPool(&store.getStringPool());
+}
+
+IngestionStats IngestionPipeline::loadNTriples(const std::string& filename, size_t parserThreads) {
+    if (parserThreads == 0) {
+        parserThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    return run(parserThreads, [&](const InputParser::BatchCallback& onBatch) {
+        return parser.parseNTriplesBatches(filename, onBatch, parserThreads, batchSize);
+    });
+}
+
+IngestionStats IngestionPipeline::loadTurtle(const std::string& filename) {
+    return run(1, [&](const InputParser::BatchCallback& onBatch) {
+        return parser.parseTurtleBatches(filename, onBatch, batchSize);
+    });
+}
+
+IngestionStats IngestionPipeline::loadCSV(const std::string& filename, const CsvOptions& options,
+                                         size_t parserThreads) {
+    if (parserThreads == 0) {
+        parserThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    return run(parserThreads, [&](const InputParser::BatchCallback& onBatch) {
+        return parser.parseCSVBatches(filename, onBatch, options, parserThreads, batchSize);
+    });
+}
+
+IngestionStats IngestionPipeline::run(size_t parserThreads, const Producer& produce) {
+    IngestionStats stats;
+    stats.parserThreads = parserThreads;
+    BoundedQueue<std::vector<Triple>> queue(queueCapacity);
+    const Clock::time_point start = Clock::now();
+
+    // 建索引阶段：唯一写事实库的线程
+    std::thread indexer([&]() {
+        std::vector<Triple> batch;
+        while (true) {
+            Clock::time_point waitStart = Clock::now();
+            bool received = queue.pop(batch);
+            stats.idleSeconds += secondsSince(waitStart);
+            if (!received) {
+                break;
+            }
+            Clock::time_point workStart = Clock::now();
+            for (const auto& triple : batch) {
+                stats.stored += store.addTriple(triple);
+            }
+            stats.indexSeconds += secondsSince(workStart);
+            stats.batches++;
+        }
+    });
+
+    // 解析阶段：回调可能在多个解析线程中并发调用
+    std::atomic<int64_t> blockedNanos{0};
+    stats.parsed = produce([&](std::vector<Triple>& batch) {
+        Clock::time_point pushStart = Clock::now();
+        queue.push(std::move(batch));
+        blockedNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - pushStart).count();
+    });
+    stats.parseSeconds = secondsSince(start);
+    stats.blockedSeconds = blockedNanos / 1e9;
+
+    queue.close();
+    indexer.join();
+    stats.wallSeconds = secondsSince(start);
+    return stats;
+}
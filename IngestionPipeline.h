@@ -0,0 +1,55 @@
+#ifndef RDFPANDA_STORAGE_INGESTIONPIPELINE_H
+#define RDFPANDA_STORAGE_INGESTIONPIPELINE_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "InputParser.h"
+#include "TripleStore.h"
+
+// 一次导入各阶段的统计，时间单位为秒
+struct IngestionStats {
+    size_t parsed = 0;           // 解析出的三元组数
+    size_t stored = 0;           // 新写入事实库的三元组数（去重后）
+    size_t batches = 0;
+    size_t parserThreads = 0;
+    double wallSeconds = 0;
+    double parseSeconds = 0;     // 解析阶段从开始到最后一批入队
+    double blockedSeconds = 0;   // 解析线程因队列已满而等待的累计时间（背压）
+    double indexSeconds = 0;     // 建索引阶段处理批的累计时间
+    double idleSeconds = 0;      // 建索引阶段等待队列的累计时间
+
+    void print(std::ostream& out) const;
+};
+
+// IngestionPipeline：解析与建索引流水线化的导入
+// 解析线程把固定大小的ID三元组批放入有界队列，建索引线程同时取出写入事实库；队列满时解析线程阻塞等待，
+// 内存中最多只有 queueCapacity 个批，不再先生成完整的 std::vector<Triple> 再逐个 addTriple
+// 解析直接使用事实库的字符串池；事实库本身只由建索引线程写入
+class IngestionPipeline {
+public:
+    IngestionPipeline(TripleStore& store, size_t queueCapacity = 8, size_t batchSize = 65536);
+
+    // parserThreads 为 0 时使用硬件线程数
+    IngestionStats loadNTriples(const std::string& filename, size_t parserThreads = 0);
+    IngestionStats loadTurtle(const std::string& filename);
+    IngestionStats loadCSV(const std::string& filename, const CsvOptions& options = CsvOptions(),
+                           size_t parserThreads = 0);
+
+    const std::vector<ParseError>& getParseErrors() const { return parser.getParseErrors(); }
+
+private:
+    using Producer = std::function<size_t(const InputParser::BatchCallback&)>;
+
+    TripleStore& store;
+    InputParser parser;
+    size_t queueCapacity;
+    size_t batchSize;
+
+    IngestionStats run(size_t parserThreads, const Producer& produce);
+};
+
+
+#endif //RDFPANDA_STORAGE_INGESTIONPIPELINE_H
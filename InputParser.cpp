@@ -9,246 +9,1102 @@
 #include <mutex>
 #include <queue>
 #include <atomic>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <charconv>
+#include <unordered_map>
 
 #include "DatabaseConfig.h"
+#include "MappedFile.h"
+#include "BoundedQueue.h"
+#include "CompressedInput.h"
 
-std::vector<Triple> InputParser::parseNTriples(const std::string& filename) {
+namespace {
+
+// 并行解析 N-Triples 时每块的大致字节数，块数远多于线程数，行长不均时由动态调度平衡负载
+constexpr size_t NTRIPLES_CHUNK_SIZE = 4 << 20;
+constexpr size_t CSV_CHUNK_SIZE = 4 << 20;
+// 映射 SQL 结果时每批交给映射线程的行数
+constexpr size_t SQL_ROW_BATCH = 4096;
+// 并行读取 SQLite 表时每个 rowid 区间的大致行数
+constexpr size_t SQLITE_RANGE_ROWS = 65536;
+// 按主语排序读取时每个区间用于估计分界的采样行数
+constexpr size_t SQLITE_SORT_SAMPLES = 64;
+
+// 按块的顺序汇总各块的结果并立即释放，先完成的后续块只暂存到前面的块完成为止；add 可被多个线程并发调用
+class OrderedCollector {
+public:
+    void add(size_t chunk, std::vector<Triple>& chunkTriples) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.emplace(chunk, std::move(chunkTriples));
+        for (auto it = pending.begin(); it != pending.end() && it->first == committed; it = pending.erase(it)) {
+            triples.insert(triples.end(), it->second.begin(), it->second.end());
+            committed++;
+        }
+    }
+
+    std::vector<Triple> take() { return std::move(triples); }
+
+private:
+    std::mutex mutex;
+    size_t committed = 0;
+    std::map<size_t, std::vector<Triple>> pending;
     std::vector<Triple> triples;
-    std::ifstream file(filename);
-    // std::cout << "Parsing file: " << filename << std::endl;
-    std::string line;
-    std::regex tripleRegex(R"(<([^>]+)> <([^>]+)> (\"[^\"]*\"|<[^>]+>|_:.*) \.)");
-    // 主语： <uri>
-    // 谓语： <uri>
-    // 宾语： <uri> 或 "literal" 或 _:blankNode
+};
 
-    while (std::getline(file, line)) {
-        // std::cout << line << std::endl;
-        std::smatch match;
-        if (std::regex_match(line, match, tripleRegex)) {
-            std::string subject = match[1].str();
-            std::string predicate = match[2].str();
-            std::string object = match[3].str();
-            triples.emplace_back(subject, predicate, object);
+// SQL 结果的一批行：各行各列的值依次存放在 text 中，cells 记录每个值的 (起点, 长度)，长度为 SIZE_MAX 表示 NULL
+struct RowBatch {
+    size_t index = 0;
+    std::string text;
+    std::vector<std::pair<size_t, size_t>> cells;
+
+    void add(const char* value, size_t length) {
+        if (value == nullptr) {
+            cells.emplace_back(0, SIZE_MAX);
+        } else {
+            cells.emplace_back(text.size(), length);
+            text.append(value, length);
         }
     }
+};
 
-    return triples;
+// 调用线程用 fetch 逐批读取结果行（fetch 返回 false 表示没有更多的行），numThreads 个线程并行按映射生成三元组，
+// 结果按批的顺序汇总
+std::vector<Triple> mapRowBatches(const RowMapper& mapper, size_t columns, size_t numThreads,
+                                  const std::function<bool(RowBatch&)>& fetch) {
+    OrderedCollector collector;
+    BoundedQueue<RowBatch> batches(numThreads * 2);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&]() {
+            RowBatch batch;
+            std::vector<std::string_view> row(columns);
+            std::vector<Triple> triples;
+            std::string scratch;
+            while (batches.pop(batch)) {
+                for (size_t cell = 0; cell + columns <= batch.cells.size(); cell += columns) {
+                    for (size_t c = 0; c < columns; ++c) {
+                        const auto& value = batch.cells[cell + c];
+                        row[c] = value.second == SIZE_MAX ? std::string_view()
+                                                          : std::string_view(batch.text.data() + value.first, value.second);
+                    }
+                    mapper.map(row, triples, scratch);
+                }
+                collector.add(batch.index, triples);
+                triples.clear();
+            }
+        });
+    }
+    size_t index = 0;
+    bool more = true;
+    while (more) {
+        RowBatch batch;
+        batch.index = index++;
+        more = fetch(batch);
+        batches.push(std::move(batch));
+    }
+    batches.close();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return collector.take();
 }
 
-std::vector<Triple> InputParser::parseTurtle(const std::string& filename) {
-    std::vector<Triple> triples;
-    std::ifstream file(filename);
-    std::string line;
+// 执行返回少量行的查询（表的元数据等），各行各列的值存入 rows，NULL 为空串
+bool queryRows(MYSQL* conn, const std::string& query, std::vector<std::vector<std::string>>& rows, std::string& error) {
+    if (mysql_query(conn, query.c_str()) != 0) {
+        error = std::string("mysql_query() failed: ") + mysql_error(conn);
+        return false;
+    }
+    MYSQL_RES* res = mysql_store_result(conn);
+    if (res == nullptr) {
+        error = std::string("mysql_store_result() failed: ") + mysql_error(conn);
+        return false;
+    }
+    const unsigned int columnCount = mysql_num_fields(res);
+    MYSQL_ROW row;
+    while ((row = mysql_fetch_row(res))) {
+        rows.emplace_back();
+        for (unsigned int i = 0; i < columnCount; ++i) {
+            rows.back().emplace_back(row[i] ? row[i] : "");
+        }
+    }
+    mysql_free_result(res);
+    return true;
+}
 
-    // 正则表达式匹配三元组和前缀声明
-    std::regex tripleRegex(R"((<[^>]+>|_:.*|[^:]+:[^ ]+)\s+(<[^>]+>|[^:]+:[^ ]+)\s+(\"[^\"]*\"|<[^>]+>|_:.*|[^:]+:[^ ]+)\s*\.)");
-    std::regex prefixRegex(R"(@prefix\s+([^:]+):\s+<([^>]+)>\s*\.)");
+// 表的主键只有一列时返回 true 并给出列名
+bool primaryKeyColumn(MYSQL* conn, const std::string& tableName, std::string& column) {
+    std::vector<std::vector<std::string>> rows;
+    std::string error;
+    // SHOW KEYS 结果的第 5 列为 Column_name
+    if (!queryRows(conn, "SHOW KEYS FROM " + tableName + " WHERE Key_name = 'PRIMARY'", rows, error) ||
+        rows.size() != 1 || rows[0].size() < 5) {
+        return false;
+    }
+    column = rows[0][4];
+    return true;
+}
 
-    // 全局前缀映射表
-    std::map<std::string, std::string> prefixMap;
+// 取得整数键的最小值和最大值；表为空或键不是整数时返回 false
+bool keyRange(MYSQL* conn, const std::string& tableName, const std::string& key, int64_t& low, int64_t& high) {
+    std::vector<std::vector<std::string>> rows;
+    std::string error;
+    if (!queryRows(conn, "SELECT MIN(`" + key + "`), MAX(`" + key + "`) FROM " + tableName, rows, error) ||
+        rows.size() != 1 || rows[0].size() != 2) {
+        return false;
+    }
+    int64_t* bounds[2] = {&low, &high};
+    for (int i = 0; i < 2; ++i) {
+        const std::string& text = rows[0][i];
+        char* end = nullptr;
+        errno = 0;
+        *bounds[i] = std::strtoll(text.c_str(), &end, 10);
+        if (text.empty() || *end != '\0' || errno != 0) {
+            return false;
+        }
+    }
+    return low <= high;
+}
 
-    // 第一步：预处理前缀声明
-    while (std::getline(file, line)) {
-        line = std::regex_replace(line, std::regex(R"(^\s+|\s+$)"), "");
-        if (line.empty() || line[0] == '#') {
+// 执行 subject, predicate, object 三列的查询，用 mysql_use_result 逐行从服务器读取（不在客户端缓存结果集），
+// 各项直接写入字符串池得到 ID；含 NULL 的行被跳过
+bool streamTriples(MYSQL* conn, const std::string& query, StringPool& pool, std::vector<Triple>& triples,
+                   std::string& error) {
+    if (mysql_query(conn, query.c_str()) != 0) {
+        error = std::string("mysql_query() failed: ") + mysql_error(conn);
+        return false;
+    }
+    MYSQL_RES* res = mysql_use_result(conn);
+    if (res == nullptr) {
+        error = std::string("mysql_use_result() failed: ") + mysql_error(conn);
+        return false;
+    }
+    MYSQL_ROW row;
+    while ((row = mysql_fetch_row(res))) {
+        if (row[0] == nullptr || row[1] == nullptr || row[2] == nullptr) {
             continue;
         }
+        unsigned long* lengths = mysql_fetch_lengths(res);
+        triples.emplace_back(pool.getId(std::string_view(row[0], lengths[0])),
+                             pool.getId(std::string_view(row[1], lengths[1])),
+                             pool.getId(std::string_view(row[2], lengths[2])));
+    }
+    bool ok = mysql_errno(conn) == 0;
+    if (!ok) {
+        error = std::string("mysql_fetch_row() failed: ") + mysql_error(conn);
+    }
+    mysql_free_result(res);
+    return ok;
+}
 
-        std::smatch prefixMatch;
-        if (std::regex_match(line, prefixMatch, prefixRegex)) {
-            std::string prefixName = prefixMatch[1].str();
-            std::string prefixUri = prefixMatch[2].str();
-            prefixMap[prefixName] = prefixUri;
+// 只读打开 SQLite 数据库；每个线程使用自己的连接（SQLITE_OPEN_NOMUTEX），多个只读连接可同时持有共享锁并发读取
+sqlite3* openSQLiteReader(const std::string& dbPath) {
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+        std::cerr << "Unable to open database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return nullptr;
+    }
+    return db;
+}
+
+// 逐行读取 subject, predicate, object 三列的结果，sqlite3_column_text 的内容直接写入字符串池得到 ID；含 NULL 的行被跳过
+bool stepTriples(sqlite3* db, sqlite3_stmt* stmt, StringPool& pool, std::vector<Triple>& triples) {
+    int status;
+    while ((status = sqlite3_step(stmt)) == SQLITE_ROW) {
+        uint32_t ids[3];
+        bool complete = true;
+        for (int i = 0; i < 3 && complete; ++i) {
+            const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+            if (text == nullptr) {
+                complete = false;
+            } else {
+                ids[i] = pool.getId(std::string_view(text, sqlite3_column_bytes(stmt, i)));
+            }
         }
+        if (complete) {
+            triples.emplace_back(ids[0], ids[1], ids[2]);
+        }
+    }
+    if (status != SQLITE_DONE) {
+        std::cerr << "Failed to read rows: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 外部整数键到字符串池 ID 的转换表：读完字典后 build()，键基本连续时用数组直接下标，否则用哈希表
+class ExternalIdMap {
+public:
+    void add(int64_t key, uint32_t id) { entries.emplace_back(key, id); }
 
-        // 当匹配到三元组时说明已经读到数据部分，停止读取前缀声明
-        std::smatch tripleMatch;
-        if (std::regex_match(line, tripleMatch, tripleRegex)) {
-            break;
+    void build() {
+        if (entries.empty()) {
+            return;
         }
+        auto bounds = std::minmax_element(entries.begin(), entries.end());
+        low = bounds.first->first;
+        const uint64_t span = static_cast<uint64_t>(bounds.second->first) - static_cast<uint64_t>(low);
+        if (span < entries.size() * 4 + 1024) {
+            dense.assign(span + 1, UINT32_MAX);
+            for (const auto& entry : entries) {
+                dense[static_cast<uint64_t>(entry.first) - static_cast<uint64_t>(low)] = entry.second;
+            }
+        } else {
+            sparse.reserve(entries.size());
+            for (const auto& entry : entries) {
+                sparse[entry.first] = entry.second;
+            }
+        }
+        std::vector<std::pair<int64_t, uint32_t>>().swap(entries);
     }
 
-    // 重置文件流
-    file.clear();
-    file.seekg(0, std::ios::beg);
+    // 不在字典中的键返回 UINT32_MAX
+    uint32_t find(int64_t key) const {
+        if (!dense.empty()) {
+            const uint64_t offset = static_cast<uint64_t>(key) - static_cast<uint64_t>(low);
+            return offset < dense.size() ? dense[offset] : UINT32_MAX;
+        }
+        auto it = sparse.find(key);
+        return it != sparse.end() ? it->second : UINT32_MAX;
+    }
 
-    // 第二步：多线程处理三元组
-    std::vector<std::string> lines;
-    while (std::getline(file, line)) {
-        lines.push_back(line);
+private:
+    std::vector<std::pair<int64_t, uint32_t>> entries;
+    int64_t low = 0;
+    std::vector<uint32_t> dense;
+    std::unordered_map<int64_t, uint32_t> sparse;
+};
+
+bool parseInt64(const char* text, size_t length, int64_t& value) {
+    auto result = std::from_chars(text, text + length, value);
+    return result.ec == std::errc() && result.ptr == text + length;
+}
+
+// 按字典把一行事实的三个键转为三元组，有键不在字典中时返回 false
+bool addEncodedTriple(const ExternalIdMap& ids, const int64_t (&keys)[3], std::vector<Triple>& triples) {
+    uint32_t subject = ids.find(keys[0]);
+    uint32_t predicate = ids.find(keys[1]);
+    uint32_t object = ids.find(keys[2]);
+    if (subject == UINT32_MAX || predicate == UINT32_MAX || object == UINT32_MAX) {
+        return false;
     }
+    triples.emplace_back(subject, predicate, object);
+    return true;
+}
 
-    const size_t numThreads = std::thread::hardware_concurrency();
-    size_t chunkSize = lines.size() / numThreads;
-    std::vector<std::vector<Triple>> threadResults(numThreads);
-    std::mutex resultMutex;
+}
 
-    auto parseChunk = [&](size_t start, size_t end, size_t threadIndex) {
-        // std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
-        std::vector<Triple> localTriples;
-        const char* ws = " \t\n\r";
+StringPool& InputParser::activeStringPool() const {
+    StringPool* pool = string_pool ? string_pool : Triple::getStringPool();
+    if (pool == nullptr) {
+        throw std::runtime_error("StringPool not initialized. Call Triple::setStringPool() first.");
+    }
+    return *pool;
+}
 
-        for (size_t i = start; i < end; ++i) {
-            std::string line = lines[i];
-            // line = std::regex_replace(line, std::regex(R"(^\s+|\s+$)"), "");
-            // 去除行首尾空白字符
-            line.erase(0, line.find_first_not_of(ws));
-            line.erase(line.find_last_not_of(ws) + 1);
+MySQLConnectionPool& InputParser::mysqlPool(const std::string& schemaName, size_t connections) {
+    if (!mysql_pool || mysql_pool->getSchemaName() != schemaName) {
+        mysql_pool = std::make_unique<MySQLConnectionPool>(schemaName, connections);
+    } else {
+        mysql_pool->growTo(connections);
+    }
+    return *mysql_pool;
+}
 
-            if (line.empty() || line[0] == '#' || std::regex_match(line, prefixRegex)) {
-                continue;
+void InputParser::reportParseErrors(const std::string& filename, const std::vector<ParseError>& errors) {
+    parse_errors = errors;
+    for (const auto& error : parse_errors) {
+        std::cerr << filename << ":" << error.line << ":" << error.column << ": " << error.message << std::endl;
+    }
+}
+
+bool InputParser::parseNTriplesChunks(const std::string& filename, size_t numThreads, size_t batchSize,
+                                      const ChunkCallback& onTriples) {
+    parse_errors.clear();
+    MappedFile file(filename);
+    if (!file.isOpen()) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return false;
+    }
+    StringPool& pool = activeStringPool();
+    if (numThreads == 0) {
+        numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    struct ChunkErrors {
+        std::vector<ParseError> errors;
+        size_t lines = 0;
+    };
+    std::vector<ChunkErrors> chunkErrors;
+    std::mutex errorsMutex;
+
+    auto parseChunk = [&](size_t index, const char* data, size_t size, std::vector<Triple>& triples) {
+        NTriplesTokenizer tokenizer(data, size);
+        TermTriple terms;
+        // 导出的数据通常按主语分组，连续相同的主语不必再查字符串池
+        std::string_view lastSubject;
+        uint32_t lastSubjectId = UINT32_MAX;
+        while (tokenizer.next(terms)) {
+            if (lastSubjectId == UINT32_MAX || terms.subject != lastSubject) {
+                lastSubject = terms.subject;
+                lastSubjectId = pool.getId(terms.subject);
+            }
+            triples.emplace_back(lastSubjectId, pool.getId(terms.predicate), pool.getId(terms.object));
+            if (triples.size() >= batchSize) {
+                onTriples(index, triples);
+                triples.clear();
             }
+        }
+        // 块结束时总会回调一次（可能为空），调用方据此得知该块已完成
+        onTriples(index, triples);
+        triples.clear();
+        std::lock_guard<std::mutex> lock(errorsMutex);
+        if (chunkErrors.size() <= index) {
+            chunkErrors.resize(index + 1);
+        }
+        chunkErrors[index] = {tokenizer.getErrors(), tokenizer.getLine() - 1};
+    };
 
-            std::smatch tripleMatch;
-            if (std::regex_match(line, tripleMatch, tripleRegex)) {
-                auto expandPrefix = [&prefixMap](const std::string& term) -> std::string {
-                    size_t colonPos = term.find(':');
-                    if (colonPos != std::string::npos) {
-                        std::string prefix = term.substr(0, colonPos);
-                        if (prefixMap.find(prefix) != prefixMap.end()) {
-                            return prefixMap[prefix] + term.substr(colonPos + 1);
-                        }
-                    }
-                    return term;
-                };
+    const Compression compression = detectCompression(file.data(), file.size());
+    std::string decompressError;
+    if (compression == Compression::None) {
+        // 按字节切块，块尾延伸到下一个换行符之后；N-Triples 每行一条语句，各块可以独立解析
+        const char* data = file.data();
+        const size_t size = file.size();
+        std::vector<size_t> bounds = {0};
+        while (bounds.back() < size) {
+            size_t next = bounds.back() + NTRIPLES_CHUNK_SIZE;
+            if (next >= size) {
+                next = size;
+            } else {
+                const void* newline = std::memchr(data + next, '\n', size - next);
+                next = newline ? static_cast<const char*>(newline) - data + 1 : size;
+            }
+            bounds.push_back(next);
+        }
+        const size_t chunkCount = bounds.size() - 1;
+        std::atomic<size_t> nextChunk{0};
+        auto worker = [&]() {
+            std::vector<Triple> triples;
+            size_t index;
+            while ((index = nextChunk.fetch_add(1)) < chunkCount) {
+                parseChunk(index, data + bounds[index], bounds[index + 1] - bounds[index], triples);
+            }
+        };
 
-                std::string subject = expandPrefix(tripleMatch[1].str());
-                std::string predicate = expandPrefix(tripleMatch[2].str());
-                std::string object = expandPrefix(tripleMatch[3].str());
-                localTriples.emplace_back(subject, predicate, object);
+        numThreads = std::min(numThreads, chunkCount);
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < numThreads; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    } else {
+        // 压缩文件：调用线程边解压边按行切块，块经有界队列交给解析线程，不落盘也不保留整个解压结果
+        BoundedQueue<std::pair<size_t, std::string>> chunks(numThreads * 2);
+        auto worker = [&]() {
+            std::vector<Triple> triples;
+            std::pair<size_t, std::string> chunk;
+            while (chunks.pop(chunk)) {
+                parseChunk(chunk.first, chunk.second.data(), chunk.second.size(), triples);
             }
+        };
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < numThreads; ++i) {
+            threads.emplace_back(worker);
+        }
 
+        std::string pending;
+        size_t chunkCount = 0;
+        decompressBlocks(file.data(), file.size(), compression, numThreads, [&](const char* data, size_t size) {
+            pending.append(data, size);
+            if (pending.size() >= NTRIPLES_CHUNK_SIZE) {
+                size_t cut = pending.rfind('\n');
+                if (cut != std::string::npos) {
+                    std::string rest = pending.substr(cut + 1);
+                    pending.resize(cut + 1);
+                    chunks.push({chunkCount++, std::move(pending)});
+                    pending = std::move(rest);
+                }
+            }
+        }, decompressError);
+        if (!pending.empty()) {
+            chunks.push({chunkCount++, std::move(pending)});
         }
+        chunks.close();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
 
-        std::lock_guard<std::mutex> lock(resultMutex);
-        threadResults[threadIndex] = std::move(localTriples);
+    // 块内行号加上之前各块的行数
+    std::vector<ParseError> errors;
+    size_t linesBefore = 0;
+    for (auto& chunk : chunkErrors) {
+        for (auto& error : chunk.errors) {
+            error.line += linesBefore;
+            errors.push_back(std::move(error));
+        }
+        linesBefore += chunk.lines;
+    }
+    if (!decompressError.empty()) {
+        errors.push_back({linesBefore + 1, 1, decompressError});
+    }
+    reportParseErrors(filename, errors);
+    return true;
+}
 
-//        std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
-//        std::chrono::duration<double> elapsedTime = endTime - startTime;
-//        std::cout << "Thread " << threadIndex << " processed " << (end - start) << " lines in " << elapsedTime.count() << " seconds." << std::endl;
-    };
+std::vector<Triple> InputParser::parseNTriples(const std::string& filename, size_t numThreads) {
+    OrderedCollector collector;
+    parseNTriplesChunks(filename, numThreads, SIZE_MAX, [&](size_t chunk, std::vector<Triple>& chunkTriples) {
+        collector.add(chunk, chunkTriples);
+    });
+    return collector.take();
+}
 
-    std::vector<std::thread> threads;
-    for (size_t i = 0; i < numThreads; ++i) {
-        size_t start = i * chunkSize;
-        size_t end = (i == numThreads - 1) ? lines.size() : start + chunkSize;
-        threads.emplace_back(parseChunk, start, end, i);
+size_t InputParser::parseNTriplesBatches(const std::string& filename, const BatchCallback& onBatch,
+                                         size_t numThreads, size_t batchSize) {
+    std::atomic<size_t> total{0};
+    parseNTriplesChunks(filename, numThreads, batchSize, [&](size_t, std::vector<Triple>& batch) {
+        if (!batch.empty()) {
+            total += batch.size();
+            onBatch(batch);
+        }
+    });
+    return total;
+}
+
+size_t InputParser::parseTurtleBatches(const std::string& filename, const BatchCallback& onBatch, size_t batchSize) {
+    parse_errors.clear();
+    DecompressedStream file(filename);
+    if (!file.isOpen()) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return 0;
     }
+    TurtleParser parser(file, activeStringPool(), batchSize);
+    std::vector<Triple> batch;
+    size_t total = 0;
+    while (parser.nextBatch(batch)) {
+        total += batch.size();
+        onBatch(batch);
+    }
+    std::vector<ParseError> errors = parser.getErrors();
+    if (!file.getError().empty()) {
+        errors.push_back({parser.getLine(), 1, file.getError()});
+    }
+    reportParseErrors(filename, errors);
+    return total;
+}
 
-    for (auto& thread : threads) {
-        thread.join();
+std::vector<Triple> InputParser::parseTurtle(const std::string& filename) {
+    std::vector<Triple> triples;
+    parseTurtleBatches(filename, [&triples](std::vector<Triple>& batch) {
+        triples.insert(triples.end(), batch.begin(), batch.end());
+    });
+    return triples;
+}
+
+bool InputParser::parseCSVRows(const std::string& filename, char delimiter, bool header, size_t numThreads,
+                               size_t batchSize, const RowHandlerFactory& makeHandler, const ChunkCallback& onTriples) {
+    parse_errors.clear();
+    MappedFile file(filename);
+    if (!file.isOpen()) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return false;
     }
+    if (numThreads == 0) {
+        numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    const char* data = file.data();
+    const size_t size = file.size();
+
+    // 按线程数并行执行 task(0..count-1)，调用线程也参与
+    auto parallelFor = [numThreads](size_t count, const std::function<void(size_t)>& task) {
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            size_t index;
+            while ((index = next.fetch_add(1)) < count) {
+                task(index);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < std::min(numThreads, count); ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
 
-    for (const auto& threadResult : threadResults) {
-        triples.insert(triples.end(), threadResult.begin(), threadResult.end());
+    // 先按字节切块并行统计各块的引号个数，由此得知每块开头是否在引号内（"" 计两次，不影响奇偶），
+    // 再把块首移到其后第一个引号外的换行之后，使每块都由完整的记录组成
+    const size_t rawChunks = std::max<size_t>(1, (size + CSV_CHUNK_SIZE - 1) / CSV_CHUNK_SIZE);
+    std::vector<size_t> quotes(rawChunks);
+    parallelFor(rawChunks, [&](size_t i) {
+        size_t begin = i * CSV_CHUNK_SIZE;
+        quotes[i] = CsvScanner::countQuotes(data + begin, std::min(size, begin + CSV_CHUNK_SIZE) - begin);
+    });
+    std::vector<size_t> bounds = {0};
+    bool inQuotes = false;
+    for (size_t i = 1; i < rawChunks; ++i) {
+        inQuotes ^= quotes[i - 1] & 1;
+        size_t begin = i * CSV_CHUNK_SIZE;
+        if (begin < bounds.back()) {
+            continue;  // 上一块的记录跨过了本块的开头（很长的带引号字段）
+        }
+        bounds.push_back(begin + CsvScanner::findRecordStart(data + begin, size - begin, inQuotes));
     }
+    bounds.push_back(size);
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    const size_t chunkCount = bounds.size() - 1;
 
-    return triples;
+    struct ChunkErrors {
+        std::vector<ParseError> errors;
+        size_t lines = 0;
+    };
+    std::vector<ChunkErrors> chunkErrors(chunkCount);
+    parallelFor(chunkCount, [&](size_t index) {
+        CsvScanner scanner(data + bounds[index], bounds[index + 1] - bounds[index], delimiter);
+        RowHandler handleRow = makeHandler();
+        std::vector<ParseError> errors;
+        std::vector<std::string_view> fields;
+        std::vector<Triple> triples;
+        std::string error;
+        bool skipHeader = header && index == 0;
+        while (scanner.next(fields)) {
+            if (skipHeader) {
+                skipHeader = false;
+                continue;
+            }
+            if (!handleRow(fields, triples, error)) {
+                errors.push_back({scanner.getRecordLine(), 1, error});
+                continue;
+            }
+            if (triples.size() >= batchSize) {
+                onTriples(index, triples);
+                triples.clear();
+            }
+        }
+        onTriples(index, triples);
+        // 扫描器的错误与各行的映射错误按行号合并
+        errors.insert(errors.end(), scanner.getErrors().begin(), scanner.getErrors().end());
+        std::stable_sort(errors.begin(), errors.end(), [](const ParseError& a, const ParseError& b) {
+            return a.line < b.line;
+        });
+        chunkErrors[index] = {std::move(errors), scanner.getLine() - 1};
+    });
+
+    std::vector<ParseError> errors;
+    size_t linesBefore = 0;
+    for (auto& chunk : chunkErrors) {
+        for (auto& error : chunk.errors) {
+            error.line += linesBefore;
+            errors.push_back(std::move(error));
+        }
+        linesBefore += chunk.lines;
+    }
+    reportParseErrors(filename, errors);
+    return true;
 }
 
-std::vector<Triple> InputParser::parseCSV(const std::string& filename) {
-    std::vector<Triple> triples;
-    std::ifstream file(filename);
-    std::string line;
+bool InputParser::parseCSVChunks(const std::string& filename, const CsvOptions& options, size_t numThreads,
+                                 size_t batchSize, const ChunkCallback& onTriples) {
+    if (options.subjectColumn < 0 || options.objectColumn < 0) {
+        parse_errors.clear();
+        std::cerr << "CSV mapping needs subject and object columns" << std::endl;
+        return false;
+    }
+    StringPool& pool = activeStringPool();
+    const size_t fieldsNeeded = static_cast<size_t>(
+            std::max({options.subjectColumn, options.predicateColumn, options.objectColumn})) + 1;
+    const uint32_t constantPredicate = options.predicateColumn < 0 ? pool.getId(options.predicate) : UINT32_MAX;
+    return parseCSVRows(filename, options.delimiter, options.header, numThreads, batchSize, [&]() -> RowHandler {
+        // 同一主语的多行通常相邻，连续相同的主语不必再查字符串池
+        std::string lastSubject;
+        uint32_t lastSubjectId = UINT32_MAX;
+        return [&, lastSubject, lastSubjectId](const std::vector<std::string_view>& fields, std::vector<Triple>& triples,
+                                               std::string& error) mutable {
+            if (fields.size() < fieldsNeeded) {
+                error = "expected at least " + std::to_string(fieldsNeeded) + " fields, found " +
+                        std::to_string(fields.size());
+                return false;
+            }
+            std::string_view subject = fields[options.subjectColumn];
+            if (lastSubjectId == UINT32_MAX || subject != lastSubject) {
+                lastSubject.assign(subject.data(), subject.size());
+                lastSubjectId = pool.getId(subject);
+            }
+            uint32_t predicate = options.predicateColumn < 0 ? constantPredicate
+                                                             : pool.getId(fields[options.predicateColumn]);
+            triples.emplace_back(lastSubjectId, predicate, pool.getId(fields[options.objectColumn]));
+            return true;
+        };
+    }, onTriples);
+}
 
-    while (std::getline(file, line)) {
-        std::istringstream ss(line);
-        std::string subject, predicate, object;
+std::vector<Triple> InputParser::parseCSV(const std::string& filename, const CsvOptions& options, size_t numThreads) {
+    OrderedCollector collector;
+    parseCSVChunks(filename, options, numThreads, SIZE_MAX, [&](size_t chunk, std::vector<Triple>& chunkTriples) {
+        collector.add(chunk, chunkTriples);
+    });
+    return collector.take();
+}
 
-        if (std::getline(ss, subject, ',') &&
-            std::getline(ss, predicate, ',') &&
-            std::getline(ss, object, ',')) {
-            triples.emplace_back(subject, predicate, object);
+size_t InputParser::parseCSVBatches(const std::string& filename, const BatchCallback& onBatch,
+                                    const CsvOptions& options, size_t numThreads, size_t batchSize) {
+    std::atomic<size_t> total{0};
+    parseCSVChunks(filename, options, numThreads, batchSize, [&](size_t, std::vector<Triple>& batch) {
+        if (!batch.empty()) {
+            total += batch.size();
+            onBatch(batch);
+        }
+    });
+    return total;
+}
+
+std::vector<Triple> InputParser::parseMappedCSV(const std::string& filename, const TriplesMap& mapping,
+                                                size_t numThreads, char delimiter) {
+    // 第一条记录是表头，给出列名
+    std::vector<std::string> columns;
+    {
+        MappedFile file(filename);
+        if (!file.isOpen()) {
+            std::cerr << "Failed to open file: " << filename << std::endl;
+            return {};
+        }
+        CsvScanner scanner(file.data(), file.size(), delimiter);
+        std::vector<std::string_view> fields;
+        if (scanner.next(fields)) {
+            columns.assign(fields.begin(), fields.end());
         }
     }
+    std::unique_ptr<RowMapper> mapper;
+    try {
+        mapper.reset(new RowMapper(mapping, columns, activeStringPool()));
+    } catch (const std::exception& e) {
+        std::cerr << filename << ": " << e.what() << std::endl;
+        return {};
+    }
 
-    return triples;
+    OrderedCollector collector;
+    parseCSVRows(filename, delimiter, true, numThreads, SIZE_MAX, [&]() -> RowHandler {
+        std::vector<std::string_view> row;
+        std::string scratch;
+        return [&, row, scratch](const std::vector<std::string_view>& fields, std::vector<Triple>& triples,
+                                 std::string& error) mutable {
+            if (fields.size() != columns.size()) {
+                error = "expected " + std::to_string(columns.size()) + " fields, found " + std::to_string(fields.size());
+                return false;
+            }
+            // CSV 的空字段作为 NULL
+            row.assign(fields.begin(), fields.end());
+            for (auto& value : row) {
+                if (value.empty()) {
+                    value = std::string_view();
+                }
+            }
+            mapper->map(row, triples, scratch);
+            return true;
+        };
+    }, [&](size_t chunk, std::vector<Triple>& chunkTriples) {
+        collector.add(chunk, chunkTriples);
+    });
+    return collector.take();
 }
 
-std::vector<Triple> InputParser::parseMySQLTable(const std::string& schemaName, const std::string& tableName) {
+std::vector<Triple> InputParser::parseMappedSQLiteTable(const std::string& dbName, const TriplesMap& mapping,
+                                                        size_t numThreads) {
     std::vector<Triple> triples;
-    MYSQL* conn;
-    MYSQL_RES* res;
-    MYSQL_ROW row;
-
-    // 初始化 MySQL 连接
-    conn = mysql_init(nullptr);
-    if (conn == nullptr) {
-        std::cerr << "mysql_init() failed" << std::endl;
+    sqlite3* db;
+    sqlite3_stmt* stmt;
+    std::string dbPath = "./SQLiteDb/" + dbName + ".db";
+    if (sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        std::cerr << "Unable to open database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
         return triples;
     }
-
-    // 连接到数据库
-    if (mysql_real_connect(conn, DB_HOST, DB_USER, DB_PASSWORD, schemaName.c_str(), DB_PORT, nullptr, 0) == nullptr) {
-        std::cerr << "mysql_real_connect() failed: " << mysql_error(conn) << std::endl;
-        mysql_close(conn);
+    std::string query = mapping.selectQuery();
+    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
         return triples;
     }
 
-    // 构建查询语句
-    std::string query = "SELECT subject, predicate, object FROM " + tableName;
+    const int columnCount = sqlite3_column_count(stmt);
+    std::vector<std::string> columns;
+    for (int i = 0; i < columnCount; ++i) {
+        columns.emplace_back(sqlite3_column_name(stmt, i));
+    }
+    try {
+        RowMapper mapper(mapping, columns, activeStringPool());
+        if (numThreads == 0) {
+            numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        // 调用线程逐行读取，映射与写入字符串池由映射线程并行完成
+        int status = SQLITE_ROW;
+        triples = mapRowBatches(mapper, columns.size(), numThreads, [&](RowBatch& batch) {
+            for (size_t row = 0; row < SQL_ROW_BATCH; ++row) {
+                if ((status = sqlite3_step(stmt)) != SQLITE_ROW) {
+                    return false;
+                }
+                for (int i = 0; i < columnCount; ++i) {
+                    const char* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+                    batch.add(value, value ? static_cast<size_t>(sqlite3_column_bytes(stmt, i)) : 0);
+                }
+            }
+            return true;
+        });
+        if (status != SQLITE_DONE) {
+            std::cerr << "sqlite3_step() failed: " << sqlite3_errmsg(db) << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << mapping.name << ": " << e.what() << std::endl;
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return triples;
+}
 
-    // 执行查询
+std::vector<Triple> InputParser::parseMappedMySQLTable(const std::string& schemaName, const TriplesMap& mapping,
+                                                       size_t numThreads) {
+    std::vector<Triple> triples;
+    MySQLConnectionPool::Lease lease = mysqlPool(schemaName, 1).acquire();
+    if (!lease) {
+        std::cerr << lease.error() << std::endl;
+        return triples;
+    }
+    MYSQL* conn = lease.get();
+    std::string query = mapping.selectQuery();
     if (mysql_query(conn, query.c_str())) {
         std::cerr << "mysql_query() failed: " << mysql_error(conn) << std::endl;
-        mysql_close(conn);
         return triples;
     }
-
-    // 获取查询结果
-    res = mysql_store_result(conn);
+    // 逐行从服务器读取，不在客户端缓存整个结果集
+    MYSQL_RES* res = mysql_use_result(conn);
     if (res == nullptr) {
-        std::cerr << "mysql_store_result() failed: " << mysql_error(conn) << std::endl;
-        mysql_close(conn);
+        std::cerr << "mysql_use_result() failed: " << mysql_error(conn) << std::endl;
         return triples;
     }
 
-    // 解析结果集
-    while ((row = mysql_fetch_row(res))) {
-        std::string subject = row[0] ? row[0] : "";
-        std::string predicate = row[1] ? row[1] : "";
-        std::string object = row[2] ? row[2] : "";
-        triples.emplace_back(subject, predicate, object);
+    const unsigned int columnCount = mysql_num_fields(res);
+    MYSQL_FIELD* fields = mysql_fetch_fields(res);
+    std::vector<std::string> columns;
+    for (unsigned int i = 0; i < columnCount; ++i) {
+        columns.emplace_back(fields[i].name);
+    }
+    try {
+        RowMapper mapper(mapping, columns, activeStringPool());
+        if (numThreads == 0) {
+            numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        triples = mapRowBatches(mapper, columns.size(), numThreads, [&](RowBatch& batch) {
+            for (size_t row = 0; row < SQL_ROW_BATCH; ++row) {
+                MYSQL_ROW values = mysql_fetch_row(res);
+                if (values == nullptr) {
+                    return false;
+                }
+                unsigned long* lengths = mysql_fetch_lengths(res);
+                for (unsigned int i = 0; i < columnCount; ++i) {
+                    batch.add(values[i], lengths[i]);
+                }
+            }
+            return true;
+        });
+        if (mysql_errno(conn) != 0) {
+            std::cerr << "mysql_fetch_row() failed: " << mysql_error(conn) << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << mapping.name << ": " << e.what() << std::endl;
+    }
+    mysql_free_result(res);
+    return triples;
+}
+
+std::vector<Triple> InputParser::parseMySQLTable(const std::string& schemaName, const std::string& tableName) {
+    std::vector<Triple> triples;
+    MySQLConnectionPool::Lease lease = mysqlPool(schemaName, 1).acquire();
+    if (!lease) {
+        std::cerr << lease.error() << std::endl;
+        return triples;
+    }
+    std::string error;
+    if (!streamTriples(lease.get(), "SELECT subject, predicate, object FROM " + tableName, activeStringPool(),
+                       triples, error)) {
+        std::cerr << error << std::endl;
     }
+    return triples;
+}
 
-    // 释放资源
+std::vector<Triple> InputParser::parseEncodedMySQLTables(const std::string& schemaName, const std::string& factTable,
+                                                         const std::string& dictionaryTable) {
+    std::vector<Triple> triples;
+    MySQLConnectionPool::Lease lease = mysqlPool(schemaName, 1).acquire();
+    if (!lease) {
+        std::cerr << lease.error() << std::endl;
+        return triples;
+    }
+    MYSQL* conn = lease.get();
+    StringPool& pool = activeStringPool();
+    ExternalIdMap ids;
+    // 两张表都用 mysql_use_result 逐行读取；字典中的每个词项只写入字符串池一次
+    std::string query = "SELECT id, lexical FROM " + dictionaryTable;
+    if (mysql_query(conn, query.c_str()) != 0) {
+        std::cerr << "mysql_query() failed: " << mysql_error(conn) << std::endl;
+        return triples;
+    }
+    MYSQL_RES* res = mysql_use_result(conn);
+    if (res == nullptr) {
+        std::cerr << "mysql_use_result() failed: " << mysql_error(conn) << std::endl;
+        return triples;
+    }
+    MYSQL_ROW row;
+    int64_t key;
+    while ((row = mysql_fetch_row(res))) {
+        unsigned long* lengths = mysql_fetch_lengths(res);
+        if (row[0] != nullptr && row[1] != nullptr && parseInt64(row[0], lengths[0], key)) {
+            ids.add(key, pool.getId(std::string_view(row[1], lengths[1])));
+        }
+    }
+    bool failed = mysql_errno(conn) != 0;
     mysql_free_result(res);
-    mysql_close(conn);
+    if (failed) {
+        std::cerr << "mysql_fetch_row() failed: " << mysql_error(conn) << std::endl;
+        return triples;
+    }
+    ids.build();
 
+    query = "SELECT s_id, p_id, o_id FROM " + factTable;
+    if (mysql_query(conn, query.c_str()) != 0) {
+        std::cerr << "mysql_query() failed: " << mysql_error(conn) << std::endl;
+        return triples;
+    }
+    res = mysql_use_result(conn);
+    if (res == nullptr) {
+        std::cerr << "mysql_use_result() failed: " << mysql_error(conn) << std::endl;
+        return triples;
+    }
+    size_t unresolved = 0;
+    while ((row = mysql_fetch_row(res))) {
+        unsigned long* lengths = mysql_fetch_lengths(res);
+        int64_t keys[3];
+        bool complete = true;
+        for (int i = 0; i < 3; ++i) {
+            complete = complete && row[i] != nullptr && parseInt64(row[i], lengths[i], keys[i]);
+        }
+        if (!complete || !addEncodedTriple(ids, keys, triples)) {
+            unresolved++;
+        }
+    }
+    if (mysql_errno(conn) != 0) {
+        std::cerr << "mysql_fetch_row() failed: " << mysql_error(conn) << std::endl;
+    }
+    mysql_free_result(res);
+    if (unresolved > 0) {
+        std::cerr << "Warning: " << unresolved << " rows of " << factTable << " have NULL keys or keys missing from "
+                  << dictionaryTable << std::endl;
+    }
     return triples;
 }
 
-std::vector<Triple> InputParser::parseSQLiteTable(const std::string &dbName, const std::string &tableName) {
+std::vector<Triple> InputParser::parseSQLiteTable(const std::string &dbName, const std::string &tableName,
+                                                  size_t numThreads, bool sorted) {
     std::vector<Triple> triples;
-    sqlite3* db;
-    sqlite3_stmt* stmt;
     std::string dbPath = "./SQLiteDb/" + dbName + ".db";
-    // 打开数据库
-    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK) {
-        std::cerr << "Unable to open database: " << sqlite3_errmsg(db) << std::endl;
+    sqlite3* db = openSQLiteReader(dbPath);
+    if (db == nullptr) {
         return triples;
     }
-    std::string query = "SELECT subject, predicate, object FROM " + tableName;
-    // 准备查询语句
+    StringPool& pool = activeStringPool();
+    if (numThreads == 0) {
+        numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    const std::string query = "SELECT subject, predicate, object FROM " + tableName;
+    const std::string order = sorted ? " ORDER BY subject, predicate, object" : "";
+
+    // rowid 的范围；没有 rowid 的表（WITHOUT ROWID）或空表用一条查询读取
+    sqlite3_int64 low = 0;
+    sqlite3_int64 high = -1;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, ("SELECT MIN(rowid), MAX(rowid) FROM " + tableName).c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) == SQLITE_INTEGER) {
+            low = sqlite3_column_int64(stmt, 0);
+            high = sqlite3_column_int64(stmt, 1);
+        }
+        sqlite3_finalize(stmt);
+    }
+    if (high < low || numThreads == 1) {
+        if (sqlite3_prepare_v2(db, (query + order).c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        } else {
+            stepTriples(db, stmt, pool, triples);
+            sqlite3_finalize(stmt);
+        }
+        sqlite3_close(db);
+        return triples;
+    }
+
+    // 各区间的分界：不排序时按 rowid 均分；排序时按主语的取值划分，使各区间按序拼接即为全局有序，
+    // 分界取自按 rowid 均匀采样的行的主语（每次采样只是一次 rowid 查找）。排序的区间数等于线程数，
+    // subject 上有索引时各区间直接走索引读出有序的行，否则每个区间各自扫描全表后排序
+    const uint64_t span = static_cast<uint64_t>(high) - static_cast<uint64_t>(low);
+    std::vector<sqlite3_int64> rowidBounds;
+    std::vector<std::string> subjectBounds;
+    if (!sorted) {
+        const uint64_t rangeCount = std::min<uint64_t>(span / SQLITE_RANGE_ROWS + 1, numThreads * 16);
+        for (uint64_t i = 1; i < rangeCount; ++i) {
+            rowidBounds.push_back(static_cast<sqlite3_int64>(
+                    static_cast<uint64_t>(low) + i * (span / rangeCount) + std::min(i, span % rangeCount)));
+        }
+    } else if (sqlite3_prepare_v2(db, ("SELECT subject FROM " + tableName + " WHERE rowid >= ?1 ORDER BY rowid LIMIT 1").c_str(),
+                                  -1, &stmt, nullptr) == SQLITE_OK) {
+        const uint64_t samples = numThreads * SQLITE_SORT_SAMPLES;
+        std::vector<std::string> sampled;
+        for (uint64_t i = 0; i < samples; ++i) {
+            sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(
+                    static_cast<uint64_t>(low) + i * (span / samples) + std::min(i, span % samples)));
+            if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) == SQLITE_TEXT) {
+                sampled.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)),
+                                     sqlite3_column_bytes(stmt, 0));
+            }
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+        std::sort(sampled.begin(), sampled.end());
+        for (size_t i = 1; i < numThreads && !sampled.empty(); ++i) {
+            const std::string& bound = sampled[i * sampled.size() / numThreads];
+            if (bound > (subjectBounds.empty() ? sampled.front() : subjectBounds.back())) {
+                subjectBounds.push_back(bound);
+            }
+        }
+    }
+    sqlite3_close(db);
+
+    const size_t rangeCount = (sorted ? subjectBounds.size() : rowidBounds.size()) + 1;
+    const std::string column = sorted ? "subject" : "rowid";
+    auto bindBound = [&](sqlite3_stmt* rangeStmt, int parameter, size_t bound) {
+        if (sorted) {
+            sqlite3_bind_text(rangeStmt, parameter, subjectBounds[bound].data(),
+                              static_cast<int>(subjectBounds[bound].size()), SQLITE_STATIC);
+        } else {
+            sqlite3_bind_int64(rangeStmt, parameter, rowidBounds[bound]);
+        }
+    };
+
+    // 工作线程各用一个只读连接，动态领取区间；第一个区间不设下界、最后一个不设上界，结果按区间的顺序汇总
+    OrderedCollector collector;
+    std::atomic<size_t> nextRange{0};
+    std::atomic<size_t> failed{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < std::min(numThreads, rangeCount); ++t) {
+        threads.emplace_back([&]() {
+            sqlite3* reader = openSQLiteReader(dbPath);
+            if (reader == nullptr) {
+                return;
+            }
+            std::vector<Triple> rangeTriples;
+            for (size_t i = nextRange++; i < rangeCount; i = nextRange++) {
+                std::string rangeQuery = query;
+                if (i > 0) {
+                    rangeQuery += " WHERE " + column + " >= ?1";
+                }
+                if (i + 1 < rangeCount) {
+                    rangeQuery += (i > 0 ? " AND " : " WHERE ") + column + " < ?2";
+                }
+                rangeQuery += order;
+                sqlite3_stmt* rangeStmt;
+                if (sqlite3_prepare_v2(reader, rangeQuery.c_str(), -1, &rangeStmt, nullptr) != SQLITE_OK) {
+                    std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(reader) << std::endl;
+                    failed++;
+                } else {
+                    if (i > 0) {
+                        bindBound(rangeStmt, 1, i - 1);
+                    }
+                    if (i + 1 < rangeCount) {
+                        bindBound(rangeStmt, 2, i);
+                    }
+                    if (!stepTriples(reader, rangeStmt, pool, rangeTriples)) {
+                        rangeTriples.clear();
+                        failed++;
+                    }
+                    sqlite3_finalize(rangeStmt);
+                }
+                collector.add(i, rangeTriples);
+                rangeTriples.clear();
+            }
+            sqlite3_close(reader);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    failed += rangeCount - std::min(nextRange.load(), rangeCount);
+    if (failed > 0) {
+        std::cerr << "Warning: " << failed << " of " << rangeCount << " ranges failed while reading " << tableName
+                  << std::endl;
+    }
+    return collector.take();
+}
+
+std::vector<Triple> InputParser::parseEncodedSQLiteTables(const std::string& dbName, const std::string& factTable,
+                                                          const std::string& dictionaryTable) {
+    std::vector<Triple> triples;
+    sqlite3* db = openSQLiteReader("./SQLiteDb/" + dbName + ".db");
+    if (db == nullptr) {
+        return triples;
+    }
+    StringPool& pool = activeStringPool();
+    ExternalIdMap ids;
+    sqlite3_stmt* stmt;
+    // 字典中的每个词项只写入字符串池一次
+    std::string query = "SELECT id, lexical FROM " + dictionaryTable;
     if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
         std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
         sqlite3_close(db);
         return triples;
     }
-    // 执行查询并解析结果
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        const char* subject = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        const char* predicate = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        const char* object = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        const char* lexical = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        if (sqlite3_column_type(stmt, 0) == SQLITE_INTEGER && lexical != nullptr) {
+            ids.add(sqlite3_column_int64(stmt, 0), pool.getId(std::string_view(lexical, sqlite3_column_bytes(stmt, 1))));
+        }
+    }
+    sqlite3_finalize(stmt);
+    ids.build();
 
-        if (subject && predicate && object) {
-            triples.emplace_back(subject, predicate, object);
+    // 事实表只读整数列，不经过字符串
+    query = "SELECT s_id, p_id, o_id FROM " + factTable;
+    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return triples;
+    }
+    size_t unresolved = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int64_t keys[3];
+        bool complete = true;
+        for (int i = 0; i < 3; ++i) {
+            complete = complete && sqlite3_column_type(stmt, i) == SQLITE_INTEGER;
+            keys[i] = sqlite3_column_int64(stmt, i);
+        }
+        if (!complete || !addEncodedTriple(ids, keys, triples)) {
+            unresolved++;
         }
     }
-    // 释放资源
     sqlite3_finalize(stmt);
     sqlite3_close(db);
+    if (unresolved > 0) {
+        std::cerr << "Warning: " << unresolved << " rows of " << factTable << " have NULL keys or keys missing from "
+                  << dictionaryTable << std::endl;
+    }
     return triples;
 }
 
@@ -260,9 +1116,9 @@ std::vector<Rule> InputParser::parseDatalogFromFile(const std::string &filename)
 
     // 正则表达式匹配 PREFIX 声明
     std::regex prefixRegex(R"(PREFIX\s+([^:]+):\s+<([^>]+)>)");
-    // 正则表达式匹配规则（支持有无前缀的情况）
-    std::regex ruleRegex(R"(([\w:]+\([^)]+\)) :- (.+)\.)");
-    std::regex tripleRegex(R"(([\w:]+)\(([^,]+), ([^)]+)\))");
+    // 正则表达式匹配规则（支持有无前缀的情况，谓语也可以是变量，如 ?P(?X, ?Y)）
+    std::regex ruleRegex(R"((\??[\w:]+\([^)]+\)) :- (.+)\.)");
+    std::regex tripleRegex(R"((\??[\w:]+)\(([^,]+), ([^)]+)\))");
 
     // 前缀映射表
     std::map<std::string, std::string> prefixMap;
@@ -306,23 +1162,23 @@ std::vector<Rule> InputParser::parseDatalogFromFile(const std::string &filename)
             // 解析规则头部
             std::smatch headMatch;
             auto matchResult = std::regex_match(headStr, headMatch, tripleRegex);
-            Triple head(
+            Atom head{
                 headMatch[2].str(),
                 expandPrefix(headMatch[1].str()),
                 headMatch[3].str()
-            );
+            };
 
             // 解析规则体
-            std::vector<Triple> body;
+            std::vector<Atom> body;
             std::sregex_iterator bodyBegin(bodyStr.begin(), bodyStr.end(), tripleRegex);
             std::sregex_iterator bodyEnd;
             for (std::sregex_iterator i = bodyBegin; i != bodyEnd; ++i) {
                 const std::smatch& bodyMatch = *i;
-                body.emplace_back(
+                body.push_back({
                     bodyMatch[2].str(),
                     expandPrefix(bodyMatch[1].str()),
                     bodyMatch[3].str()
-                );
+                });
             }
 
             rules.emplace_back("", body, head);
@@ -332,266 +1188,106 @@ std::vector<Rule> InputParser::parseDatalogFromFile(const std::string &filename)
     return rules;
 }
 
-std::vector<Triple> InputParser::parseMySQLTableParallel(const std::string& schemaName, const std::string& tableName, size_t pageSize) {
-    std::vector<Triple> allTriples;
-    
-    // 首先获取表的总行数
-    MYSQL* countConn = mysql_init(nullptr);
-    if (countConn == nullptr) {
-        std::cerr << "mysql_init() failed for count query" << std::endl;
-        return allTriples;
-    }
-    
-    if (mysql_real_connect(countConn, DB_HOST, DB_USER, DB_PASSWORD, schemaName.c_str(), DB_PORT, nullptr, 0) == nullptr) {
-        std::cerr << "mysql_real_connect() failed for count query: " << mysql_error(countConn) << std::endl;
-        mysql_close(countConn);
-        return allTriples;
-    }
-    
-    // 获取表的总行数
-    std::string countQuery = "SELECT COUNT(*) FROM " + tableName;
-    size_t totalRows = 0;
-    
-    if (mysql_query(countConn, countQuery.c_str()) == 0) {
-        MYSQL_RES* countRes = mysql_store_result(countConn);
-        if (countRes) {
-            MYSQL_ROW countRow = mysql_fetch_row(countRes);
-            if (countRow && countRow[0]) {
-                totalRows = std::stoul(countRow[0]);
-            }
-            mysql_free_result(countRes);
-        }
-    }
-    
-    mysql_close(countConn);
-    
-    if (totalRows == 0) {
-        std::cerr << "No data found in table " << tableName << std::endl;
-        return allTriples;
-    }
-    
-    // 计算分页数量和线程数
-    const size_t numThreads = std::min(static_cast<size_t>(std::thread::hardware_concurrency()), (totalRows + pageSize - 1) / pageSize);
-    const size_t actualPageSize = (totalRows + numThreads - 1) / numThreads;
-    
-    std::vector<std::vector<Triple>> threadResults(numThreads);
-    std::vector<std::thread> threads;
-    std::mutex resultMutex;
-    
-    // 并行处理函数
-    auto processPage = [&](size_t threadIndex, size_t offset, size_t limit) {
-        MYSQL* conn = mysql_init(nullptr);
-        if (conn == nullptr) {
-            std::cerr << "mysql_init() failed for thread " << threadIndex << std::endl;
-            return;
-        }
-        
-        if (mysql_real_connect(conn, DB_HOST, DB_USER, DB_PASSWORD, schemaName.c_str(), DB_PORT, nullptr, 0) == nullptr) {
-            std::cerr << "mysql_real_connect() failed for thread " << threadIndex << ": " << mysql_error(conn) << std::endl;
-            mysql_close(conn);
-            return;
-        }
-        
-        // 构建分页查询
-        std::string query = "SELECT subject, predicate, object FROM " + tableName + 
-                           " LIMIT " + std::to_string(limit) + " OFFSET " + std::to_string(offset);
-        
-        if (mysql_query(conn, query.c_str()) != 0) {
-            std::cerr << "mysql_query() failed for thread " << threadIndex << ": " << mysql_error(conn) << std::endl;
-            mysql_close(conn);
-            return;
-        }
-        
-        MYSQL_RES* res = mysql_store_result(conn);
-        if (res == nullptr) {
-            std::cerr << "mysql_store_result() failed for thread " << threadIndex << ": " << mysql_error(conn) << std::endl;
-            mysql_close(conn);
-            return;
+std::vector<Triple> InputParser::parseMySQLTableKeyset(const std::string& schemaName, const std::string& tableName,
+                                                       size_t pageSize, size_t numThreads, size_t* completedRanges) {
+    std::vector<Triple> triples;
+    MySQLConnectionPool& connections = mysqlPool(schemaName, numThreads);
+    StringPool& pool = activeStringPool();
+    const std::string query = "SELECT subject, predicate, object FROM " + tableName;
+    std::string key;
+    int64_t low = 0;
+    int64_t high = 0;
+    {
+        MySQLConnectionPool::Lease lease = connections.acquire();
+        if (!lease) {
+            std::cerr << lease.error() << std::endl;
+            return triples;
         }
-        
-        std::vector<Triple> localTriples;
-        MYSQL_ROW row;
-        while ((row = mysql_fetch_row(res))) {
-            std::string subject = row[0] ? row[0] : "";
-            std::string predicate = row[1] ? row[1] : "";
-            std::string object = row[2] ? row[2] : "";
-            localTriples.emplace_back(subject, predicate, object);
-        }
-        
-        mysql_free_result(res);
-        mysql_close(conn);
-        
-        // 线程安全地存储结果
-        std::lock_guard<std::mutex> lock(resultMutex);
-        threadResults[threadIndex] = std::move(localTriples);
-    };
-    
-    // 启动工作线程
-    for (size_t i = 0; i < numThreads; ++i) {
-        size_t offset = i * actualPageSize;
-        size_t limit = std::min(actualPageSize, totalRows - offset);
-        
-        if (limit > 0) {
-            threads.emplace_back(processPage, i, offset, limit);
+        // 没有单列的整数主键（或表为空）时无法按键划分，退化为一次流式读取
+        if (!primaryKeyColumn(lease.get(), tableName, key) || !keyRange(lease.get(), tableName, key, low, high)) {
+            std::string error;
+            if (!streamTriples(lease.get(), query, pool, triples, error)) {
+                std::cerr << error << std::endl;
+            }
+            if (completedRanges != nullptr) {
+                *completedRanges = 1;
+            }
+            return triples;
         }
     }
-    
-    // 等待所有线程完成
-    for (auto& thread : threads) {
-        thread.join();
-    }
-    
-    // 合并结果
-    for (const auto& threadResult : threadResults) {
-        allTriples.insert(allTriples.end(), threadResult.begin(), threadResult.end());
-    }
-    
-    return allTriples;
-}
 
-std::vector<Triple> InputParser::parseMySQLTableAdvanced(const std::string& schemaName, const std::string& tableName, 
-                                                       size_t pageSize, size_t maxConnections) {
-    std::vector<Triple> allTriples;
-    
-    // 获取表的总行数
-    MYSQL* countConn = mysql_init(nullptr);
-    if (countConn == nullptr) {
-        std::cerr << "mysql_init() failed for count query" << std::endl;
-        return allTriples;
-    }
-    
-    if (mysql_real_connect(countConn, DB_HOST, DB_USER, DB_PASSWORD, schemaName.c_str(), DB_PORT, nullptr, 0) == nullptr) {
-        std::cerr << "mysql_real_connect() failed for count query: " << mysql_error(countConn) << std::endl;
-        mysql_close(countConn);
-        return allTriples;
-    }
-    
-    std::string countQuery = "SELECT COUNT(*) FROM " + tableName;
-    size_t totalRows = 0;
-    
-    if (mysql_query(countConn, countQuery.c_str()) == 0) {
-        MYSQL_RES* countRes = mysql_store_result(countConn);
-        if (countRes) {
-            MYSQL_ROW countRow = mysql_fetch_row(countRes);
-            if (countRow && countRow[0]) {
-                totalRows = std::stoul(countRow[0]);
+    // 按主键的取值区间划分，每个区间的查询直接走主键索引定位，不像 OFFSET 那样从头扫描；
+    // 区间数多于线程数，由工作线程动态领取，键分布不均时也能平衡负载。第一个区间不设下界、最后一个不设上界
+    const uint64_t span = static_cast<uint64_t>(high) - static_cast<uint64_t>(low);
+    const size_t rangeCount = static_cast<size_t>(
+            std::min<uint64_t>(span / std::max<size_t>(pageSize, 1) + 1, numThreads * 64));
+    const uint64_t quotient = span / rangeCount;
+    const uint64_t remainder = span % rangeCount;
+    auto boundary = [&](size_t i) {
+        return static_cast<int64_t>(static_cast<uint64_t>(low) + i * quotient + std::min<uint64_t>(i, remainder));
+    };
+    const std::string column = "`" + key + "`";
+
+    OrderedCollector collector;
+    std::atomic<size_t> nextRange{0};
+    std::atomic<size_t> completed{0};
+    std::atomic<size_t> failed{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < std::min(numThreads, rangeCount); ++t) {
+        threads.emplace_back([&]() {
+            MySQLConnectionPool::Lease lease = connections.acquire();
+            if (!lease) {
+                std::cerr << lease.error() << std::endl;
+                return;
             }
-            mysql_free_result(countRes);
-        }
-    }
-    mysql_close(countConn);
-    
-    if (totalRows == 0) {
-        return allTriples;
-    }
-    
-    // 计算分页数量
-    const size_t numPages = (totalRows + pageSize - 1) / pageSize;
-    const size_t numThreads = std::min(maxConnections, numPages);
-    
-    // 线程安全的任务队列
-    std::queue<std::pair<size_t, size_t>> taskQueue; // (offset, limit)
-    for (size_t i = 0; i < numPages; ++i) {
-        size_t offset = i * pageSize;
-        size_t limit = std::min(pageSize, totalRows - offset);
-        taskQueue.push({offset, limit});
-    }
-    
-    std::mutex queueMutex;
-    std::mutex resultMutex;
-    std::vector<Triple> results;
-    std::atomic<size_t> completedTasks{0};
-    std::atomic<size_t> failedTasks{0};
-    
-    // 工作线程函数
-    auto workerThread = [&](size_t threadId) {
-        MYSQL* conn = mysql_init(nullptr);
-        if (conn == nullptr) {
-            std::cerr << "Thread " << threadId << ": mysql_init() failed" << std::endl;
-            return;
-        }
-        
-        // 设置连接超时
-        unsigned int timeout = 30;
-        mysql_options(conn, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
-        mysql_options(conn, MYSQL_OPT_READ_TIMEOUT, &timeout);
-        mysql_options(conn, MYSQL_OPT_WRITE_TIMEOUT, &timeout);
-        
-        if (mysql_real_connect(conn, DB_HOST, DB_USER, DB_PASSWORD, schemaName.c_str(), DB_PORT, nullptr, 0) == nullptr) {
-            std::cerr << "Thread " << threadId << ": mysql_real_connect() failed: " << mysql_error(conn) << std::endl;
-            mysql_close(conn);
-            return;
-        }
-        
-        while (true) {
-            std::pair<size_t, size_t> task;
-            
-            // 从队列中获取任务
-            {
-                std::lock_guard<std::mutex> lock(queueMutex);
-                if (taskQueue.empty()) {
-                    break;
+            std::vector<Triple> rangeTriples;
+            std::string error;
+            for (size_t i = nextRange++; i < rangeCount; i = nextRange++) {
+                std::string rangeQuery = query;
+                if (i > 0) {
+                    rangeQuery += " WHERE " + column + " >= " + std::to_string(boundary(i));
                 }
-                task = taskQueue.front();
-                taskQueue.pop();
-            }
-            
-            // 执行任务
-            std::string query = "SELECT subject, predicate, object FROM " + tableName + 
-                               " LIMIT " + std::to_string(task.second) + " OFFSET " + std::to_string(task.first);
-            
-            if (mysql_query(conn, query.c_str()) != 0) {
-                std::cerr << "Thread " << threadId << ": Query failed: " << mysql_error(conn) << std::endl;
-                failedTasks++;
-                continue;
-            }
-            
-            MYSQL_RES* res = mysql_store_result(conn);
-            if (res == nullptr) {
-                std::cerr << "Thread " << threadId << ": mysql_store_result() failed: " << mysql_error(conn) << std::endl;
-                failedTasks++;
-                continue;
-            }
-            
-            std::vector<Triple> localTriples;
-            MYSQL_ROW row;
-            while ((row = mysql_fetch_row(res))) {
-                if (row[0] && row[1] && row[2]) {
-                    localTriples.emplace_back(row[0], row[1], row[2]);
+                if (i + 1 < rangeCount) {
+                    rangeQuery += (i > 0 ? " AND " : " WHERE ") + column + " < " + std::to_string(boundary(i + 1));
                 }
+                if (streamTriples(lease.get(), rangeQuery, pool, rangeTriples, error)) {
+                    completed++;
+                } else {
+                    std::cerr << error << std::endl;
+                    rangeTriples.clear();
+                    failed++;
+                }
+                collector.add(i, rangeTriples);
+                rangeTriples.clear();
             }
-            
-            mysql_free_result(res);
-            
-            // 线程安全地添加结果
-            {
-                std::lock_guard<std::mutex> lock(resultMutex);
-                results.insert(results.end(), localTriples.begin(), localTriples.end());
-            }
-            
-            completedTasks++;
-        }
-        
-        mysql_close(conn);
-    };
-    
-    // 启动工作线程
-    std::vector<std::thread> threads;
-    for (size_t i = 0; i < numThreads; ++i) {
-        threads.emplace_back(workerThread, i);
+        });
     }
-    
-    // 等待所有线程完成
     for (auto& thread : threads) {
         thread.join();
     }
-    
-    // 检查是否有失败的任务
-    if (failedTasks > 0) {
-        std::cerr << "Warning: " << failedTasks << " tasks failed during parallel MySQL parsing" << std::endl;
+
+    // 所有工作线程都连接失败时剩余的区间无人处理
+    failed += rangeCount - std::min(nextRange.load(), rangeCount);
+    if (failed > 0) {
+        std::cerr << "Warning: " << failed << " of " << rangeCount << " key ranges failed during parallel MySQL parsing"
+                  << std::endl;
+    }
+    if (completedRanges != nullptr) {
+        *completedRanges = completed;
     }
-    
-    std::cout << "Completed " << completedTasks << " tasks, processed " << results.size() << " triples" << std::endl;
-    
-    return results;
+    return collector.take();
+}
+
+std::vector<Triple> InputParser::parseMySQLTableParallel(const std::string& schemaName, const std::string& tableName, size_t pageSize) {
+    return parseMySQLTableKeyset(schemaName, tableName, pageSize,
+                                 std::max<size_t>(1, std::thread::hardware_concurrency()));
+}
+
+std::vector<Triple> InputParser::parseMySQLTableAdvanced(const std::string& schemaName, const std::string& tableName, 
+                                                       size_t pageSize, size_t maxConnections) {
+    size_t completedRanges = 0;
+    std::vector<Triple> triples = parseMySQLTableKeyset(schemaName, tableName, pageSize,
+                                                        std::max<size_t>(1, maxConnections), &completedRanges);
+    std::cout << "Completed " << completedRanges << " tasks, processed " << triples.size() << " triples" << std::endl;
+    return triples;
 }
@@ -1,6 +1,8 @@
 #ifndef RDFPANDA_STORAGE_INPUTPARSER_H
 #define RDFPANDA_STORAGE_INPUTPARSER_H
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include <tuple>
@@ -9,14 +11,48 @@
 
 #include "TripleStore.h"
 #include "StringPool.h"
+#include "NTriplesTokenizer.h"
+#include "TurtleParser.h"
+#include "CsvScanner.h"
+#include "TableMapping.h"
+#include "MySQLConnectionPool.h"
 
 // using Triple = std::tuple<std::string, std::string, std::string>;
 
 class InputParser {
 private:
     StringPool* string_pool = nullptr;  // 可选的字符串池引用
+    std::vector<ParseError> parse_errors;  // 最近一次 N-Triples/Turtle 解析的语法错误
+    std::unique_ptr<MySQLConnectionPool> mysql_pool;  // MySQL 导入复用的连接
+
+    using ChunkCallback = std::function<void(size_t, std::vector<Triple>&)>;
+    // 把 CSV 的一条记录转为三元组追加到输出，返回 false 时该记录被跳过，error 为原因
+    using RowHandler = std::function<bool(const std::vector<std::string_view>&, std::vector<Triple>&, std::string&)>;
+    // 每块调用一次，得到该块专用的 RowHandler（可带有块内状态）
+    using RowHandlerFactory = std::function<RowHandler()>;
+
+    StringPool& activeStringPool() const;
+    // 取得 schemaName 的连接池：数据库不同时重建，连接数上限不够时提高上限
+    MySQLConnectionPool& mysqlPool(const std::string& schemaName, size_t connections);
+    void reportParseErrors(const std::string& filename, const std::vector<ParseError>& errors);
+    // N-Triples 分块并行解析的公共部分：工作线程每解析出 batchSize 个三元组回调一次 onTriples(块序号, 三元组)，
+    // 每块结束时再回调一次（可能为空）；回调在多个工作线程中并发调用。文件无法打开时返回 false
+    bool parseNTriplesChunks(const std::string& filename, size_t numThreads, size_t batchSize,
+                             const ChunkCallback& onTriples);
+    // CSV 分块并行扫描，每条记录交给块内的 RowHandler，回调方式与 parseNTriplesChunks 相同
+    bool parseCSVRows(const std::string& filename, char delimiter, bool header, size_t numThreads, size_t batchSize,
+                      const RowHandlerFactory& makeHandler, const ChunkCallback& onTriples);
+    // 按 CsvOptions 的列映射解析 CSV
+    bool parseCSVChunks(const std::string& filename, const CsvOptions& options, size_t numThreads, size_t batchSize,
+                        const ChunkCallback& onTriples);
+    // 按主键区间并行读取 MySQL 表，completedRanges 返回成功读取的区间数
+    std::vector<Triple> parseMySQLTableKeyset(const std::string& schemaName, const std::string& tableName,
+                                              size_t pageSize, size_t numThreads, size_t* completedRanges = nullptr);
 
 public:
+    // 批回调：可以取走（移动）批中的三元组
+    using BatchCallback = std::function<void(std::vector<Triple>&)>;
+
     // 设置字符串池（用于优化性能）
     void setStringPool(StringPool* pool) {
         string_pool = pool;
@@ -24,23 +60,69 @@ public:
             Triple::setStringPool(pool);
         }
     }
-    std::vector<Triple> parseNTriples(const std::string& filename);
+    // 解析 N-Triples 文件：文件映射到内存后按行对齐切成若干块，由 numThreads 个线程（0 为硬件线程数）动态领取并行解析，
+    // 结果保持文件中的顺序；有语法错误的行被跳过，错误输出到 std::cerr 并可由 getParseErrors() 取得
+    std::vector<Triple> parseNTriples(const std::string& filename, size_t numThreads = 0);
+    // 与 parseNTriples 相同的并行解析，但不汇总结果：每个工作线程每解析出 batchSize 个三元组回调一次，
+    // 回调会被多个线程并发调用，批之间不保持文件顺序；返回三元组总数
+    size_t parseNTriplesBatches(const std::string& filename, const BatchCallback& onBatch, size_t numThreads = 0,
+                                size_t batchSize = 65536);
+    // gzip（.gz）与 zstd（.zst）压缩的文件按文件头的魔数识别，边解压边解析，无需先解压到磁盘：
+    // N-Triples 由调用线程解压并按行切块交给解析线程，多帧 zstd 同时并行解压；Turtle 按块流式解压
+    // 完整的 Turtle 文法，单遍读取文件；有语法错误的语句被跳过，错误同样可由 getParseErrors() 取得
     std::vector<Triple> parseTurtle(const std::string& filename);
-    std::vector<Triple> parseCSV(const std::string& filename);
+    // 流式解析 Turtle，每解析出约 batchSize 个三元组回调一次，内存占用与文件大小无关，返回三元组总数
+    size_t parseTurtleBatches(const std::string& filename, const BatchCallback& onBatch, size_t batchSize = 65536);
+    // 解析 CSV 文件（RFC 4180，字段可加引号），按 options 把各列映射为主语、谓语、宾语，字段原样作为项
+    // 文件映射到内存后切块并行解析：块首按之前的引号个数的奇偶判断是否位于引号内，再移到下一条记录的开头，
+    // 引号内的换行不会被当作记录边界；结果保持文件中的顺序，有错误的记录被跳过，错误可由 getParseErrors() 取得
+    std::vector<Triple> parseCSV(const std::string& filename, const CsvOptions& options = CsvOptions(),
+                                 size_t numThreads = 0);
+    // 与 parseCSV 相同的并行解析，按批回调，批之间不保持文件顺序；返回三元组总数
+    size_t parseCSVBatches(const std::string& filename, const BatchCallback& onBatch,
+                           const CsvOptions& options = CsvOptions(), size_t numThreads = 0, size_t batchSize = 65536);
 
-    // 先从SQLite开始尝试对数据库表的解析，之后可能扩展到其他数据库
-    std::vector<Triple> parseSQLiteTable(const std::string& dbName, const std::string& tableName);
-    // 尝试MySQL
+    // 按 R2RML 映射（见 TableMapping.h）直接从宽表生成三元组：每行按主语模板生成主语，每个映射的列生成一个三元组，
+    // 项直接写入字符串池；结果保持行的顺序
+    // CSV 的第一行为列名，空字段视为 NULL，按 parseCSV 的方式分块并行解析
+    std::vector<Triple> parseMappedCSV(const std::string& filename, const TriplesMap& mapping, size_t numThreads = 0,
+                                       char delimiter = ',');
+    // SQL 来源执行映射的 rr:sqlQuery 或读取 rr:tableName 的全部列；调用线程逐行读取结果，
+    // 每批行交给 numThreads 个线程并行映射（0 为硬件线程数）
+    std::vector<Triple> parseMappedSQLiteTable(const std::string& dbName, const TriplesMap& mapping,
+                                               size_t numThreads = 0);
+    std::vector<Triple> parseMappedMySQLTable(const std::string& schemaName, const TriplesMap& mapping,
+                                              size_t numThreads = 0);
+
+    // 读取 SQLite 表的 subject, predicate, object 三列，项直接写入字符串池，含 NULL 的行被跳过
+    // 按 rowid 区间划分，由 numThreads 个线程（0 为硬件线程数）各用一个只读连接并行读取，结果保持 rowid 的顺序
+    // sorted 为 true 时改按主语的取值划分，各区间 ORDER BY subject, predicate, object，结果按这三列全局有序，
+    // 同一主语的三元组连续出现；subject 上有索引时排序由索引完成
+    std::vector<Triple> parseSQLiteTable(const std::string& dbName, const std::string& tableName,
+                                         size_t numThreads = 0, bool sorted = false);
+    // 导入已由上游编码为整数的数据：事实表 factTable 的 s_id, p_id, o_id 三列引用字典表 dictionaryTable 的 id 列，
+    // 字典表的 lexical 列为词项（写法与 N-Triples 解析结果相同）。先读取字典，每个词项写入字符串池一次，
+    // 再把事实表的整数键按字典直接转为 ID，不再传输和哈希每行的字符串；含 NULL 或字典中没有的键的行被跳过
+    std::vector<Triple> parseEncodedSQLiteTables(const std::string& dbName, const std::string& factTable,
+                                                 const std::string& dictionaryTable);
+    std::vector<Triple> parseEncodedMySQLTables(const std::string& schemaName, const std::string& factTable,
+                                                const std::string& dictionaryTable);
+    // MySQL 表的 subject, predicate, object 三列：用 mysql_use_result 逐行读取，项直接写入字符串池，含 NULL 的行被跳过；
+    // 连接来自 InputParser 持有的连接池，多次导入之间复用
     std::vector<Triple> parseMySQLTable(const std::string& schemaName, const std::string& tableName);
-    // 并行化MySQL解析
+    // 并行化MySQL解析：表有单列的整数主键时按主键的取值区间（每区间约 pageSize 个键）划分，
+    // 每个区间用 WHERE 键 >= a AND 键 < b 查询，走主键索引而不是 LIMIT/OFFSET 从头扫描；结果按主键区间的顺序排列
+    // 没有这样的主键时退化为 parseMySQLTable 的单连接流式读取。线程数为硬件线程数
     std::vector<Triple> parseMySQLTableParallel(const std::string& schemaName, const std::string& tableName, size_t pageSize = 10000);
-    // 高级并行化MySQL解析（带连接池）
+    // 与 parseMySQLTableParallel 相同，但最多使用 maxConnections 个连接
     std::vector<Triple> parseMySQLTableAdvanced(const std::string& schemaName, const std::string& tableName, 
                                                size_t pageSize = 10000, size_t maxConnections = 8);
 
     std::vector<Rule> parseDatalogFromFile(const std::string& filename);
     std::vector<Rule> parseDatalogFromConsole(const std::string& datalogString);
     
+    const std::vector<ParseError>& getParseErrors() const { return parse_errors; }
+
     // 获取字符串池统计信息（如果有的话）
     StringPool::PoolStats getStringPoolStats() const {
         if (string_pool) {
@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <set>
+#include "MagicSets.h"
+#include "DatalogEngine.h"
+
+const char* const MAGIC_NAMESPACE = "urn:rdfpanda:magic:";
+const char* const MAGIC_FILLER = "urn:rdfpanda:magic:_";
+
+namespace {
+
+bool isVariable(const std::string& term) {
+    return !term.empty() && term[0] == '?';
+}
+
+bool isBound(const std::string& term, const std::set<std::string>& bound) {
+    return !isVariable(term) || bound.count(term) > 0;
+}
+
+// 主语、宾语的绑定模式，如 "bf"
+std::string adornmentOf(const Atom& atom, const std::set<std::string>& bound) {
+    std::string adornment;
+    adornment += isBound(atom.subject, bound) ? 'b' : 'f';
+    adornment += isBound(atom.object, bound) ? 'b' : 'f';
+    return adornment;
+}
+
+// 原子在给定绑定模式下的魔法原子：绑定位置保留原项，自由位置填占位常量
+Atom magicAtom(const Atom& atom, const std::string& adornment) {
+    return {
+        adornment[0] == 'b' ? atom.subject : MAGIC_FILLER,
+        std::string(MAGIC_NAMESPACE) + adornment + ":" + atom.predicate,
+        adornment[1] == 'b' ? atom.object : MAGIC_FILLER
+    };
+}
+
+bool sameAtom(const Atom& a, const Atom& b) {
+    return a.subject == b.subject && a.predicate == b.predicate && a.object == b.object;
+}
+
+void addVariables(const Atom& atom, std::set<std::string>& bound) {
+    for (const std::string* term : {&atom.subject, &atom.predicate, &atom.object}) {
+        if (isVariable(*term)) {
+            bound.insert(*term);
+        }
+    }
+}
+
+// 改写过程的状态：可达的（谓语, 绑定模式）工作表与输出的规则
+class MagicRewriter {
+public:
+    MagicRewriter(const std::vector<Rule>& rules, const std::set<std::string>& idb, MagicProgram& program)
+            : rules(rules), idb(idb), program(program) {}
+
+    // 登记对某个推导谓语的需求，首次出现时加入工作表
+    void reach(const std::string& predicate, const std::string& adornment) {
+        if (reached.insert({predicate, adornment}).second) {
+            worklist.emplace_back(predicate, adornment);
+        }
+    }
+
+    void run() {
+        while (!worklist.empty()) {
+            const std::string predicate = worklist.front().first;
+            const std::string adornment = worklist.front().second;
+            worklist.pop_front();
+            for (const auto& rule : rules) {
+                if (rule.head.predicate == predicate) {
+                    rewriteRule(rule, adornment);
+                }
+            }
+        }
+    }
+
+    // 目标谓语为线性递归时的分解改写（right/left-linear factoring），不满足条件返回 false
+    //
+    // 以 bf 为例，若 p 的每条规则要么是出口规则，要么形如 p(X, Z) :- B(X, Y), p(Y, Z)
+    // （Z 只出现在规则头和递归原子的自由位置），则 p(c, Z) 当且仅当存在需求集合中的 Y 使出口规则或已有事实给出 p(Y, Z)。
+    // 于是只需：magic(Y) :- magic(X), B；p(c, Z) :- magic(X), 出口规则体；p(c, Z) :- magic(Y), p(Y, Z)。
+    // 不再为每个可达节点求 p 的全部结果。fb 时左右对称。
+    bool rewriteLinear(const Atom& goal, const std::string& adornment) {
+        if (adornment != "bf" && adornment != "fb") {
+            return false;
+        }
+        const std::string& p = goal.predicate;
+        const bool subjectBound = adornment == "bf";
+        auto boundTerm = [subjectBound](const Atom& atom) -> const std::string& {
+            return subjectBound ? atom.subject : atom.object;
+        };
+        auto freeTerm = [subjectBound](const Atom& atom) -> const std::string& {
+            return subjectBound ? atom.object : atom.subject;
+        };
+
+        // p 只能由目标和自身的规则提出需求，否则其他谓语需要 p 在别的绑定值上的完整结果
+        for (const auto& rule : rules) {
+            if (rule.head.predicate == p) {
+                continue;
+            }
+            for (const auto& atom : rule.body) {
+                if (atom.predicate == p) {
+                    return false;
+                }
+            }
+        }
+
+        // 检查 p 的每条规则，记下递归原子的位置
+        std::vector<const Rule*> pRules;
+        std::vector<int> recursiveAtom;
+        for (const auto& rule : rules) {
+            if (rule.head.predicate != p) {
+                continue;
+            }
+            int recursive = -1;
+            for (size_t i = 0; i < rule.body.size(); ++i) {
+                if (rule.body[i].predicate != p) {
+                    continue;
+                }
+                if (recursive >= 0) {
+                    return false;  // 非线性递归
+                }
+                recursive = static_cast<int>(i);
+            }
+            if (recursive >= 0) {
+                const std::string& head = freeTerm(rule.head);
+                const Atom& atom = rule.body[recursive];
+                if (!isVariable(head) || freeTerm(atom) != head || boundTerm(rule.head) == head ||
+                    boundTerm(atom) == head) {
+                    return false;
+                }
+                // 自由变量只能沿递归原子传递，递归原子的绑定位置须由规则头或其他原子给出
+                std::set<std::string> others;
+                if (isVariable(boundTerm(rule.head))) {
+                    others.insert(boundTerm(rule.head));
+                }
+                for (size_t i = 0; i < rule.body.size(); ++i) {
+                    if (static_cast<int>(i) == recursive) {
+                        continue;
+                    }
+                    std::set<std::string> vars;
+                    addVariables(rule.body[i], vars);
+                    if (vars.count(head) > 0) {
+                        return false;
+                    }
+                    others.insert(vars.begin(), vars.end());
+                }
+                if (!isBound(boundTerm(atom), others)) {
+                    return false;
+                }
+            }
+            pRules.push_back(&rule);
+            recursiveAtom.push_back(recursive);
+        }
+
+        for (size_t r = 0; r < pRules.size(); ++r) {
+            const Rule& rule = *pRules[r];
+            const Atom guard = magicAtom(rule.head, adornment);
+            std::vector<Atom> body = {guard};
+            std::set<std::string> bound;
+            addVariables(guard, bound);
+            std::vector<Atom> atoms;
+            for (size_t i = 0; i < rule.body.size(); ++i) {
+                if (static_cast<int>(i) != recursiveAtom[r]) {
+                    atoms.push_back(rule.body[i]);
+                }
+            }
+            passDemand(rule, atoms, body, bound);
+
+            if (recursiveAtom[r] >= 0) {
+                // 递归规则只用于扩展需求集合
+                Atom demand = magicAtom(rule.body[recursiveAtom[r]], adornment);
+                if (!(body.size() == 1 && sameAtom(demand, guard))) {
+                    program.rules.emplace_back(rule.name, body, demand);
+                }
+            } else {
+                // 出口规则直接给出目标常量上的答案
+                Atom answer = rule.head;
+                (subjectBound ? answer.subject : answer.object) = boundTerm(goal);
+                program.rules.emplace_back(rule.name, body, answer);
+            }
+        }
+
+        // 事实库中已有的 p 事实同样作为出口
+        const std::string y = "?magicNode";
+        const std::string z = "?magicValue";
+        Atom existing{subjectBound ? y : z, p, subjectBound ? z : y};
+        Atom answer = existing;
+        (subjectBound ? answer.subject : answer.object) = boundTerm(goal);
+        program.rules.emplace_back("", std::vector<Atom>{magicAtom(existing, adornment), existing}, answer);
+
+        reached.insert({p, adornment});
+        return true;
+    }
+
+private:
+    const std::vector<Rule>& rules;
+    const std::set<std::string>& idb;
+    MagicProgram& program;
+    std::set<std::pair<std::string, std::string>> reached;
+    std::deque<std::pair<std::string, std::string>> worklist;
+
+    // 按信息传递顺序把 atoms 追加到 body：每次取绑定参数最多的原子（相同时保持原顺序），
+    // 遇到推导谓语时生成对应的魔法规则
+    void passDemand(const Rule& rule, const std::vector<Atom>& atoms, std::vector<Atom>& body,
+                    std::set<std::string>& bound) {
+        const Atom guard = body.front();
+        std::vector<bool> used(atoms.size(), false);
+        for (size_t step = 0; step < atoms.size(); ++step) {
+            int best = -1;
+            int bestBound = -1;
+            for (size_t i = 0; i < atoms.size(); ++i) {
+                if (used[i]) {
+                    continue;
+                }
+                int count = isBound(atoms[i].subject, bound) + isBound(atoms[i].object, bound);
+                if (count > bestBound) {
+                    best = static_cast<int>(i);
+                    bestBound = count;
+                }
+            }
+            used[best] = true;
+            const Atom& atom = atoms[best];
+
+            if (idb.count(atom.predicate) > 0) {
+                // 把需求传给规则体中的推导谓语：magic_q(绑定参数) :- 守卫, 之前的原子
+                const std::string adornment = adornmentOf(atom, bound);
+                Atom demand = magicAtom(atom, adornment);
+                if (!(body.size() == 1 && sameAtom(demand, guard))) {
+                    program.rules.emplace_back(rule.name, body, demand);
+                }
+                reach(atom.predicate, adornment);
+            }
+            body.push_back(atom);
+            addVariables(atom, bound);
+        }
+    }
+
+    // 一般改写：规则加守卫，规则体中的推导谓语按信息传递顺序获得需求
+    void rewriteRule(const Rule& rule, const std::string& adornment) {
+        // 规则头中绑定位置上的变量在规则体开始时即已知
+        std::set<std::string> bound;
+        if (adornment[0] == 'b' && isVariable(rule.head.subject)) {
+            bound.insert(rule.head.subject);
+        }
+        if (adornment[1] == 'b' && isVariable(rule.head.object)) {
+            bound.insert(rule.head.object);
+        }
+        std::vector<Atom> body = {magicAtom(rule.head, adornment)};
+        passDemand(rule, rule.body, body, bound);
+        program.rules.emplace_back(rule.name, body, rule.head);
+    }
+};
+
+bool isMagicPredicate(const std::string& predicate) {
+    return predicate.compare(0, std::strlen(MAGIC_NAMESPACE), MAGIC_NAMESPACE) == 0;
+}
+
+// 删除种子及魔法规则推导的三元组。魔法事实只对本次目标有效：分解改写把需求集合中的节点的结果
+// 直接记到目标常量上，留下的魔法事实会让下一个目标得到错误的答案
+void removeMagicFacts(TripleStore& store, const MagicProgram& program) {
+    std::set<std::string> predicates;
+    if (program.hasSeed) {
+        predicates.insert(program.seed.predicate);
+    }
+    for (const auto& rule : program.rules) {
+        if (isMagicPredicate(rule.head.predicate)) {
+            predicates.insert(rule.head.predicate);
+        }
+    }
+
+    std::vector<uint32_t> indices;
+    for (const auto& predicate : predicates) {
+        uint32_t id = store.getStringPool().getIdIfExists(predicate);
+        if (id != UINT32_MAX) {
+            std::vector<uint32_t> list = store.queryTripleIdsByPredicateId(id);
+            indices.insert(indices.end(), list.begin(), list.end());
+        }
+    }
+    // 从大到小删除：空位由最后一个三元组填补，而下标更大的待删三元组都已删除，不会被移动
+    std::sort(indices.begin(), indices.end(), std::greater<uint32_t>());
+    for (uint32_t index : indices) {
+        store.removeTriple(store.getTripleById(index));
+    }
+}
+
+}
+
+MagicProgram magicSetsRewrite(const std::vector<Rule>& rules, const Atom& goal) {
+    MagicProgram program;
+
+    // 谓语为变量时无法判断哪些规则与目标相关
+    auto fallback = [&](const std::string& reason) {
+        program.goalDirected = false;
+        program.reason = reason;
+        program.rules = rules;
+        program.hasSeed = false;
+        return program;
+    };
+    if (isVariable(goal.predicate)) {
+        return fallback("goal predicate is a variable");
+    }
+    std::set<std::string> idb;  // 由规则推导的谓语
+    for (size_t r = 0; r < rules.size(); ++r) {
+        bool variablePredicate = isVariable(rules[r].head.predicate);
+        for (const auto& atom : rules[r].body) {
+            variablePredicate = variablePredicate || isVariable(atom.predicate);
+        }
+        if (variablePredicate) {
+            return fallback("rule " + std::to_string(r) + " has a variable predicate");
+        }
+        idb.insert(rules[r].head.predicate);
+    }
+
+    program.goalDirected = true;
+    if (idb.count(goal.predicate) == 0) {
+        return program;  // 目标只涉及事实库中已有的谓语，无需推理
+    }
+
+    const std::string goalAdornment = adornmentOf(goal, {});
+    program.hasSeed = true;
+    program.seed = magicAtom(goal, goalAdornment);
+
+    MagicRewriter rewriter(rules, idb, program);
+    if (!rewriter.rewriteLinear(goal, goalAdornment)) {
+        rewriter.reach(goal.predicate, goalAdornment);
+    }
+    rewriter.run();
+    return program;
+}
+
+QueryResult reasonGoal(TripleStore& store, const std::vector<Rule>& rules, const Atom& goal,
+                       const RowCallback& onRow) {
+    MagicProgram program = magicSetsRewrite(rules, goal);
+    if (!program.goalDirected) {
+        std::cerr << "Goal-directed rewrite skipped (" << program.reason << "), materializing all rules" << std::endl;
+    }
+
+    if (program.hasSeed) {
+        StringPool& pool = store.getStringPool();
+        store.addTriple(Triple(pool.getId(program.seed.subject), pool.getId(program.seed.predicate),
+                               pool.getId(program.seed.object)));
+    }
+    if (!program.rules.empty()) {
+        DatalogEngine engine(store, program.rules);
+        engine.reason();
+    }
+
+    QueryEngine query(store);
+    BGPQuery target;
+    target.patterns = {goal};
+    QueryResult result = query.execute(target, onRow);
+    removeMagicFacts(store, program);
+    return result;
+}
@@ -0,0 +1,42 @@
+#ifndef RDFPANDA_STORAGE_MAGICSETS_H
+#define RDFPANDA_STORAGE_MAGICSETS_H
+
+#include <string>
+#include <vector>
+
+#include "Trie.h"
+#include "TripleStore.h"
+#include "QueryEngine.h"
+
+// 魔法集（magic sets）改写：只推导与目标原子相关的事实
+//
+// 目标原子中为常量的主语/宾语称为绑定（b），变量称为自由（f），组合成谓语的绑定模式（如 bf）。
+// 对每个可达的（谓语, 绑定模式）：
+// - 以该谓语为头的规则复制一份，规则体最前加守卫原子 magic_p_bf(绑定参数)，只在有需求时触发
+// - 规则体中由规则推导的谓语（IDB）生成魔法规则，把需求沿规则体从左到右传递（按绑定参数多少贪心排序）
+// 改写后的规则仍写回原谓语，不生成带修饰的谓语副本，事实库中该谓语已有的事实照常参与连接。
+//
+// 魔法事实以三元组存放：谓语为 MAGIC_NAMESPACE 下的IRI，绑定位置取参数，自由位置填 MAGIC_FILLER。
+// reasonGoal 查询完目标后删除这些三元组，事实库中只留下原谓语上推导出的事实。
+
+extern const char* const MAGIC_NAMESPACE;
+extern const char* const MAGIC_FILLER;
+
+struct MagicProgram {
+    bool goalDirected = false;  // 为 false 时 rules 即原规则（需要全量推理），原因见 reason
+    std::string reason;
+    std::vector<Rule> rules;    // 改写后的规则
+    bool hasSeed = false;       // 目标谓语由规则推导时，推理前需写入事实库的种子魔法事实
+    Atom seed;
+};
+
+// 按目标原子改写规则；规则或目标中含谓语变量时无法确定需求，退回全量推理
+MagicProgram magicSetsRewrite(const std::vector<Rule>& rules, const Atom& goal);
+
+// 目标导向推理：改写规则、写入种子事实并推理，然后在事实库上查询目标原子，最后删除种子和魔法事实
+// 结果列为目标中的变量（按出现顺序），各行通过 onRow 流式输出
+QueryResult reasonGoal(TripleStore& store, const std::vector<Rule>& rules, const Atom& goal,
+                       const RowCallback& onRow);
+
+
+#endif //RDFPANDA_STORAGE_MAGICSETS_H
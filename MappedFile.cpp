@@ -0,0 +1,86 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filename) {
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return;
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+    if (length == 0) {
+        CloseHandle(file);
+        opened = true;
+        return;
+    }
+    // 视图建立后映射对象和文件句柄即可关闭，视图本身保持它们有效
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping != nullptr) {
+        mapped = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    opened = mapped != nullptr;
+    if (!opened) {
+        length = 0;
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (mapped != nullptr) {
+        UnmapViewOfFile(mapped);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename) {
+    int descriptor = open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return;
+    }
+    struct stat status {};
+    if (fstat(descriptor, &status) != 0) {
+        close(descriptor);
+        return;
+    }
+    length = static_cast<size_t>(status.st_size);
+    if (length == 0) {
+        close(descriptor);
+        opened = true;
+        return;
+    }
+    // 映射建立后文件描述符即可关闭
+    void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (address == MAP_FAILED) {
+        length = 0;
+        return;
+    }
+    madvise(address, length, MADV_SEQUENTIAL);
+    mapped = static_cast<const char*>(address);
+    opened = true;
+}
+
+MappedFile::~MappedFile() {
+    if (mapped != nullptr) {
+        munmap(const_cast<char*>(mapped), length);
+    }
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef RDFPANDA_STORAGE_MAPPEDFILE_H
+#define RDFPANDA_STORAGE_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// MappedFile：以只读方式把整个文件映射到内存（POSIX mmap / Windows 文件映射），析构时解除映射
+// 页面按需从页缓存载入，不占用进程堆；空文件不做映射，data() 为 nullptr、size() 为 0
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return mapped; }
+    size_t size() const { return length; }
+
+private:
+    const char* mapped = nullptr;
+    size_t length = 0;
+    bool opened = false;
+};
+
+
+#endif //RDFPANDA_STORAGE_MAPPEDFILE_H
@@ -0,0 +1,101 @@
+#include <utility>
+#include "MySQLConnectionPool.h"
+#include "DatabaseConfig.h"
+
+MySQLConnectionPool::Lease::Lease(Lease&& other) noexcept
+        : owner(other.owner), conn(other.conn), failure(std::move(other.failure)) {
+    other.owner = nullptr;
+    other.conn = nullptr;
+}
+
+MySQLConnectionPool::Lease& MySQLConnectionPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (conn != nullptr) {
+            owner->release(conn);
+        }
+        owner = other.owner;
+        conn = other.conn;
+        failure = std::move(other.failure);
+        other.owner = nullptr;
+        other.conn = nullptr;
+    }
+    return *this;
+}
+
+MySQLConnectionPool::Lease::~Lease() {
+    if (conn != nullptr) {
+        owner->release(conn);
+    }
+}
+
+MySQLConnectionPool::MySQLConnectionPool(std::string schemaName, size_t maxConnections)
+        : schemaName(std::move(schemaName)), maxConnections(maxConnections > 0 ? maxConnections : 1) {}
+
+MySQLConnectionPool::~MySQLConnectionPool() {
+    for (MYSQL* conn : idle) {
+        mysql_close(conn);
+    }
+}
+
+void MySQLConnectionPool::growTo(size_t connections) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (connections > maxConnections) {
+        maxConnections = connections;
+        available.notify_all();
+    }
+}
+
+MySQLConnectionPool::Lease MySQLConnectionPool::acquire() {
+    Lease lease;
+    MYSQL* conn = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        available.wait(lock, [this] { return !idle.empty() || opened < maxConnections; });
+        if (!idle.empty()) {
+            conn = idle.back();
+            idle.pop_back();
+        } else {
+            opened++;
+        }
+    }
+    if (conn != nullptr && mysql_ping(conn) != 0) {
+        mysql_close(conn);
+        conn = nullptr;
+    }
+    if (conn == nullptr) {
+        conn = connect(lease.failure);
+        if (conn == nullptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            opened--;
+            available.notify_one();
+            return lease;
+        }
+    }
+    lease.owner = this;
+    lease.conn = conn;
+    return lease;
+}
+
+MYSQL* MySQLConnectionPool::connect(std::string& error) const {
+    MYSQL* conn = mysql_init(nullptr);
+    if (conn == nullptr) {
+        error = "mysql_init() failed";
+        return nullptr;
+    }
+    unsigned int timeout = 30;
+    mysql_options(conn, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
+    mysql_options(conn, MYSQL_OPT_READ_TIMEOUT, &timeout);
+    mysql_options(conn, MYSQL_OPT_WRITE_TIMEOUT, &timeout);
+    if (mysql_real_connect(conn, DB_HOST, DB_USER, DB_PASSWORD, schemaName.c_str(), DB_PORT, nullptr, 0) == nullptr) {
+        error = std::string("mysql_real_connect() failed: ") + mysql_error(conn);
+        mysql_close(conn);
+        return nullptr;
+    }
+    return conn;
+}
+
+void MySQLConnectionPool::release(MYSQL* conn) {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle.push_back(conn);
+    available.notify_one();
+}
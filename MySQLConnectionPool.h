@@ -0,0 +1,65 @@
+#ifndef RDFPANDA_STORAGE_MYSQLCONNECTIONPOOL_H
+#define RDFPANDA_STORAGE_MYSQLCONNECTIONPOOL_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <mysql.h>
+
+// MySQLConnectionPool：到同一数据库的连接池，连接在首次需要时建立（参数见 DatabaseConfig.h），
+// 用完归还后供后续查询与后续的导入复用，不再为每个分页任务新建连接；析构时关闭全部连接
+// 复用空闲连接前先 mysql_ping，断开的连接重新建立
+class MySQLConnectionPool {
+public:
+    // 借出的连接，析构时归还连接池
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        MYSQL* get() const { return conn; }
+        explicit operator bool() const { return conn != nullptr; }
+        // 连接失败时的原因
+        const std::string& error() const { return failure; }
+
+    private:
+        friend class MySQLConnectionPool;
+        MySQLConnectionPool* owner = nullptr;
+        MYSQL* conn = nullptr;
+        std::string failure;
+    };
+
+    MySQLConnectionPool(std::string schemaName, size_t maxConnections = 8);
+    ~MySQLConnectionPool();
+
+    MySQLConnectionPool(const MySQLConnectionPool&) = delete;
+    MySQLConnectionPool& operator=(const MySQLConnectionPool&) = delete;
+
+    // 取得一个连接：优先复用空闲连接，未达上限时新建，否则等待其他线程归还；连接失败时返回的 Lease 为空
+    Lease acquire();
+
+    const std::string& getSchemaName() const { return schemaName; }
+    size_t getMaxConnections() const { return maxConnections; }
+    // 提高连接数上限，已建立的连接保留
+    void growTo(size_t connections);
+
+private:
+    std::string schemaName;
+    size_t maxConnections;  // 只在持有 mutex 时修改
+    std::mutex mutex;
+    std::condition_variable available;
+    std::vector<MYSQL*> idle;
+    size_t opened = 0;  // 已建立的连接数（含借出的）
+
+    MYSQL* connect(std::string& error) const;
+    void release(MYSQL* conn);
+};
+
+
+#endif //RDFPANDA_STORAGE_MYSQLCONNECTIONPOOL_H
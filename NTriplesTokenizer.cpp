@@ -0,0 +1,267 @@
+#include <cstdint>
+#include "NTriplesTokenizer.h"
+
+namespace {
+
+// 按字节查表的字符类别，UTF-8 多字节序列的各字节（>= 0x80）在 IRI、字面量和空白节点标签中都允许出现
+struct CharClasses {
+    bool iri[256];          // IRI 中可直接出现的字符（不含需转义的 \）
+    bool literalStop[256];  // 字面量中需要特殊处理的字符：引号、反斜杠、换行
+    bool label[256];        // 空白节点标签中的字符
+    bool hex[256];
+
+    CharClasses() : iri(), literalStop(), label(), hex() {
+        for (int c = 0; c < 256; ++c) {
+            iri[c] = c > 0x20;
+            label[c] = c >= 0x80 || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                       c == '_' || c == '-' || c == '.';
+            hex[c] = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+        }
+        for (unsigned char c : std::string("<>\"{}|^`\\")) {
+            iri[c] = false;
+        }
+        for (unsigned char c : std::string("\"\\\n\r")) {
+            literalStop[c] = true;
+        }
+    }
+};
+
+const CharClasses CLASSES;
+
+bool isAlpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool isAlnum(char c) {
+    return isAlpha(c) || (c >= '0' && c <= '9');
+}
+
+}
+
+bool NTriplesTokenizer::next(TermTriple& triple) {
+    while (pos < end) {
+        skipSpaces();
+        if (pos == end) {
+            break;
+        }
+        const char c = *pos;
+        if (c == '\n') {
+            ++pos;
+            ++line;
+            lineStart = pos;
+            continue;
+        }
+        if (c == '\r') {
+            ++pos;
+            if (pos == end || *pos != '\n') {
+                ++line;  // 单独的 \r 也作为行尾
+                lineStart = pos;
+            }
+            continue;
+        }
+        if (c == '#') {
+            skipLine();
+            continue;
+        }
+        if (parseTriple(triple)) {
+            return true;
+        }
+        skipLine();
+    }
+    return false;
+}
+
+bool NTriplesTokenizer::parseTriple(TermTriple& triple) {
+    // 主语
+    if (*pos == '<') {
+        if (!parseIri(triple.subject)) {
+            return false;
+        }
+    } else if (*pos == '_') {
+        if (!parseBlankNode(triple.subject)) {
+            return false;
+        }
+    } else {
+        return fail("expected IRI or blank node as subject");
+    }
+
+    // 谓语
+    skipSpaces();
+    if (pos == end || *pos != '<') {
+        return fail("expected IRI as predicate");
+    }
+    if (!parseIri(triple.predicate)) {
+        return false;
+    }
+
+    // 宾语
+    skipSpaces();
+    const char c = pos < end ? *pos : '\0';
+    if (c == '<') {
+        if (!parseIri(triple.object)) {
+            return false;
+        }
+    } else if (c == '_') {
+        if (!parseBlankNode(triple.object)) {
+            return false;
+        }
+    } else if (c == '"') {
+        if (!parseLiteral(triple.object)) {
+            return false;
+        }
+    } else {
+        return fail("expected IRI, blank node or literal as object");
+    }
+
+    skipSpaces();
+    if (pos == end || *pos != '.') {
+        return fail("expected '.' after object");
+    }
+    ++pos;
+    skipSpaces();
+    if (pos < end && *pos == '#') {
+        skipLine();
+    }
+    if (pos < end && *pos != '\n' && *pos != '\r') {
+        return fail("unexpected content after '.'");
+    }
+    return true;
+}
+
+bool NTriplesTokenizer::parseIri(std::string_view& term) {
+    const char* start = ++pos;  // 跳过 '<'
+    while (true) {
+        while (pos < end && CLASSES.iri[static_cast<uint8_t>(*pos)]) {
+            ++pos;
+        }
+        if (pos == end) {
+            return fail("unterminated IRI");
+        }
+        if (*pos == '>') {
+            term = std::string_view(start, pos - start);
+            ++pos;
+            return true;
+        }
+        if (*pos != '\\') {
+            return fail("invalid character in IRI");
+        }
+        if (!parseUchar()) {
+            return false;
+        }
+    }
+}
+
+bool NTriplesTokenizer::parseUchar() {
+    // pos 指向反斜杠：\uXXXX 或 \UXXXXXXXX
+    size_t digits = 0;
+    if (end - pos >= 2 && pos[1] == 'u') {
+        digits = 4;
+    } else if (end - pos >= 2 && pos[1] == 'U') {
+        digits = 8;
+    } else {
+        return fail("invalid escape sequence");
+    }
+    if (static_cast<size_t>(end - pos) < digits + 2) {
+        return fail("truncated unicode escape");
+    }
+    for (size_t i = 0; i < digits; ++i) {
+        if (!CLASSES.hex[static_cast<uint8_t>(pos[2 + i])]) {
+            return fail("invalid hex digit in unicode escape");
+        }
+    }
+    pos += digits + 2;
+    return true;
+}
+
+bool NTriplesTokenizer::parseBlankNode(std::string_view& term) {
+    const char* start = pos;
+    if (end - pos < 3 || pos[1] != ':') {
+        return fail("expected '_:' blank node label");
+    }
+    pos += 2;
+    const char first = *pos;
+    if (first == '-' || first == '.' || !CLASSES.label[static_cast<uint8_t>(first)]) {
+        return fail("invalid blank node label");
+    }
+    while (pos < end && CLASSES.label[static_cast<uint8_t>(*pos)]) {
+        ++pos;
+    }
+    // 标签不能以 '.' 结尾，末尾的 '.' 属于三元组的结束符
+    while (pos[-1] == '.') {
+        --pos;
+    }
+    term = std::string_view(start, pos - start);
+    return true;
+}
+
+bool NTriplesTokenizer::parseLiteral(std::string_view& term) {
+    const char* start = pos++;  // 保留开头的引号
+    while (true) {
+        while (pos < end && !CLASSES.literalStop[static_cast<uint8_t>(*pos)]) {
+            ++pos;
+        }
+        if (pos == end) {
+            return fail("unterminated literal");
+        }
+        const char c = *pos;
+        if (c == '"') {
+            ++pos;
+            break;
+        }
+        if (c != '\\') {
+            return fail("line break in literal");
+        }
+        const char escaped = end - pos >= 2 ? pos[1] : '\0';
+        switch (escaped) {
+            case 't': case 'b': case 'n': case 'r': case 'f': case '"': case '\'': case '\\':
+                pos += 2;
+                break;
+            default:
+                if (!parseUchar()) {
+                    return false;
+                }
+        }
+    }
+
+    if (pos < end && *pos == '@') {
+        // 语言标签：[a-zA-Z]+ ('-' [a-zA-Z0-9]+)*
+        ++pos;
+        if (pos == end || !isAlpha(*pos)) {
+            return fail("invalid language tag");
+        }
+        while (pos < end && isAlpha(*pos)) {
+            ++pos;
+        }
+        while (pos < end && *pos == '-') {
+            ++pos;
+            if (pos == end || !isAlnum(*pos)) {
+                return fail("invalid language tag");
+            }
+            while (pos < end && isAlnum(*pos)) {
+                ++pos;
+            }
+        }
+    } else if (end - pos >= 2 && pos[0] == '^' && pos[1] == '^') {
+        pos += 2;
+        std::string_view datatype;
+        if (pos == end || *pos != '<') {
+            return fail("expected datatype IRI after '^^'");
+        }
+        if (!parseIri(datatype)) {
+            return false;
+        }
+    }
+    term = std::string_view(start, pos - start);
+    return true;
+}
+
+void NTriplesTokenizer::skipLine() {
+    while (pos < end && *pos != '\n' && *pos != '\r') {
+        ++pos;
+    }
+}
+
+bool NTriplesTokenizer::fail(const std::string& message) {
+    errors.push_back({line, static_cast<size_t>(pos - lineStart) + 1, message});
+    return false;
+}
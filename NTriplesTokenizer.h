@@ -0,0 +1,65 @@
+#ifndef RDFPANDA_STORAGE_NTRIPLESTOKENIZER_H
+#define RDFPANDA_STORAGE_NTRIPLESTOKENIZER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 解析错误的位置与原因，行号、列号从 1 开始
+struct ParseError {
+    size_t line;
+    size_t column;
+    std::string message;
+};
+
+// 一个三元组的三个项，指向输入缓冲区（零拷贝），缓冲区释放后失效
+// 项的写法与 InputParser 一致：IRI 去掉尖括号；空白节点保留 "_:"；
+// 字面量保留引号及其后的语言标签或 ^^<数据类型>，转义序列保持原样不解码
+struct TermTriple {
+    std::string_view subject;
+    std::string_view predicate;
+    std::string_view object;
+};
+
+// NTriplesTokenizer：手写的单遍 N-Triples 词法/语法分析器，直接在内存缓冲区上工作
+// 覆盖 N-Triples 1.1 的完整文法：IRI（含 \u 转义）、空白节点、带转义的字符串字面量、语言标签、数据类型、注释，
+// 项之间的空白可省略，行尾可为 \n、\r\n 或 \r
+// 不分配内存、不回溯；某行有语法错误时记录行号与原因，跳过该行继续
+class NTriplesTokenizer {
+public:
+    // firstLine 为缓冲区首行的行号（分块解析时使用）
+    NTriplesTokenizer(const char* data, size_t size, size_t firstLine = 1)
+            : pos(data), end(data + size), line(firstLine), lineStart(data) {}
+
+    // 读取下一个三元组，缓冲区结束时返回 false
+    bool next(TermTriple& triple);
+
+    const std::vector<ParseError>& getErrors() const { return errors; }
+    size_t getLine() const { return line; }
+
+private:
+    const char* pos;
+    const char* end;
+    size_t line;
+    const char* lineStart;
+    std::vector<ParseError> errors;
+
+    bool parseTriple(TermTriple& triple);
+    bool parseIri(std::string_view& term);
+    bool parseBlankNode(std::string_view& term);
+    bool parseLiteral(std::string_view& term);
+    bool parseUchar();
+
+    void skipSpaces() {
+        while (pos < end && (*pos == ' ' || *pos == '\t')) {
+            ++pos;
+        }
+    }
+    // 跳到行尾（不越过换行符）
+    void skipLine();
+    bool fail(const std::string& message);
+};
+
+
+#endif //RDFPANDA_STORAGE_NTRIPLESTOKENIZER_H
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include "QueryEngine.h"
+
+namespace {
+
+bool isVariable(const std::string& term) {
+    return !term.empty() && term[0] == '?';
+}
+
+// 结果行的哈希，供 DISTINCT 无法完全在连接中完成时去重
+struct RowHash {
+    size_t operator()(const std::vector<uint32_t>& row) const {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (uint32_t id : row) {
+            h = (h ^ id) * 0x100000001b3ULL;
+        }
+        return static_cast<size_t>(h);
+    }
+};
+
+}
+
+QueryResult QueryEngine::execute(const BGPQuery& query, const RowCallback& onRow) {
+    QueryResult result;
+    const StringPool& pool = store.getStringPool();
+
+    // 编译模式：变量分配槽位，常量查字典但不新增字符串
+    std::unordered_map<std::string, uint32_t> slots;
+    std::vector<std::string> varNames;
+    bool missingConstant = false;
+    auto compileTerm = [&](const std::string& term) {
+        if (!isVariable(term)) {
+            uint32_t id = pool.getIdIfExists(term);
+            if (id == UINT32_MAX) {
+                missingConstant = true;
+            }
+            return JoinTerm::constant(id);
+        }
+        auto it = slots.find(term);
+        if (it == slots.end()) {
+            it = slots.emplace(term, static_cast<uint32_t>(varNames.size())).first;
+            varNames.push_back(term);
+        }
+        return JoinTerm::variable(it->second);
+    };
+    std::vector<JoinAtom> atoms;
+    atoms.reserve(query.patterns.size());
+    for (const auto& pattern : query.patterns) {
+        JoinAtom atom;
+        atom.terms[0] = compileTerm(pattern.subject);
+        atom.terms[1] = compileTerm(pattern.predicate);
+        atom.terms[2] = compileTerm(pattern.object);
+        atoms.push_back(atom);
+    }
+
+    // 输出列
+    const size_t varCount = varNames.size();
+    std::vector<uint32_t> columns;
+    if (query.select.empty()) {
+        for (uint32_t v = 0; v < varCount; ++v) {
+            columns.push_back(v);
+        }
+    } else {
+        for (const auto& name : query.select) {
+            auto it = slots.find(name);
+            if (it == slots.end()) {
+                result.error = "selected variable " + name + " does not occur in the patterns";
+                return result;
+            }
+            columns.push_back(it->second);
+        }
+    }
+    for (uint32_t v : columns) {
+        result.columns.push_back(varNames[v]);
+    }
+    result.ok = true;
+    // 字典中没有的常量不可能匹配
+    if (missingConstant || query.limit == 0) {
+        return result;
+    }
+
+    // 只有 DISTINCT 时才能把未输出变量当作存在性检查；否则每组绑定都要输出（保留重复）
+    std::vector<bool> projected;
+    if (query.distinct) {
+        projected.assign(varCount, false);
+        for (uint32_t v : columns) {
+            projected[v] = true;
+        }
+    }
+    std::vector<bool> prebound(varCount, false);
+    JoinPlan plan = planJoin(store, atoms, varCount, prebound, -1, projected);
+    if (!plan.valid) {
+        result.ok = false;
+        result.error = plan.error;
+        return result;
+    }
+
+    // 未输出变量若排在某个输出变量之前，同一输出行可能由不同取值得到，需要额外去重
+    bool dedup = false;
+    if (query.distinct) {
+        for (size_t depth = 0; depth < plan.existentialDepth; ++depth) {
+            if (!projected[plan.varOrder[depth]]) {
+                dedup = true;
+                break;
+            }
+        }
+    }
+    std::unordered_set<std::vector<uint32_t>, RowHash> seen;
+
+    std::vector<uint32_t> bindings(varCount, UNBOUND_ID);
+    std::vector<uint32_t> row(columns.size());
+    TrieJoin join(plan, stack);
+    join.run(bindings, [&](const std::vector<uint32_t>& b) {
+        for (size_t i = 0; i < columns.size(); ++i) {
+            row[i] = b[columns[i]];
+        }
+        if (dedup && !seen.insert(row).second) {
+            return;
+        }
+        result.rows++;
+        if (!onRow(row) || result.rows >= query.limit) {
+            join.stop();
+        }
+    });
+    return result;
+}
+
+QueryResult QueryEngine::execute(const BGPQuery& query, std::vector<std::vector<uint32_t>>& rows) {
+    return execute(query, [&rows](const std::vector<uint32_t>& row) {
+        rows.push_back(row);
+        return true;
+    });
+}
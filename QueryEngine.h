@@ -0,0 +1,54 @@
+#ifndef RDFPANDA_STORAGE_QUERYENGINE_H
+#define RDFPANDA_STORAGE_QUERYENGINE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Trie.h"
+#include "TrieJoin.h"
+#include "TripleStore.h"
+
+// 基本图模式（BGP）查询：一组可含变量的三元组模式，变量以 ? 开头（与规则写法一致）
+struct BGPQuery {
+    std::vector<Atom> patterns;
+    std::vector<std::string> select;  // 输出的变量，为空表示全部变量（按首次出现顺序）
+    bool distinct = false;            // 去除重复的输出行
+    size_t limit = SIZE_MAX;          // 最多输出的行数
+};
+
+// 查询结果概要，结果行本身通过回调流式输出
+struct QueryResult {
+    bool ok = false;
+    std::string error;
+    std::vector<std::string> columns;  // 输出行中各列对应的变量名
+    size_t rows = 0;                   // 输出的行数
+};
+
+// 每输出一行调用一次，row 为按 columns 排列的字符串池ID；返回 false 提前结束查询
+using RowCallback = std::function<bool(const std::vector<uint32_t>& row)>;
+
+// QueryEngine：在事实库的 Trie 索引上用 Leapfrog Triejoin 执行 BGP 查询
+// 投影、DISTINCT 与 LIMIT 都在连接中完成：
+// - DISTINCT 时未输出的变量按存在性检查处理，找到一个见证即回溯，通常无需再对结果去重
+// - LIMIT 满足后立即停止连接
+// 查询只读事实库，不能与推理等写操作并发
+// 谓语为已注册虚谓语（TripleStore::registerVirtualPredicate）的模式直接读取对应索引
+// 谓语为变量的模式需要事实库已建立 SOP/OSP 索引（TripleStore::enableTrieOrder，含此类模式的规则推理时会自动建立）
+class QueryEngine {
+public:
+    explicit QueryEngine(const TripleStore& store) : store(store) {}
+
+    QueryResult execute(const BGPQuery& query, const RowCallback& onRow);
+
+    // 便捷接口：收集全部结果行
+    QueryResult execute(const BGPQuery& query, std::vector<std::vector<uint32_t>>& rows);
+
+private:
+    const TripleStore& store;
+    JoinStack stack;  // 在多次查询间复用的连接工作区
+};
+
+
+#endif //RDFPANDA_STORAGE_QUERYENGINE_H
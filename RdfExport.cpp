@@ -0,0 +1,490 @@
+#include "RdfExport.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 每块的三元组数，块数远多于线程数时由动态领取平衡负载
+constexpr size_t EXPORT_CHUNK_TRIPLES = 65536;
+constexpr uint16_t NO_PREFIX = UINT16_MAX;
+constexpr size_t MAX_PREFIXES = 4096;
+constexpr std::string_view RDF_TYPE = "http://www.w3.org/1999/02/22-rdf-syntax-ns#type";
+
+// 按偏移写入的输出文件，多个线程可同时写入不相交的区域
+class PositionalFile {
+public:
+    explicit PositionalFile(const std::string& filename) {
+#ifdef _WIN32
+        handle = CreateFileA(filename.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+#else
+        fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+    }
+
+    ~PositionalFile() { close(); }
+
+    PositionalFile(const PositionalFile&) = delete;
+    PositionalFile& operator=(const PositionalFile&) = delete;
+
+    bool isOpen() const {
+#ifdef _WIN32
+        return handle != INVALID_HANDLE_VALUE;
+#else
+        return fd >= 0;
+#endif
+    }
+
+    bool writeAt(const char* data, size_t size, uint64_t offset) {
+        while (size > 0) {
+#ifdef _WIN32
+            DWORD piece = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+            OVERLAPPED position = {};
+            position.Offset = static_cast<DWORD>(offset);
+            position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD written = 0;
+            if (!WriteFile(handle, data, piece, &written, &position) || written == 0) {
+                return false;
+            }
+#else
+            ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return false;
+            }
+#endif
+            data += written;
+            size -= static_cast<size_t>(written);
+            offset += static_cast<uint64_t>(written);
+        }
+        return true;
+    }
+
+    bool close() {
+        bool ok = true;
+#ifdef _WIN32
+        if (handle != INVALID_HANDLE_VALUE) {
+            ok = CloseHandle(handle) != 0;
+            handle = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (fd >= 0) {
+            ok = ::close(fd) == 0;
+            fd = -1;
+        }
+#endif
+        return ok;
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+};
+
+// 按块的顺序分配文件偏移：块 i 等前面的块都取得偏移后才取得自己的，之后各块的写入互不等待
+// 块按递增的顺序被领取，等待的只是前面正在格式化的块
+class OffsetSequencer {
+public:
+    explicit OffsetSequencer(uint64_t start) : end(start) {}
+
+    uint64_t reserve(size_t chunk, size_t size) {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [&] { return next == chunk; });
+        uint64_t offset = end;
+        end += size;
+        next++;
+        ready.notify_all();
+        return offset;
+    }
+
+    uint64_t size() const { return end; }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    size_t next = 0;
+    uint64_t end;
+};
+
+bool isLiteral(std::string_view term) {
+    return !term.empty() && term[0] == '"';
+}
+
+bool isBlankNode(std::string_view term) {
+    return term.size() > 1 && term[0] == '_' && term[1] == ':';
+}
+
+// IRIREF 中不允许出现的字符（控制字符、空格与 <>"{}|^`\），写成 \u00XX
+struct IriEscapes {
+    bool escaped[256] = {};
+
+    IriEscapes() {
+        for (int c = 0; c <= 0x20; ++c) {
+            escaped[c] = true;
+        }
+        for (unsigned char c : std::string_view("<>\"{}|^`\\")) {
+            escaped[c] = true;
+        }
+    }
+};
+
+const IriEscapes IRI_ESCAPES;
+
+// iri[pos] 处的反斜杠开始的完整 \uXXXX 或 \UXXXXXXXX 转义的长度，不是时返回 0
+size_t ucharLength(std::string_view iri, size_t pos) {
+    if (pos + 1 >= iri.size() || (iri[pos + 1] != 'u' && iri[pos + 1] != 'U')) {
+        return 0;
+    }
+    const size_t length = iri[pos + 1] == 'u' ? 6 : 10;
+    if (pos + length > iri.size()) {
+        return 0;
+    }
+    for (size_t i = pos + 2; i < pos + length; ++i) {
+        if (!std::isxdigit(static_cast<unsigned char>(iri[i]))) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+// 字符串池中的 IRI 保留输入中的 \u 转义原样，这些转义照抄；其余需要转义的字符（含单独的反斜杠）写作 \u00XX
+void appendIri(std::string& out, std::string_view iri) {
+    static const char hex[] = "0123456789ABCDEF";
+    out += '<';
+    size_t start = 0;
+    for (size_t i = 0; i < iri.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(iri[i]);
+        if (c == '\\') {
+            size_t length = ucharLength(iri, i);
+            if (length > 0) {
+                i += length - 1;
+                continue;
+            }
+        }
+        if (IRI_ESCAPES.escaped[c]) {
+            out.append(iri.data() + start, i - start);
+            out += "\\u00";
+            out += hex[c >> 4];
+            out += hex[c & 0xf];
+            start = i + 1;
+        }
+    }
+    out.append(iri.data() + start, iri.size() - start);
+    out += '>';
+}
+
+void appendTerm(std::string& out, std::string_view term) {
+    if (isLiteral(term) || isBlankNode(term)) {
+        out.append(term);
+    } else {
+        appendIri(out, term);
+    }
+}
+
+// 局部名能否直接写在前缀名中（PN_LOCAL 的保守子集：字母、数字、'_'、'-'，以及不在首尾的 '.'）
+bool isSimpleLocalName(std::string_view local) {
+    for (size_t i = 0; i < local.size(); ++i) {
+        char c = local[i];
+        bool plain = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        bool inner = i > 0 && (c == '-' || (c == '.' && i + 1 < local.size()));
+        if (!plain && !inner) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 可以写成前缀名的 IRI 的命名空间（到最后一个 '#' 或 '/' 为止），否则返回空
+std::string_view prefixableNamespace(std::string_view term) {
+    if (isLiteral(term) || isBlankNode(term)) {
+        return {};
+    }
+    size_t split = term.find_last_of("#/");
+    if (split == std::string_view::npos || !isSimpleLocalName(term.substr(split + 1))) {
+        return {};
+    }
+    return term.substr(0, split + 1);
+}
+
+// 导出共用的状态：项的视图快照与要导出的三元组
+struct ExportContext {
+    const TripleStore& store;
+    std::vector<std::string_view> terms;
+    uint8_t flags;
+    size_t numThreads;
+    size_t chunkCount;
+
+    ExportContext(const TripleStore& store, const ExportOptions& options)
+            : store(store), terms(store.getStringPool().getStringViews()), flags(options.flags) {
+        numThreads = options.numThreads > 0 ? options.numThreads
+                                            : std::max<size_t>(1, std::thread::hardware_concurrency());
+        chunkCount = (store.getTripleCount() + EXPORT_CHUNK_TRIPLES - 1) / EXPORT_CHUNK_TRIPLES;
+    }
+
+    bool selected(size_t index) const { return (store.getTripleFlags(static_cast<uint32_t>(index)) & flags) != 0; }
+};
+
+// Turtle 的前缀：prefixOf[项ID] 为该项使用的前缀序号，NO_PREFIX 表示写成完整 IRI
+struct PrefixTable {
+    std::vector<std::string> names;
+    std::vector<std::string_view> namespaces;
+    std::vector<uint16_t> prefixOf;
+};
+
+// format(起始下标, 结束下标, 缓冲区) 把一块三元组格式化到缓冲区并返回其中的三元组数；各块依次写在 header 之后
+bool writeChunks(const ExportContext& context, const std::string& filename, const std::string& header,
+                 const std::function<size_t(size_t, size_t, std::string&)>& format, std::string& error,
+                 ExportInfo* info) {
+    PositionalFile file(filename);
+    if (!file.isOpen()) {
+        error = "Unable to open " + filename + " for writing";
+        return false;
+    }
+    bool ok = file.writeAt(header.data(), header.size(), 0);
+    OffsetSequencer offsets(header.size());
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<uint64_t> triples{0};
+    std::atomic<bool> failed{!ok};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < std::min(context.numThreads, context.chunkCount); ++t) {
+        threads.emplace_back([&]() {
+            std::string buffer;
+            for (size_t chunk = nextChunk++; chunk < context.chunkCount; chunk = nextChunk++) {
+                buffer.clear();
+                size_t begin = chunk * EXPORT_CHUNK_TRIPLES;
+                size_t end = std::min(begin + EXPORT_CHUNK_TRIPLES, context.store.getTripleCount());
+                triples += format(begin, end, buffer);
+                // 出错后仍为每块分配偏移，避免后面的块一直等待
+                uint64_t offset = offsets.reserve(chunk, buffer.size());
+                if (!failed && !file.writeAt(buffer.data(), buffer.size(), offset)) {
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (!file.close() || failed) {
+        error = "Failed to write " + filename;
+        return false;
+    }
+    if (info != nullptr) {
+        info->triples = triples;
+        info->bytes = offsets.size();
+    }
+    return true;
+}
+
+// 统计导出的三元组用到的 IRI 的命名空间，为至少两个项共用的命名空间分配前缀（rdf/rdfs/owl/xsd 用通常的名字）
+PrefixTable choosePrefixes(const ExportContext& context) {
+    const auto& ids = context.store.getAllTripleIds();
+    std::vector<uint8_t> used(context.terms.size(), 0);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (context.selected(i)) {
+            used[ids[i].subject_id] = 1;
+            used[ids[i].predicate_id] = 1;
+            used[ids[i].object_id] = 1;
+        }
+    }
+
+    // 各线程统计一段ID，再合并
+    const size_t threadCount = std::max<size_t>(1, std::min(context.numThreads, context.terms.size() / 65536 + 1));
+    std::vector<std::unordered_map<std::string_view, size_t>> counts(threadCount);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            size_t begin = context.terms.size() * t / threadCount;
+            size_t end = context.terms.size() * (t + 1) / threadCount;
+            for (size_t id = begin; id < end; ++id) {
+                std::string_view ns = used[id] ? prefixableNamespace(context.terms[id]) : std::string_view();
+                if (!ns.empty()) {
+                    counts[t][ns]++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t t = 1; t < threadCount; ++t) {
+        for (const auto& entry : counts[t]) {
+            counts[0][entry.first] += entry.second;
+        }
+    }
+
+    std::vector<std::pair<std::string_view, size_t>> candidates;
+    for (const auto& entry : counts[0]) {
+        if (entry.second >= 2) {
+            candidates.emplace_back(entry);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    if (candidates.size() > MAX_PREFIXES) {
+        candidates.resize(MAX_PREFIXES);
+    }
+
+    static const std::pair<std::string_view, const char*> wellKnown[] = {
+            {"http://www.w3.org/1999/02/22-rdf-syntax-ns#", "rdf"},
+            {"http://www.w3.org/2000/01/rdf-schema#", "rdfs"},
+            {"http://www.w3.org/2002/07/owl#", "owl"},
+            {"http://www.w3.org/2001/XMLSchema#", "xsd"}};
+    PrefixTable table;
+    std::unordered_map<std::string_view, uint16_t> index;
+    for (const auto& candidate : candidates) {
+        std::string name = "ns" + std::to_string(table.names.size());
+        for (const auto& known : wellKnown) {
+            if (candidate.first == known.first) {
+                name = known.second;
+            }
+        }
+        index.emplace(candidate.first, static_cast<uint16_t>(table.names.size()));
+        table.names.push_back(name);
+        table.namespaces.push_back(candidate.first);
+    }
+
+    table.prefixOf.assign(context.terms.size(), NO_PREFIX);
+    threads.clear();
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            size_t begin = context.terms.size() * t / threadCount;
+            size_t end = context.terms.size() * (t + 1) / threadCount;
+            for (size_t id = begin; id < end; ++id) {
+                std::string_view ns = used[id] ? prefixableNamespace(context.terms[id]) : std::string_view();
+                auto it = ns.empty() ? index.end() : index.find(ns);
+                if (it != index.end()) {
+                    table.prefixOf[id] = it->second;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return table;
+}
+
+void appendTurtleTerm(std::string& out, const ExportContext& context, const PrefixTable& prefixes, uint32_t id) {
+    std::string_view term = context.terms[id];
+    uint16_t prefix = prefixes.prefixOf[id];
+    if (prefix == NO_PREFIX) {
+        appendTerm(out, term);
+        return;
+    }
+    out += prefixes.names[prefix];
+    out += ':';
+    out.append(term.substr(prefixes.namespaces[prefix].size()));
+}
+
+}
+
+bool exportNTriples(const TripleStore& store, const std::string& filename, std::string& error,
+                    const ExportOptions& options, ExportInfo* info) {
+    ExportContext context(store, options);
+    const auto& ids = store.getAllTripleIds();
+    return writeChunks(context, filename, "", [&](size_t begin, size_t end, std::string& out) {
+        size_t count = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (!context.selected(i)) {
+                continue;
+            }
+            appendTerm(out, context.terms[ids[i].subject_id]);
+            out += ' ';
+            appendTerm(out, context.terms[ids[i].predicate_id]);
+            out += ' ';
+            appendTerm(out, context.terms[ids[i].object_id]);
+            out += " .\n";
+            count++;
+        }
+        return count;
+    }, error, info);
+}
+
+bool exportTurtle(const TripleStore& store, const std::string& filename, std::string& error,
+                  const ExportOptions& options, ExportInfo* info) {
+    ExportContext context(store, options);
+    const auto& ids = store.getAllTripleIds();
+    PrefixTable prefixes = choosePrefixes(context);
+    std::string header;
+    for (size_t i = 0; i < prefixes.names.size(); ++i) {
+        header += "@prefix " + prefixes.names[i] + ": ";
+        appendIri(header, prefixes.namespaces[i]);
+        header += " .\n";
+    }
+    if (!header.empty()) {
+        header += '\n';
+    }
+    const uint32_t rdfType = store.getStringPool().getIdIfExists(RDF_TYPE);
+
+    bool ok = writeChunks(context, filename, header, [&](size_t begin, size_t end, std::string& out) {
+        std::vector<uint32_t> order;
+        for (size_t i = begin; i < end; ++i) {
+            if (context.selected(i)) {
+                order.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            const auto& x = ids[a];
+            const auto& y = ids[b];
+            if (x.subject_id != y.subject_id) return x.subject_id < y.subject_id;
+            if (x.predicate_id != y.predicate_id) return x.predicate_id < y.predicate_id;
+            return x.object_id < y.object_id;
+        });
+        for (size_t k = 0; k < order.size(); ++k) {
+            const auto& triple = ids[order[k]];
+            const auto* previous = k > 0 ? &ids[order[k - 1]] : nullptr;
+            if (previous != nullptr && previous->subject_id == triple.subject_id) {
+                if (previous->predicate_id == triple.predicate_id) {
+                    out += " , ";
+                    appendTurtleTerm(out, context, prefixes, triple.object_id);
+                    continue;
+                }
+                out += " ;\n    ";
+            } else {
+                if (previous != nullptr) {
+                    out += " .\n";
+                }
+                appendTurtleTerm(out, context, prefixes, triple.subject_id);
+                out += ' ';
+            }
+            if (triple.predicate_id == rdfType) {
+                out += 'a';
+            } else {
+                appendTurtleTerm(out, context, prefixes, triple.predicate_id);
+            }
+            out += ' ';
+            appendTurtleTerm(out, context, prefixes, triple.object_id);
+        }
+        if (!order.empty()) {
+            out += " .\n";
+        }
+        return order.size();
+    }, error, info);
+    if (ok && info != nullptr) {
+        info->prefixes = prefixes.names.size();
+    }
+    return ok;
+}
@@ -0,0 +1,34 @@
+#ifndef RDFPANDA_STORAGE_RDFEXPORT_H
+#define RDFPANDA_STORAGE_RDFEXPORT_H
+
+#include <cstdint>
+#include <string>
+
+#include "TripleStore.h"
+
+// 把事实库（含推理结果）导出为 N-Triples 或 Turtle 文本
+// 三元组按下标切成固定大小的块，numThreads 个线程动态领取，各自把一块格式化到自己的缓冲区；
+// 块按顺序取得文件偏移后即用按偏移写（pwrite / 带偏移的 WriteFile）并行写入，输出与单线程导出逐字节相同
+// 项通过字符串池的视图快照按ID解码，格式化时不加锁；项的写法与字符串池一致，只为 IRI 加尖括号（必要时转义）
+struct ExportOptions {
+    uint8_t flags = BASE_FACT | DERIVED_FACT;  // 只导出来源标记含其中任一位的三元组，如 DERIVED_FACT 只导出推导事实
+    size_t numThreads = 0;                     // 0 为硬件线程数
+};
+
+struct ExportInfo {
+    uint64_t triples = 0;
+    uint64_t bytes = 0;
+    uint64_t prefixes = 0;  // Turtle 声明的前缀数
+};
+
+// 每个三元组一行；失败时返回 false 并填写 error
+bool exportNTriples(const TripleStore& store, const std::string& filename, std::string& error,
+                    const ExportOptions& options = ExportOptions(), ExportInfo* info = nullptr);
+
+// 先按导出的 IRI 的命名空间（到最后一个 '#' 或 '/'）声明前缀，局部名合法时写成前缀名；
+// 每块内按 (主语, 谓语, 宾语) 排序后用 ';' 和 ',' 合并同一主语、谓语的三元组，rdf:type 写作 a
+bool exportTurtle(const TripleStore& store, const std::string& filename, std::string& error,
+                  const ExportOptions& options = ExportOptions(), ExportInfo* info = nullptr);
+
+
+#endif //RDFPANDA_STORAGE_RDFEXPORT_H
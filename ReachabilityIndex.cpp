@@ -0,0 +1,321 @@
+#include <algorithm>
+#include "ReachabilityIndex.h"
+
+namespace {
+
+const uint32_t UNVISITED = UINT32_MAX;
+
+// 由边表建立 CSR 邻接表
+void buildAdjacency(size_t nodeCount, const std::vector<std::pair<uint32_t, uint32_t>>& edges,
+                    std::vector<uint32_t>& offsets, std::vector<uint32_t>& adj) {
+    offsets.assign(nodeCount + 1, 0);
+    for (const auto& edge : edges) {
+        offsets[edge.first + 1]++;
+    }
+    for (size_t i = 0; i < nodeCount; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    adj.resize(edges.size());
+    std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+    for (const auto& edge : edges) {
+        adj[next[edge.first]++] = edge.second;
+    }
+}
+
+}
+
+void ReachabilityIndex::Labels::build(const std::vector<uint32_t>& adjOffsets, const std::vector<uint32_t>& adj,
+                                      bool successorsFirst) {
+    const size_t count = adjOffsets.size() - 1;
+    std::vector<uint8_t> hasIncoming(count, 0);
+    for (uint32_t target : adj) {
+        hasIncoming[target] = 1;
+    }
+
+    // 从各个根出发深度优先编后序号，子树占据 [进入时的编号, 自身后序号]
+    post.assign(count, UNVISITED);
+    byPost.assign(count, 0);
+    std::vector<uint32_t> low(count, 0);
+    uint32_t nextPost = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> stack;  // (分量, 下一条待访问的边)
+    auto visit = [&](uint32_t root) {
+        low[root] = nextPost;
+        post[root] = UNVISITED - 1;  // 已进入，尚未完成
+        stack.emplace_back(root, adjOffsets[root]);
+        while (!stack.empty()) {
+            const uint32_t c = stack.back().first;
+            const uint32_t pos = stack.back().second;
+            if (pos < adjOffsets[c + 1]) {
+                stack.back().second++;
+                uint32_t d = adj[pos];
+                if (post[d] == UNVISITED) {
+                    low[d] = nextPost;
+                    post[d] = UNVISITED - 1;
+                    stack.emplace_back(d, adjOffsets[d]);
+                }
+                continue;
+            }
+            post[c] = nextPost;
+            byPost[nextPost++] = c;
+            stack.pop_back();
+        }
+    };
+    for (uint32_t c = 0; c < count; ++c) {
+        if (!hasIncoming[c]) {
+            visit(c);
+        }
+    }
+
+    // 后继的标号先于自身完成：自身子树区间并上所有后继的标号
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> labels(count);
+    std::vector<std::pair<uint32_t, uint32_t>> merged;
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint32_t c = successorsFirst ? i : static_cast<uint32_t>(count - 1 - i);
+        merged.clear();
+        merged.emplace_back(low[c], post[c]);
+        for (uint32_t e = adjOffsets[c]; e < adjOffsets[c + 1]; ++e) {
+            const auto& other = labels[adj[e]];
+            merged.insert(merged.end(), other.begin(), other.end());
+        }
+        std::sort(merged.begin(), merged.end());
+        auto& label = labels[c];
+        for (const auto& interval : merged) {
+            if (!label.empty() && interval.first <= label.back().second + 1) {
+                label.back().second = std::max(label.back().second, interval.second);
+            } else {
+                label.push_back(interval);
+            }
+        }
+    }
+
+    offsets.assign(count + 1, 0);
+    for (uint32_t c = 0; c < count; ++c) {
+        offsets[c + 1] = offsets[c] + static_cast<uint32_t>(labels[c].size());
+    }
+    intervals.clear();
+    intervals.reserve(offsets[count]);
+    for (auto& label : labels) {
+        intervals.insert(intervals.end(), label.begin(), label.end());
+        std::vector<std::pair<uint32_t, uint32_t>>().swap(label);
+    }
+}
+
+bool ReachabilityIndex::Labels::reaches(uint32_t from, uint32_t to) const {
+    const uint32_t p = post[to];
+    auto begin = intervals.begin() + offsets[from];
+    auto end = intervals.begin() + offsets[from + 1];
+    // 第一个起点大于 p 的区间之前的那个区间可能包含 p
+    auto it = std::upper_bound(begin, end, p, [](uint32_t value, const std::pair<uint32_t, uint32_t>& interval) {
+        return value < interval.first;
+    });
+    return it != begin && (it - 1)->second >= p;
+}
+
+void ReachabilityIndex::build() {
+    componentOf.clear();
+    memberOffsets.clear();
+    members.clear();
+    cyclic.clear();
+    hasSuccessor.clear();
+    hasPredecessor.clear();
+    stats = Stats();
+
+    // 边谓语下的全部 (主语, 宾语)，实体映射为稠密下标
+    std::vector<uint32_t> ids;
+    std::unordered_map<uint32_t, uint32_t> dense;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    auto denseOf = [&](uint32_t id) {
+        auto it = dense.find(id);
+        if (it == dense.end()) {
+            it = dense.emplace(id, static_cast<uint32_t>(ids.size())).first;
+            ids.push_back(id);
+        }
+        return it->second;
+    };
+    const uint32_t edgeId = store.getStringPool().getIdIfExists(edgePredicate);
+    auto predicate = store.getTriePSORoot()->children.find(edgeId);
+    if (edgeId != UINT32_MAX && predicate != store.getTriePSORoot()->children.end()) {
+        for (const auto& subject : predicate->second->children) {
+            uint32_t s = denseOf(subject.first);
+            for (const auto& object : subject.second->children) {
+                edges.emplace_back(s, denseOf(object.first));
+            }
+        }
+    }
+    const size_t n = ids.size();
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> adj;
+    buildAdjacency(n, edges, offsets, adj);
+
+    // Tarjan 求强连通分量（显式栈），分量按完成顺序编号，后继分量的编号总小于自身
+    std::vector<uint32_t> index(n, UNVISITED);
+    std::vector<uint32_t> low(n, 0);
+    std::vector<uint8_t> onStack(n, 0);
+    std::vector<uint32_t> component(n, 0);
+    std::vector<uint32_t> sccStack;
+    std::vector<std::pair<uint32_t, uint32_t>> callStack;  // (节点, 下一条待访问的边)
+    uint32_t counter = 0;
+    uint32_t components = 0;
+    for (uint32_t root = 0; root < n; ++root) {
+        if (index[root] != UNVISITED) {
+            continue;
+        }
+        index[root] = low[root] = counter++;
+        sccStack.push_back(root);
+        onStack[root] = 1;
+        callStack.emplace_back(root, offsets[root]);
+        while (!callStack.empty()) {
+            const uint32_t v = callStack.back().first;
+            const uint32_t pos = callStack.back().second;
+            if (pos < offsets[v + 1]) {
+                callStack.back().second++;
+                uint32_t w = adj[pos];
+                if (index[w] == UNVISITED) {
+                    index[w] = low[w] = counter++;
+                    sccStack.push_back(w);
+                    onStack[w] = 1;
+                    callStack.emplace_back(w, offsets[w]);
+                } else if (onStack[w]) {
+                    low[v] = std::min(low[v], index[w]);
+                }
+                continue;
+            }
+            if (low[v] == index[v]) {
+                uint32_t w;
+                do {
+                    w = sccStack.back();
+                    sccStack.pop_back();
+                    onStack[w] = 0;
+                    component[w] = components;
+                } while (w != v);
+                components++;
+            }
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                uint32_t u = callStack.back().first;
+                low[u] = std::min(low[u], low[v]);
+            }
+        }
+    }
+
+    // 分量成员表
+    memberOffsets.assign(components + 1, 0);
+    for (uint32_t v = 0; v < n; ++v) {
+        memberOffsets[component[v] + 1]++;
+    }
+    for (uint32_t c = 0; c < components; ++c) {
+        memberOffsets[c + 1] += memberOffsets[c];
+    }
+    members.resize(n);
+    std::vector<uint32_t> next(memberOffsets.begin(), memberOffsets.end() - 1);
+    componentOf.reserve(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        members[next[component[v]]++] = ids[v];
+        componentOf.emplace(ids[v], component[v]);
+    }
+
+    // 缩点图（去重）及其反向图
+    cyclic.assign(components, 0);
+    hasSuccessor.assign(components, 0);
+    hasPredecessor.assign(components, 0);
+    std::vector<std::pair<uint32_t, uint32_t>> dagEdges;
+    for (const auto& edge : edges) {
+        uint32_t from = component[edge.first];
+        uint32_t to = component[edge.second];
+        if (from == to) {
+            cyclic[from] = 1;  // 分量内的边说明有环（成员多于一个时必然有这样的边）
+        } else {
+            dagEdges.emplace_back(from, to);
+        }
+    }
+    std::sort(dagEdges.begin(), dagEdges.end());
+    dagEdges.erase(std::unique(dagEdges.begin(), dagEdges.end()), dagEdges.end());
+    std::vector<std::pair<uint32_t, uint32_t>> reversed;
+    reversed.reserve(dagEdges.size());
+    for (const auto& edge : dagEdges) {
+        hasSuccessor[edge.first] = 1;
+        hasPredecessor[edge.second] = 1;
+        reversed.emplace_back(edge.second, edge.first);
+    }
+
+    buildAdjacency(components, dagEdges, offsets, adj);
+    forward.build(offsets, adj, true);
+    buildAdjacency(components, reversed, offsets, adj);
+    backward.build(offsets, adj, false);
+
+    // 虚谓语的事实数：各分量成员数乘以其可达的实体数
+    std::vector<uint64_t> prefix(components + 1, 0);
+    for (uint32_t p = 0; p < components; ++p) {
+        uint32_t c = forward.byPost[p];
+        prefix[p + 1] = prefix[p] + (memberOffsets[c + 1] - memberOffsets[c]);
+    }
+    for (uint32_t c = 0; c < components; ++c) {
+        uint64_t size = memberOffsets[c + 1] - memberOffsets[c];
+        uint64_t reached = 0;  // 标号覆盖的实体数，含自身成员
+        for (uint32_t i = forward.offsets[c]; i < forward.offsets[c + 1]; ++i) {
+            reached += prefix[forward.intervals[i].second + 1] - prefix[forward.intervals[i].first];
+        }
+        if (!cyclic[c]) {
+            reached -= size;
+        }
+        stats.pairs += size * reached;
+    }
+    stats.nodes = n;
+    stats.edges = edges.size();
+    stats.components = components;
+    stats.intervals = forward.intervals.size() + backward.intervals.size();
+}
+
+bool ReachabilityIndex::contains(uint32_t subject, uint32_t object) const {
+    uint32_t from = componentOfId(subject);
+    uint32_t to = componentOfId(object);
+    if (from == UINT32_MAX || to == UINT32_MAX) {
+        return false;
+    }
+    if (from == to) {
+        return cyclic[from] != 0;
+    }
+    return forward.reaches(from, to);
+}
+
+void ReachabilityIndex::appendReached(const Labels& labels, uint32_t c, std::vector<uint32_t>& out) const {
+    for (uint32_t i = labels.offsets[c]; i < labels.offsets[c + 1]; ++i) {
+        for (uint32_t p = labels.intervals[i].first; p <= labels.intervals[i].second; ++p) {
+            uint32_t d = labels.byPost[p];
+            if (d == c && !cyclic[c]) {
+                continue;
+            }
+            out.insert(out.end(), members.begin() + memberOffsets[d], members.begin() + memberOffsets[d + 1]);
+        }
+    }
+}
+
+void ReachabilityIndex::objectsOf(uint32_t subject, std::vector<uint32_t>& out) const {
+    uint32_t c = componentOfId(subject);
+    if (c != UINT32_MAX) {
+        appendReached(forward, c, out);
+    }
+}
+
+void ReachabilityIndex::subjectsOf(uint32_t object, std::vector<uint32_t>& out) const {
+    uint32_t c = componentOfId(object);
+    if (c != UINT32_MAX) {
+        appendReached(backward, c, out);
+    }
+}
+
+void ReachabilityIndex::subjects(std::vector<uint32_t>& out) const {
+    for (uint32_t c = 0; c + 1 < memberOffsets.size(); ++c) {
+        if (hasSuccessor[c] || cyclic[c]) {
+            out.insert(out.end(), members.begin() + memberOffsets[c], members.begin() + memberOffsets[c + 1]);
+        }
+    }
+}
+
+void ReachabilityIndex::objects(std::vector<uint32_t>& out) const {
+    for (uint32_t c = 0; c + 1 < memberOffsets.size(); ++c) {
+        if (hasPredecessor[c] || cyclic[c]) {
+            out.insert(out.end(), members.begin() + memberOffsets[c], members.begin() + memberOffsets[c + 1]);
+        }
+    }
+}
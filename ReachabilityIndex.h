@@ -0,0 +1,78 @@
+#ifndef RDFPANDA_STORAGE_REACHABILITYINDEX_H
+#define RDFPANDA_STORAGE_REACHABILITYINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "TripleStore.h"
+
+// ReachabilityIndex：边谓语（如 edge）传递闭包的可达性索引，注册为虚谓语（如 path）后不必物化闭包
+// - 强连通分量缩为一个点，分量内有环（含自环）时成员互相可达，包括到自身
+// - 缩点后的 DAG 上做区间标号（tree cover）：按生成森林的后序编号，每个分量的子树对应一段连续后序号，
+//   其标号为自身子树区间与所有后继标号的并，合并相邻区间后按起点有序
+// - 可达判定在标号中二分查找后序号；后代为标号各区间内的分量；祖先用反向图上的同样标号
+// 标号总长在树状或层次较浅的图上接近节点数，最坏情况（如二部图）为 O(n²)
+// 索引按 build() 时事实库中的边建立，边变化后需重新 build()
+class ReachabilityIndex : public VirtualPredicate {
+public:
+    struct Stats {
+        size_t nodes = 0;
+        size_t edges = 0;
+        size_t components = 0;
+        size_t intervals = 0;   // 正反两向标号的区间总数
+        uint64_t pairs = 0;     // 可达的（主语, 宾语）对数，即虚谓语的事实数
+    };
+
+    ReachabilityIndex(const TripleStore& store, const std::string& edgePredicate)
+            : store(store), edgePredicate(edgePredicate) {}
+
+    void build();
+    const Stats& getStats() const { return stats; }
+
+    bool contains(uint32_t subject, uint32_t object) const override;
+    void objectsOf(uint32_t subject, std::vector<uint32_t>& out) const override;
+    void subjectsOf(uint32_t object, std::vector<uint32_t>& out) const override;
+    void subjects(std::vector<uint32_t>& out) const override;
+    void objects(std::vector<uint32_t>& out) const override;
+    size_t size() const override { return static_cast<size_t>(stats.pairs); }
+
+private:
+    // 缩点后 DAG 一个方向上的区间标号
+    struct Labels {
+        std::vector<uint32_t> post;      // 分量 -> 后序号
+        std::vector<uint32_t> byPost;    // 后序号 -> 分量
+        std::vector<uint32_t> offsets;   // 分量 -> 在 intervals 中的起始位置（多一项作结尾）
+        std::vector<std::pair<uint32_t, uint32_t>> intervals;  // 后序号闭区间
+
+        // adjOffsets / adj 为缩点图一个方向的邻接表（CSR）；successorsFirst 为 true 时后继的分量编号总小于自身，
+        // 否则总大于自身，据此按后继在前的顺序合并标号
+        void build(const std::vector<uint32_t>& adjOffsets, const std::vector<uint32_t>& adj, bool successorsFirst);
+        bool reaches(uint32_t from, uint32_t to) const;
+    };
+
+    const TripleStore& store;
+    std::string edgePredicate;
+    Stats stats;
+
+    std::unordered_map<uint32_t, uint32_t> componentOf;  // 实体ID -> 分量
+    std::vector<uint32_t> memberOffsets;                 // 分量 -> members 中的起始位置（多一项作结尾）
+    std::vector<uint32_t> members;                       // 按分量排列的实体ID
+    std::vector<uint8_t> cyclic;                         // 分量内有环
+    std::vector<uint8_t> hasSuccessor;                   // 缩点图中有出边
+    std::vector<uint8_t> hasPredecessor;                 // 缩点图中有入边
+    Labels forward;
+    Labels backward;
+
+    uint32_t componentOfId(uint32_t id) const {
+        auto it = componentOf.find(id);
+        return it != componentOf.end() ? it->second : UINT32_MAX;
+    }
+    // 按标号追加分量 c 可达的所有实体（不含 c 自身的成员，除非 c 内有环）
+    void appendReached(const Labels& labels, uint32_t c, std::vector<uint32_t>& out) const;
+};
+
+
+#endif //RDFPANDA_STORAGE_REACHABILITYINDEX_H
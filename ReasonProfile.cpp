@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include "ReasonProfile.h"
+
+void RuleProfile::merge(const RuleProfile& other) {
+    invocations += other.invocations;
+    seeks += other.seeks;
+    candidates += other.candidates;
+    emitted += other.emitted;
+    inserted += other.inserted;
+    duplicates += other.duplicates;
+    wallNanos += other.wallNanos;
+    cpuNanos += other.cpuNanos;
+    if (atoms.size() < other.atoms.size()) {
+        atoms.resize(other.atoms.size());
+    }
+    for (size_t i = 0; i < other.atoms.size(); ++i) {
+        atoms[i].triggers += other.atoms[i].triggers;
+        atoms[i].seeks += other.atoms[i].seeks;
+        atoms[i].emitted += other.atoms[i].emitted;
+        atoms[i].inserted += other.atoms[i].inserted;
+        atoms[i].duplicates += other.atoms[i].duplicates;
+        atoms[i].wallNanos += other.atoms[i].wallNanos;
+        atoms[i].cpuNanos += other.atoms[i].cpuNanos;
+    }
+}
+
+uint64_t wallClockNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t threadCpuNanos() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    // POSIX 以及 MinGW-w64（winpthreads）均提供线程CPU时钟
+    timespec ts{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+#endif
+    // 退化为进程CPU时间，多线程时会偏大
+    return static_cast<uint64_t>(std::clock()) * (1000000000ULL / CLOCKS_PER_SEC);
+}
+
+std::string jsonEscape(const std::string& str) {
+    std::string out;
+    out.reserve(str.size() + 2);
+    for (char c : str) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+namespace {
+
+double toMillis(uint64_t nanos) {
+    return nanos / 1e6;
+}
+
+void printProfileTable(std::ostream& os, const std::vector<RuleProfile>& profiles) {
+    // 按耗时排序，占主导的规则排在最前
+    std::vector<size_t> order(profiles.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (profiles[a].wallNanos != profiles[b].wallNanos) {
+            return profiles[a].wallNanos > profiles[b].wallNanos;
+        }
+        return profiles[a].seeks > profiles[b].seeks;
+    });
+
+    // 规则名可能很长（未命名规则用规则头谓语IRI标识），放在最后一列
+    std::ios_base::fmtflags flags = os.flags();
+    os << std::setw(10) << "calls" << std::setw(12) << "seeks" << std::setw(12) << "candidates"
+       << std::setw(10) << "emitted" << std::setw(10) << "new" << std::setw(10) << "dup"
+       << std::setw(11) << "wall(ms)" << std::setw(11) << "cpu(ms)" << "  rule\n";
+    os << std::fixed << std::setprecision(3);
+    for (size_t idx : order) {
+        const RuleProfile& p = profiles[idx];
+        os << std::setw(10) << p.invocations << std::setw(12) << p.seeks << std::setw(12) << p.candidates
+           << std::setw(10) << p.emitted << std::setw(10) << p.inserted << std::setw(10) << p.duplicates
+           << std::setw(11) << toMillis(p.wallNanos) << std::setw(11) << toMillis(p.cpuNanos)
+           << "  " << p.name << '\n';
+        // 各模式：calls 列为以该模式触发的次数，new/dup/耗时为这些触发连接的部分
+        for (size_t a = 0; a < p.atoms.size(); ++a) {
+            const AtomProfile& atom = p.atoms[a];
+            os << std::setw(10) << atom.triggers << std::setw(12) << atom.seeks << std::setw(12) << '-'
+               << std::setw(10) << atom.emitted << std::setw(10) << atom.inserted << std::setw(10) << atom.duplicates
+               << std::setw(11) << toMillis(atom.wallNanos) << std::setw(11) << toMillis(atom.cpuNanos)
+               << "    body[" << a << "]\n";
+        }
+    }
+    os.flags(flags);
+}
+
+void printProfileJson(std::ostream& os, const std::vector<RuleProfile>& profiles) {
+    os << "[";
+    for (size_t i = 0; i < profiles.size(); ++i) {
+        const RuleProfile& p = profiles[i];
+        os << (i ? "," : "") << "\n  {\"name\": \"" << jsonEscape(p.name) << "\""
+           << ", \"invocations\": " << p.invocations
+           << ", \"seeks\": " << p.seeks
+           << ", \"candidates\": " << p.candidates
+           << ", \"emitted\": " << p.emitted
+           << ", \"inserted\": " << p.inserted
+           << ", \"duplicates\": " << p.duplicates
+           << ", \"wallNanos\": " << p.wallNanos
+           << ", \"cpuNanos\": " << p.cpuNanos
+           << ", \"atoms\": [";
+        for (size_t a = 0; a < p.atoms.size(); ++a) {
+            const AtomProfile& atom = p.atoms[a];
+            os << (a ? ", " : "") << "{\"triggers\": " << atom.triggers
+               << ", \"seeks\": " << atom.seeks << ", \"emitted\": " << atom.emitted
+               << ", \"inserted\": " << atom.inserted << ", \"duplicates\": " << atom.duplicates
+               << ", \"wallNanos\": " << atom.wallNanos << ", \"cpuNanos\": " << atom.cpuNanos << "}";
+        }
+        os << "]}";
+    }
+    os << "\n]\n";
+}
+
+}
+
+void printProfile(std::ostream& os, const std::vector<RuleProfile>& profiles, ReportFormat format) {
+    if (format == ReportFormat::Json) {
+        printProfileJson(os, profiles);
+    } else {
+        printProfileTable(os, profiles);
+    }
+}
+
+void printPlan(std::ostream& os, const JoinPlan& plan,
+               const std::function<std::string(const JoinTerm&)>& termName, ReportFormat format) {
+    if (format == ReportFormat::Json) {
+        os << "{\"valid\": " << (plan.valid ? "true" : "false");
+        if (!plan.valid) {
+            os << ", \"error\": \"" << jsonEscape(plan.error) << "\"}";
+            return;
+        }
+        os << ", \"varOrder\": [";
+        for (size_t i = 0; i < plan.varOrder.size(); ++i) {
+            os << (i ? ", " : "") << "\"" << jsonEscape(termName(JoinTerm::variable(plan.varOrder[i]))) << "\"";
+        }
+        os << "], \"existentialDepth\": " << plan.existentialDepth << ", \"atoms\": [";
+        for (size_t a = 0; a < plan.atoms.size(); ++a) {
+            const AtomAccess& access = plan.atoms[a];
+            os << (a ? ", " : "") << "{\"atom\": " << access.atomIdx
+               << ", \"order\": \"" << trieOrderName(access.order) << "\""
+               << ", \"prefix\": " << access.prefixLength << ", \"levels\": [";
+            for (int level = 0; level < 3; ++level) {
+                os << (level ? ", " : "") << "\"" << jsonEscape(termName(access.levels[level])) << "\"";
+            }
+            os << "]}";
+        }
+        os << "], \"virtual\": [";
+        for (size_t v = 0; v < plan.virtuals.size(); ++v) {
+            const VirtualAccess& access = plan.virtuals[v];
+            os << (v ? ", " : "") << "{\"atom\": " << access.atomIdx << ", \"levels\": [\""
+               << jsonEscape(termName(access.subject)) << "\", \"" << jsonEscape(termName(access.object)) << "\"]}";
+        }
+        os << "]}";
+        return;
+    }
+
+    if (!plan.valid) {
+        os << "    invalid: " << plan.error << '\n';
+        return;
+    }
+    os << "    order:";
+    for (size_t i = 0; i < plan.varOrder.size(); ++i) {
+        if (i == plan.existentialDepth) {
+            os << " |";  // 之后的变量只做存在性检查
+        }
+        os << ' ' << termName(JoinTerm::variable(plan.varOrder[i]));
+    }
+    os << '\n';
+    for (const auto& access : plan.atoms) {
+        os << "    body[" << access.atomIdx << "] " << trieOrderName(access.order)
+           << " prefix=" << access.prefixLength << " (";
+        for (int level = 0; level < 3; ++level) {
+            os << (level ? " " : "") << termName(access.levels[level]);
+        }
+        os << ")\n";
+    }
+    for (const auto& access : plan.virtuals) {
+        os << "    body[" << access.atomIdx << "] virtual (" << termName(access.subject) << ' '
+           << termName(access.object) << ")\n";
+    }
+}
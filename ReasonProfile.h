@@ -0,0 +1,63 @@
+#ifndef RDFPANDA_STORAGE_REASONPROFILE_H
+#define RDFPANDA_STORAGE_REASONPROFILE_H
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "TrieJoin.h"
+
+// 推理剖析：按规则和规则体模式统计连接的开销，并输出连接计划（EXPLAIN）
+
+// 报告格式
+enum class ReportFormat {
+    Table,
+    Json
+};
+
+// 规则体中某个模式的统计；除 seeks 外均只计由该模式触发的连接（第一轮全量连接只计入规则）
+struct AtomProfile {
+    uint64_t triggers = 0;    // 以该模式为触发模式执行连接的次数
+    uint64_t seeks = 0;       // 该模式的 Trie 迭代器上的 seek 次数
+    uint64_t emitted = 0;     // 由该模式触发的连接产生的规则头实例数
+    uint64_t inserted = 0;    // 其中写入事实库的新事实数
+    uint64_t duplicates = 0;  // 其中被去重集合拒绝的事实数
+    uint64_t wallNanos = 0;   // 由该模式触发的连接耗时（墙钟）
+    uint64_t cpuNanos = 0;    // 由该模式触发的连接耗时（线程CPU时间）
+};
+
+// 单条规则的统计
+struct RuleProfile {
+    std::string name;
+    uint64_t invocations = 0;  // 连接执行次数（第一轮全量连接与触发连接之和）
+    uint64_t seeks = 0;        // 所有模式上的 seek 次数
+    uint64_t candidates = 0;   // leapfrog 交集得到的候选键数
+    uint64_t emitted = 0;      // 产生的规则头实例数
+    uint64_t inserted = 0;     // 其中写入事实库的新事实数
+    uint64_t duplicates = 0;   // 其中被去重集合拒绝的事实数
+    uint64_t wallNanos = 0;    // 连接耗时（墙钟）
+    uint64_t cpuNanos = 0;     // 连接耗时（线程CPU时间）
+    std::vector<AtomProfile> atoms;
+
+    void merge(const RuleProfile& other);
+};
+
+// 计时：单调墙钟与当前线程的CPU时间，单位纳秒
+uint64_t wallClockNanos();
+uint64_t threadCpuNanos();
+
+// 输出各规则的统计，表格按墙钟耗时从高到低排列，JSON 保持规则顺序
+void printProfile(std::ostream& os, const std::vector<RuleProfile>& profiles, ReportFormat format);
+
+// 输出一个连接计划：变量顺序、存在性检查的起始深度，以及各模式的索引顺序和前缀长度
+// termName 把计划中的项（变量槽位或常量ID）转为可读名称
+void printPlan(std::ostream& os, const JoinPlan& plan,
+               const std::function<std::string(const JoinTerm&)>& termName, ReportFormat format);
+
+// JSON 字符串转义
+std::string jsonEscape(const std::string& str);
+
+
+#endif //RDFPANDA_STORAGE_REASONPROFILE_H
@@ -0,0 +1,553 @@
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include "SchemaReasoner.h"
+#include "DatalogEngine.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+const std::string RDF = "http://www.w3.org/1999/02/22-rdf-syntax-ns#";
+const std::string RDFS = "http://www.w3.org/2000/01/rdf-schema#";
+const std::string OWL = "http://www.w3.org/2002/07/owl#";
+
+const std::string RDF_TYPE = RDF + "type";
+const std::string RDFS_DOMAIN = RDFS + "domain";
+const std::string RDFS_RANGE = RDFS + "range";
+const std::string RDFS_SUBPROPERTY = RDFS + "subPropertyOf";
+const std::string RDFS_SUBCLASS = RDFS + "subClassOf";
+const std::string OWL_INVERSE = OWL + "inverseOf";
+const std::string OWL_EQUIVALENT_PROPERTY = OWL + "equivalentProperty";
+const std::string OWL_EQUIVALENT_CLASS = OWL + "equivalentClass";
+const std::string OWL_SYMMETRIC_PROPERTY = OWL + "SymmetricProperty";
+const std::string OWL_TRANSITIVE_PROPERTY = OWL + "TransitiveProperty";
+
+// 最低的置位位的序号，bits 不能为 0
+inline unsigned lowestBit(uint64_t bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(bits));
+#endif
+}
+
+bool isVariable(const std::string& term) {
+    return !term.empty() && term[0] == '?';
+}
+
+// 内置规则的标准写法
+std::vector<std::pair<SchemaRule, Rule>> schemaRulePatterns() {
+    return {
+        {RDFS2_DOMAIN, Rule("", {{"?p", RDFS_DOMAIN, "?c"}, {"?x", "?p", "?y"}}, {"?x", RDF_TYPE, "?c"})},
+        {RDFS3_RANGE, Rule("", {{"?p", RDFS_RANGE, "?c"}, {"?x", "?p", "?y"}}, {"?y", RDF_TYPE, "?c"})},
+        {RDFS5_SUBPROPERTY_CLOSURE, Rule("", {{"?p", RDFS_SUBPROPERTY, "?q"}, {"?q", RDFS_SUBPROPERTY, "?r"}},
+                                         {"?p", RDFS_SUBPROPERTY, "?r"})},
+        {RDFS7_SUBPROPERTY, Rule("", {{"?p", RDFS_SUBPROPERTY, "?q"}, {"?x", "?p", "?y"}}, {"?x", "?q", "?y"})},
+        {RDFS9_SUBCLASS, Rule("", {{"?c", RDFS_SUBCLASS, "?d"}, {"?x", RDF_TYPE, "?c"}}, {"?x", RDF_TYPE, "?d"})},
+        {RDFS11_SUBCLASS_CLOSURE, Rule("", {{"?c", RDFS_SUBCLASS, "?d"}, {"?d", RDFS_SUBCLASS, "?e"}},
+                                       {"?c", RDFS_SUBCLASS, "?e"})},
+        {OWL_SYMMETRIC, Rule("", {{"?p", RDF_TYPE, OWL_SYMMETRIC_PROPERTY}, {"?x", "?p", "?y"}}, {"?y", "?p", "?x"})},
+        {OWL_TRANSITIVE, Rule("", {{"?p", RDF_TYPE, OWL_TRANSITIVE_PROPERTY}, {"?x", "?p", "?y"}, {"?y", "?p", "?z"}},
+                              {"?x", "?p", "?z"})},
+        {OWL_INVERSE1, Rule("", {{"?p", OWL_INVERSE, "?q"}, {"?x", "?p", "?y"}}, {"?y", "?q", "?x"})},
+        {OWL_INVERSE2, Rule("", {{"?p", OWL_INVERSE, "?q"}, {"?x", "?q", "?y"}}, {"?y", "?p", "?x"})},
+        {OWL_EQUIVALENT_PROPERTY1, Rule("", {{"?p", OWL_EQUIVALENT_PROPERTY, "?q"}, {"?x", "?p", "?y"}}, {"?x", "?q", "?y"})},
+        {OWL_EQUIVALENT_PROPERTY2, Rule("", {{"?p", OWL_EQUIVALENT_PROPERTY, "?q"}, {"?x", "?q", "?y"}}, {"?x", "?p", "?y"})},
+        {OWL_EQUIVALENT_CLASS1, Rule("", {{"?c", OWL_EQUIVALENT_CLASS, "?d"}, {"?x", RDF_TYPE, "?c"}}, {"?x", RDF_TYPE, "?d"})},
+        {OWL_EQUIVALENT_CLASS2, Rule("", {{"?c", OWL_EQUIVALENT_CLASS, "?d"}, {"?x", RDF_TYPE, "?d"}}, {"?x", RDF_TYPE, "?c"})},
+    };
+}
+
+// 规则中的项与标准写法中的项对应：常量必须相同，变量之间保持一一对应
+bool unifyTerm(const std::string& term, const std::string& pattern,
+               std::map<std::string, std::string>& forward, std::map<std::string, std::string>& backward) {
+    if (!isVariable(pattern)) {
+        return term == pattern;
+    }
+    if (!isVariable(term)) {
+        return false;
+    }
+    auto f = forward.find(term);
+    auto b = backward.find(pattern);
+    if (f == forward.end() && b == backward.end()) {
+        forward[term] = pattern;
+        backward[pattern] = term;
+        return true;
+    }
+    return f != forward.end() && b != backward.end() && f->second == pattern && b->second == term;
+}
+
+bool unifyAtom(const Atom& atom, const Atom& pattern,
+               std::map<std::string, std::string>& forward, std::map<std::string, std::string>& backward) {
+    return unifyTerm(atom.subject, pattern.subject, forward, backward) &&
+           unifyTerm(atom.predicate, pattern.predicate, forward, backward) &&
+           unifyTerm(atom.object, pattern.object, forward, backward);
+}
+
+}
+
+bool sameRule(const Rule& rule, const Rule& pattern) {
+    if (rule.body.size() != pattern.body.size()) {
+        return false;
+    }
+    std::vector<size_t> order(rule.body.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    do {
+        std::map<std::string, std::string> forward;
+        std::map<std::string, std::string> backward;
+        bool matched = unifyAtom(rule.head, pattern.head, forward, backward);
+        for (size_t i = 0; i < order.size() && matched; ++i) {
+            matched = unifyAtom(rule.body[order[i]], pattern.body[i], forward, backward);
+        }
+        if (matched) {
+            return true;
+        }
+    } while (std::next_permutation(order.begin(), order.end()));
+    return false;
+}
+
+namespace {
+
+const TrieNode* child(const TrieNode* node, uint32_t key) {
+    if (node == nullptr || key == UINT32_MAX) {
+        return nullptr;
+    }
+    auto it = node->children.find(key);
+    return it != node->children.end() ? it->second : nullptr;
+}
+
+}
+
+uint32_t recognizeSchemaRules(const std::vector<Rule>& rules, std::vector<Rule>& remaining) {
+    const auto patterns = schemaRulePatterns();
+    uint32_t recognized = 0;
+    for (const auto& rule : rules) {
+        bool builtin = false;
+        for (const auto& pattern : patterns) {
+            if (sameRule(rule, pattern.second)) {
+                recognized |= pattern.first;
+                builtin = true;
+                break;
+            }
+        }
+        if (!builtin) {
+            remaining.push_back(rule);
+        }
+    }
+    return recognized;
+}
+
+uint32_t SchemaReasoner::id(const std::string& iri) const {
+    return store.getStringPool().getIdIfExists(iri);
+}
+
+SchemaReasoner::Edges SchemaReasoner::edgesOf(uint32_t predicate) const {
+    Edges edges;
+    const TrieNode* node = child(store.getTriePSORoot(), predicate);
+    if (node == nullptr) {
+        return edges;
+    }
+    for (const auto& subject : node->children) {
+        for (const auto& object : subject.second->children) {
+            edges.emplace_back(subject.first, object.first);
+        }
+    }
+    return edges;
+}
+
+std::vector<uint32_t> SchemaReasoner::subjectsOf(uint32_t predicate, uint32_t object) const {
+    std::vector<uint32_t> subjects;
+    const TrieNode* node = child(child(store.getTriePOSRoot(), predicate), object);
+    if (node != nullptr) {
+        for (const auto& subject : node->children) {
+            subjects.push_back(subject.first);
+        }
+    }
+    return subjects;
+}
+
+SchemaReasoner::Closure SchemaReasoner::closureOf(const Edges& edges) {
+    std::unordered_map<uint32_t, std::vector<uint32_t>> adjacency;
+    for (const auto& edge : edges) {
+        adjacency[edge.first].push_back(edge.second);
+    }
+    // 模式层次通常很小，逐个节点做一次遍历
+    Closure closure;
+    for (const auto& entry : adjacency) {
+        std::unordered_set<uint32_t> visited;
+        std::vector<uint32_t> stack(entry.second.begin(), entry.second.end());
+        while (!stack.empty()) {
+            uint32_t node = stack.back();
+            stack.pop_back();
+            if (!visited.insert(node).second) {
+                continue;
+            }
+            auto next = adjacency.find(node);
+            if (next != adjacency.end()) {
+                stack.insert(stack.end(), next->second.begin(), next->second.end());
+            }
+        }
+        std::vector<uint32_t>& reachable = closure[entry.first];
+        reachable.assign(visited.begin(), visited.end());
+        std::sort(reachable.begin(), reachable.end());
+    }
+    return closure;
+}
+
+size_t SchemaReasoner::schemaSignature() const {
+    size_t count = 0;
+    for (const std::string* iri : {&RDFS_SUBPROPERTY, &RDFS_SUBCLASS, &RDFS_DOMAIN, &RDFS_RANGE,
+                                   &OWL_INVERSE, &OWL_EQUIVALENT_PROPERTY, &OWL_EQUIVALENT_CLASS}) {
+        uint32_t predicate = id(*iri);
+        if (predicate != UINT32_MAX) {
+            count += store.getPredicateCount(predicate);
+        }
+    }
+    count += subjectsOf(typeId, id(OWL_SYMMETRIC_PROPERTY)).size();
+    count += subjectsOf(typeId, id(OWL_TRANSITIVE_PROPERTY)).size();
+    return count;
+}
+
+bool SchemaReasoner::add(uint32_t subject, uint32_t predicate, uint32_t object) {
+    return store.addTriple(Triple(subject, predicate, object), DERIVED_FACT);
+}
+
+size_t SchemaReasoner::materialize() {
+    // 产生类型的规则需要 rdf:type，事实库中没有时与通用引擎编译规则时一样加入字符串池
+    typeId = id(RDF_TYPE);
+    if (typeId == UINT32_MAX && has(RDFS2_DOMAIN | RDFS3_RANGE)) {
+        typeId = store.getStringPool().getId(RDF_TYPE);
+    }
+
+    size_t total = 0;
+    while (true) {
+        stats.passes++;
+        total += hierarchyPass();
+        const size_t schema = schemaSignature();
+        bool typeActive = false;  // rdf:type 三元组本身是否会触发属性规则或 domain/range
+        total += propertyPass(typeActive);
+        size_t types = domainRangePass(typeActive);
+        types += typePass();
+        total += types;
+        // 本轮推导出的模式三元组改变了层次，或新类型还需经过属性规则，再做一轮
+        if (schemaSignature() == schema && !(typeActive && types > 0)) {
+            break;
+        }
+    }
+    return total;
+}
+
+size_t SchemaReasoner::hierarchyPass() {
+    size_t inserted = 0;
+    const std::pair<SchemaRule, const std::string*> closures[] = {
+        {RDFS5_SUBPROPERTY_CLOSURE, &RDFS_SUBPROPERTY},
+        {RDFS11_SUBCLASS_CLOSURE, &RDFS_SUBCLASS},
+    };
+    for (const auto& entry : closures) {
+        uint32_t predicate = id(*entry.second);
+        if (!has(entry.first) || predicate == UINT32_MAX) {
+            continue;
+        }
+        for (const auto& reachable : closureOf(edgesOf(predicate))) {
+            for (uint32_t super : reachable.second) {
+                inserted += add(reachable.first, predicate, super);
+            }
+        }
+    }
+    stats.hierarchy += inserted;
+    return inserted;
+}
+
+size_t SchemaReasoner::propertyPass(bool& typeActive) {
+    // 直接复制的边（子属性、等价属性）取闭包，交换主宾的边（互逆、对称）和传递属性逐个三元组处理
+    Edges straight;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> swapped;
+    if (has(RDFS7_SUBPROPERTY)) {
+        Edges edges = edgesOf(id(RDFS_SUBPROPERTY));
+        straight.insert(straight.end(), edges.begin(), edges.end());
+    }
+    for (const auto& edge : edgesOf(id(OWL_EQUIVALENT_PROPERTY))) {
+        if (has(OWL_EQUIVALENT_PROPERTY1)) {
+            straight.emplace_back(edge.first, edge.second);
+        }
+        if (has(OWL_EQUIVALENT_PROPERTY2)) {
+            straight.emplace_back(edge.second, edge.first);
+        }
+    }
+    for (const auto& edge : edgesOf(id(OWL_INVERSE))) {
+        if (has(OWL_INVERSE1)) {
+            swapped[edge.first].push_back(edge.second);
+        }
+        if (has(OWL_INVERSE2)) {
+            swapped[edge.second].push_back(edge.first);
+        }
+    }
+    if (has(OWL_SYMMETRIC)) {
+        for (uint32_t property : subjectsOf(typeId, id(OWL_SYMMETRIC_PROPERTY))) {
+            swapped[property].push_back(property);
+        }
+    }
+    std::unordered_set<uint32_t> transitive;
+    if (has(OWL_TRANSITIVE)) {
+        for (uint32_t property : subjectsOf(typeId, id(OWL_TRANSITIVE_PROPERTY))) {
+            transitive.insert(property);
+        }
+    }
+    const Closure supers = closureOf(straight);
+    typeActive = typeActive || supers.count(typeId) || swapped.count(typeId) || transitive.count(typeId);
+    if (supers.empty() && swapped.empty() && transitive.empty()) {
+        return 0;
+    }
+
+    // 工作表中的三元组：copied 表示它由直接复制得到，其上位属性已由来源三元组一并写入
+    struct Item {
+        uint32_t subject;
+        uint32_t predicate;
+        uint32_t object;
+        bool copied;
+    };
+    auto pending = [&](const Item& item) {
+        return (!item.copied && supers.count(item.predicate)) || swapped.count(item.predicate) ||
+               transitive.count(item.predicate);
+    };
+
+    std::vector<Item> work;
+    std::set<uint32_t> properties;
+    for (const auto& entry : supers) {
+        properties.insert(entry.first);
+    }
+    for (const auto& entry : swapped) {
+        properties.insert(entry.first);
+    }
+    properties.insert(transitive.begin(), transitive.end());
+    for (uint32_t property : properties) {
+        for (const auto& edge : edgesOf(property)) {
+            work.push_back({edge.first, property, edge.second, false});
+        }
+    }
+
+    size_t inserted = 0;
+    std::vector<Item> next;
+    const TrieNode* pso = store.getTriePSORoot();
+    const TrieNode* pos = store.getTriePOSRoot();
+    while (!work.empty()) {
+        const Item item = work.back();
+        work.pop_back();
+
+        // 先收集再写入，写入会修改正在读取的 Trie
+        next.clear();
+        if (!item.copied) {
+            auto it = supers.find(item.predicate);
+            if (it != supers.end()) {
+                for (uint32_t super : it->second) {
+                    next.push_back({item.subject, super, item.object, true});
+                }
+            }
+        }
+        auto it = swapped.find(item.predicate);
+        if (it != swapped.end()) {
+            for (uint32_t target : it->second) {
+                next.push_back({item.object, target, item.subject, false});
+            }
+        }
+        if (transitive.count(item.predicate)) {
+            // 新的 (x, p, y) 向后接上 (y, p, z)，向前接上 (w, p, x)
+            if (const TrieNode* node = child(child(pso, item.predicate), item.object)) {
+                for (const auto& object : node->children) {
+                    next.push_back({item.subject, item.predicate, object.first, false});
+                }
+            }
+            if (const TrieNode* node = child(child(pos, item.predicate), item.subject)) {
+                for (const auto& subject : node->children) {
+                    next.push_back({subject.first, item.predicate, item.object, false});
+                }
+            }
+        }
+
+        for (const auto& fact : next) {
+            if (add(fact.subject, fact.predicate, fact.object)) {
+                inserted++;
+                if (pending(fact)) {
+                    work.push_back(fact);
+                }
+            }
+        }
+    }
+    stats.properties += inserted;
+    return inserted;
+}
+
+size_t SchemaReasoner::domainRangePass(bool& typeActive) {
+    std::map<uint32_t, std::vector<uint32_t>> domains;
+    std::map<uint32_t, std::vector<uint32_t>> ranges;
+    if (has(RDFS2_DOMAIN)) {
+        for (const auto& edge : edgesOf(id(RDFS_DOMAIN))) {
+            domains[edge.first].push_back(edge.second);
+        }
+    }
+    if (has(RDFS3_RANGE)) {
+        for (const auto& edge : edgesOf(id(RDFS_RANGE))) {
+            ranges[edge.first].push_back(edge.second);
+        }
+    }
+    typeActive = typeActive || domains.count(typeId) || ranges.count(typeId);
+
+    // 主语（宾语）在 PSO（POS）索引中就是谓语下的第一层，整段取出即可
+    Edges types;
+    for (const auto& entry : domains) {
+        if (const TrieNode* node = child(store.getTriePSORoot(), entry.first)) {
+            for (const auto& subject : node->children) {
+                for (uint32_t cls : entry.second) {
+                    types.emplace_back(subject.first, cls);
+                }
+            }
+        }
+    }
+    for (const auto& entry : ranges) {
+        if (const TrieNode* node = child(store.getTriePOSRoot(), entry.first)) {
+            for (const auto& object : node->children) {
+                for (uint32_t cls : entry.second) {
+                    types.emplace_back(object.first, cls);
+                }
+            }
+        }
+    }
+
+    size_t inserted = 0;
+    for (const auto& type : types) {
+        inserted += add(type.first, typeId, type.second);
+    }
+    stats.domainRange += inserted;
+    return inserted;
+}
+
+size_t SchemaReasoner::typePass() {
+    Edges edges;
+    if (has(RDFS9_SUBCLASS)) {
+        edges = edgesOf(id(RDFS_SUBCLASS));
+    }
+    for (const auto& edge : edgesOf(id(OWL_EQUIVALENT_CLASS))) {
+        if (has(OWL_EQUIVALENT_CLASS1)) {
+            edges.emplace_back(edge.first, edge.second);
+        }
+        if (has(OWL_EQUIVALENT_CLASS2)) {
+            edges.emplace_back(edge.second, edge.first);
+        }
+    }
+    const Closure supers = closureOf(edges);
+    const TrieNode* typeNode = child(store.getTriePOSRoot(), typeId);
+    if (supers.empty() || typeNode == nullptr) {
+        return 0;
+    }
+
+    // 层次中出现的类编号为位下标，每个类的上位类闭包是一行位图
+    std::vector<uint32_t> classes;
+    std::unordered_map<uint32_t, uint32_t> bit;
+    auto indexOf = [&](uint32_t cls) {
+        auto it = bit.find(cls);
+        if (it == bit.end()) {
+            it = bit.emplace(cls, static_cast<uint32_t>(classes.size())).first;
+            classes.push_back(cls);
+        }
+        return it->second;
+    };
+    for (const auto& entry : supers) {
+        indexOf(entry.first);
+        for (uint32_t super : entry.second) {
+            indexOf(super);
+        }
+    }
+    const size_t words = (classes.size() + 63) / 64;
+    std::vector<uint64_t> superBits(classes.size() * words, 0);
+    for (const auto& entry : supers) {
+        uint64_t* row = &superBits[bit[entry.first] * words];
+        for (uint32_t super : entry.second) {
+            uint32_t b = bit[super];
+            row[b / 64] |= 1ULL << (b % 64);
+        }
+    }
+
+    // 每个主语在层次中的已有类型
+    std::vector<uint32_t> subjects;
+    std::unordered_map<uint32_t, size_t> rows;
+    std::vector<uint64_t> own;
+    for (uint32_t b = 0; b < classes.size(); ++b) {
+        const TrieNode* node = child(typeNode, classes[b]);
+        if (node == nullptr) {
+            continue;
+        }
+        for (const auto& subject : node->children) {
+            auto it = rows.find(subject.first);
+            if (it == rows.end()) {
+                it = rows.emplace(subject.first, subjects.size()).first;
+                subjects.push_back(subject.first);
+                own.resize(own.size() + words, 0);
+            }
+            own[it->second * words + b / 64] |= 1ULL << (b % 64);
+        }
+    }
+
+    // 已有类型的上位类按位或，去掉已有的即为新类型
+    Edges types;
+    std::vector<uint64_t> reach(words);
+    for (size_t s = 0; s < subjects.size(); ++s) {
+        const uint64_t* mine = &own[s * words];
+        std::fill(reach.begin(), reach.end(), 0);
+        for (size_t w = 0; w < words; ++w) {
+            for (uint64_t bits = mine[w]; bits; bits &= bits - 1) {
+                const uint64_t* row = &superBits[(w * 64 + lowestBit(bits)) * words];
+                for (size_t k = 0; k < words; ++k) {
+                    reach[k] |= row[k];
+                }
+            }
+        }
+        for (size_t w = 0; w < words; ++w) {
+            for (uint64_t bits = reach[w] & ~mine[w]; bits; bits &= bits - 1) {
+                types.emplace_back(subjects[s], classes[w * 64 + lowestBit(bits)]);
+            }
+        }
+    }
+
+    size_t inserted = 0;
+    for (const auto& type : types) {
+        inserted += add(type.first, typeId, type.second);
+    }
+    stats.types += inserted;
+    return inserted;
+}
+
+void reasonWithSchema(TripleStore& store, const std::vector<Rule>& rules) {
+    std::vector<Rule> remaining;
+    const uint32_t builtin = recognizeSchemaRules(rules, remaining);
+    std::cout << "Built-in schema rules:            " << rules.size() - remaining.size()
+              << " of " << rules.size() << std::endl;
+    if (builtin == 0) {
+        DatalogEngine engine(store, rules);
+        engine.reason();
+        return;
+    }
+
+    // 其余规则可能推导出模式三元组或新的类型，二者交替直到都不再产生新事实
+    SchemaReasoner schema(store, builtin);
+    while (true) {
+        size_t inserted = schema.materialize();
+        std::cout << "Schema closure inserted:          " << inserted << std::endl;
+        if (remaining.empty()) {
+            break;
+        }
+        const size_t before = store.getTripleCount();
+        DatalogEngine engine(store, remaining);
+        engine.reason();
+        if (store.getTripleCount() == before) {
+            break;
+        }
+    }
+}
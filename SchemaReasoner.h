@@ -0,0 +1,96 @@
+#ifndef RDFPANDA_STORAGE_SCHEMAREASONER_H
+#define RDFPANDA_STORAGE_SCHEMAREASONER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Trie.h"
+#include "TripleStore.h"
+
+// 内置的 RDFS / OWL-RL 子集规则，按位组合
+// 每一种对应一条通用 Datalog 规则（写法见 input_examples/owl-rl.dl），内置闭包的结果与通用引擎执行这些规则一致
+enum SchemaRule : uint32_t {
+    RDFS2_DOMAIN = 1u << 0,            // rdf:type(?X, ?C) :- rdfs:domain(?P, ?C), ?P(?X, ?Y)
+    RDFS3_RANGE = 1u << 1,             // rdf:type(?Y, ?C) :- rdfs:range(?P, ?C), ?P(?X, ?Y)
+    RDFS5_SUBPROPERTY_CLOSURE = 1u << 2,  // subPropertyOf 传递
+    RDFS7_SUBPROPERTY = 1u << 3,       // ?Q(?X, ?Y) :- rdfs:subPropertyOf(?P, ?Q), ?P(?X, ?Y)
+    RDFS9_SUBCLASS = 1u << 4,          // rdf:type(?X, ?D) :- rdfs:subClassOf(?C, ?D), rdf:type(?X, ?C)
+    RDFS11_SUBCLASS_CLOSURE = 1u << 5,    // subClassOf 传递
+    OWL_SYMMETRIC = 1u << 6,           // prp-symp
+    OWL_TRANSITIVE = 1u << 7,          // prp-trp
+    OWL_INVERSE1 = 1u << 8,            // prp-inv1：?Q(?Y, ?X) :- owl:inverseOf(?P, ?Q), ?P(?X, ?Y)
+    OWL_INVERSE2 = 1u << 9,            // prp-inv2：?P(?Y, ?X) :- owl:inverseOf(?P, ?Q), ?Q(?X, ?Y)
+    OWL_EQUIVALENT_PROPERTY1 = 1u << 10,  // prp-eqp1
+    OWL_EQUIVALENT_PROPERTY2 = 1u << 11,  // prp-eqp2
+    OWL_EQUIVALENT_CLASS1 = 1u << 12,     // cax-eqc1
+    OWL_EQUIVALENT_CLASS2 = 1u << 13,     // cax-eqc2
+};
+
+// 两条规则在变量改名和规则体重排下是否相同（常量须完全一致）
+bool sameRule(const Rule& rule, const Rule& pattern);
+
+// 在规则集中识别内置规则（变量改名、规则体顺序不同也能识别），返回识别出的种类，其余规则追加到 remaining
+uint32_t recognizeSchemaRules(const std::vector<Rule>& rules, std::vector<Rule>& remaining);
+
+// SchemaReasoner：不经过通用连接，直接按模式词汇计算 RDFS / OWL-RL 子集的闭包
+// - 先由 subPropertyOf / subClassOf 等模式三元组算出属性和类的层次闭包（每轮只算一次）
+// - 属性层次：每个三元组按闭包一次复制到所有上位属性；对称、互逆、传递属性用工作表半朴素地处理
+// - domain / range 按属性在 PSO / POS 索引上整段产生类型
+// - 类型传播：每个主语的类型集合用稠密位图表示，与各类的上位类位图按位或，一次得到全部新类型
+// 推理产生的模式三元组（如属性层次本身被推导）改变层次时再做一轮，直到不动点
+// 单线程执行，写入事实库，不可与其他读写并发
+class SchemaReasoner {
+public:
+    struct Stats {
+        size_t passes = 0;
+        size_t hierarchy = 0;   // rdfs5 / rdfs11 写入的层次闭包三元组
+        size_t properties = 0;  // 属性层次、对称、互逆、传递产生的三元组
+        size_t domainRange = 0; // domain / range 产生的类型
+        size_t types = 0;       // 类层次传播产生的类型
+    };
+
+    SchemaReasoner(TripleStore& store, uint32_t enabledRules) : store(store), enabled(enabledRules) {}
+
+    // 计算闭包并写入事实库，返回新写入的三元组数
+    size_t materialize();
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    TripleStore& store;
+    uint32_t enabled;
+    Stats stats;
+    uint32_t typeId = UINT32_MAX;  // rdf:type
+
+    using Edges = std::vector<std::pair<uint32_t, uint32_t>>;
+    using Closure = std::unordered_map<uint32_t, std::vector<uint32_t>>;
+
+    bool has(uint32_t rules) const { return (enabled & rules) != 0; }
+    uint32_t id(const std::string& iri) const;
+
+    // 谓语为 predicate 的全部 (主语, 宾语)
+    Edges edgesOf(uint32_t predicate) const;
+    // 谓语为 predicate、宾语为 object 的全部主语
+    std::vector<uint32_t> subjectsOf(uint32_t predicate, uint32_t object) const;
+    // 有向图中每个节点经一条及以上的边可达的节点（有序）
+    static Closure closureOf(const Edges& edges);
+
+    // 模式三元组的数量，一轮前后不同说明层次发生了变化
+    size_t schemaSignature() const;
+
+    bool add(uint32_t subject, uint32_t predicate, uint32_t object);
+
+    size_t hierarchyPass();
+    size_t propertyPass(bool& typeActive);
+    size_t domainRangePass(bool& typeActive);
+    size_t typePass();
+};
+
+// 推理入口：识别规则集中的内置规则用 SchemaReasoner 计算，其余规则交给 DatalogEngine，二者交替直到不动点
+void reasonWithSchema(TripleStore& store, const std::vector<Rule>& rules);
+
+
+#endif //RDFPANDA_STORAGE_SCHEMAREASONER_H
@@ -1,20 +1,27 @@
 #ifndef STRINGPOOL_H
 #define STRINGPOOL_H
 
+#include <deque>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
+#include <atomic>
 #include <shared_mutex>
 #include <cstdint>
 #include <mutex>
 
 class StringPool {
 private:
-    // 双向映射
-    std::unordered_map<std::string, uint32_t> str_to_id;
-    std::vector<std::string> id_to_str;
+    // 双向映射：字符串只在 id_to_str 中存一份，str_to_id 的键指向它
+    // deque 追加元素时已有元素不移动，短字符串（SSO）的视图也保持有效；按 string_view 查找，解析器无需先构造 std::string
+    std::unordered_map<std::string_view, uint32_t> str_to_id;
+    std::deque<std::string> id_to_str;
     
     uint32_t next_id = 0;
+
+    // 已开始解析的文档数：Turtle 解析器按文档编号区分各文件的空白节点
+    std::atomic<uint32_t> next_document{0};
     
     // 读写锁：读多写少的场景
     mutable std::shared_mutex pool_mutex;
@@ -27,11 +34,10 @@ public:
     StringPool() {
         // 预留空间避免频繁扩容
         str_to_id.reserve(1000000);
-        id_to_str.reserve(1000000);
     }
 
-    // 获取字符串对应的ID，不存在则创建（带预分配优化）
-    uint32_t getId(const std::string& str) {
+    // 获取字符串对应的ID，不存在则创建
+    uint32_t getId(std::string_view str) {
         // 先尝试读锁（大部分情况是查找已存在的字符串）
         {
             std::shared_lock<std::shared_mutex> read_lock(pool_mutex);
@@ -53,14 +59,8 @@ public:
         // 真正的插入操作
         uint32_t id = next_id++;
         
-        // 预分配策略：当容量不足时预分配更多空间
-        if (id_to_str.size() >= id_to_str.capacity()) {
-            size_t new_capacity = id_to_str.capacity() * 2;
-            id_to_str.reserve(new_capacity);
-        }
-        
-        str_to_id.emplace(str, id);
-        id_to_str.push_back(str);
+        id_to_str.emplace_back(str);
+        str_to_id.emplace(std::string_view(id_to_str.back()), id);
         
         // 更新统计
         total_string_bytes += str.size();
@@ -79,14 +79,21 @@ public:
         return id_to_str[id];
     }
     
+    // 所有字符串的视图（下标为ID），只在取得时加一次读锁，之后按ID读取不再加锁；
+    // deque 追加时已有元素不移动，视图在池被 clear 之前一直有效。用于导出等大量解码ID的场合
+    std::vector<std::string_view> getStringViews() const {
+        std::shared_lock<std::shared_mutex> read_lock(pool_mutex);
+        return std::vector<std::string_view>(id_to_str.begin(), id_to_str.end());
+    }
+
     // 检查字符串是否存在
-    bool contains(const std::string& str) const {
+    bool contains(std::string_view str) const {
         std::shared_lock<std::shared_mutex> read_lock(pool_mutex);
         return str_to_id.find(str) != str_to_id.end();
     }
     
     // 获取ID（不创建新的）
-    uint32_t getIdIfExists(const std::string& str) const {
+    uint32_t getIdIfExists(std::string_view str) const {
         std::shared_lock<std::shared_mutex> read_lock(pool_mutex);
         auto it = str_to_id.find(str);
         return (it != str_to_id.end()) ? it->second : UINT32_MAX;
@@ -106,7 +113,7 @@ public:
         return {
             unique_strings,
             total_string_bytes,
-            str_to_id.size() * (sizeof(std::string) + sizeof(uint32_t)),
+            str_to_id.size() * (sizeof(std::string_view) + sizeof(uint32_t)),
             static_cast<double>(estimated_original_size) / (total_string_bytes > 0 ? total_string_bytes : 1)
         };
     }
@@ -121,6 +128,11 @@ public:
         unique_strings = 0;
     }
 
+    // 为一次文档解析分配编号，同一个池中各次解析的编号不同
+    uint32_t nextDocumentId() {
+        return ++next_document;
+    }
+
     // 获取当前唯一字符串数量
     size_t size() const {
         std::shared_lock<std::shared_mutex> read_lock(pool_mutex);
@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include "TableMapping.h"
+#include "TurtleParser.h"
+
+namespace {
+
+const std::string RR = "http://www.w3.org/ns/r2rml#";
+const std::string RDF_TYPE = "http://www.w3.org/1999/02/22-rdf-syntax-ns#type";
+
+// 字面量项的词法形式：去掉引号及其后的语言标签或类型，还原 N-Triples 转义
+std::string lexicalForm(const std::string& term) {
+    size_t close = term.rfind('"');
+    if (term.empty() || term[0] != '"' || close == 0) {
+        return term;
+    }
+    std::string text;
+    for (size_t i = 1; i < close; ++i) {
+        if (term[i] == '\\' && i + 1 < close) {
+            char c = term[++i];
+            text.push_back(c == 'n' ? '\n' : c == 't' ? '\t' : c == 'r' ? '\r' : c);
+        } else {
+            text.push_back(term[i]);
+        }
+    }
+    return text;
+}
+
+// 映射文件解析出的图
+class MappingGraph {
+public:
+    StringPool pool;
+    std::vector<uint32_t> subjects;  // 按首次出现的顺序
+
+    void add(const Triple& triple) {
+        auto& edges = outgoing[triple.getSubjectId()];
+        if (edges.empty()) {
+            subjects.push_back(triple.getSubjectId());
+        }
+        edges.emplace_back(triple.getPredicateId(), triple.getObjectId());
+    }
+
+    std::vector<uint32_t> objects(uint32_t node, const std::string& property) const {
+        std::vector<uint32_t> result;
+        auto it = outgoing.find(node);
+        uint32_t predicate = pool.getIdIfExists(RR + property);
+        if (it != outgoing.end() && predicate != UINT32_MAX) {
+            for (const auto& edge : it->second) {
+                if (edge.first == predicate) {
+                    result.push_back(edge.second);
+                }
+            }
+        }
+        return result;
+    }
+
+    bool object(uint32_t node, const std::string& property, uint32_t& value) const {
+        std::vector<uint32_t> values = objects(node, property);
+        if (values.empty()) {
+            return false;
+        }
+        value = values.front();
+        return true;
+    }
+
+    const std::string& text(uint32_t id) const { return pool.getString(id); }
+
+private:
+    std::unordered_map<uint32_t, std::vector<std::pair<uint32_t, uint32_t>>> outgoing;
+};
+
+TermMap::TermType constantTermType(const std::string& term) {
+    return term.compare(0, 1, "\"") == 0   ? TermMap::Literal
+           : term.compare(0, 2, "_:") == 0 ? TermMap::BlankNode
+                                           : TermMap::Iri;
+}
+
+bool readTermMap(const MappingGraph& graph, uint32_t node, bool isSubject, TermMap& term, std::string& error) {
+    const std::string& name = graph.text(node);
+    uint32_t value;
+    if (graph.object(node, "constant", value)) {
+        term.kind = TermMap::Constant;
+        term.value = graph.text(value);
+    } else if (graph.object(node, "column", value)) {
+        term.kind = TermMap::Column;
+        term.value = lexicalForm(graph.text(value));
+    } else if (graph.object(node, "template", value)) {
+        term.kind = TermMap::Template;
+        term.value = lexicalForm(graph.text(value));
+    } else {
+        error = name + ": term map needs rr:constant, rr:column or rr:template";
+        return false;
+    }
+    if (graph.object(node, "datatype", value)) {
+        term.datatype = graph.text(value);
+    }
+    if (graph.object(node, "language", value)) {
+        term.language = lexicalForm(graph.text(value));
+    }
+
+    if (graph.object(node, "termType", value)) {
+        const std::string& type = graph.text(value);
+        if (type == RR + "IRI") {
+            term.termType = TermMap::Iri;
+        } else if (type == RR + "BlankNode") {
+            term.termType = TermMap::BlankNode;
+        } else if (type == RR + "Literal") {
+            term.termType = TermMap::Literal;
+        } else {
+            error = name + ": unknown rr:termType " + type;
+            return false;
+        }
+    } else if (term.kind == TermMap::Constant) {
+        term.termType = constantTermType(term.value);
+    } else if (!isSubject && (term.kind == TermMap::Column || !term.datatype.empty() || !term.language.empty())) {
+        term.termType = TermMap::Literal;
+    } else {
+        term.termType = TermMap::Iri;
+    }
+
+    if (term.termType != TermMap::Literal && (!term.datatype.empty() || !term.language.empty())) {
+        error = name + ": rr:datatype and rr:language only apply to literals";
+        return false;
+    }
+    if (isSubject && term.termType == TermMap::Literal) {
+        error = name + ": a subject cannot be a literal";
+        return false;
+    }
+    return true;
+}
+
+bool readTriplesMap(const MappingGraph& graph, uint32_t node, TriplesMap& map, std::string& error) {
+    map.name = graph.text(node);
+    uint32_t value;
+    if (graph.object(node, "logicalTable", value)) {
+        uint32_t text;
+        if (graph.object(value, "tableName", text)) {
+            map.tableName = lexicalForm(graph.text(text));
+        }
+        if (graph.object(value, "sqlQuery", text)) {
+            map.sqlQuery = lexicalForm(graph.text(text));
+        }
+    }
+
+    if (graph.object(node, "subject", value)) {
+        map.subject.kind = TermMap::Constant;
+        map.subject.value = graph.text(value);
+    } else if (graph.object(node, "subjectMap", value)) {
+        if (!readTermMap(graph, value, true, map.subject, error)) {
+            return false;
+        }
+        for (uint32_t type : graph.objects(value, "class")) {
+            map.classes.push_back(graph.text(type));
+        }
+    }
+
+    for (uint32_t predicateObject : graph.objects(node, "predicateObjectMap")) {
+        std::vector<std::string> predicates;
+        for (uint32_t predicate : graph.objects(predicateObject, "predicate")) {
+            predicates.push_back(graph.text(predicate));
+        }
+        for (uint32_t predicateMap : graph.objects(predicateObject, "predicateMap")) {
+            if (!graph.object(predicateMap, "constant", value)) {
+                error = map.name + ": only constant predicate maps are supported";
+                return false;
+            }
+            predicates.push_back(graph.text(value));
+        }
+
+        std::vector<TermMap> objects;
+        for (uint32_t object : graph.objects(predicateObject, "object")) {
+            TermMap term;
+            term.kind = TermMap::Constant;
+            term.value = graph.text(object);
+            term.termType = constantTermType(term.value);
+            objects.push_back(term);
+        }
+        for (uint32_t objectMap : graph.objects(predicateObject, "objectMap")) {
+            if (graph.object(objectMap, "parentTriplesMap", value)) {
+                error = map.name + ": rr:parentTriplesMap (joins) is not supported";
+                return false;
+            }
+            TermMap term;
+            if (!readTermMap(graph, objectMap, false, term, error)) {
+                return false;
+            }
+            objects.push_back(term);
+        }
+
+        if (predicates.empty() || objects.empty()) {
+            error = map.name + ": predicateObjectMap needs at least one predicate and one object";
+            return false;
+        }
+        for (const auto& predicate : predicates) {
+            for (const auto& object : objects) {
+                map.predicateObjects.emplace_back(predicate, object);
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+std::string TriplesMap::selectQuery() const {
+    return sqlQuery.empty() ? "SELECT * FROM " + tableName : sqlQuery;
+}
+
+bool loadTriplesMaps(const std::string& filename, std::vector<TriplesMap>& maps, std::string& error) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        error = "cannot open " + filename;
+        return false;
+    }
+    MappingGraph graph;
+    TurtleParser parser(file, graph.pool);
+    std::vector<Triple> batch;
+    while (parser.nextBatch(batch)) {
+        for (const auto& triple : batch) {
+            graph.add(triple);
+        }
+    }
+    if (!parser.getErrors().empty()) {
+        const ParseError& first = parser.getErrors().front();
+        error = filename + ":" + std::to_string(first.line) + ":" + std::to_string(first.column) + ": " + first.message;
+        return false;
+    }
+
+    maps.clear();
+    for (uint32_t node : graph.subjects) {
+        uint32_t value;
+        if (!graph.object(node, "subjectMap", value) && !graph.object(node, "subject", value)) {
+            continue;
+        }
+        TriplesMap map;
+        if (!readTriplesMap(graph, node, map, error)) {
+            return false;
+        }
+        maps.push_back(std::move(map));
+    }
+    if (maps.empty()) {
+        error = filename + ": no rr:subjectMap found";
+        return false;
+    }
+    return true;
+}
+
+RowMapper::RowMapper(const TriplesMap& mapping, const std::vector<std::string>& columns, StringPool& pool)
+        : pool(pool), rdfType(pool.getId(RDF_TYPE)) {
+    subject = compile(mapping.subject, columns);
+    for (const auto& type : mapping.classes) {
+        classes.push_back(pool.getId(type));
+    }
+    for (const auto& predicateObject : mapping.predicateObjects) {
+        objects.emplace_back(pool.getId(predicateObject.first), compile(predicateObject.second, columns));
+    }
+}
+
+RowMapper::CompiledTerm RowMapper::compile(const TermMap& term, const std::vector<std::string>& columns) const {
+    CompiledTerm compiled;
+    compiled.termType = term.termType;
+    if (term.kind == TermMap::Constant) {
+        compiled.constant = pool.getId(term.value);
+        return compiled;
+    }
+
+    auto columnIndex = [&columns](std::string name) {
+        // SQL 的带引号标识符 "列名"
+        if (name.size() >= 2 && name.front() == '"' && name.back() == '"') {
+            name = name.substr(1, name.size() - 2);
+        }
+        auto it = std::find(columns.begin(), columns.end(), name);
+        if (it == columns.end()) {
+            throw std::runtime_error("column '" + name + "' not found in source");
+        }
+        return static_cast<int>(it - columns.begin());
+    };
+    const Encoding valueEncoding = term.termType == TermMap::Literal ? LiteralEscape
+                                   : term.kind == TermMap::Template && term.termType == TermMap::Iri ? IriSafe
+                                   : Raw;
+    // 字面量的固定文字同样需要转义
+    auto addText = [&](const std::string& text) {
+        Segment segment{"", -1, Raw};
+        appendEncoded(segment.text, text, term.termType == TermMap::Literal ? LiteralEscape : Raw);
+        compiled.segments.push_back(std::move(segment));
+    };
+
+    if (term.kind == TermMap::Column) {
+        compiled.segments.push_back({"", columnIndex(term.value), valueEncoding});
+    } else {
+        // 模板：{列名} 替换为列值，\{ \} \\ 为字面字符
+        std::string text;
+        for (size_t i = 0; i < term.value.size(); ++i) {
+            char c = term.value[i];
+            if (c == '\\' && i + 1 < term.value.size()) {
+                text.push_back(term.value[++i]);
+            } else if (c == '{') {
+                size_t close = term.value.find('}', i);
+                if (close == std::string::npos) {
+                    throw std::runtime_error("unterminated '{' in template " + term.value);
+                }
+                if (!text.empty()) {
+                    addText(text);
+                    text.clear();
+                }
+                compiled.segments.push_back({"", columnIndex(term.value.substr(i + 1, close - i - 1)), valueEncoding});
+                i = close;
+            } else {
+                text.push_back(c);
+            }
+        }
+        if (!text.empty()) {
+            addText(text);
+        }
+    }
+
+    if (term.termType == TermMap::Literal) {
+        compiled.suffix = "\"";
+        if (!term.language.empty()) {
+            compiled.suffix += "@" + term.language;
+        } else if (!term.datatype.empty()) {
+            compiled.suffix += "^^<" + term.datatype + ">";
+        }
+    }
+    return compiled;
+}
+
+void RowMapper::appendEncoded(std::string& out, std::string_view value, Encoding encoding) {
+    static const char HEX[] = "0123456789ABCDEF";
+    for (char c : value) {
+        auto byte = static_cast<unsigned char>(c);
+        if (encoding == IriSafe) {
+            // IRI-safe：iunreserved（字母、数字、- . _ ~ 及非 ASCII 字符）之外的字节编码为 %XX
+            if ((byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z') || (byte >= '0' && byte <= '9') ||
+                byte == '-' || byte == '.' || byte == '_' || byte == '~' || byte >= 0x80) {
+                out.push_back(c);
+            } else {
+                out.push_back('%');
+                out.push_back(HEX[byte >> 4]);
+                out.push_back(HEX[byte & 15]);
+            }
+        } else if (encoding == LiteralEscape && (c == '"' || c == '\\' || c == '\n' || c == '\r')) {
+            out.push_back('\\');
+            out.push_back(c == '\n' ? 'n' : c == '\r' ? 'r' : c);
+        } else {
+            out.push_back(c);
+        }
+    }
+}
+
+uint32_t RowMapper::generate(const CompiledTerm& term, const std::vector<std::string_view>& row,
+                             std::string& scratch) const {
+    if (term.constant != UINT32_MAX) {
+        return term.constant;
+    }
+    scratch.clear();
+    if (term.termType == TermMap::Literal) {
+        scratch.push_back('"');
+    } else if (term.termType == TermMap::BlankNode) {
+        scratch += "_:";
+    }
+    for (const Segment& segment : term.segments) {
+        if (segment.column < 0) {
+            scratch += segment.text;
+            continue;
+        }
+        if (static_cast<size_t>(segment.column) >= row.size() || row[segment.column].data() == nullptr) {
+            return UINT32_MAX;
+        }
+        appendEncoded(scratch, row[segment.column], segment.encoding);
+    }
+    scratch += term.suffix;
+    return pool.getId(scratch);
+}
+
+void RowMapper::map(const std::vector<std::string_view>& row, std::vector<Triple>& out, std::string& scratch) const {
+    uint32_t subjectId = generate(subject, row, scratch);
+    if (subjectId == UINT32_MAX) {
+        return;
+    }
+    for (uint32_t type : classes) {
+        out.emplace_back(subjectId, rdfType, type);
+    }
+    for (const auto& object : objects) {
+        uint32_t objectId = generate(object.second, row, scratch);
+        if (objectId != UINT32_MAX) {
+            out.emplace_back(subjectId, object.first, objectId);
+        }
+    }
+}
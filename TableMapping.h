@@ -0,0 +1,89 @@
+#ifndef RDFPANDA_STORAGE_TABLEMAPPING_H
+#define RDFPANDA_STORAGE_TABLEMAPPING_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "StringPool.h"
+#include "Trie.h"
+
+// 表到三元组的声明式映射（R2RML 的子集），用于直接导入宽表，不必先在 SQL 中把每列拆成 subject,predicate,object 行
+// 映射文件用 Turtle 写，支持的词汇（rr: 为 http://www.w3.org/ns/r2rml#）：
+// - rr:logicalTable [ rr:tableName "表名" ] 或 [ rr:sqlQuery "查询" ]（CSV 来源忽略）
+// - rr:subjectMap [ rr:template "http://ex/person/{id}" | rr:column "列" | rr:constant <IRI>; rr:class <类>* ]
+// - rr:predicateObjectMap [ rr:predicate <谓语>+ | rr:predicateMap [ rr:constant <谓语> ];
+//                           rr:objectMap [ rr:column | rr:template | rr:constant; rr:datatype; rr:language; rr:termType ] |
+//                           rr:object <常量> ]
+// 不支持连接（rr:parentTriplesMap）和以模板生成谓语
+// 值为 NULL 的列不生成三元组，主语为 NULL 时整行跳过；模板生成 IRI 时插入的值按 R2RML 的规则做百分号编码
+// 生成的项与 N-Triples 解析结果的写法一致：IRI 不带尖括号，字面量为 "词法形式"（转义为 N-Triples 写法）加 @语言 或 ^^<类型>
+
+// 一个项的生成方式
+struct TermMap {
+    enum Kind { Constant, Column, Template };
+    enum TermType { Iri, BlankNode, Literal };
+
+    Kind kind = Constant;
+    TermType termType = Iri;
+    std::string value;      // 常量项（已是字符串池中的写法）、列名或模板
+    std::string datatype;   // 字面量的数据类型 IRI，可为空
+    std::string language;   // 字面量的语言标签，可为空
+};
+
+struct TriplesMap {
+    std::string name;
+    std::string tableName;
+    std::string sqlQuery;
+    TermMap subject;
+    std::vector<std::string> classes;
+    std::vector<std::pair<std::string, TermMap>> predicateObjects;  // (谓语 IRI, 宾语的生成方式)
+
+    // SQL 来源要执行的查询：rr:sqlQuery，或读取 rr:tableName 的全部列
+    std::string selectQuery() const;
+};
+
+// 读取映射文件中的全部 TriplesMap（按出现顺序）；文件无法解析或使用了不支持的词汇时返回 false 并填写 error
+bool loadTriplesMaps(const std::string& filename, std::vector<TriplesMap>& maps, std::string& error);
+
+// RowMapper：按来源的列名编译后的映射，逐行生成三元组，项直接写入字符串池得到 ID
+// map() 只读，可被多个线程同时调用，每个线程使用自己的 scratch
+class RowMapper {
+public:
+    // 映射引用了 columns 中没有的列时抛出 std::runtime_error
+    RowMapper(const TriplesMap& mapping, const std::vector<std::string>& columns, StringPool& pool);
+
+    // row 为一行各列的值，data() 为 nullptr 的表示 NULL；生成的三元组追加到 out
+    void map(const std::vector<std::string_view>& row, std::vector<Triple>& out, std::string& scratch) const;
+
+private:
+    enum Encoding { Raw, IriSafe, LiteralEscape };
+
+    struct Segment {
+        std::string text;
+        int column;         // 为 -1 时本段是模板中的固定文字
+        Encoding encoding;  // 插入列值时的编码
+    };
+
+    struct CompiledTerm {
+        uint32_t constant = UINT32_MAX;
+        TermMap::TermType termType = TermMap::Iri;
+        std::vector<Segment> segments;
+        std::string suffix;  // 字面量结尾的引号和 @语言 或 ^^<类型>
+    };
+
+    StringPool& pool;
+    uint32_t rdfType;
+    CompiledTerm subject;
+    std::vector<uint32_t> classes;
+    std::vector<std::pair<uint32_t, CompiledTerm>> objects;
+
+    static void appendEncoded(std::string& out, std::string_view value, Encoding encoding);
+    CompiledTerm compile(const TermMap& term, const std::vector<std::string>& columns) const;
+    // 生成一个项的 ID，引用的列为 NULL 时返回 UINT32_MAX
+    uint32_t generate(const CompiledTerm& term, const std::vector<std::string_view>& row, std::string& scratch) const;
+};
+
+
+#endif //RDFPANDA_STORAGE_TABLEMAPPING_H
@@ -36,32 +36,74 @@ std::string Triple::object() const {
     return global_pool->getString(object_id);
 }
 
-// 插入时采用 PSO 顺序：先插入 predicate，再 subject，最后 object
-void Trie::insertPSO(const Triple& triple) {
+// 按给定顺序插入：依次以 trieOrderPositions(order) 指定的位置作为各层的键
+bool Trie::insert(const Triple& triple, TrieOrder order, uint32_t tripleIndex) {
+    const uint32_t ids[3] = { triple.getSubjectId(), triple.getPredicateId(), triple.getObjectId() };
+    const int* positions = trieOrderPositions(order);
     TrieNode* curr = root;
-    // 顺序：predicate, subject, object (使用ID)
-    std::vector<uint32_t> keys = { triple.getPredicateId(), triple.getSubjectId(), triple.getObjectId() };
-    for (const auto & key : keys) {
-        if (curr->children.find(key) == curr->children.end()) {
-            curr->children[key] = new TrieNode();
+    for (int level = 0; level < 3; ++level) {
+        TrieNode*& child = curr->children[ids[positions[level]]];
+        if (child == nullptr) {
+            child = new TrieNode();
         }
-        curr = curr->children[key];
+        curr = child;
+    }
+    if (curr->isEnd) {
+        return false;
     }
     curr->isEnd = true;
+    curr->tripleIndex = tripleIndex;
+    return true;
 }
 
-// 插入时采用 POS 顺序：先插入 predicate，再 object，最后 subject
-void Trie::insertPOS(const Triple &triple) {
+TrieNode* Trie::find(const Triple& triple, TrieOrder order) const {
+    const uint32_t ids[3] = { triple.getSubjectId(), triple.getPredicateId(), triple.getObjectId() };
+    const int* positions = trieOrderPositions(order);
     TrieNode* curr = root;
-    // 顺序：predicate, object, subject (使用ID)
-    std::vector<uint32_t> keys = { triple.getPredicateId(), triple.getObjectId(), triple.getSubjectId() };
-    for (const auto & key : keys) {
-        if (curr->children.find(key) == curr->children.end()) {
-            curr->children[key] = new TrieNode();
+    for (int level = 0; level < 3; ++level) {
+        auto it = curr->children.find(ids[positions[level]]);
+        if (it == curr->children.end()) {
+            return nullptr;
         }
-        curr = curr->children[key];
+        curr = it->second;
     }
-    curr->isEnd = true;
+    return curr->isEnd ? curr : nullptr;
+}
+
+// 删除叶子节点，并自下而上释放删除后没有子节点的中间节点
+bool Trie::remove(const Triple& triple, TrieOrder order) {
+    const uint32_t ids[3] = { triple.getSubjectId(), triple.getPredicateId(), triple.getObjectId() };
+    const int* positions = trieOrderPositions(order);
+    TrieNode* path[4] = { root, nullptr, nullptr, nullptr };
+    for (int level = 0; level < 3; ++level) {
+        auto it = path[level]->children.find(ids[positions[level]]);
+        if (it == path[level]->children.end()) {
+            return false;
+        }
+        path[level + 1] = it->second;
+    }
+    if (!path[3]->isEnd) {
+        return false;
+    }
+    for (int level = 2; level >= 0; --level) {
+        TrieNode* child = path[level + 1];
+        if (!child->children.empty()) {
+            break;
+        }
+        path[level]->children.erase(ids[positions[level]]);
+        delete child;
+    }
+    return true;
+}
+
+// 插入时采用 PSO 顺序：先插入 predicate，再 subject，最后 object
+void Trie::insertPSO(const Triple& triple) {
+    insert(triple, TrieOrder::PSO);
+}
+
+// 插入时采用 POS 顺序：先插入 predicate，再 object，最后 subject
+void Trie::insertPOS(const Triple &triple) {
+    insert(triple, TrieOrder::POS);
 }
 
 
@@ -88,20 +130,21 @@ void Trie::printAllHelper(TrieNode* node, std::vector<std::string>& binding) {
 
 // 在一组 TrieIterator 上执行 leapfrog 交集查找，找到所有迭代器中当前键值相等的位置
 void LeapfrogJoin::leapfrog_search() {
-    if (iterators.empty()) { // 如果没有迭代器，直接返回
+    if (count == 0) { // 如果没有迭代器，直接返回
         done = true;
         return;
     }
     while (true) {
         // 找出所有迭代器中最大的当前key (使用ID)
         uint32_t maxKey = iterators[0]->key();
-        for (auto it : iterators) {
-            if (it->key() > maxKey)
-                maxKey = it->key(); // 遍历更新最大key
+        for (size_t i = 1; i < count; ++i) {
+            if (iterators[i]->key() > maxKey)
+                maxKey = iterators[i]->key(); // 遍历更新最大key
         }
         // 对于当前 key 小于 maxKey 的迭代器，执行 seek(maxKey)
         bool allEqual = true;
-        for (TrieIterator* it : iterators) {
+        for (size_t i = 0; i < count; ++i) {
+            TrieIterator* it = iterators[i];
             if (it->key() < maxKey) {
                 it->seek(maxKey);
                 if (it->atEnd()) {
@@ -113,4 +156,4 @@ void LeapfrogJoin::leapfrog_search() {
         }
         if (allEqual) break;
     }
-}
\ No newline at end of file
+}
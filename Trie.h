@@ -58,24 +58,34 @@ public:
     }
 };
 
+// 规则中的三元组模式：保留原始字符串，不进入字符串池
+// 变量（如 ?X）只在规则中有意义，常量在编译规则时才解析为ID
+struct Atom {
+    std::string subject;
+    std::string predicate;
+    std::string object;
+};
+
 class Rule {
 public:
     std::string name;
-    std::vector<Triple> body;
-    Triple head;
+    std::vector<Atom> body;
+    Atom head;
 
-    Rule(std::string name, const std::vector<Triple>& body, Triple head)
+    Rule(std::string name, const std::vector<Atom>& body, Atom head)
             : name(std::move(name)), body(body), head(std::move(head)) {}
 };
 
 // TrieNode：Trie 的节点，使用 std::map 保持子节点有序（即 PSO 顺序中的字典顺序）
 // 优化：使用ID而非字符串作为键
+// update: 叶子节点可记录三元组在事实库中的下标，按三元组查找下标只需沿 Trie 下降
 class TrieNode {
 public:
     std::map<uint32_t, TrieNode*> children;
     bool isEnd;
+    uint32_t tripleIndex;  // 叶子节点对应的三元组下标，未记录时为 UINT32_MAX
 
-    TrieNode() : isEnd(false) {}
+    TrieNode() : isEnd(false), tripleIndex(UINT32_MAX) {}
     ~TrieNode() {
         for (auto& pair : children) {
             delete pair.second;
@@ -83,8 +93,35 @@ public:
     }
 };
 
+// Trie 的索引顺序，决定三元组各位置在 Trie 中的层次
+// SOP/OSP 谓语在最后一层，供谓语为变量的模式使用，由事实库按需建立
+enum class TrieOrder {
+    PSO,
+    POS,
+    SOP,
+    OSP
+};
+
+// 返回索引顺序对应的三元组位置序列（主0/谓1/宾2），如 PSO -> {1, 0, 2}
+inline const int* trieOrderPositions(TrieOrder order) {
+    static const int positions[][3] = {
+        {1, 0, 2},  // PSO
+        {1, 2, 0},  // POS
+        {0, 2, 1},  // SOP
+        {2, 0, 1},  // OSP
+    };
+    return positions[static_cast<int>(order)];
+}
+
+inline const char* trieOrderName(TrieOrder order) {
+    static const char* names[] = {"PSO", "POS", "SOP", "OSP"};
+    return names[static_cast<int>(order)];
+}
+
 // Trie 类，按 PSO 顺序存储三元组
 // update: 按 PSO 和 POS 两种顺序存储三元组
+// update: 支持按任意 TrieOrder 插入
+// update: 支持删除，删除后空的中间节点一并释放
 class Trie {
 public:
     TrieNode* root;
@@ -96,6 +133,12 @@ public:
         delete root;
     }
 
+    // 插入三元组，返回是否为新三元组；新建的叶子节点记录 tripleIndex
+    bool insert(const Triple& triple, TrieOrder order, uint32_t tripleIndex = UINT32_MAX);
+    // 删除三元组，返回是否存在
+    bool remove(const Triple& triple, TrieOrder order);
+    // 查找三元组对应的叶子节点，不存在返回 nullptr
+    TrieNode* find(const Triple& triple, TrieOrder order) const;
     void insertPSO(const Triple& triple);
     void insertPOS(const Triple& triple);
     void printAll();
@@ -107,16 +150,28 @@ private:
 
 // TrieIterator：对 TrieNode 的子节点进行遍历，提供类似迭代器的接口
 // 优化：使用ID而非字符串
+// update: 可默认构造并用 reset() 原地复用，便于放在预分配的工作区中，不需要 new/delete
 class TrieIterator {
 public:
-    TrieNode* node; // 当前所在节点
+    TrieNode* node = nullptr; // 当前所在节点
     std::map<uint32_t, TrieNode*>::iterator it;
     std::map<uint32_t, TrieNode*>::iterator end;
+    uint32_t seeks = 0; // reset() 以来 seek 的次数，用于剖析
+
+    TrieIterator() = default;
 
-    TrieIterator(TrieNode* n) : node(n) {
+    TrieIterator(TrieNode* n) {
+        reset(n);
+    }
+
+    void reset(TrieNode* n) {
+        node = n;
+        seeks = 0;
         if (node) {
             it = node->children.begin();
             end = node->children.end();
+        } else {
+            it = end;
         }
     }
 
@@ -128,6 +183,11 @@ public:
         return it->first;
     }
 
+    // 当前 key 对应的子节点
+    TrieNode* child() const {
+        return it->second;
+    }
+
     void next() {
         if (!atEnd()) {
             ++it;
@@ -136,6 +196,7 @@ public:
 
     // 跳跃到不小于 target 的位置
     void seek(uint32_t target) {
+        seeks++;
         it = node->children.lower_bound(target);
     }
 
@@ -149,15 +210,24 @@ public:
 };
 
 // LeapfrogJoin类：在一组TrieIterator上实现leapfrog交集查找（适用于单变量join）
+// update: 不再持有迭代器数组的副本，只引用调用方提供的指针数组（会被原地排序），构造与执行都不分配堆内存
 class LeapfrogJoin {
 public:
-    std::vector<TrieIterator*> iterators;
-    int p;       // 当前指针索引
+    TrieIterator** iterators;
+    size_t count;
+    size_t p;    // 当前指针索引
     bool done;   // 标记是否结束
 
-    LeapfrogJoin(std::vector<TrieIterator*>& its) : iterators(its), p(0), done(false) {
+    LeapfrogJoin(TrieIterator** its, size_t n) : iterators(its), count(n), p(0), done(false) {
+        // 任一迭代器为空时交集必为空
+        for (size_t i = 0; i < count; ++i) {
+            if (iterators[i]->atEnd()) {
+                done = true;
+                return;
+            }
+        }
         // 对所有迭代器按当前 key 从小到大排序
-        std::sort(iterators.begin(), iterators.end(), [](TrieIterator* a, TrieIterator* b) {
+        std::sort(iterators, iterators + count, [](TrieIterator* a, TrieIterator* b) {
             return a->key() < b->key();
         });
         leapfrog_search();
@@ -181,7 +251,7 @@ public:
             done = true;
             return;
         }
-        p = (p + 1) % iterators.size();
+        p = (p + 1) % count;
         leapfrog_search();
     }
 
@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <climits>
+#include "TrieJoin.h"
+
+namespace {
+
+// 模式的规模估算：谓语为常量时取该谓语下的三元组数（虚谓语取其事实数），否则取全部三元组数
+size_t estimateAtom(const TripleStore& store, const JoinAtom& atom) {
+    const JoinTerm& predicate = atom.terms[1];
+    if (!predicate.isVar) {
+        const VirtualPredicate* source = store.getVirtualPredicate(predicate.value);
+        return source != nullptr ? source->size() : store.getPredicateCount(predicate.value);
+    }
+    return store.getTripleCount();
+}
+
+bool containsVar(const JoinAtom& atom, uint32_t slot) {
+    for (const auto& term : atom.terms) {
+        if (term.isVar && term.value == slot) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+JoinPlan planJoin(const TripleStore& store, const std::vector<JoinAtom>& atoms, size_t varCount,
+                  const std::vector<bool>& prebound, int skipAtom,
+                  const std::vector<bool>& projected) {
+    JoinPlan plan;
+    std::vector<bool> bound(prebound);
+    bound.resize(varCount, false);
+
+    // 需要在连接中消解的变量
+    std::vector<bool> pending(varCount, false);
+    std::vector<size_t> estimates(atoms.size(), 0);
+    for (size_t a = 0; a < atoms.size(); ++a) {
+        if (static_cast<int>(a) == skipAtom) {
+            continue;
+        }
+        estimates[a] = estimateAtom(store, atoms[a]);
+        for (const auto& term : atoms[a].terms) {
+            if (term.isVar && !bound[term.value]) {
+                pending[term.value] = true;
+            }
+        }
+    }
+
+    auto isProjected = [&projected](uint32_t v) {
+        return projected.empty() || projected[v];
+    };
+
+    // 贪心确定变量顺序：优先与已绑定项相连的变量（避免笛卡尔积），其次需要输出的变量，最后候选最少的变量
+    // 谓语变量不排在同一模式的主语与宾语之间（没有 SPO/OPS 索引），此时推迟到主宾都确定之后，对应 SOP/OSP
+    while (true) {
+        int best = -1;
+        bool bestDeferred = false;
+        bool bestConnected = false;
+        bool bestProjected = false;
+        size_t bestEstimate = SIZE_MAX;
+        for (uint32_t v = 0; v < varCount; ++v) {
+            if (!pending[v] || bound[v]) {
+                continue;
+            }
+            bool deferred = false;
+            bool connected = false;
+            size_t estimate = SIZE_MAX;
+            for (size_t a = 0; a < atoms.size(); ++a) {
+                if (static_cast<int>(a) == skipAtom || !containsVar(atoms[a], v)) {
+                    continue;
+                }
+                estimate = std::min(estimate, estimates[a]);
+                const JoinTerm* terms = atoms[a].terms;
+                if (terms[1].isVar && terms[1].value == v &&
+                    (!terms[0].isVar || bound[terms[0].value]) != (!terms[2].isVar || bound[terms[2].value])) {
+                    deferred = true;
+                }
+                for (int pos = 0; pos < 3; ++pos) {
+                    const JoinTerm& term = atoms[a].terms[pos];
+                    if (term.isVar && term.value == v) {
+                        continue;
+                    }
+                    // 常量谓语不构成连接约束，主宾常量或已绑定变量才算
+                    if ((term.isVar && bound[term.value]) || (!term.isVar && pos != 1)) {
+                        connected = true;
+                    }
+                }
+            }
+            bool output = isProjected(v);
+            bool better;
+            if (best < 0) {
+                better = true;
+            } else if (deferred != bestDeferred) {
+                better = !deferred;
+            } else if (connected != bestConnected) {
+                better = connected;
+            } else if (output != bestProjected) {
+                better = output;
+            } else {
+                better = estimate < bestEstimate;
+            }
+            if (better) {
+                best = static_cast<int>(v);
+                bestDeferred = deferred;
+                bestConnected = connected;
+                bestProjected = output;
+                bestEstimate = estimate;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        plan.varOrder.push_back(static_cast<uint32_t>(best));
+        bound[best] = true;
+    }
+
+    // 顺序末尾连续的不输出变量只需存在性检查
+    plan.existentialDepth = plan.varOrder.size();
+    while (plan.existentialDepth > 0 && !isProjected(plan.varOrder[plan.existentialDepth - 1])) {
+        plan.existentialDepth--;
+    }
+
+    // 变量在顺序中的位置，常量与预绑定变量记为 -1
+    std::vector<int> rank(varCount, -1);
+    for (size_t i = 0; i < plan.varOrder.size(); ++i) {
+        rank[plan.varOrder[i]] = static_cast<int>(i);
+    }
+    plan.participants.resize(plan.varOrder.size());
+
+    // 为每个模式选择索引顺序：常量层在前，其余各层按变量顺序非递减
+    for (size_t a = 0; a < atoms.size(); ++a) {
+        if (static_cast<int>(a) == skipAtom) {
+            continue;
+        }
+        const JoinAtom& atom = atoms[a];
+        if (!atom.terms[1].isVar) {
+            const VirtualPredicate* source = store.getVirtualPredicate(atom.terms[1].value);
+            if (source != nullptr) {
+                plan.virtuals.push_back({a, source, atom.terms[0], atom.terms[2]});
+                continue;
+            }
+        }
+        int ranks[3];
+        for (int pos = 0; pos < 3; ++pos) {
+            const JoinTerm& term = atom.terms[pos];
+            ranks[pos] = term.isVar ? rank[term.value] : -1;
+        }
+
+        bool found = false;
+        AtomAccess access{};
+        for (TrieOrder order : store.getTrieOrders()) {
+            const int* positions = trieOrderPositions(order);
+            bool ordered = true;
+            for (int level = 1; level < 3; ++level) {
+                if (ranks[positions[level]] < ranks[positions[level - 1]]) {
+                    ordered = false;
+                    break;
+                }
+            }
+            if (!ordered) {
+                continue;
+            }
+            access.atomIdx = a;
+            access.order = order;
+            access.root = store.getTrieRoot(order);
+            access.prefixLength = 0;
+            for (int level = 0; level < 3; ++level) {
+                access.levels[level] = atom.terms[positions[level]];
+                if (ranks[positions[level]] < 0) {
+                    access.prefixLength++;
+                }
+            }
+            found = true;
+            break;
+        }
+        if (!found) {
+            plan.error = "no index order available for body atom " + std::to_string(a);
+            if (atom.terms[1].isVar && !store.hasTrieOrder(TrieOrder::SOP)) {
+                plan.error += " (variable predicate needs the SOP/OSP indexes)";
+            }
+            return plan;
+        }
+
+        // 记录各深度的参与者，同一变量的连续层合并为一个参与者
+        int accessIdx = static_cast<int>(plan.atoms.size());
+        for (int level = access.prefixLength; level < 3; ) {
+            int depth = rank[access.levels[level].value];
+            int levels = 1;
+            while (level + levels < 3 && access.levels[level + levels].isVar &&
+                   access.levels[level + levels].value == access.levels[level].value) {
+                levels++;
+            }
+            plan.participants[depth].push_back({accessIdx, levels});
+            level += levels;
+        }
+        plan.atoms.push_back(access);
+    }
+
+    // 没有 Trie 参与者的深度由虚模式生成候选，优先另一端已确定的模式
+    plan.generators.assign(plan.varOrder.size(), VirtualGenerator());
+    for (size_t depth = 0; depth < plan.varOrder.size(); ++depth) {
+        if (!plan.participants[depth].empty()) {
+            continue;
+        }
+        const uint32_t v = plan.varOrder[depth];
+        VirtualGenerator& generator = plan.generators[depth];
+        for (size_t i = 0; i < plan.virtuals.size(); ++i) {
+            const VirtualAccess& access = plan.virtuals[i];
+            for (bool bindsObject : {true, false}) {
+                const JoinTerm& self = bindsObject ? access.object : access.subject;
+                const JoinTerm& other = bindsObject ? access.subject : access.object;
+                if (!self.isVar || self.value != v) {
+                    continue;
+                }
+                bool all = other.isVar && (other.value == v || rank[other.value] >= static_cast<int>(depth));
+                if (generator.access < 0 || (generator.all && !all)) {
+                    generator = {static_cast<int>(i), bindsObject, all};
+                }
+            }
+        }
+        if (generator.access < 0) {
+            plan.error = "no body atom binds variable slot " + std::to_string(v);
+            return plan;
+        }
+    }
+
+    // 虚模式在其项全部确定的深度检查；作为生成者且另一端已确定时，生成的候选已满足该模式
+    plan.virtualChecks.assign(plan.varOrder.size(), std::vector<int>());
+    for (size_t i = 0; i < plan.virtuals.size(); ++i) {
+        const VirtualAccess& access = plan.virtuals[i];
+        int last = -1;
+        for (const JoinTerm* term : {&access.subject, &access.object}) {
+            if (term->isVar) {
+                last = std::max(last, rank[term->value]);
+            }
+        }
+        if (last < 0) {
+            plan.initialChecks.push_back(static_cast<int>(i));
+            continue;
+        }
+        const VirtualGenerator& generator = plan.generators[last];
+        if (generator.access != static_cast<int>(i) || generator.all) {
+            plan.virtualChecks[last].push_back(static_cast<int>(i));
+        }
+    }
+
+    // 各深度参与者在 JoinStack 中的位置
+    plan.participantOffsets.resize(plan.participants.size());
+    for (size_t depth = 0; depth < plan.participants.size(); ++depth) {
+        plan.participantOffsets[depth] = plan.participantCount;
+        plan.participantCount += plan.participants[depth].size();
+    }
+
+    plan.valid = true;
+    return plan;
+}
+
+void JoinStack::prepare(const JoinPlan& plan) {
+    ensure(iterators, plan.participantCount);
+    ensure(pointers, plan.participantCount);
+    ensure(saved, plan.participantCount);
+    ensure(nodes, plan.atoms.size());
+    ensure(seeks, plan.atoms.size());
+    ensure(generated, plan.varOrder.size());
+    std::fill(seeks.begin(), seeks.begin() + plan.atoms.size(), 0);
+    candidates = 0;
+}
@@ -0,0 +1,283 @@
+#ifndef RDFPANDA_STORAGE_TRIEJOIN_H
+#define RDFPANDA_STORAGE_TRIEJOIN_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "Trie.h"
+#include "TripleStore.h"
+
+// 未绑定变量在绑定数组中的占位值
+const uint32_t UNBOUND_ID = UINT32_MAX;
+
+// 连接模式中的项：常量ID或变量槽位
+struct JoinTerm {
+    bool isVar = false;
+    uint32_t value = 0;  // 常量时为字符串池ID，变量时为变量槽位
+
+    static JoinTerm constant(uint32_t id) { return {false, id}; }
+    static JoinTerm variable(uint32_t slot) { return {true, slot}; }
+};
+
+// 连接中的一个三元组模式，terms 按 主0/谓1/宾2 排列
+struct JoinAtom {
+    JoinTerm terms[3];
+};
+
+// 某个三元组模式在计划中的访问路径
+struct AtomAccess {
+    size_t atomIdx;       // 在输入模式列表中的下标
+    TrieOrder order;      // 选用的索引顺序
+    TrieNode* root;
+    JoinTerm levels[3];   // 按 Trie 层次排列的项
+    int prefixLength;     // 连接开始前即可确定的层数（常量或预绑定变量）
+};
+
+// 某一连接深度上参与交集的模式：从其当前节点下降 levels 层
+// 同一变量在一个模式中多次出现时（如 ?x p ?x）levels 大于 1，其余层按已得到的键精确查找
+struct JoinParticipant {
+    int access;
+    int levels;
+};
+
+// 谓语为已注册虚谓语的模式：不经过 Trie，由 VirtualPredicate 生成候选或检查是否成立
+struct VirtualAccess {
+    size_t atomIdx;                   // 在输入模式列表中的下标
+    const VirtualPredicate* source;
+    JoinTerm subject;
+    JoinTerm object;
+};
+
+// 没有 Trie 模式参与的深度（变量只出现在虚模式中）由一个虚模式生成候选：
+// 另一端已确定时取其邻居，否则枚举虚谓语在该位置的全部取值
+struct VirtualGenerator {
+    int access = -1;          // plan.virtuals 中的下标，-1 表示该深度由 Trie 参与者消解
+    bool bindsObject = true;  // 当前变量位于宾语（由主语生成）还是主语
+    bool all = false;         // 另一端尚未确定
+};
+
+// Generic Join 计划：全局变量消解顺序，以及每个模式按该顺序可用的 Trie 访问路径
+struct JoinPlan {
+    bool valid = false;
+    std::string error;                                        // 无法生成计划时的原因
+    std::vector<uint32_t> varOrder;                           // 按消解顺序排列的变量槽位
+    size_t existentialDepth = 0;                              // 从该深度起的变量均不需输出，只需找到一个见证
+    std::vector<AtomAccess> atoms;
+    std::vector<std::vector<JoinParticipant>> participants;   // 每一深度参与交集的模式
+    std::vector<size_t> participantOffsets;                   // 每一深度的参与者在 JoinStack 中的起始位置
+    size_t participantCount = 0;                              // 所有深度的参与者总数
+    std::vector<VirtualAccess> virtuals;                      // 虚谓语模式
+    std::vector<VirtualGenerator> generators;                 // 每一深度的候选来源
+    std::vector<std::vector<int>> virtualChecks;              // 每一深度绑定后项已全部确定、需要检查的虚模式
+    std::vector<int> initialChecks;                           // 连接开始前即可检查的虚模式
+};
+
+// 为一组三元组模式生成连接计划
+// prebound[slot] 为 true 的变量在执行前已绑定；skipAtom 指定的模式（如触发模式）不参与连接
+// projected[slot] 为 true 的变量需要输出（如出现在规则头中），为空表示全部输出；
+// 不输出的变量尽量排在最后，只做存在性检查
+// 谓语为事实库中已注册虚谓语的模式不选 Trie 索引，记入 virtuals，由 TrieJoin 检查或生成候选
+JoinPlan planJoin(const TripleStore& store, const std::vector<JoinAtom>& atoms, size_t varCount,
+                  const std::vector<bool>& prebound, int skipAtom = -1,
+                  const std::vector<bool>& projected = {});
+
+// JoinStack：连接执行时的工作区，按深度预分配迭代器栈
+// 第 d 层使用 [participantOffsets[d], participantOffsets[d] + participants[d].size()) 段，
+// 各层互不重叠，递归过程中不再分配堆内存。同一线程的多次连接可复用同一个 JoinStack
+class JoinStack {
+public:
+    // 按计划所需的大小准备工作区（容量不足时才扩展），并清零统计
+    void prepare(const JoinPlan& plan);
+
+    // 工作区扩展（堆分配）的累计次数，含虚模式候选缓冲的扩容，稳定后多次连接不应再增长
+    size_t getAllocationCount() const { return allocationCount; }
+
+    // 最近一次连接的统计：leapfrog 交集得到的候选键数，以及计划中第 access 个模式上的 seek 次数
+    uint64_t getCandidateCount() const { return candidates; }
+    uint64_t getSeekCount(size_t access) const { return seeks[access]; }
+
+private:
+    friend class TrieJoin;
+
+    std::vector<TrieIterator> iterators;
+    std::vector<TrieIterator*> pointers;
+    std::vector<TrieNode*> saved;   // 进入某一深度前各参与模式所在的节点，回溯时恢复
+    std::vector<TrieNode*> nodes;   // 各模式在当前深度所在的节点
+    std::vector<uint64_t> seeks;
+    std::vector<std::vector<uint32_t>> generated;  // 各深度由虚模式生成的候选
+    uint64_t candidates = 0;
+    size_t allocationCount = 0;
+
+    template<typename T>
+    void ensure(std::vector<T>& buffer, size_t size) {
+        if (buffer.size() < size) {
+            buffer.resize(size);
+            allocationCount++;
+        }
+    }
+};
+
+// TrieJoin：按计划执行多路 Leapfrog Triejoin
+// 每一深度对所有含当前变量的模式做 leapfrog 交集，对环状规则体（如三角形）也是最坏情况最优的
+// 虚谓语模式不参与交集：项全部确定时检查是否成立，变量只出现在虚模式中时由虚谓语生成候选
+// 输出变量都绑定后，剩余变量找到第一个见证即回溯，同一结果只输出一次
+// 迭代器放在调用方提供的 JoinStack 中，构造和执行都不分配堆内存（emit 自身除外）
+class TrieJoin {
+public:
+    TrieJoin(const JoinPlan& plan, JoinStack& stack) : plan(plan), stack(stack) {
+        stack.prepare(plan);
+    }
+
+    // bindings 中预绑定变量需已赋值，每得到一组完整绑定调用一次 emit(bindings)
+    template<typename Emit>
+    void run(std::vector<uint32_t>& bindings, Emit&& emit) {
+        stopped = false;
+        if (!plan.valid) {
+            return;
+        }
+        // 先沿常量和预绑定变量下降到各模式的起始节点，任一不存在则结果为空
+        for (size_t a = 0; a < plan.atoms.size(); ++a) {
+            const AtomAccess& access = plan.atoms[a];
+            TrieNode* node = access.root;
+            for (int level = 0; level < access.prefixLength && node; ++level) {
+                const JoinTerm& term = access.levels[level];
+                node = child(node, term.isVar ? bindings[term.value] : term.value);
+            }
+            if (node == nullptr) {
+                return;
+            }
+            stack.nodes[a] = node;
+        }
+        if (!virtualHolds(plan.initialChecks, bindings)) {
+            return;
+        }
+        join(0, bindings, emit);
+    }
+
+    // 在 emit 中调用，不再产生后续结果（如查询的 LIMIT 已满足）
+    void stop() { stopped = true; }
+
+private:
+    const JoinPlan& plan;
+    JoinStack& stack;
+    bool stopped = false;
+
+    static TrieNode* child(TrieNode* node, uint32_t key) {
+        auto it = node->children.find(key);
+        return it != node->children.end() ? it->second : nullptr;
+    }
+
+    static uint32_t valueOf(const JoinTerm& term, const std::vector<uint32_t>& bindings) {
+        return term.isVar ? bindings[term.value] : term.value;
+    }
+
+    bool virtualHolds(const std::vector<int>& checks, const std::vector<uint32_t>& bindings) const {
+        for (int c : checks) {
+            const VirtualAccess& access = plan.virtuals[c];
+            if (!access.source->contains(valueOf(access.subject, bindings), valueOf(access.object, bindings))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 返回是否找到了至少一组完整绑定
+    template<typename Emit>
+    bool join(size_t depth, std::vector<uint32_t>& bindings, Emit& emit) {
+        if (depth == plan.varOrder.size()) {
+            emit(bindings);
+            return true;
+        }
+        if (plan.generators[depth].access >= 0) {
+            return generate(depth, bindings, emit);
+        }
+
+        const std::vector<JoinParticipant>& parts = plan.participants[depth];
+        const size_t offset = plan.participantOffsets[depth];
+        TrieIterator* iterators = stack.iterators.data() + offset;
+        TrieIterator** pointers = stack.pointers.data() + offset;
+        TrieNode** saved = stack.saved.data() + offset;
+        TrieNode** nodes = stack.nodes.data();
+        for (size_t i = 0; i < parts.size(); ++i) {
+            saved[i] = nodes[parts[i].access];
+            iterators[i].reset(saved[i]);
+            pointers[i] = &iterators[i];
+        }
+
+        const uint32_t var = plan.varOrder[depth];
+        const bool existential = depth >= plan.existentialDepth;
+        bool found = false;
+        LeapfrogJoin lf(pointers, parts.size());
+        while (!lf.atEnd() && !stopped) {
+            uint32_t key = lf.key();
+            stack.candidates++;
+            bool matched = true;
+            for (size_t i = 0; i < parts.size() && matched; ++i) {
+                TrieNode* node = iterators[i].child();
+                for (int level = 1; level < parts[i].levels && node; ++level) {
+                    node = child(node, key);
+                }
+                matched = node != nullptr;
+                nodes[parts[i].access] = node;
+            }
+            if (matched) {
+                bindings[var] = key;
+                if (virtualHolds(plan.virtualChecks[depth], bindings)) {
+                    found = join(depth + 1, bindings, emit) || found;
+                    if (found && existential) {
+                        break;  // 存在性检查：已有见证，不再枚举其余取值
+                    }
+                }
+            }
+            lf.next();
+        }
+
+        for (size_t i = 0; i < parts.size(); ++i) {
+            nodes[parts[i].access] = saved[i];
+            stack.seeks[parts[i].access] += iterators[i].seeks;
+        }
+        bindings[var] = UNBOUND_ID;
+        return found;
+    }
+
+    // 变量只出现在虚模式中：由虚谓语生成候选，逐个检查其余虚模式
+    template<typename Emit>
+    bool generate(size_t depth, std::vector<uint32_t>& bindings, Emit& emit) {
+        const VirtualGenerator& generator = plan.generators[depth];
+        const VirtualAccess& access = plan.virtuals[generator.access];
+        std::vector<uint32_t>& keys = stack.generated[depth];
+        const size_t capacity = keys.capacity();
+        keys.clear();
+        if (generator.all) {
+            generator.bindsObject ? access.source->objects(keys) : access.source->subjects(keys);
+        } else if (generator.bindsObject) {
+            access.source->objectsOf(valueOf(access.subject, bindings), keys);
+        } else {
+            access.source->subjectsOf(valueOf(access.object, bindings), keys);
+        }
+        if (keys.capacity() != capacity) {
+            stack.allocationCount++;  // 候选比这一深度以往的都多，缓冲扩容
+        }
+
+        const uint32_t var = plan.varOrder[depth];
+        const bool existential = depth >= plan.existentialDepth;
+        bool found = false;
+        for (size_t i = 0; i < keys.size() && !stopped; ++i) {
+            stack.candidates++;
+            bindings[var] = keys[i];
+            if (!virtualHolds(plan.virtualChecks[depth], bindings)) {
+                continue;
+            }
+            found = join(depth + 1, bindings, emit) || found;
+            if (found && existential) {
+                break;
+            }
+        }
+        bindings[var] = UNBOUND_ID;
+        return found;
+    }
+};
+
+
+#endif //RDFPANDA_STORAGE_TRIEJOIN_H
@@ -1,8 +1,15 @@
+#include <algorithm>
 #include "TripleStore.h"
 
-void TripleStore::addTriple(const Triple& triple) {
+bool TripleStore::addTriple(const Triple& triple, uint8_t flags) {
     // 获取当前三元组的索引
     uint32_t triple_index = static_cast<uint32_t>(triple_ids.size());
+
+    // PSO Trie 同时用于判重，叶子节点记录三元组下标
+    if (!triePSO.insert(triple, TrieOrder::PSO, triple_index)) {
+        triple_flags[findTriple(triple)] |= flags;
+        return false;
+    }
     
     // 存储紧凑的ID版本
     triple_ids.emplace_back(
@@ -10,6 +17,7 @@ void TripleStore::addTriple(const Triple& triple) {
         triple.getPredicateId(),
         triple.getObjectId()
     );
+    triple_flags.push_back(flags);
 
     // 更新优化后的索引：使用ID作为key
     subject_index[triple.getSubjectId()].push_back(triple_index);
@@ -17,8 +25,78 @@ void TripleStore::addTriple(const Triple& triple) {
     object_index[triple.getObjectId()].push_back(triple_index);
 
     // 继续使用Trie树优化（保持现有逻辑）
-    triePSO.insertPSO(triple);
     triePOS.insertPOS(triple);
+    for (size_t i = 2; i < trie_orders.size(); ++i) {
+        getTrie(trie_orders[i])->insert(triple, trie_orders[i]);
+    }
+    return true;
+}
+
+uint32_t TripleStore::findTriple(const Triple& triple) const {
+    TrieNode* leaf = triePSO.find(triple, TrieOrder::PSO);
+    return leaf != nullptr ? leaf->tripleIndex : UINT32_MAX;
+}
+
+namespace {
+
+// 从单项索引中删除一个下标，列表为空时删除该项
+// 列表从后向前查找：新加入的三元组在列表末尾，删除推理中间结果等最近加入的三元组时很快找到
+void eraseFromIndex(std::unordered_map<uint32_t, std::vector<uint32_t>>& index, uint32_t key, uint32_t triple_index) {
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return;
+    }
+    std::vector<uint32_t>& list = it->second;
+    auto pos = std::find(list.rbegin(), list.rend(), triple_index);
+    if (pos != list.rend()) {
+        *pos = list.back();
+        list.pop_back();
+    }
+    if (list.empty()) {
+        index.erase(it);
+    }
+}
+
+// 把单项索引中的下标 from 改为 to
+void renameInIndex(std::unordered_map<uint32_t, std::vector<uint32_t>>& index, uint32_t key, uint32_t from, uint32_t to) {
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return;
+    }
+    auto pos = std::find(it->second.rbegin(), it->second.rend(), from);
+    if (pos != it->second.rend()) {
+        *pos = to;
+    }
+}
+
+}
+
+bool TripleStore::removeTriple(const Triple& triple) {
+    uint32_t triple_index = findTriple(triple);
+    if (triple_index == UINT32_MAX) {
+        return false;
+    }
+    for (TrieOrder order : trie_orders) {
+        getTrie(order)->remove(triple, order);
+    }
+    eraseFromIndex(subject_index, triple.getSubjectId(), triple_index);
+    eraseFromIndex(predicate_index, triple.getPredicateId(), triple_index);
+    eraseFromIndex(object_index, triple.getObjectId(), triple_index);
+
+    // 用最后一个三元组填补空位，保持 triple_ids 连续
+    uint32_t last = static_cast<uint32_t>(triple_ids.size() - 1);
+    if (triple_index != last) {
+        const TripleIds moved = triple_ids[last];
+        triple_ids[triple_index] = moved;
+        triple_flags[triple_index] = triple_flags[last];
+        renameInIndex(subject_index, moved.subject_id, last, triple_index);
+        renameInIndex(predicate_index, moved.predicate_id, last, triple_index);
+        renameInIndex(object_index, moved.object_id, last, triple_index);
+        triePSO.find(Triple(moved.subject_id, moved.predicate_id, moved.object_id), TrieOrder::PSO)->tripleIndex = triple_index;
+    }
+    triple_ids.pop_back();
+    triple_flags.pop_back();
+    return true;
 }
 
 std::vector<Triple> TripleStore::queryBySubject(const std::string& subject) {
@@ -106,6 +184,58 @@ Triple TripleStore::getTripleById(uint32_t triple_id) const {
     return Triple(ids.subject_id, ids.predicate_id, ids.object_id);
 }
 
+TrieNode* TripleStore::getTrieRoot(TrieOrder order) const {
+    if (!hasTrieOrder(order)) {
+        return nullptr;
+    }
+    switch (order) {
+        case TrieOrder::PSO: return triePSO.root;
+        case TrieOrder::POS: return triePOS.root;
+        case TrieOrder::SOP: return trieSOP.root;
+        case TrieOrder::OSP: return trieOSP.root;
+    }
+    return nullptr;
+}
+
+Trie* TripleStore::getTrie(TrieOrder order) {
+    switch (order) {
+        case TrieOrder::PSO: return &triePSO;
+        case TrieOrder::POS: return &triePOS;
+        case TrieOrder::SOP: return &trieSOP;
+        case TrieOrder::OSP: return &trieOSP;
+    }
+    return nullptr;
+}
+
+bool TripleStore::hasTrieOrder(TrieOrder order) const {
+    return std::find(trie_orders.begin(), trie_orders.end(), order) != trie_orders.end();
+}
+
+void TripleStore::enableTrieOrder(TrieOrder order) {
+    if (hasTrieOrder(order)) {
+        return;
+    }
+    Trie* trie = getTrie(order);
+    for (const auto& ids : triple_ids) {
+        trie->insert(Triple(ids.subject_id, ids.predicate_id, ids.object_id), order);
+    }
+    trie_orders.push_back(order);
+}
+
+void TripleStore::registerVirtualPredicate(const std::string& predicate, const VirtualPredicate* source) {
+    uint32_t predicate_id = string_pool.getId(predicate);
+    if (source == nullptr) {
+        virtual_predicates.erase(predicate_id);
+    } else {
+        virtual_predicates[predicate_id] = source;
+    }
+}
+
+size_t TripleStore::getPredicateCount(uint32_t predicate_id) const {
+    auto it = predicate_index.find(predicate_id);
+    return it != predicate_index.end() ? it->second.size() : 0;
+}
+
 TrieNode* TripleStore::getNodeByTriple(const Triple& triple) const {
     // 返回指定三元组的Trie节点 (使用ID)
     TrieNode* node = triePSO.root;
@@ -11,6 +11,29 @@
 
 //// Triple 和 Rule 类已定义在Trie.h中
 
+// 三元组的来源标记，一个三元组可以同时是基础事实和推导事实
+enum TripleFlag : uint8_t {
+    BASE_FACT = 1,     // 基础事实（EDB），由输入加载或 insertBase 写入
+    DERIVED_FACT = 2   // 推导事实（IDB），由推理写入
+};
+
+// 虚谓语：事实不以三元组存放，由外部索引回答（如 ReachabilityIndex 回答的可达关系）
+// 在事实库注册后，规则与查询中以它为（常量）谓语的模式在连接时直接读取索引；谓语为变量的模式看不到这些事实
+// 各方法只读，可被多个推理线程并发调用
+class VirtualPredicate {
+public:
+    virtual ~VirtualPredicate() = default;
+
+    virtual bool contains(uint32_t subject, uint32_t object) const = 0;
+    // 以下方法把结果追加到 out，不重复，顺序不限
+    virtual void objectsOf(uint32_t subject, std::vector<uint32_t>& out) const = 0;
+    virtual void subjectsOf(uint32_t object, std::vector<uint32_t>& out) const = 0;
+    virtual void subjects(std::vector<uint32_t>& out) const = 0;  // 至少有一个事实的主语
+    virtual void objects(std::vector<uint32_t>& out) const = 0;   // 至少有一个事实的宾语
+    // 事实数，用于连接顺序估算
+    virtual size_t size() const = 0;
+};
+
 class TripleStore {
 private:
     // 字符串池
@@ -26,11 +49,19 @@ private:
             : subject_id(s), predicate_id(p), object_id(o) {}
     };
     std::vector<TripleIds> triple_ids;
+    std::vector<uint8_t> triple_flags;  // 与 triple_ids 对应的来源标记（TripleFlag）
     
     
     // 使用Trie树优化
     Trie triePSO;
     Trie triePOS;
+    // 谓语在后的索引只在需要时（谓语为变量的模式）建立，之后随插入删除一并维护
+    Trie trieSOP;
+    Trie trieOSP;
+    std::vector<TrieOrder> trie_orders = { TrieOrder::PSO, TrieOrder::POS };  // 已建立的索引顺序
+
+    // 已注册的虚谓语：谓语ID -> 回答它的索引（不归事实库所有）
+    std::unordered_map<uint32_t, const VirtualPredicate*> virtual_predicates;
 
     // 优化后的索引：使用ID而非字符串
     std::unordered_map<uint32_t, std::vector<uint32_t>> subject_index;  // Subject ID → Triple Index
@@ -43,7 +74,17 @@ public:
         Triple::setStringPool(&string_pool);
     }
     
-    void addTriple(const Triple& triple);
+    // 添加三元组，返回是否为新三元组；已存在时只合并来源标记
+    bool addTriple(const Triple& triple, uint8_t flags = BASE_FACT);
+    // 删除三元组，返回是否存在；最后一个三元组移入被删除的位置，其下标随之改变
+    bool removeTriple(const Triple& triple);
+    // 三元组的下标（经 PSO Trie 叶子节点查找），不存在返回 UINT32_MAX
+    uint32_t findTriple(const Triple& triple) const;
+    bool containsTriple(const Triple& triple) const { return findTriple(triple) != UINT32_MAX; }
+
+    uint8_t getTripleFlags(uint32_t triple_index) const { return triple_flags[triple_index]; }
+    void setTripleFlags(uint32_t triple_index, uint8_t flags) { triple_flags[triple_index] = flags; }
+
     std::vector<Triple> queryBySubject(const std::string& subject);
     std::vector<Triple> queryByPredicate(const std::string& predicate);
     std::vector<Triple> queryByObject(const std::string& object);
@@ -63,8 +104,36 @@ public:
 
     TrieNode* getNodeByTriple(const Triple& triple) const;
 
+private:
+    Trie* getTrie(TrieOrder order);
+
+public:
+
     TrieNode* getTriePSORoot() const { return triePSO.root; }
     TrieNode* getTriePOSRoot() const { return triePOS.root; }
+
+    // 按索引顺序获取Trie根节点，不支持的顺序返回nullptr
+    TrieNode* getTrieRoot(TrieOrder order) const;
+    // 当前维护的所有索引顺序，PSO/POS 始终在前
+    const std::vector<TrieOrder>& getTrieOrders() const { return trie_orders; }
+    bool hasTrieOrder(TrieOrder order) const;
+    // 建立尚未维护的索引顺序（按现有三元组一次性构建），不可与读写并发
+    void enableTrieOrder(TrieOrder order);
+
+    // 注册虚谓语，source 为 nullptr 时取消注册；source 须在注册期间保持有效
+    // 同一谓语已存放的三元组在注册期间不参与连接
+    void registerVirtualPredicate(const std::string& predicate, const VirtualPredicate* source);
+    // 谓语ID对应的虚谓语，未注册返回 nullptr
+    const VirtualPredicate* getVirtualPredicate(uint32_t predicate_id) const {
+        if (virtual_predicates.empty()) {
+            return nullptr;
+        }
+        auto it = virtual_predicates.find(predicate_id);
+        return it != virtual_predicates.end() ? it->second : nullptr;
+    }
+
+    // 某谓语下的三元组数量（不复制索引，用于连接顺序估算）
+    size_t getPredicateCount(uint32_t predicate_id) const;
     
     // 获取字符串池统计信息
     StringPool::PoolStats getStringPoolStats() const {
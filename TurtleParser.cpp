@@ -0,0 +1,738 @@
+#include <cctype>
+#include <cstring>
+#include "TurtleParser.h"
+
+namespace {
+
+const std::string RDF = "http://www.w3.org/1999/02/22-rdf-syntax-ns#";
+const std::string XSD = "http://www.w3.org/2001/XMLSchema#";
+
+bool isDigit(int c) {
+    return c >= '0' && c <= '9';
+}
+
+bool isAlpha(int c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool isHex(int c) {
+    return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// PN_CHARS_BASE：UTF-8 多字节序列的各字节（>= 0x80）一律放行
+bool isNameBase(int c) {
+    return isAlpha(c) || c >= 0x80;
+}
+
+// PN_CHARS
+bool isNameChar(int c) {
+    return isNameBase(c) || isDigit(c) || c == '_' || c == '-';
+}
+
+bool isSpace(int c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool equalsIgnoreCase(const std::string& word, const char* keyword) {
+    size_t length = std::strlen(keyword);
+    if (word.size() != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        if (std::toupper(static_cast<unsigned char>(word[i])) != keyword[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool hasScheme(const std::string& iri) {
+    if (iri.empty() || !isAlpha(iri[0])) {
+        return false;
+    }
+    for (char c : iri) {
+        if (c == ':') {
+            return true;
+        }
+        if (!isAlpha(c) && !isDigit(c) && c != '+' && c != '-' && c != '.') {
+            return false;
+        }
+    }
+    return false;
+}
+
+// RFC 3986 5.2.4
+std::string removeDotSegments(std::string input) {
+    std::string output;
+    auto popSegment = [&output]() {
+        size_t slash = output.rfind('/');
+        output.erase(slash == std::string::npos ? 0 : slash);
+    };
+    while (!input.empty()) {
+        if (input.compare(0, 3, "../") == 0) {
+            input.erase(0, 3);
+        } else if (input.compare(0, 2, "./") == 0) {
+            input.erase(0, 2);
+        } else if (input.compare(0, 3, "/./") == 0) {
+            input.replace(0, 3, "/");
+        } else if (input == "/.") {
+            input = "/";
+        } else if (input.compare(0, 4, "/../") == 0) {
+            input.replace(0, 4, "/");
+            popSegment();
+        } else if (input == "/..") {
+            input = "/";
+            popSegment();
+        } else if (input == "." || input == "..") {
+            input.clear();
+        } else {
+            size_t next = input.find('/', input[0] == '/' ? 1 : 0);
+            output += input.substr(0, next);
+            input.erase(0, next);
+        }
+    }
+    return output;
+}
+
+}
+
+TurtleParser::TurtleParser(std::istream& input, StringPool& pool, size_t batchSize)
+        : input(input), pool(pool), batchSize(batchSize), buffer(1 << 20),
+          blankPrefix("_:d" + std::to_string(pool.nextDocumentId())) {
+    rdfType = pool.getId(RDF + "type");
+    rdfFirst = pool.getId(RDF + "first");
+    rdfRest = pool.getId(RDF + "rest");
+    rdfNil = pool.getId(RDF + "nil");
+}
+
+bool TurtleParser::refill(size_t needed) {
+    if (pos > 0) {
+        std::memmove(buffer.data(), buffer.data() + pos, filled - pos);
+        filled -= pos;
+        pos = 0;
+    }
+    while (filled < needed && !exhausted) {
+        input.read(buffer.data() + filled, static_cast<std::streamsize>(buffer.size() - filled));
+        filled += static_cast<size_t>(input.gcount());
+        if (!input) {
+            exhausted = true;
+        }
+    }
+    return filled >= needed;
+}
+
+bool TurtleParser::nextBatch(std::vector<Triple>& batch) {
+    batch.clear();
+    out = &batch;
+    while (batch.size() < batchSize) {
+        skipWhitespace();
+        if (peek() == END) {
+            break;
+        }
+        size_t mark = batch.size();
+        try {
+            parseStatement();
+        } catch (const ParseError& error) {
+            errors.push_back(error);
+            batch.erase(batch.begin() + static_cast<std::ptrdiff_t>(mark), batch.end());
+            recover();
+        }
+    }
+    out = nullptr;
+    return !batch.empty();
+}
+
+void TurtleParser::parseStatement() {
+    int c = peek();
+    if (c == '@') {
+        advance();
+        std::string directive;
+        while (isAlpha(peek())) {
+            directive += static_cast<char>(peek());
+            advance();
+        }
+        if (directive == "prefix") {
+            parsePrefix(true);
+        } else if (directive == "base") {
+            parseBase(true);
+        } else {
+            fail("unknown directive '@" + directive + "'");
+        }
+        return;
+    }
+
+    uint32_t subject;
+    if (isNameBase(c)) {
+        // 可能是 SPARQL 风格的 PREFIX/BASE，也可能是前缀名主语
+        std::string word = readPrefixPart();
+        if (peek() != ':') {
+            if (equalsIgnoreCase(word, "PREFIX")) {
+                parsePrefix(false);
+            } else if (equalsIgnoreCase(word, "BASE")) {
+                parseBase(false);
+            } else {
+                fail("unexpected '" + word + "'");
+            }
+            return;
+        }
+        subject = pool.getId(readPrefixedName(word));
+    } else if (c == '[') {
+        subject = parseBlankNodePropertyList();
+        skipWhitespace();
+        // [ ... ] 单独成句时谓语列表可省略
+        if (peek() == '.') {
+            advance();
+            return;
+        }
+    } else {
+        subject = parseSubject();
+    }
+    skipWhitespace();
+    parsePredicateObjectList(subject);
+    skipWhitespace();
+    expect('.');
+}
+
+void TurtleParser::parsePrefix(bool atForm) {
+    skipWhitespace();
+    std::string name;
+    if (isNameBase(peek())) {
+        name = readPrefixPart();
+    }
+    expect(':');
+    skipWhitespace();
+    prefixes[name] = resolve(readIriRef());
+    if (atForm) {
+        skipWhitespace();
+        expect('.');
+    }
+}
+
+void TurtleParser::parseBase(bool atForm) {
+    skipWhitespace();
+    base = resolve(readIriRef());
+    if (atForm) {
+        skipWhitespace();
+        expect('.');
+    }
+}
+
+void TurtleParser::parsePredicateObjectList(uint32_t subject) {
+    while (true) {
+        uint32_t predicate = parseVerb();
+        skipWhitespace();
+        parseObjectList(subject, predicate);
+        skipWhitespace();
+        if (peek() != ';') {
+            return;
+        }
+        while (peek() == ';') {
+            advance();
+            skipWhitespace();
+        }
+        // 允许多余的 ;
+        int c = peek();
+        if (c == '.' || c == ']' || c == END) {
+            return;
+        }
+    }
+}
+
+void TurtleParser::parseObjectList(uint32_t subject, uint32_t predicate) {
+    while (true) {
+        emit(subject, predicate, parseObject());
+        skipWhitespace();
+        if (peek() != ',') {
+            return;
+        }
+        advance();
+        skipWhitespace();
+    }
+}
+
+uint32_t TurtleParser::parseSubject() {
+    int c = peek();
+    if (c == '<') {
+        return pool.getId(resolve(readIriRef()));
+    }
+    if (c == ':') {
+        return pool.getId(readPrefixedName(""));
+    }
+    if (c == '_') {
+        return parseBlankNodeLabel();
+    }
+    if (c == '(') {
+        return parseCollection();
+    }
+    fail("expected IRI, blank node or collection as subject");
+}
+
+uint32_t TurtleParser::parseVerb() {
+    int c = peek();
+    if (c == '<') {
+        return pool.getId(resolve(readIriRef()));
+    }
+    if (c == ':') {
+        return pool.getId(readPrefixedName(""));
+    }
+    if (isNameBase(c)) {
+        std::string word = readPrefixPart();
+        if (peek() == ':') {
+            return pool.getId(readPrefixedName(word));
+        }
+        if (word == "a") {
+            return rdfType;
+        }
+    }
+    fail("expected IRI or 'a' as predicate");
+}
+
+uint32_t TurtleParser::parseObject() {
+    int c = peek();
+    switch (c) {
+        case '<':
+            return pool.getId(resolve(readIriRef()));
+        case ':':
+            return pool.getId(readPrefixedName(""));
+        case '_':
+            return parseBlankNodeLabel();
+        case '[':
+            return parseBlankNodePropertyList();
+        case '(':
+            return parseCollection();
+        case '"':
+        case '\'':
+            return parseLiteral();
+        case '+':
+        case '-':
+            return parseNumber();
+        case '.':
+            if (isDigit(peekAt(1))) {
+                return parseNumber();
+            }
+            break;
+        default:
+            if (isDigit(c)) {
+                return parseNumber();
+            }
+            if (isNameBase(c)) {
+                std::string word = readPrefixPart();
+                if (peek() == ':') {
+                    return pool.getId(readPrefixedName(word));
+                }
+                if (word == "true" || word == "false") {
+                    return pool.getId("\"" + word + "\"^^<" + XSD + "boolean>");
+                }
+            }
+    }
+    fail("expected IRI, blank node, collection or literal as object");
+}
+
+uint32_t TurtleParser::parseBlankNodePropertyList() {
+    expect('[');
+    skipWhitespace();
+    uint32_t node = newBlankNode();
+    if (peek() != ']') {
+        parsePredicateObjectList(node);
+        skipWhitespace();
+    }
+    expect(']');
+    return node;
+}
+
+uint32_t TurtleParser::parseCollection() {
+    // ( a b ) 展开为 rdf:first/rdf:rest 链表，边读边输出
+    expect('(');
+    skipWhitespace();
+    uint32_t head = rdfNil;
+    uint32_t previous = UINT32_MAX;
+    while (peek() != ')') {
+        if (peek() == END) {
+            fail("unterminated collection");
+        }
+        uint32_t item = parseObject();
+        uint32_t node = newBlankNode();
+        if (previous == UINT32_MAX) {
+            head = node;
+        } else {
+            emit(previous, rdfRest, node);
+        }
+        emit(node, rdfFirst, item);
+        previous = node;
+        skipWhitespace();
+    }
+    advance();
+    if (previous != UINT32_MAX) {
+        emit(previous, rdfRest, rdfNil);
+    }
+    return head;
+}
+
+uint32_t TurtleParser::parseBlankNodeLabel() {
+    advance();
+    if (peek() != ':') {
+        fail("expected '_:' blank node label");
+    }
+    advance();
+    std::string label = blankPrefix + "_";
+    int c = peek();
+    if (!isNameChar(c) || c == '-') {
+        fail("invalid blank node label");
+    }
+    while (true) {
+        c = peek();
+        if (isNameChar(c) || (c == '.' && dotsContinueName(false))) {
+            label += static_cast<char>(c);
+            advance();
+        } else {
+            break;
+        }
+    }
+    return pool.getId(label);
+}
+
+uint32_t TurtleParser::parseLiteral() {
+    const int quote = peek();
+    advance();
+    bool longForm = false;
+    if (peek() == quote && peekAt(1) == quote) {
+        advance();
+        advance();
+        longForm = true;
+    }
+
+    // 统一输出为双引号形式：内容中的双引号和长字符串中的换行需要转义
+    std::string term = "\"";
+    while (true) {
+        int c = peek();
+        if (c == END) {
+            fail("unterminated literal");
+        }
+        if (c == quote) {
+            if (!longForm) {
+                advance();
+                break;
+            }
+            // 结尾的三个引号之前可以紧挨着属于内容的引号
+            if (peekAt(1) == quote && peekAt(2) == quote && peekAt(3) != quote) {
+                advance();
+                advance();
+                advance();
+                break;
+            }
+        }
+        if (c == '\\') {
+            int escaped = peekAt(1);
+            if (escaped == 'u' || escaped == 'U') {
+                readUchar(term);
+                continue;
+            }
+            if (escaped <= 0 || std::strchr("tbnrf\"'\\", escaped) == nullptr) {
+                fail("invalid escape sequence");
+            }
+            term += '\\';
+            term += static_cast<char>(escaped);
+            advance();
+            advance();
+            continue;
+        }
+        if (c == '\n' || c == '\r') {
+            if (!longForm) {
+                fail("line break in literal");
+            }
+            term += c == '\n' ? "\\n" : "\\r";
+        } else if (c == '"') {
+            term += "\\\"";
+        } else {
+            term += static_cast<char>(c);
+        }
+        advance();
+    }
+    term += '"';
+
+    if (peek() == '@') {
+        advance();
+        term += '@';
+        readLanguageTag(term);
+    } else if (peek() == '^' && peekAt(1) == '^') {
+        advance();
+        advance();
+        skipWhitespace();
+        std::string datatype;
+        int c = peek();
+        if (c == '<') {
+            datatype = resolve(readIriRef());
+        } else if (c == ':') {
+            datatype = readPrefixedName("");
+        } else if (isNameBase(c)) {
+            std::string prefix = readPrefixPart();
+            datatype = readPrefixedName(prefix);
+        } else {
+            fail("expected datatype IRI after '^^'");
+        }
+        term += "^^<" + datatype + ">";
+    }
+    return pool.getId(term);
+}
+
+uint32_t TurtleParser::parseNumber() {
+    std::string lexical;
+    if (peek() == '+' || peek() == '-') {
+        lexical += static_cast<char>(peek());
+        advance();
+    }
+    bool digits = false;
+    while (isDigit(peek())) {
+        lexical += static_cast<char>(peek());
+        advance();
+        digits = true;
+    }
+    const char* type = "integer";
+    // 末尾的 '.' 是语句结束符，只有后面跟着数字或指数时才属于数值
+    int next = peekAt(1);
+    bool exponentAfterDot = (next == 'e' || next == 'E') && digits;
+    if (peek() == '.' && (isDigit(next) || exponentAfterDot)) {
+        lexical += '.';
+        advance();
+        while (isDigit(peek())) {
+            lexical += static_cast<char>(peek());
+            advance();
+            digits = true;
+        }
+        type = "decimal";
+    }
+    if (!digits) {
+        fail("invalid numeric literal");
+    }
+    if (peek() == 'e' || peek() == 'E') {
+        lexical += static_cast<char>(peek());
+        advance();
+        if (peek() == '+' || peek() == '-') {
+            lexical += static_cast<char>(peek());
+            advance();
+        }
+        if (!isDigit(peek())) {
+            fail("invalid exponent in numeric literal");
+        }
+        while (isDigit(peek())) {
+            lexical += static_cast<char>(peek());
+            advance();
+        }
+        type = "double";
+    }
+    return pool.getId("\"" + lexical + "\"^^<" + XSD + type + ">");
+}
+
+std::string TurtleParser::readIriRef() {
+    if (peek() != '<') {
+        fail("expected IRI");
+    }
+    advance();
+    std::string iri;
+    while (true) {
+        int c = peek();
+        if (c == '>') {
+            advance();
+            return iri;
+        }
+        if (c == '\\') {
+            readUchar(iri);
+            continue;
+        }
+        if (c == END || c <= 0x20 || std::strchr("<\"{}|^`", c) != nullptr) {
+            fail(c == END ? "unterminated IRI" : "invalid character in IRI");
+        }
+        iri += static_cast<char>(c);
+        advance();
+    }
+}
+
+std::string TurtleParser::readPrefixPart() {
+    // PN_PREFIX：首字符已由调用方检查
+    std::string word;
+    while (true) {
+        int c = peek();
+        if (isNameChar(c) || (c == '.' && dotsContinueName(false))) {
+            word += static_cast<char>(c);
+            advance();
+        } else {
+            return word;
+        }
+    }
+}
+
+std::string TurtleParser::readPrefixedName(const std::string& prefix) {
+    auto it = prefixes.find(prefix);
+    if (it == prefixes.end()) {
+        fail("undefined prefix '" + prefix + ":'");
+    }
+    advance();  // ':'
+    std::string iri = it->second;
+    while (true) {
+        int c = peek();
+        if (isNameChar(c) || c == ':') {
+            iri += static_cast<char>(c);
+            advance();
+        } else if (c == '.' && dotsContinueName(true)) {
+            iri += '.';
+            advance();
+        } else if (c == '%') {
+            if (!isHex(peekAt(1)) || !isHex(peekAt(2))) {
+                fail("invalid percent encoding in local name");
+            }
+            for (int i = 0; i < 3; ++i) {
+                iri += static_cast<char>(peek());
+                advance();
+            }
+        } else if (c == '\\') {
+            // PN_LOCAL_ESC：去掉反斜杠
+            int escaped = peekAt(1);
+            if (escaped <= 0 || std::strchr("_~.-!$&'()*+,;=/?#@%", escaped) == nullptr) {
+                fail("invalid escape in local name");
+            }
+            advance();
+            iri += static_cast<char>(escaped);
+            advance();
+        } else {
+            return iri;
+        }
+    }
+}
+
+void TurtleParser::readLanguageTag(std::string& term) {
+    if (!isAlpha(peek())) {
+        fail("invalid language tag");
+    }
+    while (isAlpha(peek())) {
+        term += static_cast<char>(peek());
+        advance();
+    }
+    while (peek() == '-') {
+        term += '-';
+        advance();
+        if (!isAlpha(peek()) && !isDigit(peek())) {
+            fail("invalid language tag");
+        }
+        while (isAlpha(peek()) || isDigit(peek())) {
+            term += static_cast<char>(peek());
+            advance();
+        }
+    }
+}
+
+void TurtleParser::readUchar(std::string& term) {
+    // 与 N-Triples 一致，\u 转义保持原样
+    int kind = peekAt(1);
+    size_t digits = kind == 'u' ? 4 : kind == 'U' ? 8 : 0;
+    if (digits == 0) {
+        fail("invalid escape sequence");
+    }
+    for (size_t i = 0; i < digits; ++i) {
+        if (!isHex(peekAt(2 + i))) {
+            fail("invalid hex digit in unicode escape");
+        }
+    }
+    for (size_t i = 0; i < digits + 2; ++i) {
+        term += static_cast<char>(peek());
+        advance();
+    }
+}
+
+bool TurtleParser::dotsContinueName(bool local) {
+    // 名字不能以 '.' 结尾：连续的 '.' 之后还有名字字符时才属于名字
+    size_t k = 0;
+    while (peekAt(k) == '.') {
+        ++k;
+    }
+    int c = peekAt(k);
+    return isNameChar(c) || (local && (c == ':' || c == '%' || c == '\\'));
+}
+
+std::string TurtleParser::resolve(const std::string& reference) const {
+    if (base.empty() || hasScheme(reference)) {
+        return reference;
+    }
+    // 拆分基准 IRI：scheme ":" ["//" authority] path ["?" query] ["#" fragment]
+    size_t schemeEnd = base.find(':') + 1;
+    std::string scheme = base.substr(0, schemeEnd);
+    size_t pathStart = schemeEnd;
+    if (base.compare(schemeEnd, 2, "//") == 0) {
+        pathStart = base.find_first_of("/?#", schemeEnd + 2);
+        if (pathStart == std::string::npos) {
+            pathStart = base.size();
+        }
+    }
+    std::string authority = base.substr(schemeEnd, pathStart - schemeEnd);
+    size_t pathEnd = base.find_first_of("?#", pathStart);
+    if (pathEnd == std::string::npos) {
+        pathEnd = base.size();
+    }
+    std::string basePath = base.substr(pathStart, pathEnd - pathStart);
+    std::string withoutFragment = base.substr(0, base.find('#'));
+
+    if (reference.empty()) {
+        return withoutFragment;
+    }
+    if (reference[0] == '#') {
+        return withoutFragment + reference;
+    }
+    if (reference.compare(0, 2, "//") == 0) {
+        return scheme + reference;
+    }
+    if (reference[0] == '?') {
+        return scheme + authority + basePath + reference;
+    }
+    size_t referencePathEnd = reference.find_first_of("?#");
+    if (referencePathEnd == std::string::npos) {
+        referencePathEnd = reference.size();
+    }
+    std::string path = reference.substr(0, referencePathEnd);
+    if (path[0] != '/') {
+        if (!authority.empty() && basePath.empty()) {
+            path = "/" + path;
+        } else {
+            path = basePath.substr(0, basePath.rfind('/') + 1) + path;
+        }
+    }
+    return scheme + authority + removeDotSegments(path) + reference.substr(referencePathEnd);
+}
+
+void TurtleParser::skipWhitespace() {
+    while (true) {
+        int c = peek();
+        if (isSpace(c)) {
+            advance();
+        } else if (c == '#') {
+            while ((c = peek()) != END && c != '\n' && c != '\r') {
+                advance();
+            }
+        } else {
+            return;
+        }
+    }
+}
+
+void TurtleParser::expect(char c) {
+    if (peek() != static_cast<unsigned char>(c)) {
+        fail(std::string("expected '") + c + "'");
+    }
+    advance();
+}
+
+void TurtleParser::recover() {
+    // 跳到下一个后面跟着空白或文件结尾的 '.'，即出错语句的结束符
+    int c;
+    while ((c = peek()) != END) {
+        advance();
+        if (c == '.') {
+            int next = peek();
+            if (next == END || isSpace(next) || next == '#') {
+                return;
+            }
+        }
+    }
+}
+
+void TurtleParser::fail(const std::string& message) const {
+    throw ParseError{line, column, message};
+}
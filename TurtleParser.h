@@ -0,0 +1,106 @@
+#ifndef RDFPANDA_STORAGE_TURTLEPARSER_H
+#define RDFPANDA_STORAGE_TURTLEPARSER_H
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "NTriplesTokenizer.h"
+#include "StringPool.h"
+#include "Trie.h"
+
+// TurtleParser：流式 Turtle 1.1 解析器，单遍读取输入，内存占用只有读缓冲区、前缀表和当前语句，与文件大小无关
+// 支持 @prefix/@base 与 SPARQL 风格的 PREFIX/BASE、相对 IRI 解析、a、谓语列表 ;、宾语列表 ,、跨行语句、
+// [] 与 [ ... ] 空白节点、( ... ) 集合、单双引号及三引号字面量、语言标签、数据类型、数值与布尔字面量
+// 项按 N-Triples 的写法写入字符串池，与 parseNTriples 一致：IRI 为去掉尖括号的完整 IRI；
+// 字面量统一为双引号形式（转义为 N-Triples 写法）加 @语言 或 ^^<数据类型IRI>
+// 空白节点只在所属文档内有效：每个解析器从字符串池取得文档编号 n，带标签的空白节点写为 "_:dn_标签"，
+// 匿名空白节点写为 "_:dn.genid序号"，不同文件的同名标签以及标签与匿名节点之间都不会合并
+// 某条语句有语法错误时丢弃该语句已产生的三元组，记录位置后跳到下一条语句
+class TurtleParser {
+public:
+    TurtleParser(std::istream& input, StringPool& pool, size_t batchSize = 65536);
+
+    // 清空 batch 后解析若干完整语句，直到三元组数达到 batchSize 或输入结束；没有更多三元组时返回 false
+    bool nextBatch(std::vector<Triple>& batch);
+
+    const std::vector<ParseError>& getErrors() const { return errors; }
+    size_t getLine() const { return line; }
+
+private:
+    static constexpr int END = -1;
+
+    std::istream& input;
+    StringPool& pool;
+    size_t batchSize;
+    std::vector<char> buffer;
+    size_t pos = 0;
+    size_t filled = 0;
+    bool exhausted = false;
+    size_t line = 1;
+    size_t column = 1;
+
+    std::string base;
+    std::unordered_map<std::string, std::string> prefixes;
+    std::string blankPrefix;
+    uint64_t blankCounter = 0;
+    uint32_t rdfType;
+    uint32_t rdfFirst;
+    uint32_t rdfRest;
+    uint32_t rdfNil;
+    std::vector<Triple>* out = nullptr;
+    std::vector<ParseError> errors;
+
+    int peek() {
+        return pos < filled || refill(1) ? static_cast<unsigned char>(buffer[pos]) : END;
+    }
+    // 向前看第 k 个字符，peekAt(0) 即 peek()
+    int peekAt(size_t k) {
+        return pos + k < filled || refill(k + 1) ? static_cast<unsigned char>(buffer[pos + k]) : END;
+    }
+    // 只能在 peek() 不为 END 之后调用
+    void advance() {
+        if (buffer[pos++] == '\n') {
+            ++line;
+            column = 1;
+        } else {
+            ++column;
+        }
+    }
+    // 保留未读部分并读入更多数据，使至少 needed 个字符可用
+    bool refill(size_t needed);
+
+    void parseStatement();
+    void parsePrefix(bool atForm);
+    void parseBase(bool atForm);
+    void parsePredicateObjectList(uint32_t subject);
+    void parseObjectList(uint32_t subject, uint32_t predicate);
+    uint32_t parseSubject();
+    uint32_t parseVerb();
+    uint32_t parseObject();
+    uint32_t parseBlankNodePropertyList();
+    uint32_t parseCollection();
+    uint32_t parseBlankNodeLabel();
+    uint32_t parseLiteral();
+    uint32_t parseNumber();
+
+    std::string readIriRef();
+    std::string readPrefixPart();
+    std::string readPrefixedName(const std::string& prefix);
+    void readLanguageTag(std::string& term);
+    void readUchar(std::string& term);
+    bool dotsContinueName(bool local);
+    std::string resolve(const std::string& reference) const;
+
+    uint32_t newBlankNode() { return pool.getId(blankPrefix + ".genid" + std::to_string(++blankCounter)); }
+    void emit(uint32_t subject, uint32_t predicate, uint32_t object) { out->emplace_back(subject, predicate, object); }
+    void skipWhitespace();
+    void expect(char c);
+    void recover();
+    [[noreturn]] void fail(const std::string& message) const;
+};
+
+
+#endif //RDFPANDA_STORAGE_TURTLEPARSER_H
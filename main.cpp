@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <fstream>
@@ -6,6 +7,14 @@
 #include "InputParser.h"
 #include "TripleStore.h"
 #include "DatalogEngine.h"
+#include "QueryEngine.h"
+#include "MagicSets.h"
+#include "SchemaReasoner.h"
+#include "EqualityReasoner.h"
+#include "ReachabilityIndex.h"
+#include "IngestionPipeline.h"
+#include "BinaryRdf.h"
+#include "RdfExport.h"
 
 //// 测试用，打印文件内容
 void printFileContent(const std::string& filename) {
@@ -126,6 +135,37 @@ void TestQueryBySubject() {
     }
 }
 
+//// 测试用，测试多模式（BGP）查询
+void TestQuery() {
+    InputParser parser;
+    TripleStore store;
+
+    std::vector<Triple> triples = parser.parseTurtle("input_examples/example.ttl");
+    for (const auto& triple : triples) {
+        store.addTriple(triple);
+    }
+
+    // 查询朋友的朋友，且中间人是 Person
+    BGPQuery query;
+    query.patterns = {
+        {"?x", "http://example.org/friendOf", "?y"},
+        {"?y", "http://www.w3.org/1999/02/22-rdf-syntax-ns#type", "http://example.org/Person"},
+        {"?y", "http://example.org/friendOf", "?z"}
+    };
+    query.select = {"?x", "?z"};
+    query.distinct = true;
+
+    QueryEngine engine(store);
+    QueryResult result = engine.execute(query, [&](const std::vector<uint32_t>& row) {
+        std::cout << store.getStringPool().getString(row[0]) << " "
+                  << store.getStringPool().getString(row[1]) << std::endl;
+        return true;
+    });
+    if (!result.ok) {
+        std::cerr << "Query failed: " << result.error << std::endl;
+    }
+}
+
 //// 测试用，测试简单推理功能
 void TestInfer() {
     InputParser parser;
@@ -140,28 +180,28 @@ void TestInfer() {
     std::vector<Rule> rules;
     Rule rule1(
             "rule1",
-            std::vector<Triple>{
+            std::vector<Atom>{
                 {"?x", "http://example.org/friendOf", "?y"},
             },
-            Triple{"?x", "http://example.org/knows", "?y"}
+            Atom{"?x", "http://example.org/knows", "?y"}
     );
 
     Rule rule2(
             "rule2",
-            std::vector<Triple>{
+            std::vector<Atom>{
                 // {"?x", "http://example.org/knows", "?y"},
                 {"?x", "http://example.org/knows", "?y"},
                 {"?y", "http://example.org/knows", "?z"},
             },
-            Triple{"?x", "http://example.org/knows", "?z"}
+            Atom{"?x", "http://example.org/knows", "?z"}
     );
 
     Rule rule3(
             "rule3",
-            std::vector<Triple>{
+            std::vector<Atom>{
                 {"?x", "http://example.org/knows", "?y"},
             },
-            Triple{"?y", "http://example.org/knows", "?x"}
+            Atom{"?y", "http://example.org/knows", "?x"}
     );
 
     rules.push_back(rule1);  // 一次迭代
@@ -189,9 +229,9 @@ void TestDatalogParser() {
     for (const auto& rule : rules) {
         std::cout << rule.name << std::endl;
         for (const auto& triple : rule.body) {
-            std::cout << triple.subject() << " " << triple.predicate() << " " << triple.object() << std::endl;
+            std::cout << triple.subject << " " << triple.predicate << " " << triple.object << std::endl;
         }
-        std::cout << "=> " << rule.head.subject() << " " << rule.head.predicate() << " " << rule.head.object() << std::endl;
+        std::cout << "=> " << rule.head.subject << " " << rule.head.predicate << " " << rule.head.object << std::endl;
     }
 }
 
@@ -214,6 +254,164 @@ void TestLargeFile() {
 
 }
 
+//// 测试目标导向推理：只求某个节点可达的节点，不物化整个闭包
+void TestGoalReasoning() {
+    InputParser parser;
+    TripleStore store;
+    std::vector<Triple> triples = parser.parseTurtle("input_examples/DAG.ttl");
+    for (const auto& triple : triples) {
+        store.addTriple(triple);
+    }
+
+    std::vector<Rule> rules = parser.parseDatalogFromFile("input_examples/DAG-R.dl");
+
+    auto start = std::chrono::high_resolution_clock::now();
+    Atom goal{"http://dag.org#node840", "http://dag.org#path", "?Z"};
+    size_t count = 0;
+    reasonGoal(store, rules, goal, [&](const std::vector<uint32_t>&) {
+        count++;
+        return true;
+    });
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Reachable nodes: " << count << ", time: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+}
+
+
+//// 测试增量维护：删除再插入一批基础事实，事实库应回到完整推理的结果
+void TestIncremental() {
+    InputParser parser;
+    TripleStore store;
+    std::vector<Triple> triples = parser.parseTurtle("input_examples/mid-k.ttl");
+    for (const auto& triple : triples) {
+        store.addTriple(triple);
+    }
+    std::vector<Rule> rules = parser.parseDatalogFromFile("input_examples/mid.dl");
+    DatalogEngine engine(store, rules);
+    engine.reason();
+    size_t materializedCount = store.getTripleCount();
+
+    std::vector<Triple> batch(triples.begin(), triples.begin() + std::min<size_t>(100, triples.size()));
+    auto start = std::chrono::high_resolution_clock::now();
+    engine.deleteBase(batch);
+    auto mid = std::chrono::high_resolution_clock::now();
+    engine.insertBase(batch);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Delete: " << std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count() << " us, "
+              << "insert: " << std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count() << " us, "
+              << "triples: " << store.getTripleCount() << " (expected " << materializedCount << ")" << std::endl;
+}
+
+
+//// 测试谓语为变量的规则：RDFS 模式推理（rdfs2/3/5/7/9/11）
+void TestRDFSSchema() {
+    InputParser parser;
+    TripleStore store;
+    for (const char* file : {"input_examples/rdfs-schema.ttl", "input_examples/data_100k.ttl"}) {
+        for (const auto& triple : parser.parseTurtle(file)) {
+            store.addTriple(triple);
+        }
+    }
+    std::vector<Rule> rules = parser.parseDatalogFromFile("input_examples/rdfs.dl");
+
+    auto start = std::chrono::high_resolution_clock::now();
+    DatalogEngine engine(store, rules);
+    engine.setTimingEnabled(false);
+    engine.reason();
+    auto end = std::chrono::high_resolution_clock::now();
+    engine.printProfile(std::cout);
+    std::cout << "RDFS closure: " << store.getTripleCount() << " triples, time: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+
+    // 主语已知、谓语未知的模式走 SOP 索引
+    QueryEngine query(store);
+    BGPQuery describe;
+    describe.patterns = {{"http://example.org/Person0", "?p", "?o"}};
+    std::vector<std::vector<uint32_t>> rows;
+    query.execute(describe, rows);
+    for (const auto& row : rows) {
+        std::cout << store.getStringPool().getString(row[0]) << " " << store.getStringPool().getString(row[1]) << std::endl;
+    }
+}
+
+
+//// 测试可达性索引：path 注册为虚谓语，由 edge 的区间标号回答，不物化闭包
+void TestReachability() {
+    InputParser parser;
+    TripleStore store;
+    for (const auto& triple : parser.parseTurtle("input_examples/DAG.ttl")) {
+        store.addTriple(triple);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    ReachabilityIndex index(store, "http://dag.org#edge");
+    index.build();
+    store.registerVirtualPredicate("http://dag.org#path", &index);
+    auto end = std::chrono::high_resolution_clock::now();
+    const ReachabilityIndex::Stats& stats = index.getStats();
+    std::cout << "Reachability index: " << stats.nodes << " nodes, " << stats.components << " components, "
+              << stats.intervals << " intervals for " << stats.pairs << " path facts, time: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+
+    // DAG-R.dl 中推导 path 的规则由索引代替，不再执行
+    std::vector<Rule> rules = parser.parseDatalogFromFile("input_examples/DAG-R.dl");
+    DatalogEngine engine(store, rules);
+    engine.reason();
+
+    QueryEngine query(store);
+    BGPQuery descendants;
+    descendants.patterns = {{"http://dag.org#node840", "http://dag.org#path", "?z"}};
+    std::vector<std::vector<uint32_t>> rows;
+    query.execute(descendants, rows);
+    std::cout << "Reachable nodes: " << rows.size() << std::endl;
+}
+
+
+//// 测试内置 RDFS/OWL-RL 闭包：与通用引擎执行同样的规则文件结果一致
+void TestNativeSchema() {
+    InputParser parser;
+    TripleStore store;
+    for (const char* file : {"input_examples/rdfs-schema.ttl", "input_examples/data_100k.ttl"}) {
+        for (const auto& triple : parser.parseTurtle(file)) {
+            store.addTriple(triple);
+        }
+    }
+    std::vector<Rule> rules = parser.parseDatalogFromFile("input_examples/owl-rl.dl");
+
+    auto start = std::chrono::high_resolution_clock::now();
+    reasonWithSchema(store, rules);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Native closure: " << store.getTripleCount() << " triples, time: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+}
+
+
+//// 测试等价模式：owl:sameAs 用并查集合并，事实库只存代表元，查询时展开
+void TestEquality() {
+    InputParser parser;
+    TripleStore store;
+    for (const auto& triple : parser.parseTurtle("input_examples/sameas.ttl")) {
+        store.addTriple(triple);
+    }
+    std::vector<Rule> rules = parser.parseDatalogFromFile("input_examples/sameas.dl");
+
+    EqualityReasoner equality(store);
+    equality.reason(rules);
+    std::cout << "Canonical triples: " << store.getTripleCount() << std::endl;
+
+    // ex:Alice 与 ex:AliceSmith、ex:A_Smith 同一，ex:Paris 与 ex:ParisFrance 同一
+    BGPQuery query;
+    query.patterns = {{"http://example.org/AliceSmith", "http://example.org/birthPlace", "?place"},
+                      {"?place", "http://example.org/locatedIn", "?country"}};
+    const StringPool& pool = store.getStringPool();
+    QueryResult result = equality.query(query, [&](const std::vector<uint32_t>& row) {
+        std::cout << pool.getString(row[0]) << " " << pool.getString(row[1]) << std::endl;
+        return true;
+    });
+    std::cout << "Rows: " << result.rows << std::endl;
+}
+
+
 //// 测试百到万级三元组和两位数规则
 void TestMidFile() {
     InputParser parser;
@@ -231,6 +429,10 @@ void TestMidFile() {
     DatalogEngine engine(store, rules);
     engine.reason();
 
+    // 输出各规则的连接计划与剖析统计
+    engine.explain(std::cout);
+    engine.printProfile(std::cout);
+
 }
 
 //// 测试百万级别三元组和两位数规则
@@ -272,6 +474,98 @@ void TestMillionTriples() {
 
 }
 
+//// 测试流水线导入：解析与建索引同时进行，与先解析成 vector 再逐个 addTriple 对比
+void TestIngestionPipeline() {
+    {
+        InputParser parser;
+        TripleStore store;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const auto& triple : parser.parseTurtle("input_examples/DAG.ttl")) {
+            store.addTriple(triple);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "Parse then store: " << store.getTripleCount() << " triples, "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+    }
+
+    TripleStore store;
+    IngestionPipeline pipeline(store);
+    IngestionStats stats = pipeline.loadTurtle("input_examples/DAG.ttl");
+    stats.print(std::cout);
+}
+
+//// 二进制格式：文本解析一次后写出，之后直接按ID加载
+void TestBinaryRdf() {
+    std::string error;
+    BinaryRdfInfo info;
+    {
+        TripleStore store;
+        IngestionPipeline pipeline(store);
+        IngestionStats stats = pipeline.loadTurtle("input_examples/DAG.ttl");
+        std::cout << "Turtle load: " << stats.wallSeconds << " s" << std::endl;
+        if (!writeBinaryRdf(store, "input_examples/DAG.rdfb", error, &info)) {
+            std::cerr << error << std::endl;
+            return;
+        }
+        std::cout << "Written: " << info.terms << " terms (" << info.dictionaryBytes << " bytes), " << info.triples
+                  << " triples (" << info.triplesBytes << " bytes)" << std::endl;
+    }
+
+    TripleStore store;
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!loadBinaryRdf(store, "input_examples/DAG.rdfb", error, &info)) {
+        std::cerr << error << std::endl;
+        return;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Binary load: " << store.getTripleCount() << " triples, "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+}
+
+//// 宽表按 R2RML 映射导入
+void TestTableMapping() {
+    std::vector<TriplesMap> maps;
+    std::string error;
+    if (!loadTriplesMaps("input_examples/example-mapping.ttl", maps, error)) {
+        std::cerr << error << std::endl;
+        return;
+    }
+    InputParser parser;
+    TripleStore store;
+    parser.setStringPool(&store.getStringPool());
+    for (const auto& triple : parser.parseMappedCSV("input_examples/example-wide.csv", maps[0])) {
+        std::cout << triple.subject() << " " << triple.predicate() << " " << triple.object() << std::endl;
+    }
+}
+
+//// 导出推理结果：推导事实写为 N-Triples，全部三元组写为带前缀的 Turtle
+void TestRdfExport() {
+    InputParser parser;
+    TripleStore store;
+    for (const auto& triple : parser.parseTurtle("input_examples/mid-k.ttl")) {
+        store.addTriple(triple);
+    }
+    std::vector<Rule> rules = parser.parseDatalogFromFile("input_examples/mid.dl");
+    DatalogEngine engine(store, rules);
+    engine.reason();
+
+    std::string error;
+    ExportInfo info;
+    ExportOptions derived;
+    derived.flags = DERIVED_FACT;
+    if (!exportNTriples(store, "input_examples/mid-k-derived.nt", error, derived, &info)) {
+        std::cerr << error << std::endl;
+        return;
+    }
+    std::cout << "N-Triples: " << info.triples << " derived triples, " << info.bytes << " bytes" << std::endl;
+    if (!exportTurtle(store, "input_examples/mid-k-all.ttl", error, ExportOptions(), &info)) {
+        std::cerr << error << std::endl;
+        return;
+    }
+    std::cout << "Turtle: " << info.triples << " triples, " << info.prefixes << " prefixes, " << info.bytes << " bytes"
+              << std::endl;
+}
+
 //// 计时用
 void startTimer() {
     // 用结束时间与开始时间相减
@@ -279,7 +573,17 @@ void startTimer() {
 
     // 这里调用要测试的函数
     // TestLargeFile();
+    // TestIncremental();
+    // TestRDFSSchema();
+    // TestNativeSchema();
+    // TestEquality();
+    // TestGoalReasoning();
+    // TestReachability();
     // TestMidFile();
+    // TestIngestionPipeline();
+    // TestBinaryRdf();
+    // TestTableMapping();
+    // TestRdfExport();
     TestMillionTriples();
 
     std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
@@ -346,6 +650,7 @@ int main() {
     
     // 原有测试
     // TestInfer();
+    // TestQuery();
     // TestDatalogParser();
     // TestLargeFile();
     // startTimer();
@@ -0,0 +1,111 @@
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include "../BinaryRdf.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+class BinaryRdfTest : public ::testing::Test {
+protected:
+    const std::string path = (std::filesystem::temp_directory_path() / "rdfpanda_test.rdfb").string();
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+};
+
+TEST_F(BinaryRdfTest, RoundTripPreservesTermsAndFlags) {
+    TripleStore source;
+    add(source, "http://example.org/a", "http://example.org/p", "http://example.org/b", BASE_FACT);
+    add(source, "http://example.org/a", "http://example.org/p", "\"x\"@en", DERIVED_FACT);
+    add(source, "http://example.org/ab", "http://example.org/q", "_:b1", BASE_FACT | DERIVED_FACT);
+    add(source, "_:b1", "http://example.org/p", "\"1\"^^<http://www.w3.org/2001/XMLSchema#integer>", BASE_FACT);
+    for (int i = 0; i < 1000; ++i) {
+        add(source, "http://example.org/n" + std::to_string(i % 37), "http://example.org/r" + std::to_string(i % 5),
+            "\"" + std::to_string(i) + "\"", BASE_FACT);
+    }
+
+    std::string error;
+    BinaryRdfInfo written;
+    ASSERT_TRUE(writeBinaryRdf(source, path, error, &written)) << error;
+    EXPECT_EQ(written.triples, source.getTripleCount());
+
+    TripleStore loaded;
+    BinaryRdfInfo read;
+    ASSERT_TRUE(loadBinaryRdf(loaded, path, error, &read)) << error;
+    EXPECT_EQ(read.terms, written.terms);
+    EXPECT_EQ(read.triples, written.triples);
+    EXPECT_EQ(flaggedContents(loaded), flaggedContents(source));
+}
+
+TEST_F(BinaryRdfTest, BaseFactsOnlyLoadAsBase) {
+    TripleStore source;
+    add(source, "http://example.org/a", "http://example.org/p", "http://example.org/b", BASE_FACT);
+    std::string error;
+    ASSERT_TRUE(writeBinaryRdf(source, path, error)) << error;
+
+    TripleStore loaded;
+    ASSERT_TRUE(loadBinaryRdf(loaded, path, error)) << error;
+    ASSERT_EQ(loaded.getTripleCount(), 1u);
+    EXPECT_EQ(loaded.getTripleFlags(0), BASE_FACT);
+}
+
+// 来源标记位于文件末尾，每个三元组一个字节
+TEST_F(BinaryRdfTest, RejectsInvalidFlags) {
+    TripleStore source;
+    add(source, "http://example.org/a", "http://example.org/p", "http://example.org/b", BASE_FACT);
+    add(source, "http://example.org/a", "http://example.org/p", "http://example.org/c", DERIVED_FACT);
+    std::string error;
+    ASSERT_TRUE(writeBinaryRdf(source, path, error)) << error;
+    const std::string original = readFile(path);
+
+    for (char flags : {'\0', '\x04', '\x83'}) {
+        std::string corrupted = original;
+        corrupted.back() = flags;
+        writeFile(path, corrupted);
+        TripleStore loaded;
+        error.clear();
+        EXPECT_FALSE(loadBinaryRdf(loaded, path, error)) << "flags " << int(flags);
+        EXPECT_NE(error.find("invalid fact flags"), std::string::npos) << error;
+        EXPECT_EQ(loaded.getTripleCount(), 0u);
+    }
+}
+
+TEST_F(BinaryRdfTest, RejectsTruncatedAndForeignFiles) {
+    TripleStore source;
+    add(source, "http://example.org/a", "http://example.org/p", "http://example.org/b", BASE_FACT);
+    std::string error;
+    ASSERT_TRUE(writeBinaryRdf(source, path, error)) << error;
+    const std::string original = readFile(path);
+
+    writeFile(path, original.substr(0, original.size() - 1));
+    TripleStore truncated;
+    EXPECT_FALSE(loadBinaryRdf(truncated, path, error));
+
+    writeFile(path, "<http://example.org/a> <http://example.org/p> <http://example.org/b> .\n");
+    TripleStore text;
+    EXPECT_FALSE(loadBinaryRdf(text, path, error));
+}
+
+// 头部的词项数、三元组数（偏移 16 与 24，小端 64 位）超出段大小时返回错误，不按计数分配内存
+TEST_F(BinaryRdfTest, RejectsCountsExceedingSections) {
+    TripleStore source;
+    add(source, "http://example.org/a", "http://example.org/p", "http://example.org/b", BASE_FACT);
+    std::string error;
+    ASSERT_TRUE(writeBinaryRdf(source, path, error)) << error;
+    const std::string original = readFile(path);
+
+    for (size_t offset : {16u, 24u}) {
+        std::string corrupted = original;
+        for (size_t i = 0; i < 8; ++i) {
+            corrupted[offset + i] = i < 4 ? '\xff' : '\0';
+        }
+        writeFile(path, corrupted);
+        TripleStore loaded;
+        error.clear();
+        EXPECT_FALSE(loadBinaryRdf(loaded, path, error)) << "offset " << offset;
+        EXPECT_NE(error.find("corrupt header"), std::string::npos) << error;
+        EXPECT_EQ(loaded.getTripleCount(), 0u);
+    }
+}
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../InputParser.h"
+#include "../CompressedInput.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+#ifdef RDFPANDA_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef RDFPANDA_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+#ifdef RDFPANDA_HAS_ZLIB
+std::string gzip(const std::string& content) {
+    z_stream stream{};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&stream, content.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(content.data()));
+    stream.avail_in = static_cast<uInt>(content.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+#endif
+
+#ifdef RDFPANDA_HAS_ZSTD
+// 每 frameSize 字节压缩为一个独立的帧，与 pzstd 的输出相同
+std::string zstdFrames(const std::string& content, size_t frameSize) {
+    std::string out;
+    for (size_t offset = 0; offset < content.size(); offset += frameSize) {
+        size_t length = std::min(frameSize, content.size() - offset);
+        std::string frame(ZSTD_compressBound(length), '\0');
+        frame.resize(ZSTD_compress(&frame[0], frame.size(), content.data() + offset, length, 3));
+        out += frame;
+    }
+    return out;
+}
+#endif
+
+#if defined(RDFPANDA_HAS_ZLIB) || defined(RDFPANDA_HAS_ZSTD)
+// 大于一个 N-Triples 块（4 MB）的文件，第 3 行和最后一行有语法错误
+std::string sampleNTriples() {
+    std::string content;
+    for (int i = 0; i < 120000; ++i) {
+        if (i == 2) {
+            content += "<http://example.org/bad> .\n";
+        }
+        content += "<http://example.org/s" + std::to_string(i % 1013) + "> <http://example.org/p" +
+                   std::to_string(i % 17) + "> \"value " + std::to_string(i) + "\" .\n";
+    }
+    content += "<http://example.org/s> <http://example.org/p>\n";
+    return content;
+}
+#endif
+
+}
+
+class CompressedInputTest : public ::testing::Test {
+protected:
+    TripleStore store;
+    InputParser parser;
+    std::vector<std::string> files;
+
+    void SetUp() override {
+        parser.setStringPool(&store.getStringPool());
+    }
+
+    void TearDown() override {
+        for (const auto& file : files) {
+            std::remove(file.c_str());
+        }
+    }
+
+    std::string createFile(const std::string& name, const std::string& content) {
+        files.push_back(tempPath(name));
+        writeFile(files.back(), content);
+        return files.back();
+    }
+};
+
+TEST_F(CompressedInputTest, DetectsFormatByMagicNumber) {
+    EXPECT_EQ(detectCompression("\x1f\x8b\x08", 3), Compression::Gzip);
+    EXPECT_EQ(detectCompression("\x28\xb5\x2f\xfd", 4), Compression::Zstd);
+    EXPECT_EQ(detectCompression("<http://a> ", 11), Compression::None);
+    EXPECT_EQ(detectCompression("\x1f", 1), Compression::None);
+}
+
+TEST_F(CompressedInputTest, GzipNTriplesMatchPlain) {
+#ifdef RDFPANDA_HAS_ZLIB
+    const std::string content = sampleNTriples();
+    const std::string plain = createFile("rdfpanda_plain.nt", content);
+    const std::string compressed = createFile("rdfpanda_compressed.nt.gz", gzip(content));
+
+    std::vector<Triple> expected = parser.parseNTriples(plain, 1);
+    std::vector<size_t> expectedErrors = errorLines(parser);
+    std::vector<Triple> triples = parser.parseNTriples(compressed, 4);
+
+    ASSERT_EQ(expected.size(), 120000u);
+    EXPECT_TRUE(triples == expected);
+    EXPECT_EQ(errorLines(parser), expectedErrors);
+    EXPECT_EQ(expectedErrors, (std::vector<size_t>{3, 120002}));
+#else
+    // 未启用 zlib 时 gzip 文件报告错误，不当作文本解析
+    const std::string compressed = createFile("rdfpanda_compressed.nt.gz", std::string("\x1f\x8b\x08\x00", 4));
+    EXPECT_TRUE(parser.parseNTriples(compressed).empty());
+    EXPECT_FALSE(parser.getParseErrors().empty());
+#endif
+}
+
+// 多帧 zstd 由多个线程并行解压，结果仍按文件顺序
+TEST_F(CompressedInputTest, MultiFrameZstdNTriplesMatchPlain) {
+#ifdef RDFPANDA_HAS_ZSTD
+    const std::string content = sampleNTriples();
+    const std::string plain = createFile("rdfpanda_plain.nt", content);
+    const std::string compressed = createFile("rdfpanda_compressed.nt.zst", zstdFrames(content, 300000));
+
+    std::vector<Triple> expected = parser.parseNTriples(plain, 1);
+    std::vector<size_t> expectedErrors = errorLines(parser);
+    for (size_t threads : {1, 4}) {
+        std::vector<Triple> triples = parser.parseNTriples(compressed, threads);
+        EXPECT_TRUE(triples == expected) << threads << " threads";
+        EXPECT_EQ(errorLines(parser), expectedErrors) << threads << " threads";
+    }
+#else
+    GTEST_SKIP() << "built without libzstd";
+#endif
+}
+
+TEST_F(CompressedInputTest, CompressedTurtleMatchesPlain) {
+    std::string content = "@prefix ex: <http://example.org/> .\n";
+    for (int i = 0; i < 20000; ++i) {
+        content += "ex:s" + std::to_string(i) + " ex:p ex:o" + std::to_string(i % 7) + " ; ex:q \"" +
+                   std::to_string(i) + "\" .\n";
+    }
+    const std::string plain = createFile("rdfpanda_plain.ttl", content);
+    std::vector<Triple> expected = parser.parseTurtle(plain);
+    ASSERT_EQ(expected.size(), 40000u);
+
+    std::vector<std::string> compressed;
+#ifdef RDFPANDA_HAS_ZLIB
+    compressed.push_back(createFile("rdfpanda_compressed.ttl.gz", gzip(content)));
+#endif
+#ifdef RDFPANDA_HAS_ZSTD
+    compressed.push_back(createFile("rdfpanda_compressed.ttl.zst", zstdFrames(content, 100000)));
+#endif
+    if (compressed.empty()) {
+        GTEST_SKIP() << "built without zlib and libzstd";
+    }
+    for (const auto& file : compressed) {
+        EXPECT_TRUE(parser.parseTurtle(file) == expected) << file;
+        EXPECT_TRUE(parser.getParseErrors().empty()) << file;
+    }
+}
+
+// 压缩数据损坏时已解压的部分照常解析，并报告一个错误
+TEST_F(CompressedInputTest, CorruptGzipReportsError) {
+#ifdef RDFPANDA_HAS_ZLIB
+    std::string data = gzip(sampleNTriples());
+    data.resize(data.size() / 2);
+    const std::string compressed = createFile("rdfpanda_corrupt.nt.gz", data);
+
+    std::vector<Triple> triples = parser.parseNTriples(compressed, 2);
+    EXPECT_LT(triples.size(), 120000u);
+    EXPECT_FALSE(parser.getParseErrors().empty());
+#else
+    GTEST_SKIP() << "built without zlib";
+#endif
+}
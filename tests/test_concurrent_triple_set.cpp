@@ -0,0 +1,95 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../ConcurrentTripleSet.h"
+#include "gtest/gtest.h"
+
+TEST(ConcurrentTripleSetTest, InsertIfAbsent) {
+    ConcurrentTripleSet set;
+    EXPECT_TRUE(set.insert(1, 2, 3));
+    EXPECT_FALSE(set.insert(1, 2, 3));
+    EXPECT_TRUE(set.insert(3, 2, 1));
+    EXPECT_TRUE(set.insert(1, 3, 2));
+    // 谓语 0 与主语、宾语为 0 的三元组同样有效
+    EXPECT_TRUE(set.insert(0, 0, 0));
+    EXPECT_FALSE(set.insert(0, 0, 0));
+
+    EXPECT_TRUE(set.contains(1, 2, 3));
+    EXPECT_TRUE(set.contains(0, 0, 0));
+    EXPECT_FALSE(set.contains(2, 1, 3));
+    EXPECT_EQ(set.size(), 4u);
+
+    ConcurrentTripleSet::Stats stats = set.getStats();
+    EXPECT_EQ(stats.inserts, 4u);
+    EXPECT_EQ(stats.duplicates, 2u);
+}
+
+TEST(ConcurrentTripleSetTest, GrowsAndKeepsContents) {
+    ConcurrentTripleSet set(16);
+    const size_t initialCapacity = set.capacity();
+    for (uint32_t i = 0; i < 100000; ++i) {
+        ASSERT_TRUE(set.insert(i, i % 7, i * 3));
+    }
+    EXPECT_EQ(set.size(), 100000u);
+    EXPECT_GT(set.capacity(), initialCapacity);
+    EXPECT_GT(set.getStats().resizes, 0u);
+    for (uint32_t i = 0; i < 100000; ++i) {
+        ASSERT_TRUE(set.contains(i, i % 7, i * 3)) << i;
+        ASSERT_FALSE(set.contains(i, i % 7 + 1, i * 3)) << i;
+    }
+}
+
+TEST(ConcurrentTripleSetTest, EraseLeavesProbeChainsIntact) {
+    ConcurrentTripleSet set(64);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        set.insert(i, 1, i);
+    }
+    for (uint32_t i = 0; i < 1000; i += 2) {
+        EXPECT_TRUE(set.erase(i, 1, i));
+    }
+    EXPECT_FALSE(set.erase(0, 1, 0));
+    EXPECT_EQ(set.size(), 500u);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        EXPECT_EQ(set.contains(i, 1, i), i % 2 == 1) << i;
+    }
+    // 删除后可以重新插入
+    EXPECT_TRUE(set.insert(0, 1, 0));
+    EXPECT_TRUE(set.contains(0, 1, 0));
+
+    set.reset(10);
+    EXPECT_EQ(set.size(), 0u);
+    EXPECT_FALSE(set.contains(1, 1, 1));
+}
+
+// 多个线程插入相互重叠的三元组（同时触发扩容），每个三元组恰好有一次插入成功
+TEST(ConcurrentTripleSetTest, ConcurrentInsertsAcceptEachTripleOnce) {
+    const uint32_t distinct = 200000;
+    const int threadCount = 8;
+    ConcurrentTripleSet set(1024);
+    std::atomic<size_t> accepted{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            size_t local = 0;
+            // 各线程从不同位置开始遍历全部三元组
+            for (uint32_t k = 0; k < distinct; ++k) {
+                uint32_t i = (k + static_cast<uint32_t>(t) * (distinct / threadCount)) % distinct;
+                local += set.insert(i / 100, i % 100, i);
+            }
+            accepted += local;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(accepted.load(), distinct);
+    EXPECT_EQ(set.size(), distinct);
+    ConcurrentTripleSet::Stats stats = set.getStats();
+    EXPECT_EQ(stats.inserts, distinct);
+    EXPECT_EQ(stats.duplicates, static_cast<uint64_t>(distinct) * (threadCount - 1));
+    for (uint32_t i = 0; i < distinct; ++i) {
+        ASSERT_TRUE(set.contains(i / 100, i % 100, i)) << i;
+    }
+}
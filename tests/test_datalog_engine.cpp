@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../DatalogEngine.h"
+#include "../InputParser.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+namespace {
+
+const std::string EDGE = "http://example.org/edge";
+const std::string PATH = "http://example.org/path";
+
+std::string node(int i) {
+    return "http://example.org/n" + std::to_string(i);
+}
+
+// path 为 edge 的传递闭包（右线性）
+std::vector<Rule> closureRules() {
+    return {
+        Rule("path-base", {{"?X", EDGE, "?Y"}}, {"?X", PATH, "?Y"}),
+        Rule("path-step", {{"?X", EDGE, "?Y"}, {"?Y", PATH, "?Z"}}, {"?X", PATH, "?Z"}),
+    };
+}
+
+size_t countPredicate(TripleStore& store, const std::string& predicate) {
+    uint32_t id = store.getStringPool().getIdIfExists(predicate);
+    return id == UINT32_MAX ? 0 : store.queryTripleIdsByPredicateId(id).size();
+}
+
+}
+
+TEST(DatalogEngineTest, TransitiveClosureOfChain) {
+    TripleStore store;
+    const int n = 40;
+    for (int i = 0; i + 1 < n; ++i) {
+        store.addTriple(makeTriple(store, node(i), EDGE, node(i + 1)));
+    }
+    DatalogEngine engine(store, closureRules());
+    engine.reason();
+
+    EXPECT_EQ(countPredicate(store, PATH), static_cast<size_t>(n * (n - 1) / 2));
+    EXPECT_TRUE(store.containsTriple(makeTriple(store, node(0), PATH, node(n - 1))));
+    EXPECT_FALSE(store.containsTriple(makeTriple(store, node(n - 1), PATH, node(0))));
+    uint32_t index = store.findTriple(makeTriple(store, node(3), PATH, node(7)));
+    ASSERT_NE(index, UINT32_MAX);
+    EXPECT_EQ(store.getTripleFlags(index), DERIVED_FACT);
+}
+
+// 模式的 new/dup 只计由它触发的连接，加上第一轮全量连接的部分即为规则的合计
+TEST(DatalogEngineTest, ProfileAttributesCountsToTriggerAtoms) {
+    TripleStore store;
+    for (int i = 0; i < 30; ++i) {
+        store.addTriple(makeTriple(store, node(i), EDGE, node(i + 1)));
+        store.addTriple(makeTriple(store, node(i), EDGE, node(i + 2)));
+    }
+    DatalogEngine engine(store, closureRules());
+    engine.reason();
+
+    const std::vector<RuleProfile>& profiles = engine.getProfile();
+    ASSERT_EQ(profiles.size(), 2u);
+    const RuleProfile& step = profiles[1];
+    EXPECT_EQ(step.name, "path-step");
+    ASSERT_EQ(step.atoms.size(), 2u);
+
+    uint64_t triggers = 0, emitted = 0, inserted = 0, duplicates = 0, wall = 0, cpu = 0;
+    for (const auto& atom : step.atoms) {
+        triggers += atom.triggers;
+        emitted += atom.emitted;
+        inserted += atom.inserted;
+        duplicates += atom.duplicates;
+        wall += atom.wallNanos;
+        cpu += atom.cpuNanos;
+    }
+    EXPECT_GT(step.atoms[1].triggers, 0u);   // 新的 path 事实触发 path-step
+    EXPECT_GT(step.atoms[1].duplicates, 0u);  // 两条路径到达同一节点
+    EXPECT_EQ(triggers + 1, step.invocations);  // 另有一次第一轮全量连接
+    EXPECT_EQ(inserted + duplicates, emitted);
+    EXPECT_LE(emitted, step.emitted);
+    EXPECT_LE(inserted, step.inserted);
+    EXPECT_LE(duplicates, step.duplicates);
+    EXPECT_LE(wall, step.wallNanos);
+    EXPECT_LE(cpu, step.cpuNanos);
+    EXPECT_GT(step.atoms[1].wallNanos, 0u);
+
+    std::ostringstream json;
+    engine.printProfile(json, ReportFormat::Json);
+    EXPECT_NE(json.str().find("\"duplicates\": " + std::to_string(step.atoms[1].duplicates)), std::string::npos);
+    EXPECT_NE(json.str().find("\"cpuNanos\""), std::string::npos);
+}
+
+TEST(DatalogEngineTest, ProfileWithoutTimingKeepsCounts) {
+    TripleStore store;
+    for (int i = 0; i < 10; ++i) {
+        store.addTriple(makeTriple(store, node(i), EDGE, node(i + 1)));
+    }
+    DatalogEngine engine(store, closureRules());
+    engine.setTimingEnabled(false);
+    engine.reason();
+
+    const RuleProfile& step = engine.getProfile()[1];
+    EXPECT_EQ(step.wallNanos, 0u);
+    EXPECT_EQ(step.atoms[1].wallNanos, 0u);
+    EXPECT_EQ(step.atoms[1].cpuNanos, 0u);
+    EXPECT_GT(step.atoms[1].inserted, 0u);
+}
+
+namespace {
+
+// 由给定的边重新完整推理
+std::set<FlaggedFact> recomputed(const std::vector<std::pair<int, int>>& edges) {
+    TripleStore store;
+    for (const auto& e : edges) {
+        store.addTriple(makeTriple(store, node(e.first), EDGE, node(e.second)));
+    }
+    DatalogEngine engine(store, closureRules());
+    engine.reason();
+    return flaggedContents(store);
+}
+
+}
+
+// 删除与插入后的事实库与由剩余基础事实重新推理的结果相同，含环（DRed 的重新推导）
+TEST(DatalogEngineTest, IncrementalMatchesRecomputation) {
+    std::vector<std::pair<int, int>> edges = {{0, 1}, {1, 2}, {2, 3}, {3, 1}, {3, 4}, {4, 5}, {0, 4}, {6, 7}};
+    TripleStore store;
+    for (const auto& e : edges) {
+        store.addTriple(makeTriple(store, node(e.first), EDGE, node(e.second)));
+    }
+    DatalogEngine engine(store, closureRules());
+    engine.reason();
+    ASSERT_EQ(flaggedContents(store), recomputed(edges));
+
+    // 删除环上的一条边：n1、n2、n3 之间的部分路径不再成立，n0 -> n5 仍可经 n4 到达
+    engine.deleteBase({makeTriple(store, node(3), EDGE, node(1))});
+    edges.erase(std::find(edges.begin(), edges.end(), std::make_pair(3, 1)));
+    EXPECT_EQ(flaggedContents(store), recomputed(edges));
+    EXPECT_GT(engine.getMaintenanceStats().overDeleted, engine.getMaintenanceStats().rederived);
+    EXPECT_TRUE(store.containsTriple(makeTriple(store, node(0), PATH, node(5))));
+    EXPECT_FALSE(store.containsTriple(makeTriple(store, node(3), PATH, node(2))));
+
+    // 插入一条连接两部分的边
+    engine.insertBase({makeTriple(store, node(5), EDGE, node(6))});
+    edges.emplace_back(5, 6);
+    EXPECT_EQ(flaggedContents(store), recomputed(edges));
+    EXPECT_TRUE(store.containsTriple(makeTriple(store, node(0), PATH, node(7))));
+
+    // 删除不存在的事实不改变事实库
+    engine.deleteBase({makeTriple(store, node(9), EDGE, node(8))});
+    EXPECT_EQ(engine.getMaintenanceStats().baseChanged, 0u);
+    EXPECT_EQ(flaggedContents(store), recomputed(edges));
+}
+
+// 也能由规则推出的基础事实：删除基础标记后由重新推导保留为推导事实
+TEST(DatalogEngineTest, DeletingBaseFactKeepsDerivedCopy) {
+    std::vector<Rule> rules = {
+        Rule("", {{"?X", EDGE, "?Y"}}, {"?X", PATH, "?Y"}),
+        Rule("", {{"?X", PATH, "?Y"}, {"?Y", PATH, "?Z"}}, {"?X", PATH, "?Z"}),
+    };
+    TripleStore store;
+    store.addTriple(makeTriple(store, node(0), EDGE, node(1)));
+    store.addTriple(makeTriple(store, node(1), EDGE, node(2)));
+    store.addTriple(makeTriple(store, node(0), PATH, node(2)));
+    DatalogEngine engine(store, rules);
+    engine.reason();
+    uint32_t index = store.findTriple(makeTriple(store, node(0), PATH, node(2)));
+    ASSERT_NE(index, UINT32_MAX);
+    EXPECT_EQ(store.getTripleFlags(index), BASE_FACT);
+
+    engine.deleteBase({makeTriple(store, node(0), PATH, node(2))});
+    index = store.findTriple(makeTriple(store, node(0), PATH, node(2)));
+    ASSERT_NE(index, UINT32_MAX);
+    EXPECT_EQ(store.getTripleFlags(index), DERIVED_FACT);
+    EXPECT_EQ(engine.getMaintenanceStats().baseChanged, 1u);
+    EXPECT_EQ(engine.getMaintenanceStats().rederived, 1u);
+
+    engine.deleteBase({makeTriple(store, node(1), EDGE, node(2))});
+    EXPECT_FALSE(store.containsTriple(makeTriple(store, node(0), PATH, node(2))));
+    EXPECT_TRUE(store.containsTriple(makeTriple(store, node(0), PATH, node(1))));
+}
+
+namespace {
+
+const std::string RDF_TYPE = "http://www.w3.org/1999/02/22-rdf-syntax-ns#type";
+const std::string SUB_PROPERTY = "http://www.w3.org/2000/01/rdf-schema#subPropertyOf";
+const std::string SUB_CLASS = "http://www.w3.org/2000/01/rdf-schema#subClassOf";
+const std::string DOMAIN = "http://www.w3.org/2000/01/rdf-schema#domain";
+const std::string RANGE = "http://www.w3.org/2000/01/rdf-schema#range";
+
+std::string ex(const std::string& local) {
+    return "http://example.org/" + local;
+}
+
+// 逐条规则、逐个模式穷举全部事实的朴素求值，作为参照
+void naiveMatch(const Rule& rule, size_t atomIdx, std::map<std::string, std::string>& bindings,
+                const std::set<TermFact>& facts, std::set<TermFact>& derived) {
+    auto resolve = [&](const std::string& term) {
+        return term[0] == '?' ? bindings[term] : term;
+    };
+    if (atomIdx == rule.body.size()) {
+        derived.emplace(resolve(rule.head.subject), resolve(rule.head.predicate), resolve(rule.head.object));
+        return;
+    }
+    const Atom& atom = rule.body[atomIdx];
+    for (const auto& fact : facts) {
+        std::map<std::string, std::string> next = bindings;
+        bool matched = true;
+        const std::string* terms[3] = {&atom.subject, &atom.predicate, &atom.object};
+        const std::string* values[3] = {&std::get<0>(fact), &std::get<1>(fact), &std::get<2>(fact)};
+        for (int i = 0; i < 3 && matched; ++i) {
+            if ((*terms[i])[0] != '?') {
+                matched = *terms[i] == *values[i];
+            } else {
+                auto inserted = next.emplace(*terms[i], *values[i]);
+                matched = inserted.second || inserted.first->second == *values[i];
+            }
+        }
+        if (matched) {
+            naiveMatch(rule, atomIdx + 1, next, facts, derived);
+        }
+    }
+}
+
+std::set<TermFact> naiveClosure(std::set<TermFact> facts, const std::vector<Rule>& rules) {
+    for (size_t before = 0; before != facts.size();) {
+        before = facts.size();
+        std::set<TermFact> derived;
+        for (const auto& rule : rules) {
+            std::map<std::string, std::string> bindings;
+            naiveMatch(rule, 0, bindings, facts, derived);
+        }
+        facts.insert(derived.begin(), derived.end());
+    }
+    return facts;
+}
+
+// 小型模式：属性层次三层、类层次两层，另有 domain/range 与对称属性
+std::set<TermFact> schemaFacts() {
+    return {
+        {ex("parentOf"), SUB_PROPERTY, ex("relativeOf")},
+        {ex("relativeOf"), SUB_PROPERTY, ex("knows")},
+        {ex("knows"), DOMAIN, ex("Person")},
+        {ex("knows"), RANGE, ex("Person")},
+        {ex("worksAt"), RANGE, ex("Organization")},
+        {ex("Person"), SUB_CLASS, ex("Agent")},
+        {ex("Organization"), SUB_CLASS, ex("Agent")},
+        {ex("Agent"), SUB_CLASS, ex("Thing")},
+        {ex("marriedTo"), RDF_TYPE, ex("Symmetric")},
+        {ex("marriedTo"), SUB_PROPERTY, ex("relativeOf")},
+        {ex("ann"), ex("parentOf"), ex("bob")},
+        {ex("bob"), ex("marriedTo"), ex("cat")},
+        {ex("cat"), ex("worksAt"), ex("acme")},
+        {ex("dan"), RDF_TYPE, ex("Organization")},
+    };
+}
+
+// 规则文件经解析器读入：谓语为变量的模式写作 ?P(...)；前缀只在谓语位置展开，其余位置的常量写完整 IRI
+std::vector<Rule> parseRules(const std::string& text) {
+    const std::string path = tempPath("rdfpanda_rules.dl");
+    writeFile(path, text);
+    InputParser parser;
+    std::vector<Rule> rules = parser.parseDatalogFromFile(path);
+    std::remove(path.c_str());
+    return rules;
+}
+
+const char* const SCHEMA_RULES =
+        "PREFIX rdf: <http://www.w3.org/1999/02/22-rdf-syntax-ns#>\n"
+        "PREFIX rdfs: <http://www.w3.org/2000/01/rdf-schema#>\n"
+        "rdf:type(?X, ?C) :- rdfs:domain(?P, ?C), ?P(?X, ?Y) .\n"
+        "rdf:type(?Y, ?C) :- rdfs:range(?P, ?C), ?P(?X, ?Y) .\n"
+        "rdfs:subPropertyOf(?P, ?R) :- rdfs:subPropertyOf(?P, ?Q), rdfs:subPropertyOf(?Q, ?R) .\n"
+        "?Q(?X, ?Y) :- rdfs:subPropertyOf(?P, ?Q), ?P(?X, ?Y) .\n"
+        "rdf:type(?X, ?D) :- rdfs:subClassOf(?C, ?D), rdf:type(?X, ?C) .\n"
+        "?P(?Y, ?X) :- rdf:type(?P, http://example.org/Symmetric), ?P(?X, ?Y) .\n";
+
+}
+
+TEST(DatalogEngineTest, ParsesVariablePredicateAtoms) {
+    std::vector<Rule> rules = parseRules(SCHEMA_RULES);
+    ASSERT_EQ(rules.size(), 6u);
+    EXPECT_EQ(rules[3].head.predicate, "?Q");
+    ASSERT_EQ(rules[3].body.size(), 2u);
+    EXPECT_EQ(rules[3].body[0].predicate, SUB_PROPERTY);
+    EXPECT_EQ(rules[3].body[1].predicate, "?P");
+    EXPECT_EQ(rules[3].body[1].subject, "?X");
+    EXPECT_EQ(rules[5].body[0].object, ex("Symmetric"));
+}
+
+// 谓语为变量的规则：结果与朴素求值一致（模式三元组本身也参与 ?P 的匹配）
+TEST(DatalogEngineTest, VariablePredicateRulesMatchNaiveEvaluation) {
+    const std::vector<Rule> rules = parseRules(SCHEMA_RULES);
+    const std::set<TermFact> expected = naiveClosure(schemaFacts(), rules);
+    TripleStore store;
+    load(store, schemaFacts());
+    DatalogEngine engine(store, rules);
+    engine.reason();
+
+    EXPECT_EQ(contents(store), expected);
+    EXPECT_TRUE(expected.count({ex("ann"), ex("knows"), ex("bob")}));
+    EXPECT_TRUE(expected.count({ex("cat"), ex("knows"), ex("bob")}));
+    EXPECT_TRUE(expected.count({ex("parentOf"), SUB_PROPERTY, ex("knows")}));
+    EXPECT_TRUE(expected.count({ex("acme"), RDF_TYPE, ex("Thing")}));
+    EXPECT_TRUE(expected.count({ex("dan"), RDF_TYPE, ex("Agent")}));
+}
+
+// 删除时谓语为变量的模式同样参与过度删除与重新推导
+TEST(DatalogEngineTest, VariablePredicateRulesMaintainedIncrementally) {
+    const std::vector<Rule> rules = parseRules(SCHEMA_RULES);
+    std::set<TermFact> base = schemaFacts();
+    TripleStore store;
+    load(store, base);
+    DatalogEngine engine(store, rules);
+    engine.reason();
+
+    const TermFact removed{ex("relativeOf"), SUB_PROPERTY, ex("knows")};
+    engine.deleteBase({makeTriple(store, std::get<0>(removed), std::get<1>(removed), std::get<2>(removed))});
+    base.erase(removed);
+    EXPECT_EQ(contents(store), naiveClosure(base, rules));
+    EXPECT_FALSE(store.containsTriple(makeTriple(store, ex("ann"), ex("knows"), ex("bob"))));
+    EXPECT_TRUE(store.containsTriple(makeTriple(store, ex("cat"), ex("relativeOf"), ex("bob"))));
+
+    const TermFact added{ex("cat"), ex("parentOf"), ex("eve")};
+    engine.insertBase({makeTriple(store, std::get<0>(added), std::get<1>(added), std::get<2>(added))});
+    base.insert(added);
+    EXPECT_EQ(contents(store), naiveClosure(base, rules));
+}
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../EqualityReasoner.h"
+#include "../DatalogEngine.h"
+#include "../InputParser.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+namespace {
+
+const std::string SAME_AS = "http://www.w3.org/2002/07/owl#sameAs";
+const std::string RDF_TYPE = "http://www.w3.org/1999/02/22-rdf-syntax-ns#type";
+const std::string FUNCTIONAL = "http://www.w3.org/2002/07/owl#FunctionalProperty";
+const std::string EX = "http://example.org/";
+
+// 仓库自带的等价规则文件（五条等价规则与函数属性、反函数属性规则），测试在 tests 目录下运行
+std::vector<Rule> sameAsRules() {
+    InputParser parser;
+    return parser.parseDatalogFromFile("../input_examples/sameas.dl");
+}
+
+// 随机数据：若干 sameAs 链、一个函数属性，以及引用各成员的普通事实
+void randomData(TripleStore& store, unsigned seed) {
+    std::mt19937 random(seed);
+    auto entity = [&]() { return EX + "e" + std::to_string(random() % 30); };
+    for (int i = 0; i < 12; ++i) {
+        add(store, entity(), SAME_AS, entity());
+    }
+    add(store, EX + "mother", RDF_TYPE, FUNCTIONAL);
+    for (int i = 0; i < 6; ++i) {
+        add(store, entity(), EX + "mother", entity());
+    }
+    for (int i = 0; i < 40; ++i) {
+        add(store, entity(), EX + "knows", entity());
+        add(store, entity(), EX + "name", "\"n" + std::to_string(random() % 10) + "\"");
+    }
+    // 谓语之间的等价
+    add(store, EX + "knows", SAME_AS, EX + "acquaintedWith");
+}
+
+std::vector<std::string> run(const std::function<QueryResult(const BGPQuery&, const RowCallback&)>& execute,
+                             const TripleStore& store, const BGPQuery& query) {
+    std::vector<std::string> rows;
+    QueryResult result = execute(query, [&](const std::vector<uint32_t>& row) {
+        std::string line;
+        for (uint32_t value : row) {
+            line += store.getStringPool().getString(value) + " ";
+        }
+        rows.push_back(line);
+        return true;
+    });
+    EXPECT_TRUE(result.ok) << result.error;
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+}
+
+TEST(EqualityReasonerTest, EquivalenceClassesMergeSmallerIntoLarger) {
+    EquivalenceClasses classes;
+    std::vector<uint32_t> demoted;
+    EXPECT_EQ(classes.find(7), 7u);
+    EXPECT_EQ(classes.members(7), nullptr);
+
+    EXPECT_TRUE(classes.unite(1, 2, demoted));
+    EXPECT_TRUE(classes.unite(2, 3, demoted));
+    EXPECT_FALSE(classes.unite(3, 1, demoted));
+    EXPECT_TRUE(classes.unite(4, 5, demoted));
+    ASSERT_EQ(demoted.size(), 3u);
+
+    // 两个元素的类并入三个元素的类，代表元不变
+    const uint32_t rep = classes.find(1);
+    EXPECT_TRUE(classes.unite(5, 3, demoted));
+    EXPECT_EQ(classes.find(4), rep);
+    EXPECT_EQ(classes.find(5), rep);
+    ASSERT_NE(classes.members(rep), nullptr);
+    std::vector<uint32_t> members = *classes.members(rep);
+    std::sort(members.begin(), members.end());
+    EXPECT_EQ(members, (std::vector<uint32_t>{1, 2, 3, 4, 5}));
+    EXPECT_EQ(classes.getClassCount(), 1u);
+    EXPECT_EQ(classes.getMemberCount(), 5u);
+}
+
+TEST(EqualityReasonerTest, RecognizesShippedRuleFile) {
+    std::vector<Rule> rules = sameAsRules();
+    ASSERT_EQ(rules.size(), 7u);
+    std::vector<Rule> remaining;
+    EXPECT_EQ(recognizeEqualityRules(rules, remaining), 5u);
+    ASSERT_EQ(remaining.size(), 2u);
+    EXPECT_EQ(remaining[0].head.predicate, SAME_AS);
+}
+
+TEST(EqualityReasonerTest, CanonicalStoreKeepsOneFactPerClass) {
+    TripleStore store;
+    add(store, EX + "a", SAME_AS, EX + "b");
+    add(store, EX + "b", SAME_AS, EX + "c");
+    add(store, EX + "a", EX + "p", EX + "x");
+    add(store, EX + "b", EX + "p", EX + "x");
+    add(store, EX + "c", EX + "p", EX + "x");
+    EqualityReasoner reasoner(store);
+    EXPECT_EQ(reasoner.canonicalize(), 2u);
+    EXPECT_EQ(store.queryTripleIdsByPredicateId(id(store, EX + "p")).size(), 1u);
+    EXPECT_EQ(reasoner.getClasses().find(id(store, EX + "c")), reasoner.getClasses().find(id(store, EX + "a")));
+    EXPECT_EQ(reasoner.canonicalize(), 0u);
+
+    // 查询时常量可以用类中任意成员，结果按类展开
+    BGPQuery query;
+    query.patterns = {{"?s", EX + "p", EX + "x"}};
+    auto execute = [&](const BGPQuery& q, const RowCallback& onRow) { return reasoner.query(q, onRow); };
+    EXPECT_EQ(run(execute, store, query).size(), 3u);
+    query.patterns = {{EX + "c", EX + "p", "?o"}};
+    EXPECT_EQ(run(execute, store, query), (std::vector<std::string>{EX + "x "}));
+}
+
+// 规范化推理后的查询与用全部规则物化后的查询结果相同（含重复行与 DISTINCT）
+TEST(EqualityReasonerTest, QueriesMatchFullMaterialization) {
+    const std::vector<Rule> rules = sameAsRules();
+    std::vector<BGPQuery> queries(5);
+    queries[0].patterns = {{"?s", "?p", "?o"}};
+    queries[1].patterns = {{"?x", EX + "knows", "?y"}, {"?y", EX + "name", "?n"}};
+    queries[1].select = {"?x", "?n"};
+    queries[2] = queries[1];
+    queries[2].distinct = true;
+    queries[3].patterns = {{"?x", EX + "acquaintedWith", EX + "e3"}, {"?x", SAME_AS, "?y"}};
+    queries[4].patterns = {{"?x", EX + "mother", "?m"}};
+    queries[4].select = {"?x"};
+
+    for (unsigned seed = 1; seed <= 8; ++seed) {
+        TripleStore full;
+        randomData(full, seed);
+        DatalogEngine engine(full, rules);
+        engine.reason();
+        QueryEngine fullEngine(full);
+
+        TripleStore canonical;
+        randomData(canonical, seed);
+        EqualityReasoner reasoner(canonical);
+        reasoner.reason(rules);
+        EXPECT_LT(canonical.getTripleCount(), full.getTripleCount());
+
+        // 第一条查询的谓语是变量
+        for (TripleStore* store : {&full, &canonical}) {
+            store->enableTrieOrder(TrieOrder::SOP);
+            store->enableTrieOrder(TrieOrder::OSP);
+        }
+        for (size_t q = 0; q < queries.size(); ++q) {
+            auto expected = run([&](const BGPQuery& b, const RowCallback& onRow) {
+                return fullEngine.execute(b, onRow);
+            }, full, queries[q]);
+            auto actual = run([&](const BGPQuery& b, const RowCallback& onRow) {
+                return reasoner.query(b, onRow);
+            }, canonical, queries[q]);
+            EXPECT_EQ(actual, expected) << "seed " << seed << " query " << q;
+        }
+    }
+}
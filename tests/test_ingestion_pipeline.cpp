@@ -0,0 +1,122 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../BoundedQueue.h"
+#include "../IngestionPipeline.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+namespace {
+
+// 不经流水线：解析出完整的三元组列表后逐个写入
+std::set<TermFact> loadDirectly(const std::string& filename, bool turtle) {
+    TripleStore store;
+    InputParser parser;
+    parser.setStringPool(&store.getStringPool());
+    for (const auto& triple : turtle ? parser.parseTurtle(filename) : parser.parseNTriples(filename, 1)) {
+        store.addTriple(triple);
+    }
+    return contents(store);
+}
+
+}
+
+TEST(BoundedQueueTest, BlocksWhenFullAndDrainsAfterClose) {
+    BoundedQueue<int> queue(2);
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&]() {
+        pushed = queue.push(3);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed.load());  // 队列已满，生产者阻塞
+
+    int item = 0;
+    ASSERT_TRUE(queue.pop(item));
+    EXPECT_EQ(item, 1);
+    producer.join();
+    EXPECT_TRUE(pushed.load());
+
+    queue.close();
+    EXPECT_FALSE(queue.push(4));
+    ASSERT_TRUE(queue.pop(item));
+    EXPECT_EQ(item, 2);
+    ASSERT_TRUE(queue.pop(item));
+    EXPECT_EQ(item, 3);
+    EXPECT_FALSE(queue.pop(item));
+}
+
+class IngestionPipelineTest : public ::testing::Test {
+protected:
+    const std::string path = (std::filesystem::temp_directory_path() / "rdfpanda_pipeline.nt").string();
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+};
+
+// 小队列、小批次下多个解析线程与建索引线程交替阻塞，事实库内容与直接导入相同
+TEST_F(IngestionPipelineTest, NTriplesMatchDirectLoad) {
+    {
+        std::ofstream out(path, std::ios::binary);
+        // 后一半与前一半重复
+        for (int i = 0; i < 300000; ++i) {
+            const int j = i % 150000;
+            out << "<http://example.org/s" << j % 20000 << "> <http://example.org/p" << j % 5
+                << "> \"value " << j << "\" .\n";
+        }
+    }
+    const std::set<TermFact> expected = loadDirectly(path, false);
+    ASSERT_EQ(expected.size(), 150000u);
+
+    TripleStore store;
+    IngestionPipeline pipeline(store, 2, 1000);
+    IngestionStats stats = pipeline.loadNTriples(path, 4);
+    EXPECT_TRUE(pipeline.getParseErrors().empty());
+    EXPECT_EQ(stats.parsed, 300000u);
+    EXPECT_EQ(stats.stored, 150000u);
+    EXPECT_GE(stats.batches, 300u);
+    EXPECT_EQ(stats.parserThreads, 4u);
+    EXPECT_EQ(store.getTripleCount(), 150000u);
+    EXPECT_EQ(contents(store), expected);
+}
+
+TEST_F(IngestionPipelineTest, TurtleAndCsvSources) {
+    TripleStore turtle;
+    IngestionPipeline turtlePipeline(turtle, 2, 2);
+    IngestionStats stats = turtlePipeline.loadTurtle("input_examples/example.ttl");
+    EXPECT_EQ(stats.parsed, turtle.getTripleCount());
+    EXPECT_EQ(contents(turtle), loadDirectly("input_examples/example.ttl", true));
+
+    TripleStore csv;
+    IngestionPipeline csvPipeline(csv, 2, 2);
+    stats = csvPipeline.loadCSV("input_examples/example.csv", CsvOptions(), 2);
+    EXPECT_GT(stats.parsed, 0u);
+    EXPECT_EQ(csv.getTripleCount(), stats.stored);
+}
+
+// 解析错误经流水线报告，其余行照常写入
+TEST_F(IngestionPipelineTest, ReportsParseErrors) {
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "<http://a/s> <http://a/p> \"1\" .\n"
+            << "not a triple\n"
+            << "<http://a/s> <http://a/p> \"2\" .\n";
+    }
+    TripleStore store;
+    IngestionPipeline pipeline(store);
+    IngestionStats stats = pipeline.loadNTriples(path, 2);
+    EXPECT_EQ(stats.parsed, 2u);
+    EXPECT_EQ(store.getTripleCount(), 2u);
+    ASSERT_EQ(pipeline.getParseErrors().size(), 1u);
+    EXPECT_EQ(pipeline.getParseErrors()[0].line, 2u);
+}
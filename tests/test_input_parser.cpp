@@ -1,37 +1,319 @@
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
 #include "../InputParser.h"
 #include "gtest/gtest.h"
+#include "test_util.h"
+
+namespace {
+
+// 测试用的临时文件，析构时删除
+class TempFile {
+public:
+    TempFile(const std::string& name, const std::string& content) : path(tempPath(name)) {
+        writeFile(path, content);
+    }
+    ~TempFile() { std::remove(path.c_str()); }
+
+    const std::string path;
+};
+
+}
 
-TEST(InputParserTest, ParseNTriples) {
+// 每个测试使用自己的事实库，解析结果写入其字符串池
+class InputParserTest : public ::testing::Test {
+protected:
+    TripleStore store;
     InputParser parser;
+
+    void SetUp() override {
+        parser.setStringPool(&store.getStringPool());
+    }
+};
+
+TEST_F(InputParserTest, ParseNTriples) {
     std::vector<Triple> triples = parser.parseNTriples("input_examples/example.nt");
 
-    ASSERT_EQ(triples.size(), 3);
-    EXPECT_EQ(std::get<0>(triples[0]), "http://example.org/subject");
-    EXPECT_EQ(std::get<1>(triples[0]), "http://example.org/predicate");
-    EXPECT_EQ(std::get<2>(triples[0]), "\"object\"");
+    ASSERT_EQ(triples.size(), 3u);
+    EXPECT_EQ(triples[0].subject(), "http://example.org/subject");
+    EXPECT_EQ(triples[0].predicate(), "http://example.org/predicate");
+    EXPECT_EQ(triples[0].object(), "\"object\"");
 }
 
-TEST(InputParserTest, ParseTurtle) {
-    InputParser parser;
+TEST_F(InputParserTest, ParseTurtle) {
     std::vector<Triple> triples = parser.parseTurtle("input_examples/example.ttl");
 
-    ASSERT_EQ(triples.size(), 3);
-    EXPECT_EQ(std::get<0>(triples[0]), "http://example.org/subject");
-    EXPECT_EQ(std::get<1>(triples[0]), "http://example.org/predicate");
-    EXPECT_EQ(std::get<2>(triples[0]), "\"object\"");
+    ASSERT_EQ(triples.size(), 3u);
+    EXPECT_EQ(triples[0].subject(), "http://example.org/subject");
+    EXPECT_EQ(triples[0].predicate(), "http://example.org/predicate");
+    EXPECT_EQ(triples[0].object(), "\"object\"");
 }
 
-TEST(InputParserTest, ParseCSV) {
-    InputParser parser;
+TEST_F(InputParserTest, ParseCSV) {
     std::vector<Triple> triples = parser.parseCSV("input_examples/example.csv");
 
-    ASSERT_EQ(triples.size(), 3);
-    EXPECT_EQ(std::get<0>(triples[0]), "subject1");
-    EXPECT_EQ(std::get<1>(triples[0]), "predicate1");
-    EXPECT_EQ(std::get<2>(triples[0]), "object1");
+    ASSERT_EQ(triples.size(), 3u);
+    EXPECT_EQ(triples[0].subject(), "subject1");
+    EXPECT_EQ(triples[0].predicate(), "predicate1");
+    EXPECT_EQ(triples[0].object(), "object1");
+}
+
+TEST_F(InputParserTest, NTriplesTermForms) {
+    TempFile file("rdfpanda_terms.nt",
+                  "# comment\n"
+                  "_:b1 <http://a/p> \"chat\"@fr .\n"
+                  "<http://a/s><http://a/p>\"1\"^^<http://www.w3.org/2001/XMLSchema#integer>.\r\n"
+                  "<http://a/x\\u0020y> <http://a/p> \"say \\\"hi\\\"\\n\" . # trailing\n"
+                  "\n"
+                  "\t<http://a/s> <http://a/p> _:b1 .");
+    std::vector<Triple> triples = parser.parseNTriples(file.path);
+
+    EXPECT_TRUE(parser.getParseErrors().empty());
+    ASSERT_EQ(triples.size(), 4u);
+    EXPECT_EQ(triples[0].subject(), "_:b1");
+    EXPECT_EQ(triples[0].object(), "\"chat\"@fr");
+    EXPECT_EQ(triples[1].subject(), "http://a/s");
+    EXPECT_EQ(triples[1].object(), "\"1\"^^<http://www.w3.org/2001/XMLSchema#integer>");
+    EXPECT_EQ(triples[2].subject(), "http://a/x\\u0020y");
+    EXPECT_EQ(triples[2].object(), "\"say \\\"hi\\\"\\n\"");
+    EXPECT_EQ(triples[3].object(), "_:b1");
+}
+
+TEST_F(InputParserTest, NTriplesErrorLineNumbers) {
+    TempFile file("rdfpanda_errors.nt",
+                  "<http://a/s> <http://a/p> <http://a/o1> .\n"
+                  "<http://a/s> <http://a/p> .\n"
+                  "<http://a/s> <http://a/p> <http://a/o2> .\n"
+                  "\n"
+                  "<http://a/s> \"literal\" <http://a/o> .\n"
+                  "<http://a/s> <http://a/p> \"unterminated .\n"
+                  "<http://a/s> <http://a/p> <http://a/o3> .\n");
+    std::vector<Triple> triples = parser.parseNTriples(file.path);
+
+    ASSERT_EQ(triples.size(), 3u);
+    EXPECT_EQ(triples[0].object(), "http://a/o1");
+    EXPECT_EQ(triples[1].object(), "http://a/o2");
+    EXPECT_EQ(triples[2].object(), "http://a/o3");
+    EXPECT_EQ(errorLines(parser), (std::vector<size_t>{2, 5, 6}));
 }
 
-int main(int argc, char **argv) {
-    ::testing::InitGoogleTest(&argc, argv);
-    return RUN_ALL_TESTS();
-}
\ No newline at end of file
+// 文件大于一个块（4 MB）时，各块并行解析的结果与单线程相同，块边界附近的错误行号仍按整个文件计算
+TEST_F(InputParserTest, NTriplesChunkBoundariesMatchSingleThread) {
+    const size_t lines = 200000;
+    std::string content;
+    std::vector<size_t> expectedErrors;
+    for (size_t i = 1; i <= lines; ++i) {
+        if (i % 40000 == 0) {
+            content += "<http://example.org/bad> broken line\n";
+            expectedErrors.push_back(i);
+            continue;
+        }
+        content += "<http://example.org/s" + std::to_string(i % 977) + "> <http://example.org/p" +
+                   std::to_string(i % 13) + "> \"value " + std::to_string(i) + "\" .\n";
+    }
+    ASSERT_GT(content.size(), size_t(8) << 20);
+    TempFile file("rdfpanda_chunks.nt", content);
+
+    std::vector<Triple> single = parser.parseNTriples(file.path, 1);
+    std::vector<size_t> singleErrors = errorLines(parser);
+    std::vector<Triple> parallel = parser.parseNTriples(file.path, 4);
+    std::vector<size_t> parallelErrors = errorLines(parser);
+
+    ASSERT_EQ(single.size(), lines - expectedErrors.size());
+    EXPECT_TRUE(single == parallel);
+    EXPECT_EQ(singleErrors, expectedErrors);
+    EXPECT_EQ(parallelErrors, expectedErrors);
+    EXPECT_EQ(parallel.back().object(), "\"value " + std::to_string(lines - 1) + "\"");
+
+    size_t batched = parser.parseNTriplesBatches(file.path, [](std::vector<Triple>&) {}, 4, 1000);
+    EXPECT_EQ(batched, single.size());
+}
+
+TEST_F(InputParserTest, MissingFileYieldsNoTriples) {
+    EXPECT_TRUE(parser.parseNTriples("input_examples/does_not_exist.nt").empty());
+}
+
+TEST_F(InputParserTest, TurtleGrammar) {
+    TempFile file("rdfpanda_grammar.ttl",
+                  "@base <http://example.org/> .\n"
+                  "PREFIX ex: <http://example.org/ns#>\n"
+                  "@prefix xsd: <http://www.w3.org/2001/XMLSchema#> .\n"
+                  "<doc> a ex:Document ;\n"
+                  "    ex:title 'Title'@en , \"\"\"two\n"
+                  "lines\"\"\" ;\n"
+                  "    ex:count 42 ; ex:ok true ;\n"
+                  "    ex:author [ ex:name \"Ann\" ] ;\n"
+                  "    ex:tags ( ex:a ex:b ) .\n");
+    std::vector<Triple> triples = parser.parseTurtle(file.path);
+
+    EXPECT_TRUE(parser.getParseErrors().empty());
+    std::vector<std::string> lines;
+    for (const auto& t : triples) {
+        lines.push_back(t.subject() + " " + t.predicate() + " " + t.object());
+    }
+    const std::string rdf = "http://www.w3.org/1999/02/22-rdf-syntax-ns#";
+    const std::vector<std::string> expected = {
+        "http://example.org/doc " + rdf + "type http://example.org/ns#Document",
+        "http://example.org/doc http://example.org/ns#title \"Title\"@en",
+        "http://example.org/doc http://example.org/ns#title \"two\\nlines\"",
+        "http://example.org/doc http://example.org/ns#count \"42\"^^<http://www.w3.org/2001/XMLSchema#integer>",
+        "http://example.org/doc http://example.org/ns#ok \"true\"^^<http://www.w3.org/2001/XMLSchema#boolean>",
+        "_:d1.genid1 http://example.org/ns#name \"Ann\"",
+        "http://example.org/doc http://example.org/ns#author _:d1.genid1",
+        "_:d1.genid2 " + rdf + "first http://example.org/ns#a",
+        "_:d1.genid2 " + rdf + "rest _:d1.genid3",
+        "_:d1.genid3 " + rdf + "first http://example.org/ns#b",
+        "_:d1.genid3 " + rdf + "rest " + rdf + "nil",
+        "http://example.org/doc http://example.org/ns#tags _:d1.genid2",
+    };
+    EXPECT_EQ(lines, expected);
+}
+
+TEST_F(InputParserTest, TurtleErrorsSkipStatement) {
+    TempFile file("rdfpanda_errors.ttl",
+                  "@prefix ex: <http://example.org/> .\n"
+                  "ex:s ex:p ex:o1 .\n"
+                  "ex:s ex:p ex:o2 ;\n"
+                  "     ex:q undeclared:x .\n"
+                  "ex:s ex:p ex:o3 .\n");
+    std::vector<Triple> triples = parser.parseTurtle(file.path);
+
+    ASSERT_EQ(triples.size(), 2u);
+    EXPECT_EQ(triples[0].object(), "http://example.org/o1");
+    EXPECT_EQ(triples[1].object(), "http://example.org/o3");
+    EXPECT_EQ(errorLines(parser), (std::vector<size_t>{4}));
+}
+
+// 批大小只影响回调次数，不影响结果及其顺序
+TEST_F(InputParserTest, TurtleBatchesMatchWholeFile) {
+    std::string content = "@prefix ex: <http://example.org/> .\n";
+    for (int i = 0; i < 5000; ++i) {
+        content += "ex:s" + std::to_string(i) + " ex:p ex:o" + std::to_string(i % 7) + " , \"" +
+                   std::to_string(i) + "\" ; ex:q [ ex:r " + std::to_string(i) + " ] .\n";
+    }
+    TempFile file("rdfpanda_batches.ttl", content);
+
+    std::vector<Triple> whole = parser.parseTurtle(file.path);
+    std::vector<Triple> batched;
+    size_t batches = 0;
+    size_t count = parser.parseTurtleBatches(file.path, [&](std::vector<Triple>& batch) {
+        batched.insert(batched.end(), batch.begin(), batch.end());
+        batches++;
+    }, 100);
+
+    ASSERT_EQ(whole.size(), 20000u);
+    EXPECT_EQ(count, whole.size());
+    EXPECT_GT(batches, 1u);
+    // 两次解析的文档编号不同（1 和 2），空白节点的标签只有编号部分不同
+    ASSERT_EQ(batched.size(), whole.size());
+    const StringPool& pool = store.getStringPool();
+    auto render = [&pool](uint32_t id, const std::string& document) {
+        std::string term = pool.getString(id);
+        return term.compare(0, document.size(), document) == 0 ? "_:d." + term.substr(document.size()) : term;
+    };
+    for (size_t i = 0; i < whole.size(); ++i) {
+        ASSERT_EQ(render(batched[i].getSubjectId(), "_:d2."), render(whole[i].getSubjectId(), "_:d1.")) << "triple " << i;
+        ASSERT_EQ(batched[i].getPredicateId(), whole[i].getPredicateId()) << "triple " << i;
+        ASSERT_EQ(render(batched[i].getObjectId(), "_:d2."), render(whole[i].getObjectId(), "_:d1.")) << "triple " << i;
+    }
+}
+
+// 空白节点只在所属文档内有效：不同文件的匿名节点与同名标签、以及与形如 genid 的标签都不会合并
+TEST_F(InputParserTest, TurtleBlankNodesAreScopedPerDocument) {
+    TempFile a("rdfpanda_blank_a.ttl",
+               "@prefix ex: <http://example.org/> .\n"
+               "ex:a ex:p [ ex:q 1 ] .\n"
+               "_:genid1 ex:r \"labeled\" .\n"
+               "_:x ex:r \"a\" .\n"
+               "ex:a ex:s _:x .\n");
+    TempFile b("rdfpanda_blank_b.ttl",
+               "@prefix ex: <http://example.org/> .\n"
+               "ex:b ex:p [ ex:q 2 ] .\n"
+               "_:x ex:r \"b\" .\n");
+    for (const std::string& path : {a.path, b.path}) {
+        for (const auto& triple : parser.parseTurtle(path)) {
+            store.addTriple(triple);
+        }
+        EXPECT_TRUE(parser.getParseErrors().empty()) << path;
+    }
+    ASSERT_EQ(store.getTripleCount(), 8u);
+
+    const StringPool& pool = store.getStringPool();
+    auto subjectOf = [&](const std::string& predicate, const std::string& object) {
+        for (const auto& t : store.getAllTripleIds()) {
+            if (pool.getString(t.predicate_id) == predicate && pool.getString(t.object_id) == object) {
+                return t.subject_id;
+            }
+        }
+        ADD_FAILURE() << "no subject for " << predicate << " " << object;
+        return UINT32_MAX;
+    };
+    const std::string integer = "^^<http://www.w3.org/2001/XMLSchema#integer>";
+    const uint32_t anonymousA = subjectOf("http://example.org/q", "\"1\"" + integer);
+    const uint32_t anonymousB = subjectOf("http://example.org/q", "\"2\"" + integer);
+    const uint32_t labeled = subjectOf("http://example.org/r", "\"labeled\"");
+    const uint32_t xA = subjectOf("http://example.org/r", "\"a\"");
+    const uint32_t xB = subjectOf("http://example.org/r", "\"b\"");
+    EXPECT_EQ(std::set<uint32_t>({anonymousA, anonymousB, labeled, xA, xB}).size(), 5u);
+
+    // 同一文件内同名标签仍是同一个节点
+    const uint32_t s = pool.getIdIfExists("http://example.org/s");
+    for (const auto& t : store.getAllTripleIds()) {
+        if (t.predicate_id == s) {
+            EXPECT_EQ(t.object_id, xA);
+        }
+    }
+    EXPECT_EQ(pool.getString(labeled), "_:d1_genid1");
+    EXPECT_EQ(pool.getString(anonymousA), "_:d1.genid1");
+    EXPECT_EQ(pool.getString(anonymousB), "_:d2.genid1");
+}
+
+TEST_F(InputParserTest, CsvQuotingAndColumnMapping) {
+    TempFile file("rdfpanda_quoting.csv",
+                  "id;name;note\r\n"
+                  "s1;\"Ann; B.\";\"says \"\"hi\"\"\"\r\n"
+                  "\n"
+                  "s2;Bob;\"two\n"
+                  "lines\"\n"
+                  "s3;bad\"quote;x\n"
+                  "s4;Eve;\n");
+    CsvOptions options;
+    options.delimiter = ';';
+    options.header = true;
+    options.predicateColumn = -1;
+    options.predicate = "http://example.org/note";
+    options.objectColumn = 2;
+    std::vector<Triple> triples = parser.parseCSV(file.path, options);
+
+    ASSERT_EQ(triples.size(), 3u);
+    EXPECT_EQ(triples[0].subject(), "s1");
+    EXPECT_EQ(triples[0].predicate(), "http://example.org/note");
+    EXPECT_EQ(triples[0].object(), "says \"hi\"");
+    EXPECT_EQ(triples[1].object(), "two\nlines");
+    EXPECT_EQ(triples[2].subject(), "s4");
+    EXPECT_EQ(triples[2].object(), "");
+    EXPECT_EQ(errorLines(parser), (std::vector<size_t>{6}));
+}
+
+// 引号内的换行跨过块边界时，并行解析仍与单线程相同
+TEST_F(InputParserTest, CsvChunkBoundariesMatchSingleThread) {
+    const size_t rows = 200000;
+    std::string content;
+    for (size_t i = 0; i < rows; ++i) {
+        content += "s" + std::to_string(i % 501) + ",p" + std::to_string(i % 11) + ",\"value " + std::to_string(i) +
+                   "\nsecond line, with \"\"quotes\"\"\n\"\n";
+    }
+    ASSERT_GT(content.size(), size_t(8) << 20);
+    TempFile file("rdfpanda_chunks.csv", content);
+
+    std::vector<Triple> single = parser.parseCSV(file.path, CsvOptions(), 1);
+    std::vector<Triple> parallel = parser.parseCSV(file.path, CsvOptions(), 4);
+
+    EXPECT_TRUE(parser.getParseErrors().empty());
+    ASSERT_EQ(single.size(), rows);
+    EXPECT_TRUE(single == parallel);
+    EXPECT_EQ(parallel.back().object(),
+              "value " + std::to_string(rows - 1) + "\nsecond line, with \"quotes\"\n");
+}
@@ -0,0 +1,144 @@
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../MagicSets.h"
+#include "../DatalogEngine.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+namespace {
+
+const std::string EDGE = "http://example.org/edge";
+const std::string PATH = "http://example.org/path";
+
+void addEdge(TripleStore& store, const std::string& from, const std::string& to) {
+    add(store, from, EDGE, to);
+}
+
+// 右线性：path(X, Z) :- edge(X, Y), path(Y, Z)
+std::vector<Rule> linearRules() {
+    return {
+        Rule("", {{"?X", EDGE, "?Y"}}, {"?X", PATH, "?Y"}),
+        Rule("", {{"?X", EDGE, "?Y"}, {"?Y", PATH, "?Z"}}, {"?X", PATH, "?Z"}),
+    };
+}
+
+// 非线性：path(X, Z) :- path(X, Y), path(Y, Z)，不能分解改写
+std::vector<Rule> nonLinearRules() {
+    return {
+        Rule("", {{"?X", EDGE, "?Y"}}, {"?X", PATH, "?Y"}),
+        Rule("", {{"?X", PATH, "?Y"}, {"?Y", PATH, "?Z"}}, {"?X", PATH, "?Z"}),
+    };
+}
+
+std::set<std::string> answers(TripleStore& store, const std::vector<Rule>& rules, const Atom& goal) {
+    std::set<std::string> result;
+    QueryResult summary = reasonGoal(store, rules, goal, [&](const std::vector<uint32_t>& row) {
+        result.insert(store.getStringPool().getString(row[0]));
+        return true;
+    });
+    EXPECT_TRUE(summary.ok) << summary.error;
+    return result;
+}
+
+size_t magicFacts(const TripleStore& store) {
+    size_t count = 0;
+    for (const auto& ids : store.getAllTripleIds()) {
+        const std::string& predicate = store.getStringPool().getString(ids.predicate_id);
+        count += predicate.compare(0, std::strlen(MAGIC_NAMESPACE), MAGIC_NAMESPACE) == 0;
+    }
+    return count;
+}
+
+bool contains(TripleStore& store, const std::string& s, const std::string& p, const std::string& o) {
+    const StringPool& pool = store.getStringPool();
+    uint32_t ids[] = {pool.getIdIfExists(s), pool.getIdIfExists(p), pool.getIdIfExists(o)};
+    for (uint32_t id : ids) {
+        if (id == UINT32_MAX) {
+            return false;
+        }
+    }
+    return store.containsTriple(Triple(ids[0], ids[1], ids[2]));
+}
+
+// 小型有环图：n0 -> n1 -> ... -> n9 -> n3，另有 n20 -> n21 与孤立的 n30 -> n31
+void buildGraph(TripleStore& store) {
+    for (int i = 0; i < 9; ++i) {
+        addEdge(store, "n" + std::to_string(i), "n" + std::to_string(i + 1));
+    }
+    addEdge(store, "n9", "n3");
+    addEdge(store, "n20", "n21");
+    addEdge(store, "n21", "n5");
+    addEdge(store, "n30", "n31");
+}
+
+// 在完整物化的事实库上求目标的答案，作为期望结果
+std::set<std::string> materialized(const std::vector<Rule>& rules, const Atom& goal) {
+    TripleStore full;
+    buildGraph(full);
+    DatalogEngine engine(full, rules);
+    engine.reason();
+    QueryEngine query(full);
+    BGPQuery target;
+    target.patterns = {goal};
+    std::set<std::string> result;
+    query.execute(target, [&](const std::vector<uint32_t>& row) {
+        result.insert(full.getStringPool().getString(row[0]));
+        return true;
+    });
+    return result;
+}
+
+}
+
+TEST(MagicSetsTest, BackToBackBoundGoals) {
+    TripleStore store;
+    addEdge(store, "a", "b");
+    addEdge(store, "c", "d");
+
+    EXPECT_EQ(answers(store, linearRules(), {"a", PATH, "?Z"}), (std::set<std::string>{"b"}));
+    EXPECT_EQ(answers(store, linearRules(), {"c", PATH, "?Z"}), (std::set<std::string>{"d"}));
+    EXPECT_FALSE(contains(store, "c", PATH, "b"));
+    EXPECT_TRUE(contains(store, "a", PATH, "b"));
+    EXPECT_TRUE(contains(store, "c", PATH, "d"));
+    EXPECT_EQ(magicFacts(store), 0u);
+    EXPECT_EQ(store.getTripleCount(), 4u);
+}
+
+// 同一事实库上依次求多个目标（含 bf 与 fb），每个结果都与完整物化相同
+TEST(MagicSetsTest, GoalSequenceMatchesMaterialization) {
+    for (const auto& rules : {linearRules(), nonLinearRules()}) {
+        TripleStore store;
+        buildGraph(store);
+        const std::vector<Atom> goals = {
+            {"n5", PATH, "?Z"}, {"n20", PATH, "?Z"}, {"n30", PATH, "?Z"}, {"?X", PATH, "n4"},
+            {"n0", PATH, "?Z"}, {"?X", PATH, "n21"}, {"n31", PATH, "?Z"}, {"n5", PATH, "?Z"},
+        };
+        for (const auto& goal : goals) {
+            std::set<std::string> expected = materialized(rules, goal);
+            EXPECT_EQ(answers(store, rules, goal), expected) << goal.subject << " path " << goal.object;
+            EXPECT_EQ(magicFacts(store), 0u);
+        }
+    }
+}
+
+TEST(MagicSetsTest, RewriteIsGoalDirected) {
+    MagicProgram linear = magicSetsRewrite(linearRules(), {"a", PATH, "?Z"});
+    EXPECT_TRUE(linear.goalDirected);
+    ASSERT_TRUE(linear.hasSeed);
+    EXPECT_EQ(linear.seed.subject, "a");
+    EXPECT_EQ(linear.seed.object, MAGIC_FILLER);
+
+    // 目标谓语不由规则推导时无需推理
+    MagicProgram base = magicSetsRewrite(linearRules(), {"a", EDGE, "?Z"});
+    EXPECT_TRUE(base.goalDirected);
+    EXPECT_FALSE(base.hasSeed);
+    EXPECT_TRUE(base.rules.empty());
+
+    // 谓语为变量时退回全量推理
+    MagicProgram variable = magicSetsRewrite(linearRules(), {"a", "?P", "?Z"});
+    EXPECT_FALSE(variable.goalDirected);
+    EXPECT_EQ(variable.rules.size(), 2u);
+}
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../QueryEngine.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+namespace {
+
+const std::string KNOWS = "http://example.org/knows";
+const std::string NAME = "http://example.org/name";
+const std::string AGE = "http://example.org/age";
+
+// 行转为字符串后排序，便于与期望结果比较
+std::vector<std::string> render(const TripleStore& store, const std::vector<std::vector<uint32_t>>& rows) {
+    std::vector<std::string> result;
+    for (const auto& row : rows) {
+        std::string line;
+        for (size_t i = 0; i < row.size(); ++i) {
+            line += (i ? " " : "") + store.getStringPool().getString(row[i]);
+        }
+        result.push_back(line);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+}
+
+class QueryEngineTest : public ::testing::Test {
+protected:
+    TripleStore store;
+
+    void add(const std::string& s, const std::string& p, const std::string& o) {
+        ::add(store, s, p, o);
+    }
+
+    void SetUp() override {
+        add("alice", KNOWS, "bob");
+        add("alice", KNOWS, "carol");
+        add("bob", KNOWS, "carol");
+        add("carol", KNOWS, "alice");
+        add("alice", NAME, "\"Alice\"");
+        add("bob", NAME, "\"Bob\"");
+        add("carol", NAME, "\"Carol\"");
+        add("alice", AGE, "\"30\"");
+    }
+
+    std::vector<std::string> run(const BGPQuery& query, QueryResult* summary = nullptr) {
+        QueryEngine engine(store);
+        std::vector<std::vector<uint32_t>> rows;
+        QueryResult result = engine.execute(query, rows);
+        EXPECT_TRUE(result.ok) << result.error;
+        EXPECT_EQ(result.rows, rows.size());
+        if (summary) {
+            *summary = result;
+        }
+        return render(store, rows);
+    }
+};
+
+TEST_F(QueryEngineTest, JoinWithProjection) {
+    BGPQuery query;
+    query.patterns = {{"?x", KNOWS, "?y"}, {"?y", NAME, "?name"}};
+    query.select = {"?x", "?name"};
+    QueryResult summary;
+    EXPECT_EQ(run(query, &summary), (std::vector<std::string>{
+            "alice \"Bob\"", "alice \"Carol\"", "bob \"Carol\"", "carol \"Alice\""}));
+    EXPECT_EQ(summary.columns, (std::vector<std::string>{"?x", "?name"}));
+}
+
+TEST_F(QueryEngineTest, AllVariablesInOrderOfAppearance) {
+    BGPQuery query;
+    query.patterns = {{"?a", AGE, "?age"}, {"?a", KNOWS, "?b"}};
+    QueryResult summary;
+    EXPECT_EQ(run(query, &summary), (std::vector<std::string>{"alice \"30\" bob", "alice \"30\" carol"}));
+    EXPECT_EQ(summary.columns, (std::vector<std::string>{"?a", "?age", "?b"}));
+}
+
+// 未输出的变量：不加 DISTINCT 时每组绑定输出一行，加 DISTINCT 时每个输出行只出现一次
+TEST_F(QueryEngineTest, DistinctAndDuplicates) {
+    BGPQuery query;
+    query.patterns = {{"?x", KNOWS, "?y"}};
+    query.select = {"?x"};
+    EXPECT_EQ(run(query), (std::vector<std::string>{"alice", "alice", "bob", "carol"}));
+    query.distinct = true;
+    EXPECT_EQ(run(query), (std::vector<std::string>{"alice", "bob", "carol"}));
+
+    // 未输出变量在输出变量之前消解时同样去重
+    BGPQuery reverse;
+    reverse.patterns = {{"?x", KNOWS, "?y"}, {"?y", KNOWS, "?z"}};
+    reverse.select = {"?z"};
+    reverse.distinct = true;
+    EXPECT_EQ(run(reverse), (std::vector<std::string>{"alice", "bob", "carol"}));
+}
+
+TEST_F(QueryEngineTest, LimitAndEarlyStop) {
+    BGPQuery query;
+    query.patterns = {{"?x", KNOWS, "?y"}};
+    query.limit = 2;
+    EXPECT_EQ(run(query).size(), 2u);
+
+    query.limit = SIZE_MAX;
+    QueryEngine engine(store);
+    size_t seen = 0;
+    QueryResult result = engine.execute(query, [&](const std::vector<uint32_t>&) { return ++seen < 3; });
+    EXPECT_EQ(seen, 3u);
+    EXPECT_EQ(result.rows, 3u);
+}
+
+TEST_F(QueryEngineTest, CyclicPattern) {
+    BGPQuery query;
+    query.patterns = {{"?a", KNOWS, "?b"}, {"?b", KNOWS, "?c"}, {"?c", KNOWS, "?a"}};
+    EXPECT_EQ(run(query), (std::vector<std::string>{
+            "alice bob carol", "bob carol alice", "carol alice bob"}));
+}
+
+TEST_F(QueryEngineTest, VariablePredicate) {
+    store.enableTrieOrder(TrieOrder::SOP);
+    store.enableTrieOrder(TrieOrder::OSP);
+    BGPQuery query;
+    query.patterns = {{"alice", "?p", "?o"}};
+    EXPECT_EQ(run(query).size(), 4u);
+
+    BGPQuery both;
+    both.patterns = {{"?s", "?p", "carol"}};
+    both.select = {"?s"};
+    EXPECT_EQ(run(both), (std::vector<std::string>{"alice", "bob"}));
+}
+
+TEST_F(QueryEngineTest, UnknownConstantAndVariable) {
+    BGPQuery missing;
+    missing.patterns = {{"?x", "http://example.org/unknown", "?y"}};
+    EXPECT_TRUE(run(missing).empty());
+    // 查询不向字符串池写入新的常量
+    EXPECT_EQ(store.getStringPool().getIdIfExists("http://example.org/unknown"), UINT32_MAX);
+
+    BGPQuery badSelect;
+    badSelect.patterns = {{"?x", KNOWS, "?y"}};
+    badSelect.select = {"?z"};
+    QueryEngine engine(store);
+    std::vector<std::vector<uint32_t>> rows;
+    QueryResult result = engine.execute(badSelect, rows);
+    EXPECT_FALSE(result.ok);
+    EXPECT_NE(result.error.find("?z"), std::string::npos);
+}
@@ -0,0 +1,147 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../RdfExport.h"
+#include "../InputParser.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+namespace {
+
+// Turtle 解析器把空白节点标签限定在文档内（"_:d文档编号_标签"），比较前去掉文档部分
+std::string unscoped(const std::string& term, const std::string& document) {
+    return !document.empty() && term.compare(0, document.size(), document) == 0 ? "_:" + term.substr(document.size())
+                                                                                 : term;
+}
+
+std::set<TermFact> contents(const std::vector<Triple>& triples, const std::string& document = "") {
+    std::set<TermFact> result;
+    for (const auto& t : triples) {
+        result.emplace(unscoped(t.subject(), document), t.predicate(), unscoped(t.object(), document));
+    }
+    return result;
+}
+
+// 写法与 N-Triples/Turtle 解析结果一致的项，导出后再解析应得到相同的字符串
+void addSampleTerms(TripleStore& store) {
+    const std::string ex = "http://example.org/";
+    add(store, ex + "a", ex + "p", ex + "b");
+    add(store, ex + "a", ex + "p", "\"plain\"");
+    add(store, ex + "a", ex + "p", "\"tab\\there \\\"quoted\\\" \\\\ back\"@en-GB");
+    add(store, ex + "a", ex + "q", "\"5\"^^<http://www.w3.org/2001/XMLSchema#integer>");
+    add(store, ex + "a", "http://www.w3.org/1999/02/22-rdf-syntax-ns#type", ex + "Thing");
+    add(store, "_:b0", ex + "q", ex + "x\\u0020y");
+    add(store, ex + "smile\\U0001F600", ex + "p", "_:b0", DERIVED_FACT);
+    add(store, ex + "path/with.dot", ex + "p", ex + "c", DERIVED_FACT);
+}
+
+}
+
+class RdfExportTest : public ::testing::Test {
+protected:
+    TripleStore store;
+    const std::string path = (std::filesystem::temp_directory_path() / "rdfpanda_export.out").string();
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+
+    // 导出的文件由新的解析器读入另一个事实库的字符串池
+    std::set<TermFact> reparse(bool turtle) {
+        TripleStore reloaded;
+        InputParser parser;
+        parser.setStringPool(&reloaded.getStringPool());
+        std::vector<Triple> triples = turtle ? parser.parseTurtle(path) : parser.parseNTriples(path);
+        EXPECT_TRUE(parser.getParseErrors().empty());
+        std::set<TermFact> result = contents(triples, turtle ? "_:d1_" : "");
+        Triple::setStringPool(&store.getStringPool());
+        return result;
+    }
+
+    std::set<TermFact> expected(uint8_t flags) {
+        std::set<TermFact> result;
+        const auto& ids = store.getAllTripleIds();
+        const StringPool& pool = store.getStringPool();
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (store.getTripleFlags(static_cast<uint32_t>(i)) & flags) {
+                result.emplace(pool.getString(ids[i].subject_id), pool.getString(ids[i].predicate_id),
+                               pool.getString(ids[i].object_id));
+            }
+        }
+        return result;
+    }
+};
+
+TEST_F(RdfExportTest, NTriplesRoundTrip) {
+    addSampleTerms(store);
+    std::string error;
+    ExportInfo info;
+    ASSERT_TRUE(exportNTriples(store, path, error, ExportOptions(), &info)) << error;
+    EXPECT_EQ(info.triples, store.getTripleCount());
+    EXPECT_EQ(reparse(false), expected(BASE_FACT | DERIVED_FACT));
+}
+
+TEST_F(RdfExportTest, TurtleRoundTrip) {
+    addSampleTerms(store);
+    std::string error;
+    ExportInfo info;
+    ASSERT_TRUE(exportTurtle(store, path, error, ExportOptions(), &info)) << error;
+    EXPECT_GT(info.prefixes, 0u);
+    EXPECT_EQ(reparse(true), expected(BASE_FACT | DERIVED_FACT));
+}
+
+TEST_F(RdfExportTest, FlagsSelectTriples) {
+    addSampleTerms(store);
+    std::string error;
+    ExportOptions options;
+    options.flags = DERIVED_FACT;
+    ASSERT_TRUE(exportNTriples(store, path, error, options)) << error;
+    EXPECT_EQ(reparse(false), expected(DERIVED_FACT));
+    EXPECT_EQ(expected(DERIVED_FACT).size(), 2u);
+}
+
+// IRI 中已有的 \u 转义照抄，单独的反斜杠与不允许出现的字符才转义
+TEST_F(RdfExportTest, IriEscapes) {
+    add(store, "http://a/x\\u0020y", "http://a/p", "http://a/big\\U0001F600");
+    add(store, "http://a/back\\slash", "http://a/p", "http://a/bad\\u12", BASE_FACT);
+    add(store, "http://a/space here", "http://a/p", "http://a/<angle>");
+    std::string error;
+    ExportOptions options;
+    options.numThreads = 1;
+    ASSERT_TRUE(exportNTriples(store, path, error, options)) << error;
+
+    EXPECT_EQ(readFile(path),
+              "<http://a/x\\u0020y> <http://a/p> <http://a/big\\U0001F600> .\n"
+              "<http://a/back\\u005Cslash> <http://a/p> <http://a/bad\\u005Cu12> .\n"
+              "<http://a/space\\u0020here> <http://a/p> <http://a/\\u003Cangle\\u003E> .\n");
+}
+
+// 多块导出：多线程与单线程的输出逐字节相同
+TEST_F(RdfExportTest, ParallelOutputMatchesSingleThread) {
+    for (int i = 0; i < 150000; ++i) {
+        add(store, "http://example.org/s" + std::to_string(i % 1000), "http://example.org/p" + std::to_string(i % 9),
+            "\"" + std::to_string(i) + "\"");
+    }
+    std::string error;
+    for (bool turtle : {false, true}) {
+        ExportOptions options;
+        options.numThreads = 1;
+        ASSERT_TRUE((turtle ? exportTurtle : exportNTriples)(store, path, error, options, nullptr)) << error;
+        const std::string single = readFile(path);
+        options.numThreads = 4;
+        ASSERT_TRUE((turtle ? exportTurtle : exportNTriples)(store, path, error, options, nullptr)) << error;
+        EXPECT_TRUE(readFile(path) == single) << (turtle ? "turtle" : "n-triples");
+        EXPECT_EQ(reparse(turtle).size(), store.getTripleCount());
+    }
+}
+
+TEST_F(RdfExportTest, UnwritablePathReportsError) {
+    add(store, "http://a/s", "http://a/p", "http://a/o");
+    std::string error;
+    EXPECT_FALSE(exportNTriples(store, "/nonexistent-dir/out.nt", error));
+    EXPECT_FALSE(error.empty());
+}
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../ReachabilityIndex.h"
+#include "../DatalogEngine.h"
+#include "../QueryEngine.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+namespace {
+
+const std::string EDGE = "http://example.org/edge";
+const std::string PATH = "http://example.org/path";
+const std::string LABEL = "http://example.org/label";
+const std::string REACHES = "http://example.org/reaches";
+
+std::string node(int i) {
+    return "http://example.org/n" + std::to_string(i);
+}
+
+// 随机有向图：含环与自环；每个节点带一个标签，用于混合连接
+std::vector<std::pair<int, int>> randomEdges(unsigned seed, int nodes, int edges) {
+    std::mt19937 random(seed);
+    std::vector<std::pair<int, int>> result;
+    for (int i = 0; i < edges; ++i) {
+        int from = static_cast<int>(random() % nodes);
+        // 多数边指向编号更大的节点，少数反向边形成环
+        int to = random() % 5 == 0 ? static_cast<int>(random() % nodes)
+                                   : from + 1 + static_cast<int>(random() % 4);
+        result.emplace_back(from, std::min(to, nodes - 1));
+    }
+    return result;
+}
+
+void load(TripleStore& store, const std::vector<std::pair<int, int>>& edges, int nodes) {
+    for (const auto& e : edges) {
+        add(store, node(e.first), EDGE, node(e.second));
+    }
+    for (int i = 0; i < nodes; i += 3) {
+        add(store, node(i), LABEL, "\"l" + std::to_string(i % 4) + "\"");
+    }
+}
+
+// 广度优先搜索：经一条及以上的边可达的节点
+std::map<int, std::set<int>> bfsClosure(const std::vector<std::pair<int, int>>& edges) {
+    std::map<int, std::vector<int>> adjacency;
+    for (const auto& e : edges) {
+        adjacency[e.first].push_back(e.second);
+    }
+    std::map<int, std::set<int>> result;
+    for (const auto& entry : adjacency) {
+        std::set<int>& seen = result[entry.first];
+        std::vector<int> frontier = entry.second;
+        while (!frontier.empty()) {
+            int next = frontier.back();
+            frontier.pop_back();
+            if (seen.insert(next).second) {
+                auto it = adjacency.find(next);
+                if (it != adjacency.end()) {
+                    frontier.insert(frontier.end(), it->second.begin(), it->second.end());
+                }
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> rows(TripleStore& store, const BGPQuery& query) {
+    QueryEngine engine(store);
+    std::vector<std::vector<uint32_t>> ids;
+    QueryResult result = engine.execute(query, ids);
+    EXPECT_TRUE(result.ok) << result.error;
+    std::vector<std::string> rendered;
+    for (const auto& row : ids) {
+        std::string line;
+        for (uint32_t value : row) {
+            line += store.getStringPool().getString(value) + " ";
+        }
+        rendered.push_back(line);
+    }
+    std::sort(rendered.begin(), rendered.end());
+    return rendered;
+}
+
+}
+
+// 各方向的查询与广度优先搜索的结果一致
+TEST(ReachabilityIndexTest, MatchesBreadthFirstSearch) {
+    const int nodes = 60;
+    for (unsigned seed = 1; seed <= 10; ++seed) {
+        const auto edges = randomEdges(seed, nodes, 90);
+        const auto closure = bfsClosure(edges);
+        TripleStore store;
+        load(store, edges, nodes);
+        ReachabilityIndex index(store, EDGE);
+        index.build();
+        StringPool& pool = store.getStringPool();
+
+        uint64_t pairs = 0;
+        std::set<uint32_t> expectedSubjects, expectedObjects;
+        for (int from = 0; from < nodes; ++from) {
+            const uint32_t fromId = pool.getId(node(from));
+            auto it = closure.find(from);
+            const std::set<int> empty;
+            const std::set<int>& reached = it != closure.end() ? it->second : empty;
+            pairs += reached.size();
+
+            std::vector<uint32_t> objects;
+            index.objectsOf(fromId, objects);
+            std::set<uint32_t> expected;
+            for (int to : reached) {
+                expected.insert(pool.getId(node(to)));
+                expectedObjects.insert(pool.getId(node(to)));
+            }
+            if (!reached.empty()) {
+                expectedSubjects.insert(fromId);
+            }
+            EXPECT_EQ(objects.size(), expected.size()) << "seed " << seed << " from " << from;
+            EXPECT_EQ(std::set<uint32_t>(objects.begin(), objects.end()), expected) << "seed " << seed;
+
+            for (int to = 0; to < nodes; ++to) {
+                ASSERT_EQ(index.contains(fromId, pool.getId(node(to))), reached.count(to) > 0)
+                        << "seed " << seed << " " << from << " -> " << to;
+            }
+        }
+        for (int to = 0; to < nodes; ++to) {
+            std::vector<uint32_t> subjects;
+            index.subjectsOf(pool.getId(node(to)), subjects);
+            std::set<uint32_t> expected;
+            for (const auto& entry : closure) {
+                if (entry.second.count(to)) {
+                    expected.insert(pool.getId(node(entry.first)));
+                }
+            }
+            EXPECT_EQ(subjects.size(), expected.size()) << "seed " << seed << " to " << to;
+            EXPECT_EQ(std::set<uint32_t>(subjects.begin(), subjects.end()), expected) << "seed " << seed;
+        }
+
+        std::vector<uint32_t> subjects, objects;
+        index.subjects(subjects);
+        index.objects(objects);
+        EXPECT_EQ(std::set<uint32_t>(subjects.begin(), subjects.end()), expectedSubjects);
+        EXPECT_EQ(std::set<uint32_t>(objects.begin(), objects.end()), expectedObjects);
+        EXPECT_EQ(index.size(), pairs);
+        // 不是边端点的实体不可达
+        EXPECT_FALSE(index.contains(pool.getId(LABEL), pool.getId(node(0))));
+    }
+}
+
+TEST(ReachabilityIndexTest, CyclesAndSelfLoops) {
+    // n0 -> n1 -> n2 -> n0 为环，n3 有自环，n4 单独一条边指向环
+    TripleStore store;
+    load(store, {{0, 1}, {1, 2}, {2, 0}, {3, 3}, {4, 0}}, 0);
+    ReachabilityIndex index(store, EDGE);
+    index.build();
+    StringPool& pool = store.getStringPool();
+    auto reaches = [&](int a, int b) { return index.contains(pool.getId(node(a)), pool.getId(node(b))); };
+
+    EXPECT_TRUE(reaches(0, 0));
+    EXPECT_TRUE(reaches(2, 1));
+    EXPECT_TRUE(reaches(3, 3));
+    EXPECT_TRUE(reaches(4, 2));
+    EXPECT_FALSE(reaches(4, 4));
+    EXPECT_FALSE(reaches(0, 4));
+    EXPECT_FALSE(reaches(3, 0));
+    EXPECT_EQ(index.getStats().components, 3u);
+    EXPECT_EQ(index.size(), 9u + 1u + 3u);
+}
+
+// 注册为虚谓语后，查询与读取它的规则和物化传递闭包的结果一致
+TEST(ReachabilityIndexTest, VirtualPredicateMatchesMaterializedClosure) {
+    const int nodes = 40;
+    const std::vector<Rule> closureRules = {
+        Rule("", {{"?X", EDGE, "?Y"}}, {"?X", PATH, "?Y"}),
+        Rule("", {{"?X", EDGE, "?Y"}, {"?Y", PATH, "?Z"}}, {"?X", PATH, "?Z"}),
+    };
+    const std::vector<Rule> readers = {
+        Rule("", {{"?X", PATH, "?Y"}, {"?Y", LABEL, "\"l0\""}}, {"?X", REACHES, "\"l0\""}),
+    };
+    std::vector<BGPQuery> queries(5);
+    queries[0].patterns = {{"?x", PATH, "?y"}};
+    queries[1].patterns = {{node(3), PATH, "?y"}};
+    queries[2].patterns = {{"?x", PATH, node(20)}};
+    queries[3].patterns = {{"?x", PATH, "?x"}};
+    queries[4].patterns = {{"?x", LABEL, "?l"}, {"?x", PATH, "?y"}, {"?y", LABEL, "?l"}};
+    queries[4].select = {"?x", "?y"};
+
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        const auto edges = randomEdges(seed, nodes, 60);
+
+        TripleStore materialized;
+        load(materialized, edges, nodes);
+        std::vector<Rule> all = closureRules;
+        all.insert(all.end(), readers.begin(), readers.end());
+        DatalogEngine(materialized, all).reason();
+
+        TripleStore indexed;
+        load(indexed, edges, nodes);
+        ReachabilityIndex index(indexed, EDGE);
+        index.build();
+        indexed.registerVirtualPredicate(PATH, &index);
+        // 规则头为虚谓语的规则不执行
+        DatalogEngine(indexed, all).reason();
+
+        for (size_t q = 0; q < queries.size(); ++q) {
+            EXPECT_EQ(rows(indexed, queries[q]), rows(materialized, queries[q])) << "seed " << seed << " query " << q;
+        }
+        BGPQuery reached;
+        reached.patterns = {{"?x", REACHES, "?l"}};
+        EXPECT_EQ(rows(indexed, reached), rows(materialized, reached)) << "seed " << seed;
+        // 闭包没有写入事实库
+        const uint32_t pathId = indexed.getStringPool().getIdIfExists(PATH);
+        ASSERT_NE(pathId, UINT32_MAX);
+        EXPECT_TRUE(indexed.queryTripleIdsByPredicateId(pathId).empty());
+        indexed.registerVirtualPredicate(PATH, nullptr);
+    }
+}
@@ -0,0 +1,146 @@
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../SchemaReasoner.h"
+#include "../DatalogEngine.h"
+#include "../InputParser.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+namespace {
+
+const std::string RDF = "http://www.w3.org/1999/02/22-rdf-syntax-ns#";
+const std::string RDFS = "http://www.w3.org/2000/01/rdf-schema#";
+const std::string OWL = "http://www.w3.org/2002/07/owl#";
+const std::string EX = "http://example.org/";
+
+const uint32_t ALL_RULES = (1u << 14) - 1;
+
+// 仓库自带的 OWL-RL 子集规则文件，测试在 tests 目录下运行
+std::vector<Rule> owlRlRules() {
+    InputParser parser;
+    return parser.parseDatalogFromFile("../input_examples/owl-rl.dl");
+}
+
+std::set<TermFact> genericClosure(const std::set<TermFact>& facts, const std::vector<Rule>& rules) {
+    TripleStore store;
+    load(store, facts);
+    DatalogEngine engine(store, rules);
+    engine.reason();
+    return contents(store);
+}
+
+// 随机的模式与数据：属性与类的层次可能成环，全部十四种内置规则都有机会触发
+std::set<TermFact> randomOntology(unsigned seed) {
+    std::mt19937 random(seed);
+    auto pick = [&](const std::string& kind, int count) {
+        return EX + kind + std::to_string(random() % count);
+    };
+    std::set<TermFact> facts;
+    for (int i = 0; i < 5; ++i) {
+        facts.emplace(pick("p", 8), RDFS + "subPropertyOf", pick("p", 8));
+        facts.emplace(pick("C", 8), RDFS + "subClassOf", pick("C", 8));
+        facts.emplace(pick("p", 8), RDFS + "domain", pick("C", 8));
+        facts.emplace(pick("p", 8), RDFS + "range", pick("C", 8));
+    }
+    facts.emplace(pick("p", 8), RDF + "type", OWL + "SymmetricProperty");
+    facts.emplace(pick("p", 8), RDF + "type", OWL + "TransitiveProperty");
+    facts.emplace(pick("p", 8), OWL + "inverseOf", pick("p", 8));
+    facts.emplace(pick("p", 8), OWL + "equivalentProperty", pick("p", 8));
+    facts.emplace(pick("C", 8), OWL + "equivalentClass", pick("C", 8));
+    for (int i = 0; i < 40; ++i) {
+        facts.emplace(pick("i", 20), pick("p", 8), pick("i", 20));
+        facts.emplace(pick("i", 20), RDF + "type", pick("C", 8));
+    }
+    return facts;
+}
+
+}
+
+TEST(SchemaReasonerTest, SameRuleIgnoresVariableNamesAndBodyOrder) {
+    const Rule pattern("", {{"?p", RDFS + "domain", "?c"}, {"?x", "?p", "?y"}}, {"?x", RDF + "type", "?c"});
+    EXPECT_TRUE(sameRule(Rule("", {{"?A", "?P", "?B"}, {"?P", RDFS + "domain", "?K"}}, {"?A", RDF + "type", "?K"}),
+                         pattern));
+    // 规则头用了宾语（即 range 的写法）
+    EXPECT_FALSE(sameRule(Rule("", {{"?P", RDFS + "domain", "?K"}, {"?A", "?P", "?B"}}, {"?B", RDF + "type", "?K"}),
+                          pattern));
+    // 两个变量合并为一个
+    EXPECT_FALSE(sameRule(Rule("", {{"?P", RDFS + "domain", "?K"}, {"?A", "?P", "?A"}}, {"?A", RDF + "type", "?K"}),
+                          pattern));
+    // 常量不同
+    EXPECT_FALSE(sameRule(Rule("", {{"?P", RDFS + "range", "?K"}, {"?A", "?P", "?B"}}, {"?A", RDF + "type", "?K"}),
+                          pattern));
+}
+
+TEST(SchemaReasonerTest, RecognizesShippedRuleFile) {
+    std::vector<Rule> rules = owlRlRules();
+    ASSERT_EQ(rules.size(), 14u);
+    rules.emplace_back("", std::vector<Atom>{{"?x", EX + "parentOf", "?y"}}, Atom{"?y", EX + "childOf", "?x"});
+
+    std::vector<Rule> remaining;
+    EXPECT_EQ(recognizeSchemaRules(rules, remaining), ALL_RULES);
+    ASSERT_EQ(remaining.size(), 1u);
+    EXPECT_EQ(remaining[0].head.predicate, EX + "childOf");
+}
+
+// 内置闭包与通用引擎执行同样的规则得到相同的事实库
+TEST(SchemaReasonerTest, ClosureMatchesGenericEngine) {
+    const std::vector<Rule> rules = owlRlRules();
+    for (unsigned seed = 1; seed <= 20; ++seed) {
+        const std::set<TermFact> facts = randomOntology(seed);
+        TripleStore store;
+        load(store, facts);
+        SchemaReasoner reasoner(store, ALL_RULES);
+        const size_t inserted = reasoner.materialize();
+        EXPECT_EQ(contents(store), genericClosure(facts, rules)) << "seed " << seed;
+        EXPECT_EQ(inserted, store.getTripleCount() - facts.size()) << "seed " << seed;
+        // 再次计算不产生新事实
+        EXPECT_EQ(reasoner.materialize(), 0u) << "seed " << seed;
+    }
+}
+
+// 只启用部分规则时只计算这部分规则的闭包
+TEST(SchemaReasonerTest, EnabledSubsetMatchesGenericEngine) {
+    const std::vector<Rule> all = owlRlRules();
+    const uint32_t subset = RDFS5_SUBPROPERTY_CLOSURE | RDFS7_SUBPROPERTY | RDFS9_SUBCLASS | OWL_SYMMETRIC;
+    std::vector<Rule> rules;
+    for (const auto& rule : all) {
+        std::vector<Rule> rest;
+        if (recognizeSchemaRules({rule}, rest) & subset) {
+            rules.push_back(rule);
+        }
+    }
+    ASSERT_EQ(rules.size(), 4u);
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        const std::set<TermFact> facts = randomOntology(seed);
+        TripleStore store;
+        load(store, facts);
+        SchemaReasoner(store, subset).materialize();
+        EXPECT_EQ(contents(store), genericClosure(facts, rules)) << "seed " << seed;
+    }
+}
+
+// 其余规则推导出的模式三元组使内置闭包再做一轮
+TEST(SchemaReasonerTest, MixedRulesAlternateToFixpoint) {
+    std::vector<Rule> rules = owlRlRules();
+    // 类型为 Narrowable 的类声明为 Top 的 narrower，narrower 推出 subClassOf
+    rules.emplace_back("", std::vector<Atom>{{"?c", RDF + "type", EX + "Narrowable"}},
+                       Atom{"?c", EX + "narrower", EX + "Top"});
+    rules.emplace_back("", std::vector<Atom>{{"?c", EX + "narrower", "?d"}}, Atom{"?c", RDFS + "subClassOf", "?d"});
+
+    // C1 经类层次得到类型 Narrowable，规则推出 C1 subClassOf Top，下一轮内置闭包再传播 i100 的类型
+    std::set<TermFact> facts = randomOntology(7);
+    facts.emplace(EX + "C1", RDF + "type", EX + "Mid");
+    facts.emplace(EX + "Mid", RDFS + "subClassOf", EX + "Narrowable");
+    facts.emplace(EX + "i100", RDF + "type", EX + "C1");
+    facts.emplace(EX + "p0", RDFS + "range", EX + "C1");
+
+    TripleStore store;
+    load(store, facts);
+    reasonWithSchema(store, rules);
+    const std::set<TermFact> expected = genericClosure(facts, rules);
+    EXPECT_EQ(contents(store), expected);
+    EXPECT_TRUE(expected.count({EX + "i100", RDF + "type", EX + "Top"}));
+}
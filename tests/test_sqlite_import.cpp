@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "../InputParser.h"
+#include "../TableMapping.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+// 解析器从当前目录下的 ./SQLiteDb/<名称>.db 读取；测试在临时目录中建库并切换当前目录，结束后恢复并删除
+class SQLiteImportTest : public ::testing::Test {
+protected:
+    TripleStore store;
+    InputParser parser;
+    std::filesystem::path previous;
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "rdfpanda_sqlite_test";
+    sqlite3* db = nullptr;
+
+    void SetUp() override {
+        parser.setStringPool(&store.getStringPool());
+        previous = std::filesystem::current_path();
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root / "SQLiteDb");
+        std::filesystem::current_path(root);
+        ASSERT_EQ(sqlite3_open("SQLiteDb/test.db", &db), SQLITE_OK);
+    }
+
+    void TearDown() override {
+        sqlite3_close(db);
+        std::filesystem::current_path(previous);
+        std::filesystem::remove_all(root);
+    }
+
+    void exec(const std::string& sql) {
+        char* message = nullptr;
+        ASSERT_EQ(sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &message), SQLITE_OK) << message;
+    }
+
+    // 按行插入，rows 中的 nullptr 写为 NULL
+    void insert(const std::string& sql, const std::vector<std::vector<const char*>>& rows) {
+        exec("BEGIN");
+        sqlite3_stmt* stmt;
+        ASSERT_EQ(sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr), SQLITE_OK) << sqlite3_errmsg(db);
+        for (const auto& row : rows) {
+            for (size_t i = 0; i < row.size(); ++i) {
+                if (row[i]) {
+                    sqlite3_bind_text(stmt, static_cast<int>(i + 1), row[i], -1, SQLITE_TRANSIENT);
+                } else {
+                    sqlite3_bind_null(stmt, static_cast<int>(i + 1));
+                }
+            }
+            ASSERT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+        exec("COMMIT");
+    }
+
+    // 大表：按 rowid 可划分为多个区间；部分行被删除使 rowid 不连续，部分行含 NULL
+    void createLargeTable(const std::string& table, bool indexed) {
+        exec("CREATE TABLE " + table + " (subject TEXT, predicate TEXT, object TEXT)");
+        std::vector<std::string> values;
+        std::vector<std::vector<const char*>> rows;
+        const int count = 300000;
+        values.reserve(count * 3);
+        for (int i = 0; i < count; ++i) {
+            // 主语的取值与 rowid 的顺序无关
+            values.push_back("http://ex/s" + std::to_string(i * 7919LL % 5003));
+            values.push_back("http://ex/p" + std::to_string(i % 7));
+            values.push_back("\"" + std::to_string(i) + "\"");
+        }
+        for (int i = 0; i < count; ++i) {
+            rows.push_back({values[i * 3].c_str(), values[i * 3 + 1].c_str(),
+                            i % 10007 == 5 ? nullptr : values[i * 3 + 2].c_str()});
+        }
+        insert("INSERT INTO " + table + " VALUES (?1, ?2, ?3)", rows);
+        exec("DELETE FROM " + table + " WHERE rowid BETWEEN 100000 AND 180000");
+        if (indexed) {
+            exec("CREATE INDEX " + table + "_subject ON " + table + " (subject)");
+        }
+    }
+};
+
+TEST_F(SQLiteImportTest, SkipsNullRows) {
+    exec("CREATE TABLE t (subject TEXT, predicate TEXT, object TEXT)");
+    insert("INSERT INTO t VALUES (?1, ?2, ?3)", {
+            {"http://ex/a", "http://ex/p", "\"1\""},
+            {"http://ex/a", nullptr, "\"2\""},
+            {"http://ex/b", "http://ex/p", "http://ex/c"},
+    });
+    EXPECT_EQ(terms(parser.parseSQLiteTable("test", "t", 1)), (std::vector<TermFact>{
+            {"http://ex/a", "http://ex/p", "\"1\""},
+            {"http://ex/b", "http://ex/p", "http://ex/c"},
+    }));
+    EXPECT_TRUE(parser.parseSQLiteTable("missing", "t", 1).empty());
+    EXPECT_TRUE(parser.parseSQLiteTable("test", "no_such_table", 4).empty());
+}
+
+// 多线程按 rowid 区间读取的结果与单线程相同，且保持 rowid 的顺序
+TEST_F(SQLiteImportTest, RowidRangesMatchSingleThread) {
+    createLargeTable("facts", false);
+    const std::vector<TermFact> single = terms(parser.parseSQLiteTable("test", "facts", 1));
+    ASSERT_EQ(single.size(), 300000u - 80001u - 30u + 8u);
+    EXPECT_EQ(std::get<2>(single.front()), "\"0\"");
+    EXPECT_EQ(std::get<2>(single.back()), "\"299999\"");
+    EXPECT_TRUE(terms(parser.parseSQLiteTable("test", "facts", 4)) == single);
+    EXPECT_TRUE(terms(parser.parseSQLiteTable("test", "facts", 3)) == single);
+}
+
+// 排序模式：多线程按主语划分的结果与单线程的 ORDER BY 相同，有无 subject 索引结果一致
+TEST_F(SQLiteImportTest, SortedModeIsGloballyOrdered) {
+    createLargeTable("facts", false);
+    createLargeTable("indexed", true);
+    const std::vector<TermFact> sorted = terms(parser.parseSQLiteTable("test", "facts", 1, true));
+    ASSERT_FALSE(sorted.empty());
+    EXPECT_TRUE(std::is_sorted(sorted.begin(), sorted.end()));
+
+    std::vector<TermFact> unsorted = terms(parser.parseSQLiteTable("test", "facts", 4));
+    std::sort(unsorted.begin(), unsorted.end());
+    EXPECT_TRUE(unsorted == sorted);
+
+    EXPECT_TRUE(terms(parser.parseSQLiteTable("test", "facts", 4, true)) == sorted);
+    EXPECT_TRUE(terms(parser.parseSQLiteTable("test", "indexed", 4, true)) == sorted);
+}
+
+// 没有 rowid 的表用一条查询读取
+TEST_F(SQLiteImportTest, WithoutRowidTable) {
+    exec("CREATE TABLE w (subject TEXT, predicate TEXT, object TEXT, PRIMARY KEY (subject, predicate, object)) "
+         "WITHOUT ROWID");
+    insert("INSERT INTO w VALUES (?1, ?2, ?3)", {
+            {"http://ex/b", "http://ex/p", "\"2\""},
+            {"http://ex/a", "http://ex/p", "\"1\""},
+    });
+    std::vector<TermFact> result = terms(parser.parseSQLiteTable("test", "w", 4, true));
+    EXPECT_EQ(result, (std::vector<TermFact>{
+            {"http://ex/a", "http://ex/p", "\"1\""},
+            {"http://ex/b", "http://ex/p", "\"2\""},
+    }));
+}
+
+// 整数编码的事实表：按字典转换，含 NULL、非整数或字典中没有的键的行被跳过，其余行保持顺序
+TEST_F(SQLiteImportTest, EncodedTablesResolveThroughDictionary) {
+    exec("CREATE TABLE dict (id INTEGER, lexical TEXT)");
+    exec("CREATE TABLE fact (s_id INTEGER, p_id INTEGER, o_id INTEGER)");
+    exec("INSERT INTO dict VALUES (1, 'http://ex/a'), (2, 'http://ex/p'), (3, '\"lit\"@en'), (5, 'http://ex/b'), "
+         "(6, NULL)");
+    exec("INSERT INTO fact VALUES (1, 2, 3), (5, 2, 1), (1, 2, 4), (1, NULL, 3), (6, 2, 1), ('x', 2, 3), (5, 2, 3)");
+    const size_t poolBefore = store.getStringPool().size();
+
+    EXPECT_EQ(terms(parser.parseEncodedSQLiteTables("test", "fact", "dict")), (std::vector<TermFact>{
+            {"http://ex/a", "http://ex/p", "\"lit\"@en"},
+            {"http://ex/b", "http://ex/p", "http://ex/a"},
+            {"http://ex/b", "http://ex/p", "\"lit\"@en"},
+    }));
+    // 字典中的每个词项写入字符串池一次
+    EXPECT_EQ(store.getStringPool().size(), poolBefore + 4);
+
+    EXPECT_TRUE(parser.parseEncodedSQLiteTables("test", "fact", "no_such_dict").empty());
+    EXPECT_TRUE(parser.parseEncodedSQLiteTables("test", "no_such_fact", "dict").empty());
+    EXPECT_TRUE(parser.parseEncodedSQLiteTables("missing", "fact", "dict").empty());
+}
+
+// 键稀疏（跨度远大于字典大小）时改用哈希表，结果与字符串表的导入一致
+TEST_F(SQLiteImportTest, EncodedTablesMatchStringTable) {
+    exec("CREATE TABLE dict (id INTEGER, lexical TEXT)");
+    exec("CREATE TABLE fact (s_id INTEGER, p_id INTEGER, o_id INTEGER)");
+    exec("CREATE TABLE plain (subject TEXT, predicate TEXT, object TEXT)");
+    for (int64_t stride : {1LL, 1000003LL}) {
+        exec("DELETE FROM dict");
+        exec("DELETE FROM fact");
+        exec("DELETE FROM plain");
+        exec("BEGIN");
+        for (int i = 0; i < 3000; ++i) {
+            exec("INSERT INTO dict VALUES (" + std::to_string(-5000 + i * stride) + ", 'http://ex/t" +
+                 std::to_string(i) + "')");
+        }
+        for (int i = 0; i < 5000; ++i) {
+            const int s = i % 3000, p = i % 11, o = (i * 13) % 3000;
+            exec("INSERT INTO fact VALUES (" + std::to_string(-5000 + s * stride) + ", " +
+                 std::to_string(-5000 + p * stride) + ", " + std::to_string(-5000 + o * stride) + ")");
+            exec("INSERT INTO plain VALUES ('http://ex/t" + std::to_string(s) + "', 'http://ex/t" +
+                 std::to_string(p) + "', 'http://ex/t" + std::to_string(o) + "')");
+        }
+        exec("COMMIT");
+
+        const std::vector<TermFact> encoded = terms(parser.parseEncodedSQLiteTables("test", "fact", "dict"));
+        ASSERT_EQ(encoded.size(), 5000u) << "stride " << stride;
+        EXPECT_TRUE(encoded == terms(parser.parseSQLiteTable("test", "plain", 1))) << "stride " << stride;
+    }
+}
+
+// 映射导入：示例映射读取同样内容的 SQL 表与 CSV 结果相同；多批行并行映射与单线程结果一致
+TEST_F(SQLiteImportTest, MappedTableMatchesCsv) {
+    std::vector<TriplesMap> maps;
+    std::string error;
+    const std::filesystem::path examples = previous / ".." / "input_examples";
+    ASSERT_TRUE(loadTriplesMaps((examples / "example-mapping.ttl").string(), maps, error)) << error;
+    const std::vector<TermFact> fromCsv = terms(parser.parseMappedCSV((examples / "example-wide.csv").string(), maps[0], 1));
+    ASSERT_EQ(fromCsv.size(), 12u);
+
+    exec("CREATE TABLE people (id INTEGER, name TEXT, age INTEGER, dept TEXT, email TEXT)");
+    insert("INSERT INTO people VALUES (?1, ?2, ?3, ?4, ?5)", {
+            {"1", "Alice", "34", "R&D", "alice@example.org"},
+            {"2", "Smith, Bob", nullptr, "Sales", nullptr},
+            {"3", "Carol \"CJ\" Jones", "28", nullptr, "carol@example.org"},
+    });
+    EXPECT_EQ(terms(parser.parseMappedSQLiteTable("test", maps[0], 1)), fromCsv);
+    EXPECT_EQ(terms(parser.parseMappedSQLiteTable("test", maps[0], 4)), fromCsv);
+
+    // rr:sqlQuery 来源：按查询结果的列名映射
+    TriplesMap query = maps[0];
+    query.tableName.clear();
+    query.sqlQuery = "SELECT id, name, age, dept, email FROM people WHERE id > 1";
+    const std::vector<TermFact> filtered(fromCsv.begin() + 5, fromCsv.end());
+    EXPECT_EQ(terms(parser.parseMappedSQLiteTable("test", query, 2)), filtered);
+
+    exec("BEGIN");
+    for (int i = 4; i < 60000; ++i) {
+        exec("INSERT INTO people VALUES (" + std::to_string(i) + ", 'n" + std::to_string(i) + "', " +
+             (i % 3 ? std::to_string(i % 90) : "NULL") + ", 'd" + std::to_string(i % 5) + "', NULL)");
+    }
+    exec("COMMIT");
+    const std::vector<TermFact> single = terms(parser.parseMappedSQLiteTable("test", maps[0], 1));
+    EXPECT_EQ(single.size(), 12u + 59996u * 3 + 39998u);
+    EXPECT_TRUE(terms(parser.parseMappedSQLiteTable("test", maps[0], 4)) == single);
+}
@@ -0,0 +1,147 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../InputParser.h"
+#include "../TableMapping.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+namespace {
+
+const std::string RR = "@prefix rr: <http://www.w3.org/ns/r2rml#> .\n@prefix ex: <http://example.org/> .\n";
+
+}
+
+class TableMappingTest : public ::testing::Test {
+protected:
+    TripleStore store;
+    InputParser parser;
+    const std::string mappingPath = tempPath("rdfpanda_mapping.ttl");
+    const std::string csvPath = tempPath("rdfpanda_mapping.csv");
+
+    void SetUp() override {
+        parser.setStringPool(&store.getStringPool());
+    }
+
+    void TearDown() override {
+        std::remove(mappingPath.c_str());
+        std::remove(csvPath.c_str());
+    }
+
+    TriplesMap loadMapping(const std::string& turtle) {
+        writeFile(mappingPath, RR + turtle);
+        std::vector<TriplesMap> maps;
+        std::string error;
+        EXPECT_TRUE(loadTriplesMaps(mappingPath, maps, error)) << error;
+        return maps.empty() ? TriplesMap() : maps[0];
+    }
+};
+
+// 仓库自带的示例映射：模板的百分号编码、带类型的字面量、NULL 与空字段不生成三元组
+TEST_F(TableMappingTest, ShippedExample) {
+    std::vector<TriplesMap> maps;
+    std::string error;
+    ASSERT_TRUE(loadTriplesMaps("../input_examples/example-mapping.ttl", maps, error)) << error;
+    ASSERT_EQ(maps.size(), 1u);
+    EXPECT_EQ(maps[0].name, "http://example.org/mapping#People");
+    EXPECT_EQ(maps[0].tableName, "people");
+    EXPECT_EQ(maps[0].selectQuery(), "SELECT * FROM people");
+    EXPECT_EQ(maps[0].predicateObjects.size(), 4u);
+
+    const std::string person = "http://example.org/person/";
+    const std::string foaf = "http://xmlns.com/foaf/0.1/";
+    const std::string type = "http://www.w3.org/1999/02/22-rdf-syntax-ns#type";
+    const std::string integer = "^^<http://www.w3.org/2001/XMLSchema#integer>";
+    std::vector<Triple> triples = parser.parseMappedCSV("../input_examples/example-wide.csv", maps[0], 1);
+    EXPECT_TRUE(parser.getParseErrors().empty());
+    EXPECT_EQ(terms(triples), (std::vector<TermFact>{
+            {person + "1", type, foaf + "Person"},
+            {person + "1", foaf + "name", "\"Alice\""},
+            {person + "1", foaf + "age", "\"34\"" + integer},
+            {person + "1", "http://example.org/dept", "http://example.org/dept/R%26D"},
+            {person + "1", foaf + "mbox", "mailto:alice%40example.org"},
+            {person + "2", type, foaf + "Person"},
+            {person + "2", foaf + "name", "\"Smith, Bob\""},
+            {person + "2", "http://example.org/dept", "http://example.org/dept/Sales"},
+            {person + "3", type, foaf + "Person"},
+            {person + "3", foaf + "name", "\"Carol \\\"CJ\\\" Jones\""},
+            {person + "3", foaf + "age", "\"28\"" + integer},
+            {person + "3", foaf + "mbox", "mailto:carol%40example.org"},
+    }));
+}
+
+TEST_F(TableMappingTest, TermKinds) {
+    TriplesMap map = loadMapping(
+            "<#M> rr:logicalTable [ rr:sqlQuery \"SELECT a, b FROM t\" ] ;\n"
+            "  rr:subjectMap [ rr:column \"a\" ; rr:termType rr:BlankNode ] ;\n"
+            "  rr:predicateObjectMap [ rr:predicate ex:p, ex:q ; rr:objectMap [ rr:column \"b\" ; rr:language \"en\" ] ] ;\n"
+            "  rr:predicateObjectMap [ rr:predicateMap [ rr:constant ex:r ] ; rr:object ex:fixed ] ;\n"
+            "  rr:predicateObjectMap [ rr:predicate ex:s ; rr:objectMap [ rr:template \"{a}-{b}\" ; rr:termType rr:Literal ] ] .\n");
+    EXPECT_EQ(map.selectQuery(), "SELECT a, b FROM t");
+    writeFile(csvPath, "a,b\nx1,\"hello \"\"w\"\"\"\n,skipped\nx2,\n");
+    std::vector<Triple> triples = parser.parseMappedCSV(csvPath, map, 1);
+    EXPECT_TRUE(parser.getParseErrors().empty());
+
+    // 主语为 NULL 的行整行跳过；b 为 NULL 时引用它的项不生成
+    EXPECT_EQ(terms(triples), (std::vector<TermFact>{
+            {"_:x1", "http://example.org/p", "\"hello \\\"w\\\"\"@en"},
+            {"_:x1", "http://example.org/q", "\"hello \\\"w\\\"\"@en"},
+            {"_:x1", "http://example.org/r", "http://example.org/fixed"},
+            {"_:x1", "http://example.org/s", "\"x1-hello \\\"w\\\"\""},
+            {"_:x2", "http://example.org/r", "http://example.org/fixed"},
+    }));
+}
+
+TEST_F(TableMappingTest, UnsupportedMappingsAreRejected) {
+    std::vector<TriplesMap> maps;
+    std::string error;
+    writeFile(mappingPath, RR +
+            "<#A> rr:subjectMap [ rr:template \"http://ex/{id}\" ] ;\n"
+            "  rr:predicateObjectMap [ rr:predicate ex:p ; rr:objectMap [ rr:parentTriplesMap <#B> ] ] .\n");
+    EXPECT_FALSE(loadTriplesMaps(mappingPath, maps, error));
+    EXPECT_NE(error.find("parentTriplesMap"), std::string::npos);
+
+    writeFile(mappingPath, RR + "<#A> rr:subjectMap [ rr:column \"id\" ; rr:termType rr:Literal ] .\n");
+    EXPECT_FALSE(loadTriplesMaps(mappingPath, maps, error));
+    EXPECT_NE(error.find("literal"), std::string::npos);
+
+    writeFile(mappingPath, RR + "ex:a ex:b ex:c .\n");
+    EXPECT_FALSE(loadTriplesMaps(mappingPath, maps, error));
+    EXPECT_NE(error.find("no rr:subjectMap"), std::string::npos);
+
+    EXPECT_FALSE(loadTriplesMaps(tempPath("rdfpanda_missing_mapping.ttl"), maps, error));
+}
+
+TEST_F(TableMappingTest, MissingColumnThrows) {
+    TriplesMap map = loadMapping("<#M> rr:subjectMap [ rr:template \"http://ex/{id}\" ] ;\n"
+                                 "  rr:predicateObjectMap [ rr:predicate ex:p ; rr:objectMap [ rr:column \"absent\" ] ] .\n");
+    EXPECT_THROW(RowMapper(map, {"id", "name"}, store.getStringPool()), std::runtime_error);
+    EXPECT_NO_THROW(RowMapper(map, {"absent", "id"}, store.getStringPool()));
+}
+
+// 多块并行映射与单线程的结果（含顺序）一致，字段中的换行不影响分块
+TEST_F(TableMappingTest, ChunkBoundariesMatchSingleThread) {
+    TriplesMap map = loadMapping("<#M> rr:subjectMap [ rr:template \"http://ex/row/{id}\" ; rr:class ex:Row ] ;\n"
+                                 "  rr:predicateObjectMap [ rr:predicate ex:v ; rr:objectMap [ rr:column \"v\" ] ] .\n");
+    {
+        std::ofstream out(csvPath, std::ios::binary);
+        out << "id,v\n";
+        for (int i = 0; i < 200000; ++i) {
+            out << i << ",";
+            if (i % 1000 == 0) {
+                out << "\"multi\nline " << i << "\"\n";
+            } else {
+                out << "value number " << i << " with some padding text\n";
+            }
+        }
+    }
+    ASSERT_GT(std::filesystem::file_size(csvPath), 8u << 20);
+    std::vector<TermFact> single = terms(parser.parseMappedCSV(csvPath, map, 1));
+    ASSERT_EQ(single.size(), 400000u);
+    EXPECT_EQ(std::get<2>(single[1]), "\"multi\\nline 0\"");
+    EXPECT_TRUE(terms(parser.parseMappedCSV(csvPath, map, 4)) == single);
+}
@@ -0,0 +1,113 @@
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../TrieJoin.h"
+#include "../ReachabilityIndex.h"
+#include "gtest/gtest.h"
+#include "test_util.h"
+
+namespace {
+
+JoinAtom atom(JoinTerm s, JoinTerm p, JoinTerm o) {
+    JoinAtom result;
+    result.terms[0] = s;
+    result.terms[1] = p;
+    result.terms[2] = o;
+    return result;
+}
+
+}
+
+// 三角形 edge(X, Y), edge(Y, Z), edge(Z, X)：环状规则体的多路连接
+TEST(TrieJoinTest, TriangleJoin) {
+    TripleStore store;
+    const std::vector<std::pair<int, int>> edges = {{1, 2}, {2, 3}, {3, 1}, {3, 4}, {4, 1}, {2, 4}, {5, 6}};
+    for (const auto& e : edges) {
+        add(store, "n" + std::to_string(e.first), "edge", "n" + std::to_string(e.second));
+    }
+    const JoinTerm edge = JoinTerm::constant(id(store, "edge"));
+    const JoinTerm x = JoinTerm::variable(0), y = JoinTerm::variable(1), z = JoinTerm::variable(2);
+    std::vector<JoinAtom> atoms = {atom(x, edge, y), atom(y, edge, z), atom(z, edge, x)};
+    JoinPlan plan = planJoin(store, atoms, 3, std::vector<bool>(3, false));
+    ASSERT_TRUE(plan.valid) << plan.error;
+
+    JoinStack stack;
+    std::set<std::tuple<std::string, std::string, std::string>> triangles;
+    for (int round = 0; round < 2; ++round) {
+        triangles.clear();
+        std::vector<uint32_t> bindings(3, UNBOUND_ID);
+        TrieJoin join(plan, stack);
+        join.run(bindings, [&](const std::vector<uint32_t>& b) {
+            const StringPool& pool = store.getStringPool();
+            triangles.emplace(pool.getString(b[0]), pool.getString(b[1]), pool.getString(b[2]));
+        });
+    }
+    // n1→n2→n3 与 n1→n2→n4 两个有向环，各有三种旋转；n3→n4→n1 缺少 n1→n3
+    EXPECT_EQ(triangles.size(), 6u);
+    EXPECT_TRUE(triangles.count({"n1", "n2", "n3"}));
+    EXPECT_TRUE(triangles.count({"n4", "n1", "n2"}));
+    EXPECT_FALSE(triangles.count({"n1", "n3", "n2"}));
+}
+
+// 工作区在多次连接间复用：同一计划再次执行不再分配
+TEST(TrieJoinTest, StackReuseStopsAllocating) {
+    TripleStore store;
+    for (int i = 0; i < 100; ++i) {
+        add(store, "n" + std::to_string(i), "edge", "n" + std::to_string((i * 7 + 1) % 100));
+    }
+    const JoinTerm edge = JoinTerm::constant(id(store, "edge"));
+    std::vector<JoinAtom> atoms = {atom(JoinTerm::variable(0), edge, JoinTerm::variable(1)),
+                                   atom(JoinTerm::variable(1), edge, JoinTerm::variable(2))};
+    JoinPlan plan = planJoin(store, atoms, 3, std::vector<bool>(3, false));
+    ASSERT_TRUE(plan.valid) << plan.error;
+
+    JoinStack stack;
+    size_t results = 0;
+    std::vector<uint32_t> bindings(3, UNBOUND_ID);
+    TrieJoin(plan, stack).run(bindings, [&](const std::vector<uint32_t>&) { results++; });
+    const size_t allocations = stack.getAllocationCount();
+    EXPECT_GT(allocations, 0u);
+    for (int round = 0; round < 5; ++round) {
+        TrieJoin(plan, stack).run(bindings, [&](const std::vector<uint32_t>&) { results++; });
+    }
+    EXPECT_EQ(results, 600u);
+    EXPECT_EQ(stack.getAllocationCount(), allocations);
+}
+
+// 变量只出现在虚模式中时由虚谓语生成候选，候选缓冲扩容同样计入分配次数
+TEST(TrieJoinTest, VirtualCandidateBufferGrowthIsCounted) {
+    TripleStore store;
+    for (int i = 0; i < 200; ++i) {
+        add(store, "n" + std::to_string(i), "edge", "n" + std::to_string(i + 1));
+    }
+    ReachabilityIndex reach(store, "edge");
+    reach.build();
+    store.registerVirtualPredicate("reach", &reach);
+
+    const JoinTerm reachTerm = JoinTerm::constant(id(store, "reach"));
+    std::vector<JoinAtom> atoms = {atom(JoinTerm::variable(0), reachTerm, JoinTerm::variable(1))};
+    std::vector<bool> prebound = {true, false};
+    JoinPlan plan = planJoin(store, atoms, 2, prebound);
+    ASSERT_TRUE(plan.valid) << plan.error;
+
+    JoinStack stack;
+    auto reachable = [&](const std::string& from) {
+        std::vector<uint32_t> bindings = {id(store, from), UNBOUND_ID};
+        size_t count = 0;
+        TrieJoin(plan, stack).run(bindings, [&](const std::vector<uint32_t>&) { count++; });
+        return count;
+    };
+
+    EXPECT_EQ(reachable("n198"), 2u);
+    const size_t small = stack.getAllocationCount();
+    EXPECT_EQ(reachable("n0"), 200u);
+    const size_t large = stack.getAllocationCount();
+    EXPECT_GT(large, small);
+    EXPECT_EQ(reachable("n10"), 190u);
+    EXPECT_EQ(reachable("n0"), 200u);
+    EXPECT_EQ(stack.getAllocationCount(), large);
+
+    store.registerVirtualPredicate("reach", nullptr);
+}
@@ -0,0 +1,94 @@
+#ifndef RDFPANDA_STORAGE_TEST_UTIL_H
+#define RDFPANDA_STORAGE_TEST_UTIL_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../InputParser.h"
+
+// 各测试共用的辅助函数：按字符串构造与读取事实、临时文件读写
+
+// 以字符串表示的三元组，及带来源标记的三元组
+using TermFact = std::tuple<std::string, std::string, std::string>;
+using FlaggedFact = std::tuple<std::string, std::string, std::string, int>;
+
+inline uint32_t id(TripleStore& store, const std::string& term) {
+    return store.getStringPool().getId(term);
+}
+
+inline Triple makeTriple(TripleStore& store, const std::string& s, const std::string& p, const std::string& o) {
+    return Triple(id(store, s), id(store, p), id(store, o));
+}
+
+inline void add(TripleStore& store, const std::string& s, const std::string& p, const std::string& o,
+                uint8_t flags = BASE_FACT) {
+    store.addTriple(makeTriple(store, s, p, o), flags);
+}
+
+inline void load(TripleStore& store, const std::set<TermFact>& facts) {
+    for (const auto& f : facts) {
+        add(store, std::get<0>(f), std::get<1>(f), std::get<2>(f));
+    }
+}
+
+// 事实库内容，不含来源标记
+inline std::set<TermFact> contents(const TripleStore& store) {
+    std::set<TermFact> result;
+    const StringPool& pool = store.getStringPool();
+    for (const auto& t : store.getAllTripleIds()) {
+        result.emplace(pool.getString(t.subject_id), pool.getString(t.predicate_id), pool.getString(t.object_id));
+    }
+    return result;
+}
+
+// 事实库内容及每个三元组的来源标记
+inline std::set<FlaggedFact> flaggedContents(const TripleStore& store) {
+    std::set<FlaggedFact> result;
+    const StringPool& pool = store.getStringPool();
+    const auto& ids = store.getAllTripleIds();
+    for (size_t i = 0; i < ids.size(); ++i) {
+        result.emplace(pool.getString(ids[i].subject_id), pool.getString(ids[i].predicate_id),
+                       pool.getString(ids[i].object_id), store.getTripleFlags(static_cast<uint32_t>(i)));
+    }
+    return result;
+}
+
+// 解析结果按原顺序转为字符串
+inline std::vector<TermFact> terms(const std::vector<Triple>& triples) {
+    std::vector<TermFact> result;
+    for (const auto& t : triples) {
+        result.emplace_back(t.subject(), t.predicate(), t.object());
+    }
+    return result;
+}
+
+inline std::vector<size_t> errorLines(const InputParser& parser) {
+    std::vector<size_t> lines;
+    for (const auto& error : parser.getParseErrors()) {
+        lines.push_back(error.line);
+    }
+    return lines;
+}
+
+inline std::string tempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+inline std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+inline void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+}
+
+
+#endif //RDFPANDA_STORAGE_TEST_UTIL_H